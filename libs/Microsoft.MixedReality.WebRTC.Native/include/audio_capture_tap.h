@@ -0,0 +1,190 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <atomic>
+#include <vector>
+
+#include "api/mediastreaminterface.h"
+#include "modules/audio_device/include/audio_device.h"
+
+#include "rcu_ptr.h"
+
+namespace Microsoft::MixedReality::WebRTC {
+
+/// Process-wide tap delivering the audio recorded by the audio capture device
+/// to the registered sinks.
+///
+/// WebRTC does not deliver the local audio to the sinks of the local audio
+/// tracks, as their source is the audio device module shared by all tracks,
+/// which pushes its recorded audio directly into the audio transport of the
+/// voice engine. The tap is fed by a |TappedAudioDeviceModule| wrapping that
+/// module instead.
+///
+/// The audio is tapped before the audio processing of the voice engine, so the
+/// sinks receive it before echo cancellation, noise suppression and automatic
+/// gain control, unlike the audio sent to the remote peers.
+///
+/// The registered sinks are published as an immutable snapshot, so that
+/// delivering a frame never takes a lock. See |AudioFrameObserver|.
+class AudioCaptureTap {
+ public:
+  /// Get the process-wide tap.
+  static AudioCaptureTap& Instance() noexcept;
+
+  /// Register |sink| to receive the recorded audio. This has no effect if the
+  /// sink is already registered. If |track| is not null, the sink only receives
+  /// the audio while that track is enabled, like the remote peer which only
+  /// receives silence from a disabled track. The tap keeps a reference to the
+  /// track until the sink is removed.
+  void AddSink(
+      webrtc::AudioTrackSinkInterface* sink,
+      rtc::scoped_refptr<webrtc::MediaStreamTrackInterface> track = nullptr)
+      noexcept;
+
+  /// Unregister |sink|. Once this returns the sink is not invoked anymore,
+  /// unless called from the sink itself.
+  void RemoveSink(webrtc::AudioTrackSinkInterface* sink) noexcept;
+
+  /// Deliver a chunk of recorded audio to all registered sinks. The sinks read
+  /// |audio_data| in place, so this makes no copy of the audio.
+  void Deliver(const void* audio_data,
+               int bits_per_sample,
+               int sample_rate,
+               size_t number_of_channels,
+               size_t number_of_frames) const noexcept;
+
+ private:
+  AudioCaptureTap() = default;
+
+  /// Registered sink, and the track gating its delivery if any.
+  struct Sink {
+    webrtc::AudioTrackSinkInterface* sink;
+    rtc::scoped_refptr<webrtc::MediaStreamTrackInterface> track;
+  };
+  RcuPtr<std::vector<Sink>> sinks_;
+};
+
+/// Audio device module forwarding all calls to a wrapped module, and feeding
+/// the |AudioCaptureTap| with the audio recorded by that module before passing
+/// it to the audio transport of the voice engine.
+///
+/// The tap sees the raw audio of the capture device, at its native sample rate
+/// and channel count, before the audio processing of the voice engine (echo
+/// cancellation, noise suppression, ...). The module only records while at
+/// least one peer connection sends audio.
+class TappedAudioDeviceModule : public webrtc::AudioDeviceModule,
+                                public webrtc::AudioTransport {
+ public:
+  /// Create a module wrapping |adm|. This must be called on the worker thread,
+  /// like all other calls to the module.
+  static rtc::scoped_refptr<TappedAudioDeviceModule> Create(
+      rtc::scoped_refptr<webrtc::AudioDeviceModule> adm) noexcept;
+
+  // AudioDeviceModule interface
+  int32_t ActiveAudioLayer(AudioLayer* audioLayer) const override;
+  int32_t RegisterAudioCallback(
+      webrtc::AudioTransport* audioCallback) override;
+  int32_t Init() override;
+  int32_t Terminate() override;
+  bool Initialized() const override;
+  int16_t PlayoutDevices() override;
+  int16_t RecordingDevices() override;
+  int32_t PlayoutDeviceName(uint16_t index,
+                            char name[webrtc::kAdmMaxDeviceNameSize],
+                            char guid[webrtc::kAdmMaxGuidSize]) override;
+  int32_t RecordingDeviceName(uint16_t index,
+                              char name[webrtc::kAdmMaxDeviceNameSize],
+                              char guid[webrtc::kAdmMaxGuidSize]) override;
+  int32_t SetPlayoutDevice(uint16_t index) override;
+  int32_t SetPlayoutDevice(WindowsDeviceType device) override;
+  int32_t SetRecordingDevice(uint16_t index) override;
+  int32_t SetRecordingDevice(WindowsDeviceType device) override;
+  int32_t PlayoutIsAvailable(bool* available) override;
+  int32_t InitPlayout() override;
+  bool PlayoutIsInitialized() const override;
+  int32_t RecordingIsAvailable(bool* available) override;
+  int32_t InitRecording() override;
+  bool RecordingIsInitialized() const override;
+  int32_t StartPlayout() override;
+  int32_t StopPlayout() override;
+  bool Playing() const override;
+  int32_t StartRecording() override;
+  int32_t StopRecording() override;
+  bool Recording() const override;
+  int32_t InitSpeaker() override;
+  bool SpeakerIsInitialized() const override;
+  int32_t InitMicrophone() override;
+  bool MicrophoneIsInitialized() const override;
+  int32_t SpeakerVolumeIsAvailable(bool* available) override;
+  int32_t SetSpeakerVolume(uint32_t volume) override;
+  int32_t SpeakerVolume(uint32_t* volume) const override;
+  int32_t MaxSpeakerVolume(uint32_t* maxVolume) const override;
+  int32_t MinSpeakerVolume(uint32_t* minVolume) const override;
+  int32_t MicrophoneVolumeIsAvailable(bool* available) override;
+  int32_t SetMicrophoneVolume(uint32_t volume) override;
+  int32_t MicrophoneVolume(uint32_t* volume) const override;
+  int32_t MaxMicrophoneVolume(uint32_t* maxVolume) const override;
+  int32_t MinMicrophoneVolume(uint32_t* minVolume) const override;
+  int32_t SpeakerMuteIsAvailable(bool* available) override;
+  int32_t SetSpeakerMute(bool enable) override;
+  int32_t SpeakerMute(bool* enabled) const override;
+  int32_t MicrophoneMuteIsAvailable(bool* available) override;
+  int32_t SetMicrophoneMute(bool enable) override;
+  int32_t MicrophoneMute(bool* enabled) const override;
+  int32_t StereoPlayoutIsAvailable(bool* available) const override;
+  int32_t SetStereoPlayout(bool enable) override;
+  int32_t StereoPlayout(bool* enabled) const override;
+  int32_t StereoRecordingIsAvailable(bool* available) const override;
+  int32_t SetStereoRecording(bool enable) override;
+  int32_t StereoRecording(bool* enabled) const override;
+  int32_t PlayoutDelay(uint16_t* delayMS) const override;
+  bool BuiltInAECIsAvailable() const override;
+  bool BuiltInAGCIsAvailable() const override;
+  bool BuiltInNSIsAvailable() const override;
+  int32_t EnableBuiltInAEC(bool enable) override;
+  int32_t EnableBuiltInAGC(bool enable) override;
+  int32_t EnableBuiltInNS(bool enable) override;
+
+  // AudioTransport interface
+  int32_t RecordedDataIsAvailable(const void* audioSamples,
+                                  const size_t nSamples,
+                                  const size_t nBytesPerSample,
+                                  const size_t nChannels,
+                                  const uint32_t samplesPerSec,
+                                  const uint32_t totalDelayMS,
+                                  const int32_t clockDrift,
+                                  const uint32_t currentMicLevel,
+                                  const bool keyPressed,
+                                  uint32_t& newMicLevel) override;
+  int32_t NeedMorePlayData(const size_t nSamples,
+                           const size_t nBytesPerSample,
+                           const size_t nChannels,
+                           const uint32_t samplesPerSec,
+                           void* audioSamples,
+                           size_t& nSamplesOut,
+                           int64_t* elapsed_time_ms,
+                           int64_t* ntp_time_ms) override;
+  void PullRenderData(int bits_per_sample,
+                      int sample_rate,
+                      size_t number_of_channels,
+                      size_t number_of_frames,
+                      void* audio_data,
+                      int64_t* elapsed_time_ms,
+                      int64_t* ntp_time_ms) override;
+
+ protected:
+  explicit TappedAudioDeviceModule(
+      rtc::scoped_refptr<webrtc::AudioDeviceModule> adm) noexcept;
+
+ private:
+  /// Wrapped audio device module.
+  rtc::scoped_refptr<webrtc::AudioDeviceModule> adm_;
+
+  /// Audio transport of the voice engine, invoked from the audio threads of
+  /// the wrapped module.
+  std::atomic<webrtc::AudioTransport*> transport_{nullptr};
+};
+
+}  // namespace Microsoft::MixedReality::WebRTC
@@ -4,11 +4,13 @@
 
 #pragma once
 
-#include <mutex>
+#include <atomic>
 
 #include "api/mediastreaminterface.h"
 
 #include "callback.h"
+#include "interop/interop_api.h"
+#include "rcu_ptr.h"
 
 namespace Microsoft::MixedReality::WebRTC {
 
@@ -25,11 +27,23 @@ using AudioFrameReadyCallback = Callback<const void*,
                                          const uint32_t,
                                          const uint32_t>;
 
-/// Video frame observer to get notified of newly available video frames.
+/// Callback fired on newly available audio frame, with its description and
+/// timing information.
+using AudioFrameInfoCallback = Callback<const AudioFrameInfo*>;
+
+/// Audio frame observer to get notified of newly available audio frames.
+///
+/// The registered callbacks are published as an immutable snapshot, so that
+/// delivering a frame never takes a lock. See |VideoFrameObserver|.
 class AudioFrameObserver : public webrtc::AudioTrackSinkInterface {
  public:
   void SetCallback(AudioFrameReadyCallback callback) noexcept;
 
+  /// Register a callback receiving the frames along with their timing
+  /// information. This is not exclusive with the callback above. Registering
+  /// a callback restarts the sample position of the frames from zero.
+  void SetCallback(AudioFrameInfoCallback callback) noexcept;
+
  protected:
   // AudioTrackSinkInterface interface
   void OnData(const void* audio_data,
@@ -39,8 +53,17 @@ class AudioFrameObserver : public webrtc::AudioTrackSinkInterface {
               size_t number_of_frames) noexcept override;
 
  private:
-  AudioFrameReadyCallback callback_;
-  std::mutex mutex_;
+  /// Snapshot of the registered callbacks.
+  struct Callbacks {
+    AudioFrameReadyCallback callback;
+    AudioFrameInfoCallback info_callback;
+  };
+  RcuPtr<Callbacks> callbacks_;
+
+  /// Position in the stream of the next sample delivered, in samples per
+  /// channel. The WebRTC audio sinks do not expose any RTP or NTP timestamp,
+  /// so the sample count is the media clock of the stream.
+  std::atomic<uint64_t> sample_position_{0};
 };
 
 }  // namespace Microsoft::MixedReality::WebRTC
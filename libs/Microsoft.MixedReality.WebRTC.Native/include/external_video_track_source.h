@@ -0,0 +1,68 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <memory>
+
+#include "media/base/adaptedvideotracksource.h"
+
+#include "callback.h"
+#include "interop/interop_api.h"
+
+namespace Microsoft::MixedReality::WebRTC {
+
+/// Callback fired when the pixel data of a frame pushed to an external video
+/// track source is not used anymore, and its buffers can be reused or freed.
+using ExternalVideoFrameReleaseCallback = Callback<>;
+
+/// Video track source producing the frames pushed by the application, instead
+/// of capturing them from a device.
+///
+/// Frames can be pushed from any thread, in I420, I420A, NV12 or ARGB format.
+/// When a release callback is provided, the application buffers are wrapped
+/// without any copy and must stay valid until the callback is invoked, which
+/// can happen on any thread once the frame was encoded and delivered to all
+/// the local sinks. Conversions to I420, needed by the encoders for non-I420
+/// frames, and downscaling requested by the encoder adaptation, are done into
+/// pooled buffers. Non-I420 frames are converted at most once, whatever the
+/// number of encoders and sinks consuming them, and their application buffers
+/// are released as soon as they are converted.
+class ExternalVideoTrackSource : public rtc::AdaptedVideoTrackSource {
+ public:
+  static rtc::scoped_refptr<ExternalVideoTrackSource> Create() noexcept;
+
+  /// Push a frame to the source. The frame format, resolution, planes and
+  /// strides are described by |frame|, and its timestamp and rotation by
+  /// |frame.timing.timestamp_us| and |frame.rotation|; a zero timestamp is
+  /// replaced by the current time. If |release_callback| is valid, the frame
+  /// buffers are used in place until it is invoked, otherwise they are copied
+  /// before this call returns. The release callback is invoked even if this
+  /// fails or if the frame is dropped.
+  mrsResult PushFrame(
+      const VideoFrameInfo& frame,
+      ExternalVideoFrameReleaseCallback release_callback) noexcept;
+
+  // VideoTrackSourceInterface implementation.
+
+  SourceState state() const override { return SourceState::kLive; }
+  bool remote() const override { return false; }
+  bool is_screencast() const override { return false; }
+  absl::optional<bool> needs_denoising() const override { return false; }
+
+ protected:
+  ExternalVideoTrackSource() noexcept;
+  ~ExternalVideoTrackSource() override = default;
+
+ private:
+  /// Pools of I420 buffers shared with the frames, which can outlive the
+  /// source. |webrtc::I420BufferPool| discards the buffers of any other
+  /// resolution than the one requested, so the conversions at the pushed
+  /// resolution and the outputs of the encoder adaptation use separate pools,
+  /// which would otherwise reallocate on every frame once adapting.
+  class BufferPool;
+  std::shared_ptr<BufferPool> source_pool_;
+  std::shared_ptr<BufferPool> adapted_pool_;
+};
+
+}  // namespace Microsoft::MixedReality::WebRTC
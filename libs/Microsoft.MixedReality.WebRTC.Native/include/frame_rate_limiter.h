@@ -0,0 +1,46 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+namespace Microsoft::MixedReality::WebRTC {
+
+/// Decimator limiting the rate of a stream of frames, based on the frame
+/// timestamps. Frames are delivered on a regular schedule of one frame per
+/// interval, with some tolerance for the timestamp jitter of the source, so
+/// that for example a 60 fps stream limited to 30 fps delivers exactly every
+/// other frame. If the stream falls behind the schedule, or its timestamps
+/// jump backward, the schedule restarts from the next frame.
+///
+/// The limiter is thread-safe. Concurrent |TryDeliver()| calls never deliver
+/// more than one frame per slot of the schedule, and |IsDue()| can be queried
+/// from any thread.
+class FrameRateLimiter {
+ public:
+  /// Create a limiter delivering at most |max_framerate| frames per second,
+  /// which must be positive.
+  explicit FrameRateLimiter(double max_framerate) noexcept;
+
+  /// Check whether a frame with the given timestamp would be delivered,
+  /// without updating the schedule.
+  bool IsDue(int64_t timestamp_us) const noexcept;
+
+  /// Decide whether to deliver the frame with the given timestamp, and if so
+  /// advance the schedule to the next frame.
+  bool TryDeliver(int64_t timestamp_us) noexcept;
+
+ private:
+  /// Sentinel for |next_due_us_| before the first frame.
+  static constexpr int64_t kUnscheduled = INT64_MIN;
+
+  /// Interval between two delivered frames, in microseconds.
+  const int64_t interval_us_;
+
+  /// Timestamp at which the next frame is due.
+  std::atomic<int64_t> next_due_us_{kUnscheduled};
+};
+
+}  // namespace Microsoft::MixedReality::WebRTC
@@ -0,0 +1,59 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "external_video_track_source.h"
+#include "video_frame_generator.h"
+
+namespace Microsoft::MixedReality::WebRTC {
+
+/// Video track source producing the frames of a |VideoFrameGenerator| at a
+/// fixed frame rate, on a dedicated thread. This allows sending video without
+/// any capture device, for example to measure the encoding and decoding
+/// throughput reproducibly on machines without capture hardware.
+///
+/// Frames are paced on a fixed schedule from the start of the source, so that
+/// a late frame does not delay the following ones. If the generation falls
+/// behind by more than one frame interval, the missed intervals are skipped
+/// instead of generating a burst of frames to catch up.
+class GeneratedVideoTrackSource : public ExternalVideoTrackSource {
+ public:
+  /// Create a source generating the frames of |generator| at |framerate|
+  /// frames per second, or at the nominal frame rate of the generator if
+  /// |framerate| is zero or negative. The generation starts immediately.
+  static rtc::scoped_refptr<GeneratedVideoTrackSource> Create(
+      std::unique_ptr<VideoFrameGenerator> generator,
+      double framerate) noexcept;
+
+ protected:
+  GeneratedVideoTrackSource(std::unique_ptr<VideoFrameGenerator> generator,
+                            double framerate) noexcept;
+
+  /// Stop the generation thread.
+  ~GeneratedVideoTrackSource() override;
+
+  /// Start the generation thread.
+  void Start() noexcept;
+
+  /// Generation thread procedure.
+  void Run() noexcept;
+
+ private:
+  std::unique_ptr<VideoFrameGenerator> generator_;
+
+  /// Interval between two frames, in microseconds.
+  const int64_t frame_interval_us_;
+
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  bool stopping_ = false;
+  std::thread thread_;
+};
+
+}  // namespace Microsoft::MixedReality::WebRTC
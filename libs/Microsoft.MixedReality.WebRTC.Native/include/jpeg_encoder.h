@@ -0,0 +1,23 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <vector>
+
+#include "interop/interop_api.h"
+
+namespace Microsoft::MixedReality::WebRTC {
+
+/// Encode the I420A frame |frame| into a baseline JPEG image of quality
+/// |quality| in [1:100], replacing the content of |jpeg|. The alpha plane, if
+/// any, is ignored. Return false if the encoding failed.
+///
+/// The YUV planes are fed to libjpeg as raw 4:2:0 data, so no color conversion
+/// is needed, except for the expansion of the limited-range samples of WebRTC
+/// frames to the full range of JFIF images.
+bool EncodeJpeg(const VideoFrameInfo& frame,
+                int quality,
+                std::vector<uint8_t>& jpeg) noexcept;
+
+}  // namespace Microsoft::MixedReality::WebRTC
@@ -3,12 +3,15 @@
 
 #pragma once
 
+#include <optional>
+
 #include "api/mediastreaminterface.h"
 #include "api/peerconnectioninterface.h"
 #include "api/rtpsenderinterface.h"
 
 #include "callback.h"
 #include "interop/interop_api.h"
+#include "processed_video_track_source.h"
 #include "str.h"
 #include "video_frame_observer.h"
 
@@ -27,14 +30,19 @@ class PeerConnection;
 /// The local video track is backed by a local video track source. This is
 /// typically a video capture device (e.g. webcam), but can	also be a source
 /// producing programmatically generated frames. The local video track itself
-/// has no knowledge about how the source produces the frames.
+/// has no knowledge about how the source produces the frames. The frames can
+/// however be processed before encoding, if the source is wrapped into a
+/// |ProcessedVideoTrackSource|.
 class LocalVideoTrack : public VideoFrameObserver,
                         public rtc::RefCountInterface {
  public:
   LocalVideoTrack(PeerConnection& owner,
                   rtc::scoped_refptr<webrtc::VideoTrackInterface> track,
                   rtc::scoped_refptr<webrtc::RtpSenderInterface> sender,
-                  mrsLocalVideoTrackInteropHandle interop_handle) noexcept;
+                  rtc::scoped_refptr<ProcessedVideoTrackSource> source,
+                  mrsLocalVideoTrackInteropHandle interop_handle,
+                  std::optional<VideoCaptureFormatInfo> capture_format =
+                      std::nullopt) noexcept;
   MRS_API ~LocalVideoTrack() override;
 
   /// Enable or disable the video track. An enabled track streams its content
@@ -46,6 +54,41 @@ class LocalVideoTrack : public VideoFrameObserver,
   /// See |SetEnabled(bool)|.
   MRS_API [[nodiscard]] bool IsEnabled() const noexcept;
 
+  /// Select whether the frames of the track are rotated before delivery to the
+  /// callbacks and sinks of the track. See
+  /// |VideoFrameObserver::SetApplyRotation()|.
+  void SetApplyRotation(bool apply_rotation) noexcept;
+
+  /// Enable or disable the detection of static frames, to skip encoding and
+  /// sending frames identical to the previous one. Dropped frames are not
+  /// delivered to the callbacks and sinks of the track either. This fails if
+  /// the track source is not processed. See |StaticFrameDetector|.
+  mrsResult SetStaticFrameDetection(
+      const StaticFrameDetectionConfiguration& config) noexcept;
+
+  /// Get the statistics of the static frame detection.
+  mrsResult GetStaticFrameStats(StaticFrameStats& stats) const noexcept;
+
+  /// Append a frame processor created from |config| to the chain of
+  /// processors run on the frames of the track source before encoding, and
+  /// return its position in the chain in |index|. This fails if the track
+  /// source is not processed. See |VideoFrameProcessor|.
+  mrsResult AddFrameProcessor(const VideoFrameProcessorConfiguration& config,
+                              int& index) noexcept;
+
+  /// Remove all the frame processors of the track.
+  mrsResult ClearFrameProcessors() noexcept;
+
+  /// Get the statistics of the frame processor at position |index|.
+  mrsResult GetFrameProcessorStats(int index,
+                                   VideoFrameProcessorStats& stats) const
+      noexcept;
+
+  /// Get the format the capture device of the track was opened in, if it was
+  /// selected by the library. This fails for tracks not backed by a capture
+  /// device, or for which WebRTC selected the format.
+  mrsResult GetCaptureFormat(VideoCaptureFormatInfo& format) const noexcept;
+
   //
   // Advanced use
   //
@@ -75,8 +118,14 @@ class LocalVideoTrack : public VideoFrameObserver,
   /// RTP sender this track is associated with.
   rtc::scoped_refptr<webrtc::RtpSenderInterface> sender_;
 
+  /// Source of the track processing the frames before encoding, if any.
+  rtc::scoped_refptr<ProcessedVideoTrackSource> source_;
+
   /// Optional interop handle, if associated with an interop wrapper.
   mrsLocalVideoTrackInteropHandle interop_handle_{};
+
+  /// Format of the capture device of the track, if selected by the library.
+  const std::optional<VideoCaptureFormatInfo> capture_format_;
 };
 
 }  // namespace Microsoft::MixedReality::WebRTC
@@ -3,9 +3,12 @@
 
 #pragma once
 
+#include <optional>
+
 #include "audio_frame_observer.h"
 #include "callback.h"
 #include "data_channel.h"
+#include "processed_video_track_source.h"
 #include "video_frame_observer.h"
 
 namespace Microsoft::MixedReality::WebRTC {
@@ -203,10 +206,95 @@ class PeerConnection : public webrtc::PeerConnectionObserver,
     }
   }
 
+  /// Register a custom callback invoked when a remote video frame has been
+  /// received and decompressed, and is ready to be displayed locally. The frame
+  /// is delivered as a reference-counted handle which can be retained by the
+  /// callback to access the frame after the callback returned.
+  void RegisterRemoteVideoFrameCallback(
+      VideoFrameHandleCallback callback) noexcept {
+    if (remote_video_observer_) {
+      remote_video_observer_->SetCallback(std::move(callback));
+    }
+  }
+
+  /// Add a sink receiving the remote video frames in the format specified by
+  /// |config|. On success, |sink_id| receives the identifier of the new sink.
+  /// See |VideoFrameObserver::AddSink()|.
+  mrsResult AddRemoteVideoSink(
+      const VideoSinkConfiguration& config,
+      VideoFrameHandleCallback callback,
+      VideoSinkId& sink_id,
+      rtc::scoped_refptr<rtc::RefCountInterface> owner = nullptr) noexcept {
+    if (!remote_video_observer_) {
+      return MRS_E_INVALID_OPERATION;
+    }
+    return remote_video_observer_->AddSink(config, std::move(callback),
+                                           sink_id, std::move(owner));
+  }
+
+  /// Remove a sink previously added with |AddRemoteVideoSink()|.
+  mrsResult RemoveRemoteVideoSink(VideoSinkId sink_id) noexcept {
+    if (!remote_video_observer_) {
+      return MRS_E_INVALID_OPERATION;
+    }
+    return remote_video_observer_->RemoveSink(sink_id);
+  }
+
+  /// Capture a snapshot of the next remote video frame. See
+  /// |VideoFrameObserver::CaptureSnapshot()|.
+  mrsResult CaptureRemoteVideoSnapshot(
+      const VideoSnapshotConfiguration& config,
+      VideoSnapshotReadyCallback callback) noexcept {
+    if (!remote_video_observer_) {
+      return MRS_E_INVALID_OPERATION;
+    }
+    return remote_video_observer_->CaptureSnapshot(config,
+                                                   std::move(callback));
+  }
+
+  /// Enable or disable the parallel conversion of the remote video frames to
+  /// ARGB. See |VideoFrameObserver::SetParallelConversion()|.
+  mrsResult SetRemoteVideoParallelConversion(bool enabled) noexcept {
+    if (!remote_video_observer_) {
+      return MRS_E_INVALID_OPERATION;
+    }
+    remote_video_observer_->SetParallelConversion(enabled);
+    return MRS_SUCCESS;
+  }
+
+  /// Select whether the remote video frames are rotated before delivery. See
+  /// |VideoFrameObserver::SetApplyRotation()|.
+  mrsResult SetRemoteVideoApplyRotation(bool apply_rotation) noexcept;
+
+  /// Enable or disable the asynchronous delivery of the remote video frames.
+  /// See |VideoFrameObserver::SetAsyncDelivery()|.
+  mrsResult SetRemoteVideoAsyncDelivery(int mailbox_size) noexcept {
+    if (!remote_video_observer_) {
+      return MRS_E_INVALID_OPERATION;
+    }
+    return remote_video_observer_->SetAsyncDelivery(mailbox_size);
+  }
+
+  /// Get the statistics of the asynchronous delivery of the remote video
+  /// frames.
+  mrsResult GetRemoteVideoDeliveryStats(VideoDeliveryStats& stats) noexcept {
+    if (!remote_video_observer_) {
+      return MRS_E_INVALID_OPERATION;
+    }
+    remote_video_observer_->GetAsyncDeliveryStats(stats);
+    return MRS_SUCCESS;
+  }
+
   /// Add a video track to the peer connection. If no RTP sender/transceiver
-  /// exist, create a new one for that track.
+  /// exist, create a new one for that track. If the track source is a
+  /// |ProcessedVideoTrackSource|, |source| allows controlling its processing.
+  /// If the track is backed by a capture device opened by the library in a
+  /// selected format, |capture_format| is that format.
   webrtc::RTCErrorOr<rtc::scoped_refptr<LocalVideoTrack>> AddLocalVideoTrack(
-      rtc::scoped_refptr<webrtc::VideoTrackInterface> video_track) noexcept;
+      rtc::scoped_refptr<webrtc::VideoTrackInterface> video_track,
+      rtc::scoped_refptr<ProcessedVideoTrackSource> source = nullptr,
+      std::optional<VideoCaptureFormatInfo> capture_format =
+          std::nullopt) noexcept;
 
   /// Remove a local video track from the peer connection.
   /// The underlying RTP sender/transceiver are kept alive but inactive.
@@ -219,8 +307,13 @@ class PeerConnection : public webrtc::PeerConnectionObserver,
   /// Register a custom callback invoked when a local audio frame is ready to be
   /// output.
   ///
-  /// FIXME - Current implementation of AddSink() for the local audio capture
-  /// device is no-op. So this callback is never fired.
+  /// The frames are the raw audio of the capture device, tapped from the audio
+  /// device module by |AudioCaptureTap| and delivered in place without copy,
+  /// from the audio capture thread. This is the audio before echo cancellation
+  /// and the other audio processing applied to the audio sent. Frames are only
+  /// delivered while a local audio track is added and enabled, and the device
+  /// records, that is while audio is sent to a remote peer. This is not
+  /// supported on UWP, where this callback is never fired.
   void RegisterLocalAudioFrameCallback(
       AudioFrameReadyCallback callback) noexcept {
     if (local_audio_observer_) {
@@ -237,6 +330,26 @@ class PeerConnection : public webrtc::PeerConnectionObserver,
     }
   }
 
+  /// Register a custom callback invoked when a local audio frame is ready to
+  /// be output, with its timing information.
+  ///
+  /// See |RegisterLocalAudioFrameCallback()| for when frames are delivered.
+  void RegisterLocalAudioFrameCallback(
+      AudioFrameInfoCallback callback) noexcept {
+    if (local_audio_observer_) {
+      local_audio_observer_->SetCallback(std::move(callback));
+    }
+  }
+
+  /// Register a custom callback invoked when a remote audio frame has been
+  /// received and uncompressed, with its timing information.
+  void RegisterRemoteAudioFrameCallback(
+      AudioFrameInfoCallback callback) noexcept {
+    if (remote_audio_observer_) {
+      remote_audio_observer_->SetCallback(std::move(callback));
+    }
+  }
+
   /// Add to the peer connection an audio track backed by a local audio capture
   /// device. If no RTP sender/transceiver exist, create a new one for that
   /// track.
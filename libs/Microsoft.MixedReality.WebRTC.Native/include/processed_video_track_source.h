@@ -0,0 +1,144 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "api/mediastreaminterface.h"
+#include "api/notifier.h"
+#include "common_video/include/i420_buffer_pool.h"
+#include "media/base/videobroadcaster.h"
+
+#include "interop/interop_api.h"
+#include "rcu_ptr.h"
+#include "static_frame_detector.h"
+#include "video_frame_processor.h"
+
+namespace Microsoft::MixedReality::WebRTC {
+
+/// Video track source wrapping the source of a local video track, to process
+/// the frames of that source before they are encoded and delivered to the
+/// local sinks of the track.
+///
+/// The processing stages are published as an immutable snapshot, like the
+/// callbacks of |VideoFrameObserver|, so that they can be changed at any time
+/// without blocking the thread producing the frames. The resolution and frame
+/// rate requested by the sinks are forwarded to the wrapped source.
+///
+/// Frames forwarded by the static frame detection go through the chain of
+/// frame processors, if any, in the order they were added. The frame buffers
+/// shared with the other consumers of the source are never modified: the chain
+/// reads the source frame directly, and only copies it into a pooled buffer
+/// before the first processor modifying it in place. See |ProcessedFrame|. The
+/// time spent in each processor is recorded in its statistics.
+class ProcessedVideoTrackSource
+    : public webrtc::Notifier<webrtc::VideoTrackSourceInterface>,
+      public rtc::VideoSinkInterface<webrtc::VideoFrame>,
+      public webrtc::ObserverInterface {
+ public:
+  static rtc::scoped_refptr<ProcessedVideoTrackSource> Create(
+      rtc::scoped_refptr<webrtc::VideoTrackSourceInterface> source) noexcept;
+
+  /// Enable or disable the detection of static frames, replacing any previous
+  /// detection and resetting its statistics. See |StaticFrameDetector|.
+  mrsResult SetStaticFrameDetection(
+      const StaticFrameDetectionConfiguration& config) noexcept;
+
+  /// Get the statistics of the static frame detection. All counters are zero
+  /// if it is disabled.
+  void GetStaticFrameStats(StaticFrameStats& stats) const noexcept;
+
+  /// Append a processor created from |config| to the chain of frame
+  /// processors, and return its position in the chain in |index|.
+  mrsResult AddFrameProcessor(const VideoFrameProcessorConfiguration& config,
+                              int& index) noexcept;
+
+  /// Remove all the frame processors.
+  void ClearFrameProcessors() noexcept;
+
+  /// Get the statistics of the frame processor at position |index| in the
+  /// chain. Fails with |MRS_E_INVALID_PARAMETER| if there is no such
+  /// processor.
+  mrsResult GetFrameProcessorStats(int index,
+                                   VideoFrameProcessorStats& stats) const
+      noexcept;
+
+  // VideoTrackSourceInterface implementation.
+
+  SourceState state() const override { return source_->state(); }
+  bool remote() const override { return source_->remote(); }
+  bool is_screencast() const override { return source_->is_screencast(); }
+  absl::optional<bool> needs_denoising() const override {
+    return source_->needs_denoising();
+  }
+  bool GetStats(Stats* stats) override { return source_->GetStats(stats); }
+  void AddOrUpdateSink(rtc::VideoSinkInterface<webrtc::VideoFrame>* sink,
+                       const rtc::VideoSinkWants& wants) override;
+  void RemoveSink(rtc::VideoSinkInterface<webrtc::VideoFrame>* sink) override;
+
+  // VideoSinkInterface implementation, receiving the frames of the source.
+
+  void OnFrame(const webrtc::VideoFrame& frame) override;
+  void OnDiscardedFrame() override;
+
+  // ObserverInterface implementation, receiving the source state changes.
+
+  void OnChanged() override { FireOnChanged(); }
+
+ protected:
+  explicit ProcessedVideoTrackSource(
+      rtc::scoped_refptr<webrtc::VideoTrackSourceInterface> source) noexcept;
+  ~ProcessedVideoTrackSource() override;
+
+ private:
+  /// Frame processor of the chain, with its statistics.
+  struct ProcessorStage {
+    explicit ProcessorStage(std::unique_ptr<VideoFrameProcessor> processor)
+        : processor(std::move(processor)) {}
+
+    const std::unique_ptr<VideoFrameProcessor> processor;
+    std::atomic_uint64_t processed_frames{0};
+    std::atomic_uint64_t dropped_frames{0};
+    std::atomic_int64_t total_time_us{0};
+    std::atomic_int64_t max_time_us{0};
+  };
+
+  /// Snapshot of the processing stages.
+  struct Stages {
+    /// Detector of static frames, or null if disabled.
+    std::shared_ptr<StaticFrameDetector> static_frame_detector;
+
+    /// Chain of frame processors, in processing order.
+    std::vector<std::shared_ptr<ProcessorStage>> processors;
+  };
+
+  /// Run the chain of frame |processors| on |frame|, and return the processed
+  /// buffer, or null if the frame was dropped.
+  rtc::scoped_refptr<webrtc::I420BufferInterface> RunProcessors(
+      const std::vector<std::shared_ptr<ProcessorStage>>& processors,
+      const webrtc::VideoFrame& frame) noexcept;
+
+  /// Wrapped source.
+  const rtc::scoped_refptr<webrtc::VideoTrackSourceInterface> source_;
+
+  /// Sinks of the processed frames.
+  rtc::VideoBroadcaster broadcaster_;
+
+  /// Serialize the updates of the sinks of |broadcaster_| with the forwarding
+  /// of their aggregated wants to |source_|, so that the source is not left
+  /// with the stale wants of a concurrent update.
+  std::mutex sink_mutex_;
+
+  /// Currently enabled processing stages.
+  RcuPtr<Stages> stages_;
+
+  /// Pool of the copies of the source frames modified in place by the chain,
+  /// only used by the thread delivering the source frames.
+  webrtc::I420BufferPool buffer_pool_;
+};
+
+}  // namespace Microsoft::MixedReality::WebRTC
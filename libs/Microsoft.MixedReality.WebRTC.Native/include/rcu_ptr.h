@@ -0,0 +1,166 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Microsoft::MixedReality::WebRTC {
+
+namespace detail {
+
+/// Read-side critical section of an |RcuPtr|, linked into a per-thread list of
+/// nested sections to detect updates issued from inside a read section.
+struct RcuReadSection {
+  const void* owner;
+  RcuReadSection* outer;
+};
+
+/// Innermost read section of the current thread, if any.
+inline thread_local RcuReadSection* tls_rcu_read_section = nullptr;
+
+}  // namespace detail
+
+/// Pointer to an immutable object published with read-copy-update semantics.
+///
+/// Readers access the current object with |Read()| without taking any lock,
+/// and therefore are never blocked by writers. Writers modify the object with
+/// |Update()|, which applies the change to a copy of the current object and
+/// atomically publishes that copy. The previous object is destroyed after a
+/// grace period, once all the readers which could observe it are done.
+///
+/// Writers are serialized with each other, and wait for the grace period. This
+/// guarantees that once |Update()| returns, the previous object is not
+/// observed by any reader anymore. As an exception, an update issued from
+/// inside a read section of the same object (for example, a callback which
+/// unregisters itself) cannot wait for itself, nor for a writer waiting for
+/// that read section; it does not take the writer lock and returns
+/// immediately, and the previous object is destroyed by a later update.
+///
+/// As updates from read sections are not serialized with the writers, all
+/// updates are published with a compare-and-swap, and the change is applied
+/// again to a copy of the new current object if another update won the race.
+/// The change function may therefore be invoked more than once, and must not
+/// consume its captures.
+template <typename T>
+class RcuPtr {
+ public:
+  RcuPtr() : current_(new T{}) {}
+  ~RcuPtr() {
+    delete current_.load();
+    for (const T* obj : retired_) {
+      delete obj;
+    }
+  }
+  RcuPtr(const RcuPtr&) = delete;
+  RcuPtr& operator=(const RcuPtr&) = delete;
+
+  /// Invoke |func| with a const reference to the current object. The object
+  /// stays valid until |func| returns, even if concurrently replaced.
+  template <typename Func>
+  void Read(Func&& func) const {
+    // Register with the reader counter of the current epoch. If a writer
+    // flipped the epoch in between, it may not wait for that counter, so
+    // retry with the new epoch.
+    uint32_t epoch;
+    for (;;) {
+      epoch = epoch_.load();
+      readers_[epoch & 1].fetch_add(1);
+      if (epoch_.load() == epoch) {
+        break;
+      }
+      readers_[epoch & 1].fetch_sub(1);
+    }
+    detail::RcuReadSection section{this, detail::tls_rcu_read_section};
+    detail::tls_rcu_read_section = &section;
+    func(*current_.load());
+    detail::tls_rcu_read_section = section.outer;
+    readers_[epoch & 1].fetch_sub(1);
+  }
+
+  /// Invoke |func| with a mutable reference to a copy of the current object,
+  /// then publish that copy as the new current object.
+  template <typename Func>
+  void Update(Func&& func) {
+    // A writer holding the lock may be waiting for the read section of this
+    // thread, so do not take it.
+    if (IsReadingOnThisThread()) {
+      const T* prev = Publish(func);
+      auto lock = std::scoped_lock{retired_mutex_};
+      retired_.push_back(prev);
+      return;
+    }
+
+    auto lock = std::scoped_lock{write_mutex_};
+    const T* prev = Publish(func);
+
+    // Objects retired so far are unpublished, so only readers registered
+    // before the epoch flip below can still observe them.
+    std::vector<const T*> retired;
+    {
+      auto retired_lock = std::scoped_lock{retired_mutex_};
+      retired.swap(retired_);
+    }
+
+    // Readers which loaded |prev| registered under the current epoch. Move new
+    // readers to the next epoch, and wait until the previous one drains.
+    const uint32_t epoch = epoch_.fetch_add(1);
+    while (readers_[epoch & 1].load() != 0) {
+      std::this_thread::yield();
+    }
+    delete prev;
+    for (const T* obj : retired) {
+      delete obj;
+    }
+  }
+
+ private:
+  /// Apply |func| to a copy of the current object and publish it, retrying on
+  /// a concurrent update. Return the unpublished object.
+  template <typename Func>
+  const T* Publish(Func& func) {
+    const T* prev = current_.load();
+    for (;;) {
+      auto next = std::make_unique<T>(*prev);
+      func(*next);
+      if (current_.compare_exchange_weak(prev, next.get())) {
+        next.release();
+        return prev;
+      }
+    }
+  }
+
+  bool IsReadingOnThisThread() const noexcept {
+    for (auto* section = detail::tls_rcu_read_section; section;
+         section = section->outer) {
+      if (section->owner == this) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  /// Currently published object.
+  std::atomic<const T*> current_;
+
+  /// Grace period epoch, incremented by each waiting writer.
+  std::atomic_uint32_t epoch_{0};
+
+  /// Number of active readers for even and odd epochs.
+  mutable std::atomic_uint32_t readers_[2]{};
+
+  /// Mutex serializing writers.
+  std::mutex write_mutex_;
+
+  /// Mutex protecting |retired_|, never held while waiting for readers.
+  std::mutex retired_mutex_;
+
+  /// Objects replaced from inside a read section, waiting for a grace period.
+  std::vector<const T*> retired_;
+};
+
+}  // namespace Microsoft::MixedReality::WebRTC
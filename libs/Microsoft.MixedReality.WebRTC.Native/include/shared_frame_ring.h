@@ -0,0 +1,139 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <string>
+
+#if !defined(WEBRTC_WIN)
+#include <sys/types.h>
+#endif
+
+#include "rtc_base/refcount.h"
+#include "rtc_base/scoped_ref_ptr.h"
+
+#include "interop/interop_api.h"
+
+namespace Microsoft::MixedReality::WebRTC {
+
+/// Named shared memory region, mapped into the address space of the process.
+/// This is a POSIX shared memory object, or a named file mapping on Windows.
+class SharedMemory {
+ public:
+  /// Create the region |name| of |size| bytes, mapped for writing. The region
+  /// is removed when the creator unmaps it. Return null on failure, setting
+  /// |already_exists| if a region with the same name already exists, which
+  /// is never replaced as it may be in use by another process.
+  static std::unique_ptr<SharedMemory> Create(const char* name,
+                                              size_t size,
+                                              bool* already_exists) noexcept;
+
+  /// Map for reading the existing region |name|. Return null on failure.
+  static std::unique_ptr<SharedMemory> Open(const char* name) noexcept;
+
+  ~SharedMemory();
+
+  inline uint8_t* data() const noexcept { return data_; }
+  inline size_t size() const noexcept { return size_; }
+
+ private:
+  SharedMemory() noexcept = default;
+
+  uint8_t* data_ = nullptr;
+  size_t size_ = 0;
+#if defined(WEBRTC_WIN)
+  HANDLE mapping_ = nullptr;
+#else
+  /// Name of the region created by this process, to remove on unmapping.
+  std::string owned_name_;
+
+  /// Identity of the region created, so that a region with the same name
+  /// created after it was removed by another process is not removed instead.
+  dev_t owned_device_ = 0;
+  ino_t owned_inode_ = 0;
+#endif
+};
+
+/// Video sink exporting the frames of a video track to other processes
+/// through a ring of frame slots in shared memory.
+///
+/// Each frame is copied once, in the format delivered by the sink, from the
+/// decoded frame into the next slot of the ring, with a small header holding
+/// its sequence number, format, plane layout and timing. The writer never
+/// waits for the readers: slots are overwritten in turn, and readers detect
+/// overwritten frames from the sequence number of the slot, which is cleared
+/// while the slot is being written. See |SharedFrameReader|.
+///
+/// Frames are written from a single thread. The statistics can be read from
+/// any thread.
+class SharedFrameRing : public rtc::RefCountInterface {
+ public:
+  /// Create the shared memory region |name| holding |config.num_slots| slots,
+  /// each large enough for a frame of |config.max_width| x |config.max_height|
+  /// pixels in any format. Fails with |MRS_E_INVALID_PARAMETER| if the
+  /// configuration is invalid, with |MRS_E_INVALID_OPERATION| if a region with
+  /// the same name already exists, or with |MRS_E_UNKNOWN| if the region
+  /// cannot be created.
+  static mrsResult Create(const char* name,
+                          const SharedFrameRingConfiguration& config,
+                          rtc::scoped_refptr<SharedFrameRing>& ring) noexcept;
+
+  /// Copy |frame| into the next slot of the ring and publish it. Frames too
+  /// large for a slot are dropped.
+  void Write(const VideoFrameInfo& frame) noexcept;
+
+  /// Get the current statistics of the ring.
+  void GetStats(SharedFrameRingStats& stats) const noexcept;
+
+ protected:
+  explicit SharedFrameRing(std::unique_ptr<SharedMemory> memory) noexcept;
+  ~SharedFrameRing() override = default;
+
+ private:
+  std::unique_ptr<SharedMemory> memory_;
+
+  /// Sequence number of the last frame written, producer only.
+  uint64_t sequence_ = 0;
+
+  std::atomic<uint64_t> written_count_{0};
+  std::atomic<uint64_t> dropped_count_{0};
+};
+
+/// Reader of the frames exported by a |SharedFrameRing|, possibly from another
+/// process, without copy.
+///
+/// Frames are accessed in place in the shared memory, and may be overwritten
+/// by the writer while accessed if the reader falls behind by the number of
+/// slots of the ring. |Release()| tells whether this happened, in which case
+/// the content read since |Acquire()| must be discarded.
+class SharedFrameReader {
+ public:
+  /// Open the shared frame ring |name|. Fails with |MRS_E_NOTFOUND| if it does
+  /// not exist, or with |MRS_E_INVALID_PARAMETER| if it is not a frame ring
+  /// of a compatible version.
+  static mrsResult Open(const char* name,
+                        std::unique_ptr<SharedFrameReader>& reader) noexcept;
+
+  /// Acquire the frame following the last one acquired, or the latest frame
+  /// if |latest| is true, and describe it in |frame|, pointing into the shared
+  /// memory. If the following frame was overwritten, the oldest frame still
+  /// available is acquired instead, which the caller detects from a gap in
+  /// the |sequence| numbers. Return false if no new frame is available.
+  bool Acquire(bool latest, VideoFrameInfo& frame, uint64_t& sequence) noexcept;
+
+  /// End the access to the frame |sequence|, and return true if it was not
+  /// overwritten since it was acquired.
+  bool Release(uint64_t sequence) const noexcept;
+
+ private:
+  explicit SharedFrameReader(std::unique_ptr<SharedMemory> memory) noexcept;
+
+  std::unique_ptr<SharedMemory> memory_;
+
+  /// Sequence number of the last frame acquired.
+  uint64_t last_sequence_ = 0;
+};
+
+}  // namespace Microsoft::MixedReality::WebRTC
@@ -0,0 +1,62 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <atomic>
+#include <vector>
+
+#include "api/video/video_frame.h"
+
+#include "interop/interop_api.h"
+
+namespace Microsoft::MixedReality::WebRTC {
+
+/// Detector of frames identical to the previous one, to avoid encoding and
+/// sending unchanged content, typically for screen-like video.
+///
+/// Each row of the Y, U and V planes is hashed with the SIMD-accelerated libyuv
+/// DJB2 hash, and compared with the hash of the same row in the previous frame.
+/// Only the row hashes are kept, so the previous frame is not retained. While
+/// the content is static, frames are dropped except for one keep-alive frame
+/// per interval, which lets the encoder refine the quality of the static
+/// content and keeps the receivers alive.
+///
+/// |ShouldForward()| must be called by a single thread at a time, while the
+/// statistics can be read from any thread.
+class StaticFrameDetector {
+ public:
+  /// Create a detector forwarding one static frame every
+  /// |keepalive_interval_us| microseconds, based on the frame timestamps, or
+  /// none if zero.
+  explicit StaticFrameDetector(int64_t keepalive_interval_us) noexcept;
+
+  /// Compare |frame| with the previous frame, and check whether it should be
+  /// forwarded to the encoder.
+  bool ShouldForward(const webrtc::VideoFrame& frame) noexcept;
+
+  /// Get the detection statistics since the detector was created.
+  void GetStats(StaticFrameStats& stats) const noexcept;
+
+ private:
+  /// Compute the row hashes of |frame| into |row_hashes_|, and return true if
+  /// they are all equal to the previous ones.
+  bool UpdateHashes(const webrtc::I420BufferInterface& frame) noexcept;
+
+  const int64_t keepalive_interval_us_;
+
+  /// Hashes of the Y rows, followed by the combined U and V rows, of the
+  /// previous frame.
+  std::vector<uint32_t> row_hashes_;
+  int width_ = 0;
+  int height_ = 0;
+
+  /// Timestamp of the last forwarded frame.
+  int64_t last_forwarded_us_ = 0;
+
+  std::atomic_uint64_t processed_frames_{0};
+  std::atomic_uint64_t static_frames_{0};
+  std::atomic_uint64_t dropped_frames_{0};
+};
+
+}  // namespace Microsoft::MixedReality::WebRTC
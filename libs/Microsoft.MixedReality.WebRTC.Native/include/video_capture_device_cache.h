@@ -0,0 +1,130 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "interop/interop_api.h"
+
+#if defined(WINUWP)
+#include <winrt/windows.devices.enumeration.h>
+#else   // defined(WINUWP)
+#include <cfgmgr32.h>
+#endif  // defined(WINUWP)
+
+namespace Microsoft::MixedReality::WebRTC {
+
+/// Video capture device, as enumerated by the platform.
+struct CachedVideoCaptureDevice {
+  /// Unique identifier of the device.
+  std::string id;
+
+  /// Friendly name of the device.
+  std::string name;
+};
+
+/// Process-wide cache of the video capture devices and of their capture
+/// formats.
+///
+/// Probing the devices and formats takes up to hundreds of milliseconds on
+/// some USB cameras, so the results of the first enumeration are kept and
+/// replayed by the following ones, until a device is added or removed. Device
+/// changes are watched for with the platform notifications, which invalidate
+/// the whole cache; the next enumeration then probes the hardware again.
+///
+/// The notifications are registered by the |GlobalFactory| while the library
+/// is initialized, and unregistered when it shuts down, never from a static
+/// destructor which could run under the loader lock. Results are only cached
+/// while watching, so enumerations outside of that window always probe.
+///
+/// Each invalidation starts a new generation of the cache. Enumerations
+/// remember the generation they started in, and only store their results if no
+/// invalidation occurred while probing, so that stale results are discarded.
+/// All methods are thread-safe.
+class VideoCaptureDeviceCache {
+ public:
+  /// Get the process-wide cache.
+  static VideoCaptureDeviceCache& Instance() noexcept;
+
+  /// Start watching for device changes, enabling the cache. Failing to watch
+  /// is not fatal, but stale devices are then reported until |Invalidate()| is
+  /// called. This has no effect if already watching.
+  void StartWatching() noexcept;
+
+  /// Stop watching for device changes, waiting for the notifications in
+  /// progress, and discard and disable the cache.
+  void StopWatching() noexcept;
+
+  /// Get the current generation of the cache.
+  uint64_t generation() const noexcept;
+
+  /// Get the cached devices, if the device list was probed since the last
+  /// invalidation.
+  bool TryGetDevices(std::vector<CachedVideoCaptureDevice>& devices) const;
+
+  /// Get the cached capture formats of the device |device_id|, if probed since
+  /// the last invalidation.
+  bool TryGetFormats(const std::string& device_id,
+                     std::vector<VideoCaptureFormatInfo>& formats) const;
+
+  /// Store the device list probed during |generation|. This is ignored if the
+  /// cache was invalidated since.
+  void StoreDevices(uint64_t generation,
+                    std::vector<CachedVideoCaptureDevice> devices);
+
+  /// Store the capture formats of the device |device_id| probed during
+  /// |generation|. This is ignored if the cache was invalidated since.
+  void StoreFormats(uint64_t generation,
+                    const std::string& device_id,
+                    std::vector<VideoCaptureFormatInfo> formats);
+
+  /// Discard all cached devices and formats.
+  void Invalidate() noexcept;
+
+#if !defined(WINUWP)
+  /// Probe the devices and the formats of all devices if not cached, blocking
+  /// until done. Concurrent calls probe the hardware only once. Returns false
+  /// without probing if not watching, or if the devices cannot be probed.
+  bool Refresh() noexcept;
+
+  /// Get the devices, probing them with |Refresh()| if not cached, or directly
+  /// if not watching. Returns false if the devices cannot be probed.
+  bool GetDevices(std::vector<CachedVideoCaptureDevice>& devices) noexcept;
+#endif  // !defined(WINUWP)
+
+ private:
+  VideoCaptureDeviceCache() noexcept = default;
+
+#if !defined(WINUWP)
+  /// Probe the devices and their formats from the hardware.
+  static bool Probe(
+      std::vector<CachedVideoCaptureDevice>& devices,
+      std::unordered_map<std::string, std::vector<VideoCaptureFormatInfo>>&
+          formats) noexcept;
+#endif  // !defined(WINUWP)
+
+  mutable std::mutex mutex_;
+  bool watching_ = false;
+  uint64_t generation_ = 0;
+  std::optional<std::vector<CachedVideoCaptureDevice>> devices_;
+  std::unordered_map<std::string, std::vector<VideoCaptureFormatInfo>>
+      formats_;
+
+#if defined(WINUWP)
+  winrt::Windows::Devices::Enumeration::DeviceWatcher watcher_{nullptr};
+#else   // defined(WINUWP)
+  /// Serializes |Refresh()|.
+  std::mutex refresh_mutex_;
+
+  /// Registrations of the device interface notifications, one per device
+  /// interface class of the video capture devices.
+  std::vector<HCMNOTIFICATION> notifications_;
+#endif  // defined(WINUWP)
+};
+
+}  // namespace Microsoft::MixedReality::WebRTC
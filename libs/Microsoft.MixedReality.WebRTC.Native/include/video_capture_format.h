@@ -0,0 +1,99 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "media/base/videocapturer.h"
+#include "rtc_base/third_party/sigslot/sigslot.h"
+
+#include "interop/interop_api.h"
+
+namespace Microsoft::MixedReality::WebRTC {
+
+/// Get the relative CPU cost of converting one pixel captured with the FOURCC
+/// |encoding| to I420, from 1 for I420 itself which is only copied, to the
+/// cost of a JPEG decode for MJPG. Unknown encodings cost the most.
+uint32_t GetCaptureEncodingPixelCost(uint32_t encoding) noexcept;
+
+/// Get the estimated cost of converting the frames of a capture format to
+/// I420, in weighted pixels per second. See |VideoCaptureFormatInfo::cost|.
+uint64_t GetCaptureFormatCost(uint32_t width,
+                              uint32_t height,
+                              double framerate,
+                              uint32_t encoding) noexcept;
+
+/// Select the capture format of |formats| matching the |width|, |height| and
+/// |framerate| constraints, any of which can be zero for unconstrained, and
+/// return its index, or -1 if none matches. The constraints are matched like
+/// the media constraints applied by WebRTC when opening a capture device.
+/// Matching formats are ranked by the distance of their area to the requested
+/// one, or to 640x480 if unconstrained, then by the distance of their
+/// framerate to the requested one, or to 30 FPS if unconstrained, which is how
+/// WebRTC picks a format, and finally by lowest conversion cost, which WebRTC
+/// ignores.
+int SelectCaptureFormat(const VideoCaptureFormatInfo* formats,
+                        size_t count,
+                        uint32_t width,
+                        uint32_t height,
+                        double framerate) noexcept;
+
+/// Select the capture format of |capturer| with |SelectCaptureFormat()|, and
+/// on success replace |capturer| with a |SelectedFormatVideoCapturer| opening
+/// the device in that format, and return the format in |selected|. Returns
+/// false and leaves |capturer| untouched if the capturer does not list its
+/// formats, or none matches the constraints of |config|.
+bool SelectLowestCostCaptureFormat(
+    std::unique_ptr<cricket::VideoCapturer>& capturer,
+    const VideoDeviceConfiguration& config,
+    VideoCaptureFormatInfo& selected) noexcept;
+
+/// Video capturer wrapping another capturer, and exposing only one of its
+/// formats as supported.
+///
+/// WebRTC selects the capture format of a device by resolution and framerate
+/// only, keeping the first one the device lists among the formats of equal
+/// resolution and framerate, which is often MJPG or YUY2 even when the device
+/// also supports I420 or NV12. Exposing only the format selected ahead of time
+/// makes WebRTC start the device in that format, while the frames and state
+/// changes of the wrapped capturer are forwarded unchanged.
+class SelectedFormatVideoCapturer
+    : public cricket::VideoCapturer,
+      public rtc::VideoSinkInterface<webrtc::VideoFrame>,
+      public sigslot::has_slots<> {
+ public:
+  SelectedFormatVideoCapturer(std::unique_ptr<cricket::VideoCapturer> capturer,
+                              const cricket::VideoFormat& format) noexcept;
+  ~SelectedFormatVideoCapturer() override;
+
+  //
+  // cricket::VideoCapturer interface
+  //
+
+  cricket::CaptureState Start(const cricket::VideoFormat& format) override;
+  void Stop() override;
+  bool IsRunning() override;
+  bool IsScreencast() const override;
+
+  //
+  // rtc::VideoSinkInterface interface
+  //
+
+  /// Forward a frame of the wrapped capturer to the sinks of this capturer.
+  void OnFrame(const webrtc::VideoFrame& frame) override;
+
+ protected:
+  bool GetPreferredFourccs(std::vector<uint32_t>* fourccs) override;
+  void OnSinkWantsChanged(const rtc::VideoSinkWants& wants) override;
+
+ private:
+  void OnStateChange(cricket::VideoCapturer* capturer,
+                     cricket::CaptureState state);
+
+  std::unique_ptr<cricket::VideoCapturer> capturer_;
+  const cricket::VideoFormat format_;
+};
+
+}  // namespace Microsoft::MixedReality::WebRTC
@@ -0,0 +1,51 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include "interop/interop_api.h"
+
+namespace Microsoft::MixedReality::WebRTC {
+
+class WorkerPool;
+
+/// Check if an I420 or I420A frame can be converted to |format| with the given
+/// color matrix and range. The color matrix and range are ignored for YUV
+/// formats.
+bool IsConversionSupported(VideoFrameFormat format,
+                           VideoColorMatrix matrix,
+                           VideoColorRange range) noexcept;
+
+/// Convert the I420 or I420A frame |src| to the format of |dst|, and write the
+/// result into the planes of |dst|, which must have the same resolution. The
+/// conversion must be supported, see |IsConversionSupported()|. Each output
+/// format is produced in a single pass over the frame. If |premultiply_alpha|
+/// is true and |src| has an alpha plane, RGB formats with an alpha channel
+/// receive color channels premultiplied by alpha. If |pool| is not null
+/// and the frame is large enough, the conversion is split into bands of rows
+/// converted in parallel on the pool. The result is identical in both cases.
+void ConvertI420A(const VideoFrameInfo& src,
+                  const VideoFrameInfo& dst,
+                  VideoColorMatrix matrix,
+                  VideoColorRange range,
+                  bool premultiply_alpha,
+                  WorkerPool* pool) noexcept;
+
+/// Compute the largest resolution not exceeding |max_width| x |max_height|
+/// which preserves the aspect ratio of a |width| x |height| frame, with even
+/// dimensions so that chroma planes are not resampled with rounding. A zero
+/// maximum leaves the corresponding dimension unconstrained. Frames are never
+/// upscaled, so |width| x |height| is returned if it already fits.
+void FitResolution(int width,
+                   int height,
+                   int max_width,
+                   int max_height,
+                   int* out_width,
+                   int* out_height) noexcept;
+
+/// Scale the I420 or I420A frame |src| into the I420 or I420A frame |dst|, at
+/// the resolution of |dst|, with a box filter. The alpha plane is scaled if
+/// both frames have one.
+void ScaleI420A(const VideoFrameInfo& src, const VideoFrameInfo& dst) noexcept;
+
+}  // namespace Microsoft::MixedReality::WebRTC
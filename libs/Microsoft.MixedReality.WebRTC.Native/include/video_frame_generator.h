@@ -0,0 +1,113 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "api/video/i420_buffer.h"
+#include "rtc_base/refcount.h"
+#include "rtc_base/scoped_ref_ptr.h"
+
+#include "interop/interop_api.h"
+
+namespace Microsoft::MixedReality::WebRTC {
+
+/// Producer of the frames of a |GeneratedVideoTrackSource|, which calls it
+/// from a single thread at the pace of the source frame rate.
+class VideoFrameGenerator {
+ public:
+  virtual ~VideoFrameGenerator() = default;
+
+  /// Nominal frame rate of the generated frames, in frames per second.
+  virtual double framerate() const noexcept = 0;
+
+  /// Generate the next frame into |frame|, whose pixel data stays valid and
+  /// unmodified as long as |owner| holds a reference. Return false if there
+  /// is no more frame to generate.
+  virtual bool NextFrame(
+      VideoFrameInfo& frame,
+      rtc::scoped_refptr<rtc::RefCountInterface>& owner) noexcept = 0;
+};
+
+/// Generator reading the frames of a Y4M (YUV4MPEG2) file, in 4:2:0 chroma
+/// format. The file is memory-mapped, and the frames are produced without
+/// copy, pointing directly into the mapping.
+class Y4mFrameGenerator : public VideoFrameGenerator {
+ public:
+  /// Open the Y4M file at |path|, encoded in UTF-8. If |loop| is true, the
+  /// frames are generated again from the start of the file after the last
+  /// one. Fails with |MRS_E_NOTFOUND| if the file cannot be opened, or with
+  /// |MRS_E_INVALID_PARAMETER| if it is not a valid 4:2:0 Y4M file.
+  static mrsResult Open(const char* path,
+                        bool loop,
+                        std::unique_ptr<Y4mFrameGenerator>& generator) noexcept;
+
+  ~Y4mFrameGenerator() override;
+
+  inline int width() const noexcept { return width_; }
+  inline int height() const noexcept { return height_; }
+  inline int num_frames() const noexcept {
+    return static_cast<int>(frame_offsets_.size());
+  }
+
+  // VideoFrameGenerator implementation.
+
+  double framerate() const noexcept override { return framerate_; }
+  bool NextFrame(
+      VideoFrameInfo& frame,
+      rtc::scoped_refptr<rtc::RefCountInterface>& owner) noexcept override;
+
+ private:
+  class MappedFile;
+
+  Y4mFrameGenerator(rtc::scoped_refptr<MappedFile> file, bool loop) noexcept;
+
+  /// Parse the stream header and index the frames of the file.
+  bool Parse() noexcept;
+
+  /// Mapping of the file, kept alive by the frames in use.
+  rtc::scoped_refptr<MappedFile> file_;
+  const bool loop_;
+  int width_ = 0;
+  int height_ = 0;
+  double framerate_ = 30.0;
+
+  /// Offset in the file of the pixel data of each frame.
+  std::vector<size_t> frame_offsets_;
+
+  /// Index of the next frame to generate.
+  size_t next_frame_ = 0;
+};
+
+/// Generator of a synthetic I420 test pattern of color bars above a luma ramp,
+/// scrolling horizontally by a few pixels each frame so that the encoder has
+/// some motion to compress. The pattern is rendered once, and the frames are
+/// produced without copy as windows into it.
+class TestPatternFrameGenerator : public VideoFrameGenerator {
+ public:
+  /// Create a generator for frames of the given resolution, at |framerate|
+  /// frames per second. The width and height are rounded up to even values.
+  TestPatternFrameGenerator(int width, int height, double framerate) noexcept;
+
+  // VideoFrameGenerator implementation.
+
+  double framerate() const noexcept override { return framerate_; }
+  bool NextFrame(
+      VideoFrameInfo& frame,
+      rtc::scoped_refptr<rtc::RefCountInterface>& owner) noexcept override;
+
+ private:
+  const int width_;
+  const int height_;
+  const double framerate_;
+
+  /// Pattern of twice the frame width, repeating horizontally.
+  rtc::scoped_refptr<webrtc::I420Buffer> pattern_;
+
+  /// Index of the next frame to generate.
+  int64_t frame_index_ = 0;
+};
+
+}  // namespace Microsoft::MixedReality::WebRTC
@@ -0,0 +1,84 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+#include "api/video/video_frame.h"
+
+namespace Microsoft::MixedReality::WebRTC {
+
+/// Bounded mailbox of video frames delivered on a dedicated thread.
+///
+/// Posting a frame never blocks the producer. When the mailbox is full, the
+/// oldest pending frame is dropped to make room for the new one, so that a
+/// slow consumer always receives the latest frames instead of an ever-growing
+/// backlog. Dropped frames are counted.
+class VideoFrameMailbox {
+ public:
+  /// Function delivering a frame, and the time it was posted at, in
+  /// microseconds on the |rtc::TimeMicros()| clock.
+  using DeliverFunc =
+      std::function<void(const webrtc::VideoFrame&, int64_t post_time_us)>;
+
+  /// Create a mailbox holding up to |capacity| pending frames, and start its
+  /// delivery thread, which invokes |deliver| for each frame in order.
+  VideoFrameMailbox(int capacity, DeliverFunc deliver);
+
+  /// Stop and join the delivery thread, dropping any pending frame without
+  /// counting it. This must not be called from the delivery thread.
+  ~VideoFrameMailbox();
+
+  /// Post a frame for delivery, and return immediately.
+  void Post(const webrtc::VideoFrame& frame, int64_t post_time_us);
+
+  /// Check if the calling thread is the delivery thread.
+  bool IsDeliveryThread() const noexcept {
+    return (std::this_thread::get_id() == thread_.get_id());
+  }
+
+  inline int capacity() const noexcept { return capacity_; }
+
+  /// Number of frames delivered so far.
+  inline uint64_t delivered_count() const noexcept {
+    return delivered_count_.load(std::memory_order_relaxed);
+  }
+
+  /// Number of frames dropped so far because the mailbox was full.
+  inline uint64_t dropped_count() const noexcept {
+    return dropped_count_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  void Run();
+
+  const int capacity_;
+  const DeliverFunc deliver_;
+  std::atomic<uint64_t> delivered_count_{0};
+  std::atomic<uint64_t> dropped_count_{0};
+
+  std::mutex mutex_;
+  std::condition_variable cv_;
+
+  /// Frame waiting for delivery.
+  struct PendingFrame {
+    webrtc::VideoFrame frame;
+    int64_t post_time_us;
+  };
+
+  /// Pending frames, oldest first.
+  std::deque<PendingFrame> frames_;
+
+  bool stopping_ = false;
+
+  /// Delivery thread, started last once all other members are initialized.
+  std::thread thread_;
+};
+
+}  // namespace Microsoft::MixedReality::WebRTC
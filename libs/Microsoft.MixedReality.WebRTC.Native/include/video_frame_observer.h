@@ -4,12 +4,19 @@
 
 #pragma once
 
+#include <atomic>
+#include <memory>
 #include <mutex>
+#include <vector>
 
 #include "api/video/video_frame.h"
 #include "api/video/video_sink_interface.h"
 
 #include "callback.h"
+#include "frame_rate_limiter.h"
+#include "interop/interop_api.h"
+#include "rcu_ptr.h"
+#include "video_frame_mailbox.h"
 
 namespace Microsoft::MixedReality::WebRTC {
 
@@ -32,30 +39,35 @@ using I420AFrameReadyCallback = Callback<const void*,
 /// packed ARGB data, followed by the width and height of the frame.
 using ARGBFrameReadyCallback = Callback<const void*, int, int, int>;
 
-constexpr inline size_t ArgbDataSize(int height, int stride) {
-  return static_cast<size_t>(height) * stride * 4;
-}
+/// Callback fired on newly available video frame, delivered as a
+/// reference-counted frame. The parameter describes the frame content and
+/// contains the frame handle, which can be retained by the callee to keep the
+/// frame alive after the callback returned. See |VideoFrameRef|.
+using VideoFrameHandleCallback = Callback<const VideoFrameInfo*>;
 
-// Plain 32-bit ARGB buffer in standard memory.
-class ArgbBuffer : public webrtc::VideoFrameBuffer {
- public:
-  // Create a new buffer.
-  static inline rtc::scoped_refptr<ArgbBuffer> Create(int width, int height) {
-    return new rtc::RefCountedObject<ArgbBuffer>(width, height, width * 4);
-  }
-
-  //// Create a new buffer and copy the pixel data.
-  // static rtc::scoped_refptr<ArgbBuffer> Copy(const I010BufferInterface&
-  // buffer);
+/// Callback completing a snapshot of a video frame, with the result of the
+/// capture, and the pointer to and size of the encoded image.
+using VideoSnapshotReadyCallback = Callback<mrsResult, const void*, uint64_t>;
 
-  //// Convert and put I420 buffer into a new buffer.
-  // static rtc::scoped_refptr<ArgbBuffer> Copy(const I420BufferInterface&
-  // buffer);
+class VideoFrameRef;
+class WorkerPool;
 
-  //// Return a rotated copy of |src|.
-  // static rtc::scoped_refptr<ArgbBuffer> Rotate(const I010BufferInterface&
-  // src,
-  //                                             VideoRotation rotation);
+/// Buffer holding a frame converted or scaled into one of the formats of
+/// |VideoFrameFormat|, in 64-byte aligned memory. Rows are tightly packed, and
+/// all planes are stored in a single allocation, each aligned like the first.
+///
+/// |ToI420()| references I420A buffers in place. Buffers in other formats are
+/// converted at most once, into a pooled buffer shared by all the consumers of
+/// the frame, until the buffer is returned to its pool.
+class PixelBuffer : public webrtc::VideoFrameBuffer {
+ public:
+  /// Create a new buffer for a frame of the given format and resolution. For
+  /// |VideoFrameFormat::kI420A|, |alpha| specifies whether the buffer has an
+  /// alpha plane; it is ignored for other formats.
+  static rtc::scoped_refptr<PixelBuffer> Create(VideoFrameFormat format,
+                                                int width,
+                                                int height,
+                                                bool alpha = false);
 
   // VideoFrameBuffer implementation.
 
@@ -64,27 +76,116 @@ class ArgbBuffer : public webrtc::VideoFrameBuffer {
   inline int height() const override { return height_; }
   rtc::scoped_refptr<webrtc::I420BufferInterface> ToI420() override;
 
-  inline uint8_t* Data() { return data_.get(); }
-  inline const uint8_t* Data() const { return data_.get(); }
-  inline int Stride() const { return stride_; }
-  inline constexpr size_t Size() const {
-    return ArgbDataSize(height_, stride_);
+  inline VideoFrameFormat format() const { return format_; }
+
+  /// Number of planes of the buffer: 3 or 4 for I420A depending on the alpha
+  /// plane, 2 for NV12, and 1 for packed formats.
+  inline int num_planes() const { return num_planes_; }
+
+  inline uint8_t* Data(int plane = 0) { return data_.get() + offset_[plane]; }
+  inline const uint8_t* Data(int plane = 0) const {
+    return data_.get() + offset_[plane];
   }
+  inline int Stride(int plane = 0) const { return stride_[plane]; }
+
+  /// Total size in bytes of the pixel data of all planes.
+  inline size_t Size() const { return size_; }
 
  protected:
-  ArgbBuffer(int width, int height, int stride) noexcept;
-  ~ArgbBuffer() override = default;
+  PixelBuffer(VideoFrameFormat format,
+              int width,
+              int height,
+              bool alpha) noexcept;
+  ~PixelBuffer() override = default;
 
  private:
+  friend class PixelBufferPool;
+
+  const VideoFrameFormat format_;
   const int width_;
   const int height_;
-  const int stride_;
-  const std::unique_ptr<uint8_t, webrtc::AlignedFreeDeleter> data_;
+  int num_planes_{};
+  int stride_[4]{};
+  size_t offset_[4]{};
+  size_t size_{};
+  std::unique_ptr<uint8_t, webrtc::AlignedFreeDeleter> data_;
+
+  std::mutex i420_mutex_;
+
+  /// Frame converted by the first call to |ToI420()| for formats other than
+  /// I420A, released by the pool once the buffer is returned to it.
+  rtc::scoped_refptr<webrtc::I420BufferInterface> i420_buffer_;
+};
+
+/// Bounded pool of pixel buffers, bucketed by format and resolution.
+///
+/// A buffer is checked out with |Checkout()|, and is returned to the pool once
+/// all the references to it are released. In particular, a consumer can check
+/// out a frame converted into a pooled buffer by retaining its handle, and
+/// return it by releasing that handle, while the following frames are
+/// converted into other buffers of the pool. Buffers are only reused when the
+/// pool holds their last reference, so they are never overwritten while a
+/// consumer still holds them.
+///
+/// Each bucket holds at most |capacity| buffers. When all of them are checked
+/// out, new buffers are allocated outside of the pool and freed on return.
+/// Buckets not used for some time, typically after the resolution of a track
+/// changed, are trimmed and their free buffers deallocated.
+class PixelBufferPool {
+ public:
+  /// Default maximum number of buffers per bucket.
+  static constexpr int kDefaultCapacity = 4;
+
+  /// Number of checkouts after which an unused bucket is trimmed.
+  static constexpr int kTrimAfterCheckouts = 30;
+
+  explicit PixelBufferPool(int capacity = kDefaultCapacity) noexcept
+      : capacity_(capacity) {}
+
+  /// Check out a buffer for a frame of the given format and resolution,
+  /// reusing a free pooled buffer if possible. See |PixelBuffer::Create()|.
+  rtc::scoped_refptr<PixelBuffer> Checkout(VideoFrameFormat format,
+                                           int width,
+                                           int height,
+                                           bool alpha = false);
+
+ private:
+  using PooledBuffer = rtc::scoped_refptr<rtc::RefCountedObject<PixelBuffer>>;
+
+  /// Buffers of a single format and resolution.
+  struct Bucket {
+    VideoFrameFormat format;
+    int width;
+    int height;
+    bool alpha;
+    /// Value of |checkout_count_| on last checkout from this bucket.
+    uint64_t last_checkout;
+    std::vector<PooledBuffer> buffers;
+  };
+
+  /// Maximum number of buffers per bucket.
+  const int capacity_;
+
+  /// Total number of checkouts, used as a clock for trimming.
+  uint64_t checkout_count_ = 0;
+
+  std::vector<Bucket> buckets_;
+  std::mutex mutex_;
 };
 
 /// Video frame observer to get notified of newly available video frames.
+///
+/// The registered callbacks and sinks are published as an immutable snapshot,
+/// so that delivering a frame never takes a lock, and registering a callback
+/// never stalls the thread producing the frames. A registration call waits for
+/// the frames being delivered with the previous registrations, so that once it
+/// returns the previous callbacks are not invoked anymore, except when called
+/// from inside a callback of the same observer.
 class VideoFrameObserver : public rtc::VideoSinkInterface<webrtc::VideoFrame> {
  public:
+  /// Stop the asynchronous delivery thread, if any.
+  ~VideoFrameObserver() override;
+
   /// Register a callback to get notified on frame available,
   /// and received that frame as a I420-encoded buffer.
   /// This is not exclusive and can be used along another ARGB callback.
@@ -95,24 +196,162 @@ class VideoFrameObserver : public rtc::VideoSinkInterface<webrtc::VideoFrame> {
   /// This is not exclusive and can be used along another I420 callback.
   void SetCallback(ARGBFrameReadyCallback callback) noexcept;
 
+  /// Register a callback to get notified on frame available, and receive that
+  /// frame as a reference-counted I420-encoded frame handle. This avoids
+  /// copying the frame when its content needs to outlive the callback.
+  /// This is not exclusive and can be used along other callbacks.
+  void SetCallback(VideoFrameHandleCallback callback) noexcept;
+
+  /// Add a sink receiving the frames in the format specified by |config|, as
+  /// reference-counted frames. Any number of sinks can be added, alongside
+  /// the callbacks above. Each frame is converted at most once per format and
+  /// color conversion, and the converted frame is shared by all the sinks
+  /// requesting it. On success, |sink_id| receives the identifier of the new
+  /// sink. Sinks limiting their frame rate skip the excess frames before any
+  /// conversion or scaling, so that low-rate consumers cost little. If |owner|
+  /// is not null, the sink holds a reference to it until removed and done with
+  /// its last frame, typically to keep alive the object receiving the frames
+  /// through the user data of |callback|. This fails if the configuration is
+  /// not supported.
+  mrsResult AddSink(
+      const VideoSinkConfiguration& config,
+      VideoFrameHandleCallback callback,
+      VideoSinkId& sink_id,
+      rtc::scoped_refptr<rtc::RefCountInterface> owner = nullptr) noexcept;
+
+  /// Remove a sink previously added with |AddSink()|. Once this returns, the
+  /// sink callback is not invoked anymore.
+  mrsResult RemoveSink(VideoSinkId sink_id) noexcept;
+
+  /// Enable or disable the parallel conversion of high-resolution frames to
+  /// the sink formats. When enabled, each frame is split into bands of rows
+  /// converted in parallel on the process-wide worker pool, which reduces the
+  /// latency of the conversion at the expense of using more cores. Disabled by
+  /// default.
+  void SetParallelConversion(bool enabled) noexcept;
+
+  /// Select whether the frames are rotated by WebRTC before delivery, which is
+  /// the default. Otherwise the frames are delivered unrotated, avoiding a
+  /// full copy of each rotated frame, and the rotation to apply for display is
+  /// reported in |VideoFrameInfo::rotation|. This takes effect once the
+  /// observer is registered again with its video sources, using the settings
+  /// of |GetSinkWants()|.
+  void SetApplyRotation(bool apply_rotation) noexcept;
+
+  /// Get the settings to register the observer with a video source.
+  rtc::VideoSinkWants GetSinkWants() const noexcept;
+
+  /// Enable or disable the asynchronous delivery of the frames. When enabled,
+  /// incoming frames are posted into a mailbox of |mailbox_size| frames and
+  /// the producer returns immediately, while a dedicated thread converts and
+  /// delivers them to the callbacks and sinks. If the consumers are too slow,
+  /// the oldest pending frames are dropped in favor of the latest ones. A
+  /// |mailbox_size| of zero disables the asynchronous delivery, which is the
+  /// default. This fails if called from a frame callback.
+  mrsResult SetAsyncDelivery(int mailbox_size) noexcept;
+
+  /// Get the number of frames delivered and dropped since the asynchronous
+  /// delivery was last enabled. All counters are zero if it is disabled.
+  void GetAsyncDeliveryStats(VideoDeliveryStats& stats) const noexcept;
+
+  /// Capture the next frame delivered by the observer, downscaled to the
+  /// maximum resolution of |config|, and encode it into a JPEG image passed
+  /// to |callback|. The frame is only retained, without copy, until it is
+  /// encoded on the process-wide worker pool, from which the callback is
+  /// invoked. Snapshots still pending when the observer is destroyed complete
+  /// with |MRS_E_INVALID_OPERATION|. This fails if the configuration is
+  /// invalid.
+  mrsResult CaptureSnapshot(const VideoSnapshotConfiguration& config,
+                            VideoSnapshotReadyCallback callback) noexcept;
+
  protected:
-  ArgbBuffer* GetArgbScratchBuffer(int width, int height);
+  /// Sink registered with |AddSink()|.
+  struct Sink {
+    VideoSinkId id;
+    VideoSinkConfiguration config;
+    VideoFrameHandleCallback callback;
+
+    /// Limiter of the sink frame rate, or null if unlimited. This is shared by
+    /// the successive snapshots, to keep pacing across registration changes.
+    std::shared_ptr<FrameRateLimiter> rate_limiter;
+
+    /// Object kept alive while the sink is registered, or null.
+    rtc::scoped_refptr<rtc::RefCountInterface> owner;
+  };
+
+  /// Snapshot of the registered callbacks and sinks.
+  struct Callbacks {
+    /// Registered callback for receiving I420-encoded frame.
+    I420AFrameReadyCallback i420a_callback;
+
+    /// Registered callback for receiving raw decoded ARGB frame.
+    ARGBFrameReadyCallback argb_callback;
+
+    /// Registered callback for receiving reference-counted frames.
+    VideoFrameHandleCallback frame_handle_callback;
+
+    /// Registered sinks, in registration order.
+    std::vector<Sink> sinks;
+
+    /// Worker pool for parallel conversions, or null if disabled.
+    std::shared_ptr<WorkerPool> worker_pool;
+
+    /// Mailbox for asynchronous delivery, or null if disabled.
+    std::shared_ptr<VideoFrameMailbox> mailbox;
+  };
+
+  /// Convert the I420A frame |src| to a new frame in the format and color
+  /// space of |config|, in parallel on |pool| if not null.
+  rtc::scoped_refptr<VideoFrameRef> Convert(
+      const VideoFrameInfo& src,
+      const VideoSinkConfiguration& config,
+      WorkerPool* pool);
+
+  /// Scale the I420A frame |src| to a new I420A frame of the given resolution.
+  rtc::scoped_refptr<VideoFrameRef> Scale(const VideoFrameInfo& src,
+                                          int width,
+                                          int height);
+
+  /// Snapshot requested with |CaptureSnapshot()|.
+  struct SnapshotRequest {
+    VideoSnapshotConfiguration config;
+    VideoSnapshotReadyCallback callback;
+  };
+
+  /// Replace the asynchronous delivery mailbox with |mailbox|, and destroy the
+  /// previous one, if any, once it cannot receive frames anymore.
+  void ReplaceMailbox(std::shared_ptr<VideoFrameMailbox> mailbox) noexcept;
+
+  /// Deliver |frame|, which was received by the observer at
+  /// |arrival_time_us|, to the callbacks and sinks of the snapshot
+  /// |callbacks|.
+  void DispatchFrame(const Callbacks& callbacks,
+                     const webrtc::VideoFrame& frame,
+                     int64_t arrival_time_us) noexcept;
 
   // VideoSinkInterface interface
   void OnFrame(const webrtc::VideoFrame& frame) noexcept override;
 
  private:
-  /// Registered callback for receiving I420-encoded frame.
-  I420AFrameReadyCallback i420a_callback_;
+  /// Currently registered callbacks and sinks.
+  RcuPtr<Callbacks> callbacks_;
 
-  /// Registered callback for receiving raw decoded ARGB frame.
-  ARGBFrameReadyCallback argb_callback_;
+  /// Identifier of the next sink added. Zero is reserved as invalid.
+  std::atomic<VideoSinkId> next_sink_id_{1};
 
-  /// Mutex protecting all callbacks.
-  std::mutex mutex_;
+  /// Whether the frames are rotated before delivery.
+  std::atomic_bool apply_rotation_{true};
+
+  /// Snapshots waiting for the next frame. The flag, set when the list is not
+  /// empty, lets the delivery path skip the lock in the common case.
+  std::vector<SnapshotRequest> snapshot_requests_;
+  std::atomic_bool snapshot_pending_{false};
+  std::mutex snapshot_mutex_;
 
-  /// Reusable ARGB scratch buffer to avoid per-frame allocation.
-  rtc::scoped_refptr<ArgbBuffer> argb_scratch_buffer_;
+  /// Pool of buffers the frames are converted into, to avoid per-frame
+  /// allocations. Frames shared with sinks may retain a buffer past the
+  /// callback, in which case the next frames use other buffers of the pool.
+  PixelBufferPool buffer_pool_;
 };
 
 }  // namespace Microsoft::MixedReality::WebRTC
@@ -0,0 +1,127 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "api/video/i420_buffer.h"
+#include "common_video/include/i420_buffer_pool.h"
+#include "rtc_base/scoped_ref_ptr.h"
+
+#include "interop/interop_api.h"
+
+namespace Microsoft::MixedReality::WebRTC {
+
+/// Crop the |width| x |height| area of |src| at (|x|, |y|) into |dst|, which
+/// must have the size of the area. The coordinates must be even.
+void CropI420(const webrtc::I420BufferInterface& src,
+              int x,
+              int y,
+              webrtc::I420Buffer& dst) noexcept;
+
+/// Scale |src| into |dst| with a box filter.
+void ScaleI420(const webrtc::I420BufferInterface& src,
+               webrtc::I420Buffer& dst) noexcept;
+
+/// Blur in place the |width| x |height| area of |buffer| at (|x|, |y|), using
+/// |scratch| as intermediate storage. The coordinates must be even.
+///
+/// The box filter of radius |radius| is approximated by a box downscale of the
+/// area by the filter size followed by a bilinear upscale, which only takes
+/// two SIMD passes whatever the radius.
+void BoxBlurI420(webrtc::I420Buffer& buffer,
+                 int x,
+                 int y,
+                 int width,
+                 int height,
+                 int radius,
+                 rtc::scoped_refptr<webrtc::I420Buffer>& scratch) noexcept;
+
+/// Blend in place over |buffer| at (|x|, |y|) the |width| x |height| ARGB
+/// image |overlay| with premultiplied alpha, using |scratch| to hold the ARGB
+/// conversion of the covered area. The coordinates must be even, and the
+/// overlay must fit in the buffer.
+void BlendArgbOverI420(webrtc::I420Buffer& buffer,
+                       int x,
+                       int y,
+                       int width,
+                       int height,
+                       const uint8_t* overlay,
+                       int overlay_stride,
+                       std::vector<uint8_t>& scratch) noexcept;
+
+/// Frame going through a chain of |VideoFrameProcessor|.
+///
+/// The frame starts as the I420 buffer of the source frame, which may be shared
+/// with the other consumers of the source and must not be modified. It is only
+/// copied into a pooled buffer owned by the chain when a processor first asks
+/// to modify it in place, so that processors only reading the frame, like
+/// those changing its resolution, read the source buffer directly.
+class ProcessedFrame {
+ public:
+  ProcessedFrame(rtc::scoped_refptr<webrtc::I420BufferInterface> source,
+                 int64_t timestamp_us,
+                 webrtc::I420BufferPool& pool) noexcept;
+
+  /// Current content of the frame, for reading only.
+  const webrtc::I420BufferInterface& buffer() const noexcept {
+    return *buffer_;
+  }
+
+  /// Get the frame for modification in place, copying it into a buffer owned
+  /// by the chain if not already. Return null if no buffer is available.
+  webrtc::I420Buffer* MutableBuffer() noexcept;
+
+  /// Replace the content of the frame with |buffer|, like a buffer of a
+  /// different resolution produced from |buffer()|. The chain takes ownership
+  /// of |buffer|, which must not be shared.
+  void SetBuffer(rtc::scoped_refptr<webrtc::I420Buffer> buffer) noexcept;
+
+  /// Get the processed frame buffer.
+  rtc::scoped_refptr<webrtc::I420BufferInterface> Release() noexcept {
+    mutable_buffer_ = nullptr;
+    return std::move(buffer_);
+  }
+
+  /// Capture time of the frame.
+  int64_t timestamp_us() const noexcept { return timestamp_us_; }
+
+ private:
+  rtc::scoped_refptr<webrtc::I420BufferInterface> buffer_;
+
+  /// Same buffer as |buffer_| if owned by the chain, or null if |buffer_| is
+  /// read-only.
+  rtc::scoped_refptr<webrtc::I420Buffer> mutable_buffer_;
+
+  const int64_t timestamp_us_;
+
+  /// Pool of the copies made by |MutableBuffer()|.
+  webrtc::I420BufferPool& pool_;
+};
+
+/// Processor of the frames of a local video track, before they are encoded and
+/// delivered to the local sinks. See |ProcessedVideoTrackSource|.
+///
+/// Processors are chained in order, each one receiving the frame produced by
+/// the previous one. Processors modifying the frame in place ask for a
+/// writable buffer, and processors changing its resolution read the current
+/// buffer and replace it with a buffer from their own pool, see
+/// |ProcessedFrame|. |Process()| is called by a single thread at a time.
+class VideoFrameProcessor {
+ public:
+  /// Create a built-in processor from |config|. Fails with
+  /// |MRS_E_INVALID_PARAMETER| if the configuration is invalid.
+  static mrsResult Create(
+      const VideoFrameProcessorConfiguration& config,
+      std::unique_ptr<VideoFrameProcessor>& processor) noexcept;
+
+  virtual ~VideoFrameProcessor() = default;
+
+  /// Process |frame|, in place or by replacing its buffer. Return false to
+  /// drop the frame.
+  virtual bool Process(ProcessedFrame& frame) noexcept = 0;
+};
+
+}  // namespace Microsoft::MixedReality::WebRTC
@@ -0,0 +1,92 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+
+#include "rtc_base/refcount.h"
+#include "rtc_base/scoped_ref_ptr.h"
+
+#include "interop/interop_api.h"
+
+namespace Microsoft::MixedReality::WebRTC {
+
+class VideoFrameRef;
+
+/// Queue of video frames ordered by presentation time, for rendering.
+///
+/// The queue is a lock-free multi-producer single-consumer ring of frame
+/// references, so that frames are never copied: the producers are video sinks
+/// enqueuing frames, and the consumer is the render loop, which dequeues at
+/// each render the frame to present at that time. Frames are presented at
+/// their |VideoFrameTiming::timestamp_us|.
+///
+/// Several threads can enqueue concurrently, like the decoder threads of the
+/// remote video tracks of a peer connection, or the capture and delivery
+/// threads of a sink switching to asynchronous delivery. Producers reserve a
+/// slot by advancing the write index with a compare-and-swap, and publish it
+/// with the sequence number of the slot, so that the consumer never reads a
+/// slot still being written.
+///
+/// The statistics can be read from any thread.
+class VideoFrameQueue : public rtc::RefCountInterface {
+ public:
+  /// Create a new queue holding up to |capacity| pending frames.
+  static rtc::scoped_refptr<VideoFrameQueue> Create(int capacity) noexcept;
+
+  /// Enqueue a frame, acquiring a reference to it. If the queue is full, the
+  /// frame is dropped. This can be called from any thread.
+  void Enqueue(rtc::scoped_refptr<VideoFrameRef> frame) noexcept;
+
+  /// Get the frame to present at |presentation_time_us|, which is the latest
+  /// frame due at that time. Frames due earlier are dropped as late. If no new
+  /// frame is due, the last frame returned is repeated. Return null if no frame
+  /// was ever due. The queue keeps a reference to the returned frame until the
+  /// next call. Consumer thread only.
+  VideoFrameRef* TryDequeue(int64_t presentation_time_us,
+                            bool* is_new_frame) noexcept;
+
+  inline int capacity() const noexcept { return capacity_; }
+
+  /// Get the current statistics of the queue.
+  void GetStats(VideoFrameQueueStats& stats) const noexcept;
+
+ protected:
+  explicit VideoFrameQueue(int capacity) noexcept;
+  ~VideoFrameQueue() override = default;
+
+ private:
+  /// Slot of the ring. The slot at position |pos| is free for the producer
+  /// reserving |pos| when its sequence is |pos|, and published for the
+  /// consumer when its sequence is |pos + 1|. The consumer frees it for the
+  /// next round by setting its sequence to |pos + capacity_|.
+  struct Slot {
+    std::atomic<uint64_t> sequence{0};
+    rtc::scoped_refptr<VideoFrameRef> frame;
+  };
+
+  const int capacity_;
+
+  /// Ring of |capacity_| slots.
+  std::unique_ptr<Slot[]> slots_;
+
+  /// Total number of frames consumed, modified by the consumer only. The next
+  /// frame to consume is at |head_ % capacity_|.
+  std::atomic<uint64_t> head_{0};
+
+  /// Total number of slots reserved by the producers. The next frame is
+  /// enqueued at |tail_ % capacity_|.
+  std::atomic<uint64_t> tail_{0};
+
+  /// Last frame returned by |TryDequeue()|, consumer only.
+  rtc::scoped_refptr<VideoFrameRef> current_;
+
+  std::atomic<uint64_t> dequeued_count_{0};
+  std::atomic<uint64_t> late_count_{0};
+  std::atomic<uint64_t> overflow_count_{0};
+  std::atomic<uint64_t> repeated_count_{0};
+};
+
+}  // namespace Microsoft::MixedReality::WebRTC
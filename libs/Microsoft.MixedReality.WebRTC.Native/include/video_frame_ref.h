@@ -0,0 +1,74 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include "api/video/video_frame_buffer.h"
+#include "rtc_base/refcount.h"
+
+#include "interop/interop_api.h"
+
+namespace Microsoft::MixedReality::WebRTC {
+
+class PixelBuffer;
+
+/// Reference-counted video frame shared with the user of the library.
+///
+/// A frame reference keeps alive the underlying video frame buffer produced by
+/// the WebRTC implementation, so that the pixel data of the frame can be
+/// accessed after the frame callback returned, possibly from another thread,
+/// without copying it. The frame is exposed to the interop API as an opaque
+/// |VideoFrameHandle|, which holds one reference to the object.
+///
+/// The frame content is immutable, therefore a frame reference can be safely
+/// accessed concurrently from any number of threads.
+class VideoFrameRef : public rtc::RefCountInterface {
+ public:
+  /// Create a new frame reference for the given buffer. If the buffer is not
+  /// encoded as I420 or I420A then it is converted to I420, otherwise the
+  /// buffer is referenced as is without any copy.
+  static rtc::scoped_refptr<VideoFrameRef> Create(
+      rtc::scoped_refptr<webrtc::VideoFrameBuffer> buffer) noexcept;
+
+  /// Create a new frame reference for the given pixel buffer, in the format of
+  /// that buffer, without any copy.
+  static rtc::scoped_refptr<VideoFrameRef> CreateFromPixelBuffer(
+      rtc::scoped_refptr<PixelBuffer> buffer) noexcept;
+
+  /// Get the frame description exposed through the interop API.
+  const VideoFrameInfo& info() const noexcept { return info_; }
+
+  /// Set the timing information and display rotation of the frame. This must
+  /// be called before the frame is shared with any other thread.
+  void SetMetadata(const VideoFrameTiming& timing,
+                   VideoRotation rotation) noexcept {
+    info_.timing = timing;
+    info_.rotation = rotation;
+  }
+
+  /// Get the buffer holding the pixel data described by |info()|.
+  const rtc::scoped_refptr<webrtc::VideoFrameBuffer>& buffer() const noexcept {
+    return buffer_;
+  }
+
+  /// Get the interop handle for this object. The handle does not hold any
+  /// reference; use |mrsVideoFrameAddRef()| to acquire one.
+  VideoFrameHandle GetHandle() const noexcept {
+    return const_cast<VideoFrameRef*>(this);
+  }
+
+ protected:
+  VideoFrameRef(rtc::scoped_refptr<webrtc::VideoFrameBuffer> buffer,
+                const VideoFrameInfo& info) noexcept;
+  ~VideoFrameRef() override = default;
+
+ private:
+  /// Buffer holding the pixel data. This is the buffer pointed to by the
+  /// planes of |info_|, possibly after conversion from the original buffer.
+  rtc::scoped_refptr<webrtc::VideoFrameBuffer> buffer_;
+
+  /// Cached frame description.
+  VideoFrameInfo info_{};
+};
+
+}  // namespace Microsoft::MixedReality::WebRTC
@@ -0,0 +1,126 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "api/video/i420_buffer.h"
+#include "rtc_base/refcount.h"
+#include "rtc_base/scoped_ref_ptr.h"
+
+#include "interop/interop_api.h"
+
+namespace Microsoft::MixedReality::WebRTC {
+
+class VideoFrameRef;
+class WorkerPool;
+
+/// Compositor of the frames of several video tracks into a single
+/// caller-owned canvas, laid out on a grid of tiles.
+///
+/// Each tile is fed by a video sink of a single video track, which hands over
+/// its latest frame without copy; frames not composed yet are replaced by more
+/// recent ones. The render loop then calls |Compose()| once per refresh, which
+/// scales and blits into the canvas only the tiles which received a new frame,
+/// so that the application consumes a single frame whatever the number of
+/// tracks. Frames are scaled to fit their tile with SIMD scaling, preserving
+/// their aspect ratio, and centered over the background color.
+///
+/// Tiles are fed from any number of threads, while the canvas is composed from
+/// a single thread. The statistics can be read from any thread.
+class VideoMosaic : public rtc::RefCountInterface {
+ public:
+  /// Tile of the mosaic, receiving the frames of a single video track.
+  class Tile {
+   public:
+    Tile() noexcept = default;
+    ~Tile() noexcept;
+
+    /// Hand over the latest frame of the tile, without copy. The frame must
+    /// be in I420 or I420A format; other formats are ignored. This can be
+    /// called from any thread; if several threads enqueue concurrently, the
+    /// frame enqueued last is composed and the others are dropped, so a tile
+    /// meant to show a single track is fed by the sinks of that track only.
+    void Enqueue(rtc::scoped_refptr<VideoFrameRef> frame) noexcept;
+
+    /// Request the tile to be cleared to the background color at the next
+    /// composition, discarding its pending frame if any.
+    void Clear() noexcept;
+
+   private:
+    friend class VideoMosaic;
+
+    VideoMosaic* mosaic_ = nullptr;
+
+    /// Latest frame not composed yet, holding one reference, or null.
+    std::atomic<VideoFrameRef*> pending_{nullptr};
+
+    std::atomic_bool clear_requested_{false};
+
+    /// Area of the tile in the canvas, with even coordinates and size.
+    int x_ = 0;
+    int y_ = 0;
+    int width_ = 0;
+    int height_ = 0;
+
+    /// Resolution of the last frame drawn, which determines the letterboxing.
+    /// Consumer thread only.
+    int frame_width_ = 0;
+    int frame_height_ = 0;
+
+    /// Scratch buffers for frames scaled before their conversion to RGB.
+    /// Consumer thread only.
+    rtc::scoped_refptr<webrtc::I420Buffer> scaled_;
+    std::vector<uint8_t> scaled_alpha_;
+  };
+
+  /// Create a mosaic composing into the caller-owned |canvas|, which must
+  /// outlive the mosaic. The canvas is cleared to the background color. Fails
+  /// with |MRS_E_INVALID_PARAMETER| if the configuration or canvas is invalid.
+  /// If |pool| is not null, tiles are drawn in parallel on it.
+  static mrsResult Create(const VideoMosaicConfiguration& config,
+                          const VideoFrameInfo& canvas,
+                          std::shared_ptr<WorkerPool> pool,
+                          rtc::scoped_refptr<VideoMosaic>& mosaic) noexcept;
+
+  inline int num_tiles() const noexcept { return num_tiles_; }
+
+  /// Get the tile at |index|, in row-major order.
+  Tile* tile(int index) noexcept { return &tiles_[index]; }
+
+  /// Draw into the canvas the tiles which received a new frame or were
+  /// cleared since the last call, and return true if any was. The canvas must
+  /// not be accessed by the caller during this call. Consumer thread only.
+  bool Compose() noexcept;
+
+  /// Get the current statistics of the mosaic.
+  void GetStats(VideoMosaicStats& stats) const noexcept;
+
+ protected:
+  VideoMosaic(const VideoMosaicConfiguration& config,
+              const VideoFrameInfo& canvas,
+              std::shared_ptr<WorkerPool> pool) noexcept;
+  ~VideoMosaic() override = default;
+
+  /// Fill the area of the canvas at (x, y) of size w x h with the background.
+  void FillBackground(int x, int y, int w, int h) noexcept;
+
+  /// Scale and blit |frame| into |tile|.
+  void Draw(Tile& tile, const VideoFrameInfo& frame) noexcept;
+
+ private:
+  const VideoMosaicConfiguration config_;
+  const VideoFrameInfo canvas_;
+  const std::shared_ptr<WorkerPool> pool_;
+  const int num_tiles_;
+  std::unique_ptr<Tile[]> tiles_;
+
+  std::atomic<uint64_t> composed_count_{0};
+  std::atomic<uint64_t> drawn_count_{0};
+  std::atomic<uint64_t> dropped_count_{0};
+};
+
+}  // namespace Microsoft::MixedReality::WebRTC
@@ -0,0 +1,104 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <mutex>
+#include <vector>
+
+#include "api/video/i420_buffer.h"
+#include "rtc_base/refcount.h"
+#include "rtc_base/scoped_ref_ptr.h"
+
+#include "callback.h"
+#include "interop/interop_api.h"
+
+namespace Microsoft::MixedReality::WebRTC {
+
+/// Callback receiving the tensors converted by a |VideoTensorConverter| from
+/// the frames of a video sink.
+using VideoTensorReadyCallback = Callback<const VideoTensorInfo*>;
+
+/// Converter of video frames into the planar float input tensors of machine
+/// learning models, straight from the I420 planes of the frames.
+///
+/// Frames are first scaled to the tensor resolution, or to the largest size
+/// fitting in it when letterboxing, with the SIMD scaler of libyuv. The scaled
+/// frame is then converted to RGB in strips of a few rows with the SIMD
+/// kernels of libyuv, into an ARGB strip which stays in cache, and each
+/// channel of the strip is normalized into its float plane by a loop over
+/// whole pixels with no branch nor clamping. The float tensor is thus written
+/// once, without intermediate RGB image of the whole frame.
+///
+/// Frames are converted either into a caller-provided tensor with |Convert()|,
+/// or into a tensor owned by the converter and passed to the callback of the
+/// converter with |OnFrame()|, which makes the converter usable as a video
+/// sink. Both can be called from any thread; conversions are serialized.
+class VideoTensorConverter : public rtc::RefCountInterface {
+ public:
+  /// Create a converter with the given configuration, passing the tensors
+  /// converted by |OnFrame()| to |callback|. Fails with
+  /// |MRS_E_INVALID_PARAMETER| if the configuration is invalid.
+  static mrsResult Create(
+      const VideoTensorConfiguration& config,
+      VideoTensorReadyCallback callback,
+      rtc::scoped_refptr<VideoTensorConverter>& converter) noexcept;
+
+  /// Number of floats of a tensor.
+  size_t tensor_size() const noexcept {
+    return static_cast<size_t>(config_.width) * config_.height * 3;
+  }
+
+  /// Convert the I420 or I420A |frame| into |tensor|, which must hold at least
+  /// |tensor_size()| floats, and describe the result in |info|. Fails with
+  /// |MRS_E_INVALID_PARAMETER| if the frame is in another format.
+  mrsResult Convert(const VideoFrameInfo& frame,
+                    float* tensor,
+                    VideoTensorInfo& info) noexcept;
+
+  /// Convert |frame| into the tensor of the converter, and pass it to the
+  /// callback of the converter. Frames in other formats than I420 and I420A
+  /// are ignored.
+  void OnFrame(const VideoFrameInfo& frame) noexcept;
+
+ protected:
+  VideoTensorConverter(const VideoTensorConfiguration& config,
+                       VideoTensorReadyCallback callback) noexcept;
+  ~VideoTensorConverter() override = default;
+
+ private:
+  /// Source and normalization of one output plane.
+  struct ChannelNormalization {
+    /// Shift of the 8-bit channel in the 32-bit ARGB pixels.
+    int shift;
+    float scale;
+    float bias;
+  };
+
+  /// Convert |frame| into |tensor|, with |mutex_| held.
+  void ConvertLocked(const VideoFrameInfo& frame,
+                     float* tensor,
+                     VideoTensorInfo& info) noexcept;
+
+  const VideoTensorConfiguration config_;
+  const VideoTensorReadyCallback callback_;
+
+  /// Normalization of the output planes, in tensor order.
+  ChannelNormalization channels_[3];
+
+  /// Normalized value of the letterbox border, for each output plane.
+  float border_[3];
+
+  std::mutex mutex_;
+
+  /// Frame scaled to the tensor resolution.
+  rtc::scoped_refptr<webrtc::I420Buffer> scaled_;
+
+  /// Strip of rows of the scaled frame converted to ARGB.
+  std::vector<uint32_t> strip_;
+
+  /// Tensor passed to the callback.
+  std::vector<float> tensor_;
+};
+
+}  // namespace Microsoft::MixedReality::WebRTC
@@ -0,0 +1,75 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Microsoft::MixedReality::WebRTC {
+
+/// Pool of worker threads executing data-parallel jobs, and background tasks.
+///
+/// The process-wide instance is owned by the |GlobalFactory|, and is stopped
+/// together with the other global threads when the library shuts down.
+class WorkerPool {
+ public:
+  /// Create a pool with |num_threads| worker threads.
+  explicit WorkerPool(int num_threads);
+
+  /// Stop and join all worker threads, after running the pending tasks. All
+  /// |ParallelFor()| calls must have returned.
+  ~WorkerPool();
+
+  /// Get the number of worker threads, not including the calling thread which
+  /// also participates in |ParallelFor()|.
+  int num_threads() const noexcept { return static_cast<int>(threads_.size()); }
+
+  /// Check if the calling thread is one of the worker threads, which must not
+  /// destroy the pool since this joins them.
+  bool IsCurrent() const noexcept;
+
+  /// Invoke |func| for each index in [0:count[, distributing the invocations
+  /// over the worker threads and the calling thread, and return once all of
+  /// them completed. The calling thread keeps executing invocations until all
+  /// are started, so this makes progress even if all workers are busy.
+  void ParallelFor(int count, const std::function<void(int)>& func);
+
+  /// Run |task| asynchronously on a worker thread. Tasks are started in
+  /// submission order, after the pending |ParallelFor()| jobs, so that they do
+  /// not delay the callers waiting for their jobs.
+  void Post(std::function<void()> task);
+
+ private:
+  /// Job submitted by a |ParallelFor()| call, living on the caller's stack.
+  struct Job {
+    const std::function<void(int)>* func;
+    int count;
+    /// Next index to execute.
+    int next;
+    /// Number of invocations not completed yet.
+    int pending;
+    /// Signaled when |pending| reaches zero.
+    std::condition_variable done;
+  };
+
+  void Run();
+
+  std::vector<std::thread> threads_;
+  std::mutex mutex_;
+  std::condition_variable cv_;
+
+  /// Jobs with indices not started yet, in submission order.
+  std::deque<Job*> jobs_;
+
+  /// Tasks not started yet, in submission order.
+  std::deque<std::function<void()>> tasks_;
+
+  bool stopping_ = false;
+};
+
+}  // namespace Microsoft::MixedReality::WebRTC
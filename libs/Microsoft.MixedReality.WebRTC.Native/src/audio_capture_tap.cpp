@@ -0,0 +1,379 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#include "pch.h"
+
+#include "audio_capture_tap.h"
+
+namespace Microsoft::MixedReality::WebRTC {
+
+AudioCaptureTap& AudioCaptureTap::Instance() noexcept {
+  static AudioCaptureTap tap;
+  return tap;
+}
+
+void AudioCaptureTap::AddSink(
+    webrtc::AudioTrackSinkInterface* sink,
+    rtc::scoped_refptr<webrtc::MediaStreamTrackInterface> track) noexcept {
+  sinks_.Update([sink, track](std::vector<Sink>& sinks) {
+    if (std::find_if(sinks.begin(), sinks.end(), [sink](const Sink& entry) {
+          return (entry.sink == sink);
+        }) == sinks.end()) {
+      sinks.push_back(Sink{sink, track});
+    }
+  });
+}
+
+void AudioCaptureTap::RemoveSink(
+    webrtc::AudioTrackSinkInterface* sink) noexcept {
+  sinks_.Update([sink](std::vector<Sink>& sinks) {
+    sinks.erase(std::remove_if(sinks.begin(), sinks.end(),
+                               [sink](const Sink& entry) {
+                                 return (entry.sink == sink);
+                               }),
+                sinks.end());
+  });
+}
+
+void AudioCaptureTap::Deliver(const void* audio_data,
+                              int bits_per_sample,
+                              int sample_rate,
+                              size_t number_of_channels,
+                              size_t number_of_frames) const noexcept {
+  sinks_.Read([&](const std::vector<Sink>& sinks) {
+    for (const Sink& entry : sinks) {
+      if (entry.track && !entry.track->enabled()) {
+        continue;
+      }
+      entry.sink->OnData(audio_data, bits_per_sample, sample_rate,
+                         number_of_channels, number_of_frames);
+    }
+  });
+}
+
+rtc::scoped_refptr<TappedAudioDeviceModule> TappedAudioDeviceModule::Create(
+    rtc::scoped_refptr<webrtc::AudioDeviceModule> adm) noexcept {
+  if (!adm) {
+    return nullptr;
+  }
+  return new rtc::RefCountedObject<TappedAudioDeviceModule>(std::move(adm));
+}
+
+TappedAudioDeviceModule::TappedAudioDeviceModule(
+    rtc::scoped_refptr<webrtc::AudioDeviceModule> adm) noexcept
+    : adm_(std::move(adm)) {}
+
+int32_t TappedAudioDeviceModule::ActiveAudioLayer(
+    AudioLayer* audioLayer) const {
+  return adm_->ActiveAudioLayer(audioLayer);
+}
+
+int32_t TappedAudioDeviceModule::RegisterAudioCallback(
+    webrtc::AudioTransport* audioCallback) {
+  // Interpose the tap between the wrapped module and the voice engine. When
+  // unregistering, first detach from the wrapped module so that the audio
+  // threads stop using the transport.
+  if (audioCallback) {
+    transport_.store(audioCallback);
+    return adm_->RegisterAudioCallback(this);
+  }
+  const int32_t result = adm_->RegisterAudioCallback(nullptr);
+  transport_.store(nullptr);
+  return result;
+}
+
+int32_t TappedAudioDeviceModule::Init() {
+  return adm_->Init();
+}
+
+int32_t TappedAudioDeviceModule::Terminate() {
+  return adm_->Terminate();
+}
+
+bool TappedAudioDeviceModule::Initialized() const {
+  return adm_->Initialized();
+}
+
+int16_t TappedAudioDeviceModule::PlayoutDevices() {
+  return adm_->PlayoutDevices();
+}
+
+int16_t TappedAudioDeviceModule::RecordingDevices() {
+  return adm_->RecordingDevices();
+}
+
+int32_t TappedAudioDeviceModule::PlayoutDeviceName(
+    uint16_t index,
+    char name[webrtc::kAdmMaxDeviceNameSize],
+    char guid[webrtc::kAdmMaxGuidSize]) {
+  return adm_->PlayoutDeviceName(index, name, guid);
+}
+
+int32_t TappedAudioDeviceModule::RecordingDeviceName(
+    uint16_t index,
+    char name[webrtc::kAdmMaxDeviceNameSize],
+    char guid[webrtc::kAdmMaxGuidSize]) {
+  return adm_->RecordingDeviceName(index, name, guid);
+}
+
+int32_t TappedAudioDeviceModule::SetPlayoutDevice(uint16_t index) {
+  return adm_->SetPlayoutDevice(index);
+}
+
+int32_t TappedAudioDeviceModule::SetPlayoutDevice(WindowsDeviceType device) {
+  return adm_->SetPlayoutDevice(device);
+}
+
+int32_t TappedAudioDeviceModule::SetRecordingDevice(uint16_t index) {
+  return adm_->SetRecordingDevice(index);
+}
+
+int32_t TappedAudioDeviceModule::SetRecordingDevice(WindowsDeviceType device) {
+  return adm_->SetRecordingDevice(device);
+}
+
+int32_t TappedAudioDeviceModule::PlayoutIsAvailable(bool* available) {
+  return adm_->PlayoutIsAvailable(available);
+}
+
+int32_t TappedAudioDeviceModule::InitPlayout() {
+  return adm_->InitPlayout();
+}
+
+bool TappedAudioDeviceModule::PlayoutIsInitialized() const {
+  return adm_->PlayoutIsInitialized();
+}
+
+int32_t TappedAudioDeviceModule::RecordingIsAvailable(bool* available) {
+  return adm_->RecordingIsAvailable(available);
+}
+
+int32_t TappedAudioDeviceModule::InitRecording() {
+  return adm_->InitRecording();
+}
+
+bool TappedAudioDeviceModule::RecordingIsInitialized() const {
+  return adm_->RecordingIsInitialized();
+}
+
+int32_t TappedAudioDeviceModule::StartPlayout() {
+  return adm_->StartPlayout();
+}
+
+int32_t TappedAudioDeviceModule::StopPlayout() {
+  return adm_->StopPlayout();
+}
+
+bool TappedAudioDeviceModule::Playing() const {
+  return adm_->Playing();
+}
+
+int32_t TappedAudioDeviceModule::StartRecording() {
+  return adm_->StartRecording();
+}
+
+int32_t TappedAudioDeviceModule::StopRecording() {
+  return adm_->StopRecording();
+}
+
+bool TappedAudioDeviceModule::Recording() const {
+  return adm_->Recording();
+}
+
+int32_t TappedAudioDeviceModule::InitSpeaker() {
+  return adm_->InitSpeaker();
+}
+
+bool TappedAudioDeviceModule::SpeakerIsInitialized() const {
+  return adm_->SpeakerIsInitialized();
+}
+
+int32_t TappedAudioDeviceModule::InitMicrophone() {
+  return adm_->InitMicrophone();
+}
+
+bool TappedAudioDeviceModule::MicrophoneIsInitialized() const {
+  return adm_->MicrophoneIsInitialized();
+}
+
+int32_t TappedAudioDeviceModule::SpeakerVolumeIsAvailable(bool* available) {
+  return adm_->SpeakerVolumeIsAvailable(available);
+}
+
+int32_t TappedAudioDeviceModule::SetSpeakerVolume(uint32_t volume) {
+  return adm_->SetSpeakerVolume(volume);
+}
+
+int32_t TappedAudioDeviceModule::SpeakerVolume(uint32_t* volume) const {
+  return adm_->SpeakerVolume(volume);
+}
+
+int32_t TappedAudioDeviceModule::MaxSpeakerVolume(uint32_t* maxVolume) const {
+  return adm_->MaxSpeakerVolume(maxVolume);
+}
+
+int32_t TappedAudioDeviceModule::MinSpeakerVolume(uint32_t* minVolume) const {
+  return adm_->MinSpeakerVolume(minVolume);
+}
+
+int32_t TappedAudioDeviceModule::MicrophoneVolumeIsAvailable(bool* available) {
+  return adm_->MicrophoneVolumeIsAvailable(available);
+}
+
+int32_t TappedAudioDeviceModule::SetMicrophoneVolume(uint32_t volume) {
+  return adm_->SetMicrophoneVolume(volume);
+}
+
+int32_t TappedAudioDeviceModule::MicrophoneVolume(uint32_t* volume) const {
+  return adm_->MicrophoneVolume(volume);
+}
+
+int32_t TappedAudioDeviceModule::MaxMicrophoneVolume(
+    uint32_t* maxVolume) const {
+  return adm_->MaxMicrophoneVolume(maxVolume);
+}
+
+int32_t TappedAudioDeviceModule::MinMicrophoneVolume(
+    uint32_t* minVolume) const {
+  return adm_->MinMicrophoneVolume(minVolume);
+}
+
+int32_t TappedAudioDeviceModule::SpeakerMuteIsAvailable(bool* available) {
+  return adm_->SpeakerMuteIsAvailable(available);
+}
+
+int32_t TappedAudioDeviceModule::SetSpeakerMute(bool enable) {
+  return adm_->SetSpeakerMute(enable);
+}
+
+int32_t TappedAudioDeviceModule::SpeakerMute(bool* enabled) const {
+  return adm_->SpeakerMute(enabled);
+}
+
+int32_t TappedAudioDeviceModule::MicrophoneMuteIsAvailable(bool* available) {
+  return adm_->MicrophoneMuteIsAvailable(available);
+}
+
+int32_t TappedAudioDeviceModule::SetMicrophoneMute(bool enable) {
+  return adm_->SetMicrophoneMute(enable);
+}
+
+int32_t TappedAudioDeviceModule::MicrophoneMute(bool* enabled) const {
+  return adm_->MicrophoneMute(enabled);
+}
+
+int32_t TappedAudioDeviceModule::StereoPlayoutIsAvailable(
+    bool* available) const {
+  return adm_->StereoPlayoutIsAvailable(available);
+}
+
+int32_t TappedAudioDeviceModule::SetStereoPlayout(bool enable) {
+  return adm_->SetStereoPlayout(enable);
+}
+
+int32_t TappedAudioDeviceModule::StereoPlayout(bool* enabled) const {
+  return adm_->StereoPlayout(enabled);
+}
+
+int32_t TappedAudioDeviceModule::StereoRecordingIsAvailable(
+    bool* available) const {
+  return adm_->StereoRecordingIsAvailable(available);
+}
+
+int32_t TappedAudioDeviceModule::SetStereoRecording(bool enable) {
+  return adm_->SetStereoRecording(enable);
+}
+
+int32_t TappedAudioDeviceModule::StereoRecording(bool* enabled) const {
+  return adm_->StereoRecording(enabled);
+}
+
+int32_t TappedAudioDeviceModule::PlayoutDelay(uint16_t* delayMS) const {
+  return adm_->PlayoutDelay(delayMS);
+}
+
+bool TappedAudioDeviceModule::BuiltInAECIsAvailable() const {
+  return adm_->BuiltInAECIsAvailable();
+}
+
+bool TappedAudioDeviceModule::BuiltInAGCIsAvailable() const {
+  return adm_->BuiltInAGCIsAvailable();
+}
+
+bool TappedAudioDeviceModule::BuiltInNSIsAvailable() const {
+  return adm_->BuiltInNSIsAvailable();
+}
+
+int32_t TappedAudioDeviceModule::EnableBuiltInAEC(bool enable) {
+  return adm_->EnableBuiltInAEC(enable);
+}
+
+int32_t TappedAudioDeviceModule::EnableBuiltInAGC(bool enable) {
+  return adm_->EnableBuiltInAGC(enable);
+}
+
+int32_t TappedAudioDeviceModule::EnableBuiltInNS(bool enable) {
+  return adm_->EnableBuiltInNS(enable);
+}
+
+int32_t TappedAudioDeviceModule::RecordedDataIsAvailable(
+    const void* audioSamples,
+    const size_t nSamples,
+    const size_t nBytesPerSample,
+    const size_t nChannels,
+    const uint32_t samplesPerSec,
+    const uint32_t totalDelayMS,
+    const int32_t clockDrift,
+    const uint32_t currentMicLevel,
+    const bool keyPressed,
+    uint32_t& newMicLevel) {
+  int32_t result = 0;
+  if (webrtc::AudioTransport* transport = transport_.load()) {
+    result = transport->RecordedDataIsAvailable(
+        audioSamples, nSamples, nBytesPerSample, nChannels, samplesPerSec,
+        totalDelayMS, clockDrift, currentMicLevel, keyPressed, newMicLevel);
+  }
+  // Deliver after the voice engine, so that the sinks do not delay sending.
+  // Note that |nBytesPerSample| is the size of a frame of all channels.
+  if (nChannels > 0) {
+    const int bits_per_sample =
+        static_cast<int>(8 * nBytesPerSample / nChannels);
+    AudioCaptureTap::Instance().Deliver(audioSamples, bits_per_sample,
+                                        static_cast<int>(samplesPerSec),
+                                        nChannels, nSamples);
+  }
+  return result;
+}
+
+int32_t TappedAudioDeviceModule::NeedMorePlayData(const size_t nSamples,
+                                                  const size_t nBytesPerSample,
+                                                  const size_t nChannels,
+                                                  const uint32_t samplesPerSec,
+                                                  void* audioSamples,
+                                                  size_t& nSamplesOut,
+                                                  int64_t* elapsed_time_ms,
+                                                  int64_t* ntp_time_ms) {
+  if (webrtc::AudioTransport* transport = transport_.load()) {
+    return transport->NeedMorePlayData(nSamples, nBytesPerSample, nChannels,
+                                       samplesPerSec, audioSamples, nSamplesOut,
+                                       elapsed_time_ms, ntp_time_ms);
+  }
+  nSamplesOut = 0;
+  return 0;
+}
+
+void TappedAudioDeviceModule::PullRenderData(int bits_per_sample,
+                                             int sample_rate,
+                                             size_t number_of_channels,
+                                             size_t number_of_frames,
+                                             void* audio_data,
+                                             int64_t* elapsed_time_ms,
+                                             int64_t* ntp_time_ms) {
+  if (webrtc::AudioTransport* transport = transport_.load()) {
+    transport->PullRenderData(bits_per_sample, sample_rate, number_of_channels,
+                              number_of_frames, audio_data, elapsed_time_ms,
+                              ntp_time_ms);
+  }
+}
+
+}  // namespace Microsoft::MixedReality::WebRTC
@@ -10,8 +10,16 @@ namespace Microsoft::MixedReality::WebRTC {
 
 void AudioFrameObserver::SetCallback(
     AudioFrameReadyCallback callback) noexcept {
-  auto lock = std::scoped_lock{mutex_};
-  callback_ = std::move(callback);
+  callbacks_.Update([&callback](Callbacks& callbacks) {
+    callbacks.callback = callback;
+  });
+}
+
+void AudioFrameObserver::SetCallback(AudioFrameInfoCallback callback) noexcept {
+  callbacks_.Update([&callback](Callbacks& callbacks) {
+    callbacks.info_callback = callback;
+  });
+  sample_position_.store(0, std::memory_order_relaxed);
 }
 
 void AudioFrameObserver::OnData(const void* audio_data,
@@ -19,13 +27,28 @@ void AudioFrameObserver::OnData(const void* audio_data,
                                 int sample_rate,
                                 size_t number_of_channels,
                                 size_t number_of_frames) noexcept {
-  auto lock = std::scoped_lock{mutex_};
-  if (!callback_)
-    return;
-  callback_(audio_data, static_cast<uint32_t>(bits_per_sample),
-            static_cast<uint32_t>(sample_rate),
-            static_cast<uint32_t>(number_of_channels),
-            static_cast<uint32_t>(number_of_frames));
+  const int64_t arrival_time_us = rtc::TimeMicros();
+  const uint64_t sample_position =
+      sample_position_.fetch_add(number_of_frames, std::memory_order_relaxed);
+  callbacks_.Read([&](const Callbacks& callbacks) {
+    if (callbacks.callback) {
+      callbacks.callback(audio_data, static_cast<uint32_t>(bits_per_sample),
+                         static_cast<uint32_t>(sample_rate),
+                         static_cast<uint32_t>(number_of_channels),
+                         static_cast<uint32_t>(number_of_frames));
+    }
+    if (callbacks.info_callback) {
+      AudioFrameInfo info{};
+      info.data = audio_data;
+      info.bits_per_sample = static_cast<uint32_t>(bits_per_sample);
+      info.sample_rate = static_cast<uint32_t>(sample_rate);
+      info.number_of_channels = static_cast<uint32_t>(number_of_channels);
+      info.number_of_frames = static_cast<uint32_t>(number_of_frames);
+      info.timing.arrival_time_us = arrival_time_us;
+      info.timing.sample_position = sample_position;
+      callbacks.info_callback(&info);
+    }
+  });
 }
 
 }  // namespace Microsoft::MixedReality::WebRTC
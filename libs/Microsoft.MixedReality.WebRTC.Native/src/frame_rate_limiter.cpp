@@ -0,0 +1,67 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+// This is a precompiled header, it must be on its own, followed by a blank
+// line, to prevent clang-format from reordering it with other headers.
+#include "pch.h"
+
+#include "frame_rate_limiter.h"
+
+namespace {
+
+/// Check whether a frame at |timestamp_us| is delivered when the next frame
+/// is due at |due_us|, given the delivery interval |interval_us|. Frames up to
+/// a quarter interval early are accepted, to absorb the jitter of the source
+/// timestamps without drifting.
+bool IsFrameDue(int64_t timestamp_us,
+                int64_t due_us,
+                int64_t interval_us) noexcept {
+  if (timestamp_us >= due_us - interval_us / 4) {
+    return true;
+  }
+  // Timestamps jumped backward past the last delivered frame, for example
+  // after the source restarted.
+  return (timestamp_us < due_us - interval_us);
+}
+
+}  // namespace
+
+namespace Microsoft::MixedReality::WebRTC {
+
+FrameRateLimiter::FrameRateLimiter(double max_framerate) noexcept
+    : interval_us_(
+          static_cast<int64_t>(rtc::kNumMicrosecsPerSec / max_framerate)) {
+  RTC_DCHECK_GT(max_framerate, 0.0);
+}
+
+bool FrameRateLimiter::IsDue(int64_t timestamp_us) const noexcept {
+  const int64_t due_us = next_due_us_.load(std::memory_order_relaxed);
+  return ((due_us == kUnscheduled) ||
+          IsFrameDue(timestamp_us, due_us, interval_us_));
+}
+
+bool FrameRateLimiter::TryDeliver(int64_t timestamp_us) noexcept {
+  int64_t due_us = next_due_us_.load(std::memory_order_relaxed);
+  for (;;) {
+    int64_t next_due_us;
+    if (due_us == kUnscheduled) {
+      next_due_us = timestamp_us + interval_us_;
+    } else if (!IsFrameDue(timestamp_us, due_us, interval_us_)) {
+      return false;
+    } else {
+      // Stay on the schedule to keep a steady rate, unless the frame is off by
+      // more than one interval, in which case restart from it.
+      const bool on_schedule = (timestamp_us >= due_us - interval_us_) &&
+                               (timestamp_us < due_us + interval_us_);
+      next_due_us = (on_schedule ? due_us : timestamp_us) + interval_us_;
+    }
+    // Only one of concurrent callers advances the schedule from |due_us|; the
+    // others decide again against the new schedule.
+    if (next_due_us_.compare_exchange_strong(due_us, next_due_us,
+                                             std::memory_order_relaxed)) {
+      return true;
+    }
+  }
+}
+
+}  // namespace Microsoft::MixedReality::WebRTC
@@ -0,0 +1,57 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+// This is a precompiled header, it must be on its own, followed by a blank
+// line, to prevent clang-format from reordering it with other headers.
+#include "pch.h"
+
+#include "external_video_track_source.h"
+#include "interop/external_video_track_source_interop.h"
+
+using namespace Microsoft::MixedReality::WebRTC;
+
+void MRS_CALL mrsExternalVideoTrackSourceAddRef(
+    ExternalVideoTrackSourceHandle handle) noexcept {
+  if (auto source = static_cast<ExternalVideoTrackSource*>(handle)) {
+    source->AddRef();
+  } else {
+    RTC_LOG(LS_WARNING) << "Trying to add reference to NULL "
+                           "ExternalVideoTrackSource object.";
+  }
+}
+
+void MRS_CALL mrsExternalVideoTrackSourceRemoveRef(
+    ExternalVideoTrackSourceHandle handle) noexcept {
+  if (auto source = static_cast<ExternalVideoTrackSource*>(handle)) {
+    source->Release();
+  } else {
+    RTC_LOG(LS_WARNING) << "Trying to remove reference from NULL "
+                           "ExternalVideoTrackSource object.";
+  }
+}
+
+mrsResult MRS_CALL mrsExternalVideoTrackSourceCreate(
+    ExternalVideoTrackSourceHandle* handle) noexcept {
+  if (!handle) {
+    return MRS_E_INVALID_PARAMETER;
+  }
+  rtc::scoped_refptr<ExternalVideoTrackSource> source =
+      ExternalVideoTrackSource::Create();
+  *handle = source.release();
+  return MRS_SUCCESS;
+}
+
+mrsResult MRS_CALL mrsExternalVideoTrackSourcePushFrame(
+    ExternalVideoTrackSourceHandle handle,
+    const VideoFrameInfo* frame,
+    mrsExternalVideoFrameReleaseCallback release_callback,
+    void* release_user_data) noexcept {
+  const ExternalVideoFrameReleaseCallback release{release_callback,
+                                                  release_user_data};
+  auto source = static_cast<ExternalVideoTrackSource*>(handle);
+  if (!source || !frame) {
+    release();
+    return MRS_E_INVALID_PARAMETER;
+  }
+  return source->PushFrame(*frame, release);
+}
@@ -0,0 +1,58 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include "export.h"
+#include "interop/interop_api.h"
+
+extern "C" {
+
+/// Callback fired when the application buffers of a frame pushed to an
+/// external video track source are not used anymore.
+using mrsExternalVideoFrameReleaseCallback = void(MRS_CALL*)(void* user_data);
+
+//
+// Wrapper
+//
+
+/// Add a reference to the native object associated with the given handle.
+MRS_API void MRS_CALL mrsExternalVideoTrackSourceAddRef(
+    ExternalVideoTrackSourceHandle handle) noexcept;
+
+/// Remove a reference from the native object associated with the given handle.
+MRS_API void MRS_CALL mrsExternalVideoTrackSourceRemoveRef(
+    ExternalVideoTrackSourceHandle handle) noexcept;
+
+//
+// Source
+//
+
+/// Create a video track source producing the frames pushed by the application
+/// with |mrsExternalVideoTrackSourcePushFrame|, instead of capturing them from
+/// a device. This does not require any video capture device, and works on
+/// headless machines. The source is returned with one reference, to be
+/// released with |mrsExternalVideoTrackSourceRemoveRef|. Use
+/// |mrsPeerConnectionAddLocalVideoTrackFromExternalSource| to send its frames.
+MRS_API mrsResult MRS_CALL mrsExternalVideoTrackSourceCreate(
+    ExternalVideoTrackSourceHandle* handle) noexcept;
+
+/// Push a frame to an external video track source, from any thread. The frame
+/// is described by |frame|, in |VideoFrameFormat::kI420A| (with or without
+/// alpha plane), |VideoFrameFormat::kNv12| or |VideoFrameFormat::kArgb32|
+/// format. Its timestamp is |frame->timing.timestamp_us| on the clock of
+/// |mrsGetClockTimeUs()|, or the current time if zero, and its rotation is
+/// |frame->rotation|, which must be one of the |VideoRotation| values.
+///
+/// If |release_callback| is not null, the application buffers are used in
+/// place without any copy, and must stay valid and unmodified until the
+/// callback is invoked with |release_user_data|, possibly from another thread.
+/// The callback is always invoked exactly once, even if the call fails.
+/// Otherwise the frame is copied before this call returns.
+MRS_API mrsResult MRS_CALL mrsExternalVideoTrackSourcePushFrame(
+    ExternalVideoTrackSourceHandle handle,
+    const VideoFrameInfo* frame,
+    mrsExternalVideoFrameReleaseCallback release_callback,
+    void* release_user_data) noexcept;
+
+}  // extern "C"
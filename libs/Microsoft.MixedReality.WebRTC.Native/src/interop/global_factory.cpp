@@ -6,6 +6,7 @@
 #include "pch.h"
 
 #include "interop/global_factory.h"
+#include "video_capture_device_cache.h"
 
 namespace {
 
@@ -75,6 +76,11 @@ rtc::Thread* GlobalFactory::GetWorkerThread() noexcept {
 #endif  // defined(WINUWP)
 }
 
+std::shared_ptr<WorkerPool> GlobalFactory::GetWorkerPool() noexcept {
+  std::scoped_lock lock(mutex_);
+  return worker_pool_;
+}
+
 PeerConnectionHandle GlobalFactory::AddPeerConnection(
     rtc::scoped_refptr<PeerConnection> peer) {
   RTC_CHECK(peer);
@@ -200,9 +206,24 @@ mrsResult GlobalFactory::Initialize() {
                              signaling_thread_.get());
   signaling_thread_->Start();
 
+  // Wrap the platform audio device module to tap the local audio, which
+  // WebRTC does not deliver to the local audio track sinks. Like WebRTC does
+  // for its default module, create it on the worker thread which uses it.
+  audio_device_module_ =
+      worker_thread_->Invoke<rtc::scoped_refptr<TappedAudioDeviceModule>>(
+          RTC_FROM_HERE, []() {
+            return TappedAudioDeviceModule::Create(
+                webrtc::AudioDeviceModule::Create(
+                    webrtc::AudioDeviceModule::kPlatformDefaultAudio));
+          });
+  if (!audio_device_module_) {
+    RTC_LOG(LS_WARNING) << "Failed to create the audio device module; the "
+                           "local audio will not be tapped.";
+  }
+
   factory_ = webrtc::CreatePeerConnectionFactory(
       network_thread_.get(), worker_thread_.get(), signaling_thread_.get(),
-      nullptr, webrtc::CreateBuiltinAudioEncoderFactory(),
+      audio_device_module_, webrtc::CreateBuiltinAudioEncoderFactory(),
       webrtc::CreateBuiltinAudioDecoderFactory(),
       std::unique_ptr<webrtc::VideoEncoderFactory>(
           new webrtc::MultiplexEncoderFactory(
@@ -211,7 +232,34 @@ mrsResult GlobalFactory::Initialize() {
           new webrtc::MultiplexDecoderFactory(
               absl::make_unique<webrtc::InternalDecoderFactory>())),
       nullptr, nullptr);
+
 #endif  // defined(WINUWP)
+
+  if (factory_) {
+    // Keep one core for the calling thread, which also participates in jobs.
+    // The last reference can be released from a task of the pool, like a
+    // snapshot callback shutting down the library, and a worker cannot join
+    // itself. Destroy the pool from a helper thread in that case, which joins
+    // the workers once that task returned.
+    const int num_cores = static_cast<int>(std::thread::hardware_concurrency());
+    worker_pool_.reset(new WorkerPool(std::max(num_cores - 1, 1)),
+                       [](WorkerPool* pool) {
+                         if (pool->IsCurrent()) {
+                           std::thread([pool]() { delete pool; }).detach();
+                         } else {
+                           delete pool;
+                         }
+                       });
+    VideoCaptureDeviceCache::Instance().StartWatching();
+#if !defined(WINUWP)
+    // Probe the video capture devices and their formats in the background, so
+    // that enumerating or opening them does not wait for the hardware. This
+    // is skipped if the library shuts down before the probe started, as the
+    // cache stops watching first.
+    worker_pool_->Post(
+        []() { VideoCaptureDeviceCache::Instance().Refresh(); });
+#endif  // !defined(WINUWP)
+  }
   return (factory_.get() != nullptr ? MRS_SUCCESS : MRS_E_UNKNOWN);
 }
 
@@ -223,10 +271,18 @@ void GlobalFactory::CheckForShutdown() {
 }
 
 void GlobalFactory::ShutdownNoLock() {
+  // Stop watching before releasing the worker pool, which runs its pending
+  // tasks, so that a device probe not started yet returns immediately.
+  VideoCaptureDeviceCache::Instance().StopWatching();
   factory_ = nullptr;
+  worker_pool_ = nullptr;
 #if defined(WINUWP)
   impl_ = nullptr;
 #else   // defined(WINUWP)
+  if (audio_device_module_) {
+    worker_thread_->Invoke<void>(RTC_FROM_HERE,
+                                 [this]() { audio_device_module_ = nullptr; });
+  }
   network_thread_.reset();
   worker_thread_.reset();
   signaling_thread_.reset();
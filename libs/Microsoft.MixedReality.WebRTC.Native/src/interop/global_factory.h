@@ -3,8 +3,10 @@
 
 #pragma once
 
+#include "audio_capture_tap.h"
 #include "export.h"
 #include "peer_connection.h"
+#include "worker_pool.h"
 
 namespace Microsoft::MixedReality::WebRTC {
 
@@ -32,6 +34,12 @@ class GlobalFactory {
   /// Get the worker thread. This is only valid if initialized.
   rtc::Thread* GetWorkerThread() noexcept;
 
+  /// Get the process-wide worker pool used to parallelize some per-frame
+  /// processing, or NULL if not initialized. The pool is created and stopped
+  /// together with the factory, and the returned reference keeps it alive
+  /// until released, from any thread including the workers of the pool.
+  std::shared_ptr<WorkerPool> GetWorkerPool() noexcept;
+
   /// Add a peer connection to the global map of the factory.
   PeerConnectionHandle AddPeerConnection(
       rtc::scoped_refptr<PeerConnection> peer);
@@ -79,6 +87,11 @@ class GlobalFactory {
   std::unique_ptr<rtc::Thread> network_thread_ RTC_GUARDED_BY(mutex_);
   std::unique_ptr<rtc::Thread> worker_thread_ RTC_GUARDED_BY(mutex_);
   std::unique_ptr<rtc::Thread> signaling_thread_ RTC_GUARDED_BY(mutex_);
+
+  /// Audio device module of the peer connection factory, feeding the local
+  /// audio to the |AudioCaptureTap|. Released on the worker thread.
+  rtc::scoped_refptr<TappedAudioDeviceModule> audio_device_module_
+      RTC_GUARDED_BY(mutex_);
 #endif  // defined(WINUWP)
   std::recursive_mutex mutex_;
 
@@ -88,6 +101,9 @@ class GlobalFactory {
       rtc::scoped_refptr<Microsoft::MixedReality::WebRTC::PeerConnection>>
       peer_connection_map_ RTC_GUARDED_BY(mutex_);
 
+  /// Process-wide worker pool, created with the factory.
+  std::shared_ptr<WorkerPool> worker_pool_ RTC_GUARDED_BY(mutex_);
+
   /// Collection of all objects alive.
   std::unordered_set<void*> alive_objects_ RTC_GUARDED_BY(mutex_);
 };
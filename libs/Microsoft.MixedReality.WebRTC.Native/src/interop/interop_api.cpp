@@ -6,11 +6,15 @@
 #include "pch.h"
 
 #include "data_channel.h"
+#include "external_video_track_source.h"
+#include "generated_video_track_source.h"
 #include "interop/global_factory.h"
 #include "interop/interop_api.h"
 #include "local_video_track.h"
 #include "peer_connection.h"
 #include "sdp_utils.h"
+#include "video_capture_device_cache.h"
+#include "video_capture_format.h"
 
 using namespace Microsoft::MixedReality::WebRTC;
 
@@ -172,50 +176,35 @@ mrsResult OpenVideoCaptureDevice(
   }
 #else
   // List all available video capture devices, or match by ID if specified.
+  std::vector<CachedVideoCaptureDevice> devices;
+  if (!VideoCaptureDeviceCache::Instance().GetDevices(devices)) {
+    return MRS_E_UNKNOWN;
+  }
   std::vector<std::string> device_names;
-  {
-    std::unique_ptr<webrtc::VideoCaptureModule::DeviceInfo> info(
-        webrtc::VideoCaptureFactory::CreateDeviceInfo());
-    if (!info) {
-      return MRS_E_UNKNOWN;
-    }
-
-    const int num_devices = info->NumberOfDevices();
-    constexpr uint32_t kSize = 256;
-    if (!IsStringNullOrEmpty(config.video_device_id)) {
-      // Look for the one specific device the user asked for
-      std::string video_device_id_str = config.video_device_id;
-      for (int i = 0; i < num_devices; ++i) {
-        char name[kSize] = {};
-        char id[kSize] = {};
-        if (info->GetDeviceName(i, name, kSize, id, kSize) != -1) {
-          if (video_device_id_str == id) {
-            // Keep only the device the user selected
-            device_names.push_back(name);
-            break;
-          }
-        }
-      }
-      if (device_names.empty()) {
-        RTC_LOG(LS_ERROR)
-            << "Could not find video capture device by unique ID: "
-            << config.video_device_id;
-        return MRS_E_NOTFOUND;
-      }
-    } else {
-      // List all available devices
-      for (int i = 0; i < num_devices; ++i) {
-        char name[kSize] = {};
-        char id[kSize] = {};
-        if (info->GetDeviceName(i, name, kSize, id, kSize) != -1) {
-          device_names.push_back(name);
-        }
-      }
-      if (device_names.empty()) {
-        RTC_LOG(LS_ERROR) << "Could not find any video catpure device.";
-        return MRS_E_INVALID_OPERATION;
+  if (!IsStringNullOrEmpty(config.video_device_id)) {
+    // Look for the one specific device the user asked for
+    const std::string video_device_id_str = config.video_device_id;
+    for (const CachedVideoCaptureDevice& device : devices) {
+      if (device.id == video_device_id_str) {
+        // Keep only the device the user selected
+        device_names.push_back(device.name);
+        break;
       }
     }
+    if (device_names.empty()) {
+      RTC_LOG(LS_ERROR) << "Could not find video capture device by unique ID: "
+                        << config.video_device_id;
+      return MRS_E_NOTFOUND;
+    }
+  } else {
+    // List all available devices
+    for (const CachedVideoCaptureDevice& device : devices) {
+      device_names.push_back(device.name);
+    }
+    if (device_names.empty()) {
+      RTC_LOG(LS_ERROR) << "Could not find any video catpure device.";
+      return MRS_E_INVALID_OPERATION;
+    }
   }
 
   // Open the specified capture device, or the first one available if none
@@ -234,6 +223,38 @@ mrsResult OpenVideoCaptureDevice(
   return MRS_E_UNKNOWN;
 }
 
+/// Create a video track for |video_source|, add it to |peer|, and return in
+/// |track_handle| a handle to the local video track wrapper. The source is
+/// wrapped to allow processing its frames before encoding. |capture_format| is
+/// the format the capture device of the source was opened in, if selected by
+/// the library.
+mrsResult AddLocalVideoTrackFromSource(
+    PeerConnection& peer,
+    webrtc::PeerConnectionFactoryInterface& pc_factory,
+    const char* track_name,
+    rtc::scoped_refptr<webrtc::VideoTrackSourceInterface> video_source,
+    LocalVideoTrackHandle* track_handle,
+    std::optional<VideoCaptureFormatInfo> capture_format =
+        std::nullopt) noexcept {
+  rtc::scoped_refptr<ProcessedVideoTrackSource> processed_source =
+      ProcessedVideoTrackSource::Create(std::move(video_source));
+  rtc::scoped_refptr<webrtc::VideoTrackInterface> video_track =
+      pc_factory.CreateVideoTrack(track_name, processed_source);
+  if (!video_track) {
+    return MRS_E_UNKNOWN;
+  }
+  auto result = peer.AddLocalVideoTrack(std::move(video_track),
+                                        std::move(processed_source),
+                                        std::move(capture_format));
+  if (result.ok()) {
+    rtc::scoped_refptr<LocalVideoTrack>& video_track_wrapper = result.value();
+    video_track_wrapper->AddRef();  // for the handle
+    *track_handle = video_track_wrapper.get();
+    return MRS_SUCCESS;
+  }
+  return MRS_E_UNKNOWN;
+}
+
 webrtc::PeerConnectionInterface::IceTransportsType ICETransportTypeToNative(
     IceTransportType mrsValue) {
   using Native = webrtc::PeerConnectionInterface::IceTransportsType;
@@ -272,46 +293,6 @@ std::vector<std::string> SplitString(const std::string& str, char sep) {
   return ret;
 }
 
-/// Convert a WebRTC VideoType format into its FOURCC counterpart.
-uint32_t FourCCFromVideoType(webrtc::VideoType videoType) {
-  switch (videoType) {
-    default:
-    case webrtc::VideoType::kUnknown:
-      return (uint32_t)libyuv::FOURCC_ANY;
-    case webrtc::VideoType::kI420:
-      return (uint32_t)libyuv::FOURCC_I420;
-    case webrtc::VideoType::kIYUV:
-      return (uint32_t)libyuv::FOURCC_IYUV;
-    case webrtc::VideoType::kRGB24:
-      // this seems unintuitive, but is how defined in the core implementation
-      return (uint32_t)libyuv::FOURCC_24BG;
-    case webrtc::VideoType::kABGR:
-      return (uint32_t)libyuv::FOURCC_ABGR;
-    case webrtc::VideoType::kARGB:
-      return (uint32_t)libyuv::FOURCC_ARGB;
-    case webrtc::VideoType::kARGB4444:
-      return (uint32_t)libyuv::FOURCC_R444;
-    case webrtc::VideoType::kRGB565:
-      return (uint32_t)libyuv::FOURCC_RGBP;
-    case webrtc::VideoType::kARGB1555:
-      return (uint32_t)libyuv::FOURCC_RGBO;
-    case webrtc::VideoType::kYUY2:
-      return (uint32_t)libyuv::FOURCC_YUY2;
-    case webrtc::VideoType::kYV12:
-      return (uint32_t)libyuv::FOURCC_YV12;
-    case webrtc::VideoType::kUYVY:
-      return (uint32_t)libyuv::FOURCC_UYVY;
-    case webrtc::VideoType::kMJPEG:
-      return (uint32_t)libyuv::FOURCC_MJPG;
-    case webrtc::VideoType::kNV21:
-      return (uint32_t)libyuv::FOURCC_NV21;
-    case webrtc::VideoType::kNV12:
-      return (uint32_t)libyuv::FOURCC_NV12;
-    case webrtc::VideoType::kBGRA:
-      return (uint32_t)libyuv::FOURCC_BGRA;
-  };
-}
-
 }  // namespace
 
 inline rtc::Thread* GetWorkerThread() {
@@ -336,6 +317,22 @@ void MRS_CALL mrsEnumVideoCaptureDevicesAsync(
   if (!enumCallback) {
     return;
   }
+
+  // Replay the cached devices if no device changed since they were probed,
+  // without probing the hardware again.
+  VideoCaptureDeviceCache& cache = VideoCaptureDeviceCache::Instance();
+  std::vector<CachedVideoCaptureDevice> devices;
+  if (cache.TryGetDevices(devices)) {
+    for (const CachedVideoCaptureDevice& device : devices) {
+      (*enumCallback)(device.id.c_str(), device.name.c_str(),
+                      enumCallbackUserData);
+    }
+    if (completedCallback) {
+      (*completedCallback)(completedCallbackUserData);
+    }
+    return;
+  }
+
 #if defined(WINUWP)
   // The UWP factory needs to be initialized for getDevices() to work.
   if (!GlobalFactory::Instance()->GetOrCreate()) {
@@ -343,38 +340,33 @@ void MRS_CALL mrsEnumVideoCaptureDevicesAsync(
     return;
   }
 
+  const uint64_t generation = cache.generation();
   auto vci = wrapper::impl::org::webRtc::VideoCapturer::getDevices();
-  vci->thenClosure([vci, enumCallback, completedCallback, enumCallbackUserData,
-                    completedCallbackUserData] {
+  vci->thenClosure([vci, generation, enumCallback, completedCallback,
+                    enumCallbackUserData, completedCallbackUserData] {
     auto deviceList = vci->value();
+    std::vector<CachedVideoCaptureDevice> devices;
     for (auto&& vdi : *deviceList) {
       auto devInfo =
           wrapper::impl::org::webRtc::VideoDeviceInfo::toNative_winrt(vdi);
-      auto id = winrt::to_string(devInfo.Id());
-      id.push_back('\0');  // API must ensure null-terminated
-      auto name = winrt::to_string(devInfo.Name());
-      name.push_back('\0');  // API must ensure null-terminated
-      (*enumCallback)(id.c_str(), name.c_str(), enumCallbackUserData);
+      CachedVideoCaptureDevice device;
+      device.id = winrt::to_string(devInfo.Id());
+      device.name = winrt::to_string(devInfo.Name());
+      (*enumCallback)(device.id.c_str(), device.name.c_str(),
+                      enumCallbackUserData);
+      devices.push_back(std::move(device));
     }
+    VideoCaptureDeviceCache::Instance().StoreDevices(generation,
+                                                     std::move(devices));
     if (completedCallback) {
       (*completedCallback)(completedCallbackUserData);
     }
   });
 #else
-  std::unique_ptr<webrtc::VideoCaptureModule::DeviceInfo> info(
-      webrtc::VideoCaptureFactory::CreateDeviceInfo());
-  if (!info) {
-    if (completedCallback) {
-      (*completedCallback)(completedCallbackUserData);
-    }
-  }
-  int num_devices = info->NumberOfDevices();
-  for (int i = 0; i < num_devices; ++i) {
-    constexpr uint32_t kSize = 256;
-    char name[kSize] = {0};
-    char id[kSize] = {0};
-    if (info->GetDeviceName(i, name, kSize, id, kSize) != -1) {
-      (*enumCallback)(id, name, enumCallbackUserData);
+  if (cache.GetDevices(devices)) {
+    for (const CachedVideoCaptureDevice& device : devices) {
+      (*enumCallback)(device.id.c_str(), device.name.c_str(),
+                      enumCallbackUserData);
     }
   }
   if (completedCallback) {
@@ -398,6 +390,21 @@ mrsResult MRS_CALL mrsEnumVideoCaptureFormatsAsync(
     return MRS_E_INVALID_PARAMETER;
   }
 
+  // Replay the cached formats if no device changed since they were probed,
+  // without opening the device again.
+  VideoCaptureDeviceCache& cache = VideoCaptureDeviceCache::Instance();
+  std::vector<VideoCaptureFormatInfo> formats;
+  if (cache.TryGetFormats(device_id_str, formats)) {
+    for (const VideoCaptureFormatInfo& format : formats) {
+      (*enumCallback)(format.width, format.height, format.framerate,
+                      format.encoding, enumCallbackUserData);
+    }
+    if (completedCallback) {
+      (*completedCallback)(MRS_SUCCESS, completedCallbackUserData);
+    }
+    return MRS_SUCCESS;
+  }
+
 #if defined(WINUWP)
   // The UWP factory needs to be initialized for getDevices() to work.
   WebRtcFactoryPtr uwp_factory;
@@ -426,11 +433,13 @@ mrsResult MRS_CALL mrsEnumVideoCaptureFormatsAsync(
   //}
 
   // Enumerate the video capture devices
+  const uint64_t generation = cache.generation();
   auto asyncResults =
       winrt::Windows::Devices::Enumeration::DeviceInformation::FindAllAsync(
           winrt::Windows::Devices::Enumeration::DeviceClass::VideoCapture);
-  asyncResults.Completed([device_id_str, enumCallback, completedCallback,
-                          enumCallbackUserData, completedCallbackUserData,
+  asyncResults.Completed([device_id_str, generation, enumCallback,
+                          completedCallback, enumCallbackUserData,
+                          completedCallbackUserData,
                           uwp_factory = std::move(uwp_factory)](
                              auto&& asyncResults,
                              winrt::Windows::Foundation::AsyncStatus status) {
@@ -478,6 +487,7 @@ mrsResult MRS_CALL mrsEnumVideoCaptureFormatsAsync(
     }
 
     // Get its supported capture formats
+    std::vector<VideoCaptureFormatInfo> formats;
     auto captureFormatList = vcd->getSupportedFormats();
     for (auto&& captureFormat : *captureFormatList) {
       uint32_t width = captureFormat->get_width();
@@ -490,8 +500,17 @@ mrsResult MRS_CALL mrsEnumVideoCaptureFormatsAsync(
       // those formats, as we don't know their encoding.
       if (fourcc != libyuv::FOURCC_ANY) {
         (*enumCallback)(width, height, framerate, fourcc, enumCallbackUserData);
+        VideoCaptureFormatInfo format{};
+        format.width = width;
+        format.height = height;
+        format.framerate = framerate;
+        format.encoding = fourcc;
+        format.cost = GetCaptureFormatCost(width, height, framerate, fourcc);
+        formats.push_back(format);
       }
     }
+    VideoCaptureDeviceCache::Instance().StoreFormats(generation, device_id_str,
+                                                     std::move(formats));
 
     // Invoke the completed callback at the end of enumeration
     if (completedCallback) {
@@ -499,41 +518,16 @@ mrsResult MRS_CALL mrsEnumVideoCaptureFormatsAsync(
     }
   });
 #else   // defined(WINUWP)
-  std::unique_ptr<webrtc::VideoCaptureModule::DeviceInfo> info(
-      webrtc::VideoCaptureFactory::CreateDeviceInfo());
-  if (!info) {
+  // Probe all devices and their formats, which fills the cache
+  std::vector<CachedVideoCaptureDevice> devices;
+  if (!cache.GetDevices(devices)) {
     return MRS_E_UNKNOWN;
   }
-  int num_devices = info->NumberOfDevices();
-  for (int device_idx = 0; device_idx < num_devices; ++device_idx) {
-    // Filter devices by name
-    constexpr uint32_t kSize = 256;
-    char name[kSize] = {0};
-    char id[kSize] = {0};
-    if (info->GetDeviceName(device_idx, name, kSize, id, kSize) == -1) {
-      continue;
-    }
-    if (id != device_id_str) {
-      continue;
-    }
-
-    // Enum video capture formats
-    int32_t num_capabilities = info->NumberOfCapabilities(id);
-    for (int32_t cap_idx = 0; cap_idx < num_capabilities; ++cap_idx) {
-      webrtc::VideoCaptureCapability capability{};
-      if (info->GetCapability(id, cap_idx, capability) != -1) {
-        uint32_t width = capability.width;
-        uint32_t height = capability.height;
-        double framerate = capability.maxFPS;
-        uint32_t fourcc = FourCCFromVideoType(capability.videoType);
-        if (fourcc != libyuv::FOURCC_ANY) {
-          (*enumCallback)(width, height, framerate, fourcc,
-                          enumCallbackUserData);
-        }
-      }
+  if (cache.TryGetFormats(device_id_str, formats)) {
+    for (const VideoCaptureFormatInfo& format : formats) {
+      (*enumCallback)(format.width, format.height, format.framerate,
+                      format.encoding, enumCallbackUserData);
     }
-
-    break;
   }
 
   // Invoke the completed callback at the end of enumeration
@@ -546,6 +540,40 @@ mrsResult MRS_CALL mrsEnumVideoCaptureFormatsAsync(
   // Note that the enumeration is asynchronous, so not done yet.
   return MRS_SUCCESS;
 }
+
+void MRS_CALL mrsInvalidateVideoCaptureCache() noexcept {
+  VideoCaptureDeviceCache::Instance().Invalidate();
+}
+
+uint64_t MRS_CALL mrsVideoCaptureFormatGetCost(uint32_t width,
+                                               uint32_t height,
+                                               double framerate,
+                                               uint32_t encoding) noexcept {
+  return GetCaptureFormatCost(width, height, framerate, encoding);
+}
+
+mrsResult MRS_CALL
+mrsVideoCaptureFormatSelect(const VideoCaptureFormatInfo* formats,
+                            uint32_t count,
+                            uint32_t width,
+                            uint32_t height,
+                            double framerate,
+                            VideoCaptureFormatInfo* selected) noexcept {
+  if ((!formats && (count > 0)) || !selected) {
+    return MRS_E_INVALID_PARAMETER;
+  }
+  const int index =
+      SelectCaptureFormat(formats, count, width, height, framerate);
+  if (index < 0) {
+    return MRS_E_NOTFOUND;
+  }
+  *selected = formats[index];
+  selected->cost =
+      GetCaptureFormatCost(selected->width, selected->height,
+                           selected->framerate, selected->encoding);
+  return MRS_SUCCESS;
+}
+
 mrsResult MRS_CALL
 mrsPeerConnectionCreate(PeerConnectionConfiguration config,
                         mrsPeerConnectionInteropHandle interop_handle,
@@ -716,6 +744,104 @@ void MRS_CALL mrsPeerConnectionRegisterARGBRemoteVideoFrameCallback(
   }
 }
 
+void MRS_CALL mrsPeerConnectionRegisterRemoteVideoFrameHandleCallback(
+    PeerConnectionHandle peerHandle,
+    PeerConnectionVideoFrameHandleCallback callback,
+    void* user_data) noexcept {
+  if (auto peer = static_cast<PeerConnection*>(peerHandle)) {
+    peer->RegisterRemoteVideoFrameCallback(
+        VideoFrameHandleCallback{callback, user_data});
+  }
+}
+
+mrsResult MRS_CALL mrsPeerConnectionAddRemoteVideoSink(
+    PeerConnectionHandle peerHandle,
+    VideoSinkConfiguration config,
+    PeerConnectionVideoFrameHandleCallback callback,
+    void* user_data,
+    VideoSinkId* sink_id) noexcept {
+  if (!callback || !sink_id) {
+    return MRS_E_INVALID_PARAMETER;
+  }
+  *sink_id = 0;
+  auto peer = static_cast<PeerConnection*>(peerHandle);
+  if (!peer) {
+    return MRS_E_INVALID_PEER_HANDLE;
+  }
+  return peer->AddRemoteVideoSink(
+      config, VideoFrameHandleCallback{callback, user_data}, *sink_id);
+}
+
+mrsResult MRS_CALL
+mrsPeerConnectionRemoveRemoteVideoSink(PeerConnectionHandle peerHandle,
+                                       VideoSinkId sink_id) noexcept {
+  auto peer = static_cast<PeerConnection*>(peerHandle);
+  if (!peer) {
+    return MRS_E_INVALID_PEER_HANDLE;
+  }
+  return peer->RemoveRemoteVideoSink(sink_id);
+}
+
+mrsResult MRS_CALL mrsPeerConnectionCaptureRemoteVideoSnapshot(
+    PeerConnectionHandle peerHandle,
+    VideoSnapshotConfiguration config,
+    VideoSnapshotCallback callback,
+    void* user_data) noexcept {
+  if (!callback) {
+    return MRS_E_INVALID_PARAMETER;
+  }
+  auto peer = static_cast<PeerConnection*>(peerHandle);
+  if (!peer) {
+    return MRS_E_INVALID_PEER_HANDLE;
+  }
+  return peer->CaptureRemoteVideoSnapshot(
+      config, VideoSnapshotReadyCallback{callback, user_data});
+}
+
+mrsResult MRS_CALL mrsPeerConnectionSetRemoteVideoParallelConversion(
+    PeerConnectionHandle peerHandle,
+    mrsBool enabled) noexcept {
+  auto peer = static_cast<PeerConnection*>(peerHandle);
+  if (!peer) {
+    return MRS_E_INVALID_PEER_HANDLE;
+  }
+  return peer->SetRemoteVideoParallelConversion(enabled != mrsBool::kFalse);
+}
+
+mrsResult MRS_CALL
+mrsPeerConnectionSetRemoteVideoApplyRotation(PeerConnectionHandle peerHandle,
+                                             mrsBool enabled) noexcept {
+  auto peer = static_cast<PeerConnection*>(peerHandle);
+  if (!peer) {
+    return MRS_E_INVALID_PEER_HANDLE;
+  }
+  return peer->SetRemoteVideoApplyRotation(enabled != mrsBool::kFalse);
+}
+
+mrsResult MRS_CALL
+mrsPeerConnectionSetRemoteVideoAsyncDelivery(PeerConnectionHandle peerHandle,
+                                             int32_t mailbox_size) noexcept {
+  auto peer = static_cast<PeerConnection*>(peerHandle);
+  if (!peer) {
+    return MRS_E_INVALID_PEER_HANDLE;
+  }
+  return peer->SetRemoteVideoAsyncDelivery(mailbox_size);
+}
+
+mrsResult MRS_CALL
+mrsPeerConnectionGetRemoteVideoDeliveryStats(
+    PeerConnectionHandle peerHandle,
+    VideoDeliveryStats* stats) noexcept {
+  if (!stats) {
+    return MRS_E_INVALID_PARAMETER;
+  }
+  auto peer = static_cast<PeerConnection*>(peerHandle);
+  if (!peer) {
+    return MRS_E_INVALID_PEER_HANDLE;
+  }
+  return peer->GetRemoteVideoDeliveryStats(*stats);
+}
+
 MRS_API void MRS_CALL mrsPeerConnectionRegisterLocalAudioFrameCallback(
     PeerConnectionHandle peerHandle,
     PeerConnectionAudioFrameCallback callback,
@@ -736,6 +862,30 @@ MRS_API void MRS_CALL mrsPeerConnectionRegisterRemoteAudioFrameCallback(
   }
 }
 
+void MRS_CALL mrsPeerConnectionRegisterLocalAudioFrameInfoCallback(
+    PeerConnectionHandle peerHandle,
+    PeerConnectionAudioFrameInfoCallback callback,
+    void* user_data) noexcept {
+  if (auto peer = static_cast<PeerConnection*>(peerHandle)) {
+    peer->RegisterLocalAudioFrameCallback(
+        AudioFrameInfoCallback{callback, user_data});
+  }
+}
+
+void MRS_CALL mrsPeerConnectionRegisterRemoteAudioFrameInfoCallback(
+    PeerConnectionHandle peerHandle,
+    PeerConnectionAudioFrameInfoCallback callback,
+    void* user_data) noexcept {
+  if (auto peer = static_cast<PeerConnection*>(peerHandle)) {
+    peer->RegisterRemoteAudioFrameCallback(
+        AudioFrameInfoCallback{callback, user_data});
+  }
+}
+
+int64_t MRS_CALL mrsGetClockTimeUs() noexcept {
+  return rtc::TimeMicros();
+}
+
 mrsResult MRS_CALL mrsPeerConnectionAddLocalVideoTrack(
     PeerConnectionHandle peerHandle,
     const char* track_name,
@@ -766,6 +916,15 @@ mrsResult MRS_CALL mrsPeerConnectionAddLocalVideoTrack(
   }
   RTC_CHECK(video_capturer.get());
 
+  // Select the capture format cheapest to convert, if the device lists them
+  std::optional<VideoCaptureFormatInfo> capture_format;
+  if (config.format_policy == VideoCaptureFormatPolicy::kLowestCost) {
+    VideoCaptureFormatInfo selected{};
+    if (SelectLowestCostCaptureFormat(video_capturer, config, selected)) {
+      capture_format = selected;
+    }
+  }
+
   // Apply the same constraints used for opening the video capturer
   auto videoConstraints = std::make_unique<SimpleMediaConstraints>();
   if (config.width > 0) {
@@ -793,19 +952,104 @@ mrsResult MRS_CALL mrsPeerConnectionAddLocalVideoTrack(
   if (!video_source) {
     return MRS_E_UNKNOWN;
   }
-  rtc::scoped_refptr<webrtc::VideoTrackInterface> video_track =
-      pc_factory->CreateVideoTrack(track_name, video_source);
-  if (!video_track) {
-    return MRS_E_UNKNOWN;
+  return AddLocalVideoTrackFromSource(*peer, *pc_factory, track_name,
+                                      video_source, trackHandle,
+                                      capture_format);
+}
+
+mrsResult MRS_CALL mrsPeerConnectionAddLocalVideoTrackFromExternalSource(
+    PeerConnectionHandle peerHandle,
+    const char* track_name,
+    ExternalVideoTrackSourceHandle source_handle,
+    LocalVideoTrackHandle* trackHandle) noexcept {
+  if (IsStringNullOrEmpty(track_name)) {
+    return MRS_E_INVALID_PARAMETER;
   }
-  auto result = peer->AddLocalVideoTrack(std::move(video_track));
-  if (result.ok()) {
-    rtc::scoped_refptr<LocalVideoTrack>& video_track_wrapper = result.value();
-    video_track_wrapper->AddRef();  // for the handle
-    *trackHandle = video_track_wrapper.get();
-    return MRS_SUCCESS;
+  if (!trackHandle) {
+    return MRS_E_INVALID_PARAMETER;
   }
-  return MRS_E_UNKNOWN;
+  *trackHandle = nullptr;
+
+  auto peer = static_cast<PeerConnection*>(peerHandle);
+  if (!peer) {
+    return MRS_E_INVALID_PEER_HANDLE;
+  }
+  auto source = static_cast<ExternalVideoTrackSource*>(source_handle);
+  if (!source) {
+    return MRS_E_INVALID_PARAMETER;
+  }
+  auto pc_factory = GlobalFactory::Instance()->GetExisting();
+  if (!pc_factory) {
+    return MRS_E_INVALID_OPERATION;
+  }
+  return AddLocalVideoTrackFromSource(*peer, *pc_factory, track_name, source,
+                                      trackHandle);
+}
+
+mrsResult MRS_CALL mrsPeerConnectionAddLocalVideoTrackFromY4mFile(
+    PeerConnectionHandle peerHandle,
+    const char* track_name,
+    Y4mFileConfiguration config,
+    LocalVideoTrackHandle* trackHandle) noexcept {
+  if (IsStringNullOrEmpty(track_name) || IsStringNullOrEmpty(config.path) ||
+      (config.framerate < 0.0)) {
+    return MRS_E_INVALID_PARAMETER;
+  }
+  if (!trackHandle) {
+    return MRS_E_INVALID_PARAMETER;
+  }
+  *trackHandle = nullptr;
+
+  auto peer = static_cast<PeerConnection*>(peerHandle);
+  if (!peer) {
+    return MRS_E_INVALID_PEER_HANDLE;
+  }
+  auto pc_factory = GlobalFactory::Instance()->GetExisting();
+  if (!pc_factory) {
+    return MRS_E_INVALID_OPERATION;
+  }
+  std::unique_ptr<Y4mFrameGenerator> generator;
+  const mrsResult res = Y4mFrameGenerator::Open(
+      config.path, (config.loop != mrsBool::kFalse), generator);
+  if (res != MRS_SUCCESS) {
+    return res;
+  }
+  rtc::scoped_refptr<GeneratedVideoTrackSource> source =
+      GeneratedVideoTrackSource::Create(std::move(generator), config.framerate);
+  return AddLocalVideoTrackFromSource(*peer, *pc_factory, track_name, source,
+                                      trackHandle);
+}
+
+mrsResult MRS_CALL mrsPeerConnectionAddLocalVideoTrackFromTestPattern(
+    PeerConnectionHandle peerHandle,
+    const char* track_name,
+    TestPatternConfiguration config,
+    LocalVideoTrackHandle* trackHandle) noexcept {
+  if (IsStringNullOrEmpty(track_name) || (config.width == 0) ||
+      (config.height == 0) || (config.width > 16384) ||
+      (config.height > 16384) || !(config.framerate > 0.0)) {
+    return MRS_E_INVALID_PARAMETER;
+  }
+  if (!trackHandle) {
+    return MRS_E_INVALID_PARAMETER;
+  }
+  *trackHandle = nullptr;
+
+  auto peer = static_cast<PeerConnection*>(peerHandle);
+  if (!peer) {
+    return MRS_E_INVALID_PEER_HANDLE;
+  }
+  auto pc_factory = GlobalFactory::Instance()->GetExisting();
+  if (!pc_factory) {
+    return MRS_E_INVALID_OPERATION;
+  }
+  auto generator = std::make_unique<TestPatternFrameGenerator>(
+      static_cast<int>(config.width), static_cast<int>(config.height),
+      config.framerate);
+  rtc::scoped_refptr<GeneratedVideoTrackSource> source =
+      GeneratedVideoTrackSource::Create(std::move(generator), config.framerate);
+  return AddLocalVideoTrackFromSource(*peer, *pc_factory, track_name, source,
+                                      trackHandle);
 }
 
 mrsResult MRS_CALL
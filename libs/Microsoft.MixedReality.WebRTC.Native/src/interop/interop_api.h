@@ -94,6 +94,11 @@ using mrsVideoCaptureDeviceEnumCompletedCallback =
 /// For each device found, invoke the mandatory |callback|.
 /// At the end of the enumeration, invoke the optional |completedCallback| if it
 /// was provided (non-null).
+/// While the library is initialized, that is while a peer connection or
+/// another library object is alive, the devices are probed once and cached
+/// until a device is added or removed, so that subsequent enumerations invoke
+/// the callbacks synchronously without probing the hardware. See
+/// |mrsInvalidateVideoCaptureCache|.
 MRS_API void MRS_CALL mrsEnumVideoCaptureDevicesAsync(
     mrsVideoCaptureDeviceEnumCallback enumCallback,
     void* enumCallbackUserData,
@@ -115,6 +120,8 @@ using mrsVideoCaptureFormatEnumCompletedCallback =
 /// For each device found, invoke the mandatory |callback|.
 /// At the end of the enumeration, invoke the optional |completedCallback| if it
 /// was provided (non-null).
+/// Like the devices, the formats of each device are probed once and cached
+/// until a device is added or removed.
 MRS_API mrsResult MRS_CALL mrsEnumVideoCaptureFormatsAsync(
     const char* device_id,
     mrsVideoCaptureFormatEnumCallback enumCallback,
@@ -122,6 +129,54 @@ MRS_API mrsResult MRS_CALL mrsEnumVideoCaptureFormatsAsync(
     mrsVideoCaptureFormatEnumCompletedCallback completedCallback,
     void* completedCallbackUserData) noexcept;
 
+/// Discard the cached video capture devices and formats, so that the next
+/// enumeration probes the hardware again. The cache is invalidated
+/// automatically when a device is added or removed; this is only needed for
+/// changes the platform does not notify, like a driver update changing the
+/// formats of a device.
+MRS_API void MRS_CALL mrsInvalidateVideoCaptureCache() noexcept;
+
+/// Video capture format, as enumerated by |mrsEnumVideoCaptureFormatsAsync|,
+/// with its estimated conversion cost.
+struct VideoCaptureFormatInfo {
+  uint32_t width = 0;
+  uint32_t height = 0;
+  double framerate = 0.0;
+
+  /// FOURCC of the encoding of the captured frames.
+  uint32_t encoding = 0;
+
+  /// Estimated CPU cost of converting the captured frames to I420 before
+  /// encoding, in weighted pixels per second. The weight of each pixel grows
+  /// with the work needed to convert the encoding: I420 is only copied, NV12
+  /// is deinterleaved, YUY2 is subsampled, RGB formats need a color conversion,
+  /// and MJPG a JPEG decode. Only meaningful relative to other formats.
+  uint64_t cost = 0;
+};
+
+/// Get the estimated cost of converting frames captured in the given format to
+/// I420. See |VideoCaptureFormatInfo::cost|.
+MRS_API uint64_t MRS_CALL
+mrsVideoCaptureFormatGetCost(uint32_t width,
+                             uint32_t height,
+                             double framerate,
+                             uint32_t encoding) noexcept;
+
+/// Select among the |count| capture formats of |formats| the one that
+/// |mrsPeerConnectionAddLocalVideoTrack| opens for the given resolution and
+/// framerate, any of which can be zero for unconstrained, and return it in
+/// |selected| with its cost. The formats matching the constraints are ranked
+/// by their resolution and framerate closest to the requested ones, or to
+/// 640x480 at 30 FPS if unconstrained, then by lowest cost. Fails with
+/// |MRS_E_NOTFOUND| if no format matches the constraints.
+MRS_API mrsResult MRS_CALL
+mrsVideoCaptureFormatSelect(const VideoCaptureFormatInfo* formats,
+                            uint32_t count,
+                            uint32_t width,
+                            uint32_t height,
+                            double framerate,
+                            VideoCaptureFormatInfo* selected) noexcept;
+
 //
 // Peer connection
 //
@@ -135,6 +190,33 @@ using LocalVideoTrackHandle = void*;
 /// Opaque handle to a native DataChannel C++ object.
 using DataChannelHandle = void*;
 
+/// Opaque handle to a native reference-counted video frame.
+/// See |mrsVideoFrameAddRef()| and |mrsVideoFrameRemoveRef()|.
+using VideoFrameHandle = void*;
+
+/// Opaque handle to a native ExternalVideoTrackSource C++ object.
+using ExternalVideoTrackSourceHandle = void*;
+
+/// Opaque handle to a native reference-counted video frame queue.
+/// See |mrsVideoFrameQueueCreate()|.
+using VideoFrameQueueHandle = void*;
+
+/// Opaque handle to a native reference-counted video mosaic.
+/// See |mrsVideoMosaicCreate()|.
+using VideoMosaicHandle = void*;
+
+/// Opaque handle to a native reference-counted shared memory frame ring.
+/// See |mrsSharedFrameRingCreate()|.
+using SharedFrameRingHandle = void*;
+
+/// Opaque handle to a reader of a shared memory frame ring.
+/// See |mrsSharedFrameReaderOpen()|.
+using SharedFrameReaderHandle = void*;
+
+/// Opaque handle to a converter of video frames into tensors for machine
+/// learning models. See |mrsVideoTensorConverterCreate()|.
+using VideoTensorConverterHandle = void*;
+
 /// Callback fired when the peer connection is connected, that is it finished
 /// the JSEP offer/answer exchange successfully.
 using PeerConnectionConnectedCallback = void(MRS_CALL*)(void* user_data);
@@ -230,6 +312,453 @@ using PeerConnectionARGBVideoFrameCallback =
                     const int frame_width,
                     const int frame_height);
 
+/// Pixel format of a video frame exchanged through the interop API.
+enum class VideoFrameFormat : int32_t {
+  /// Planar YUV 4:2:0 with an optional alpha plane. Planes are Y, U, V, A in
+  /// that order; the alpha plane is null if the frame has no alpha channel.
+  kI420A = 0,
+
+  /// Packed 32-bit ARGB, single plane. This is the libyuv ARGB format, that is
+  /// one little-endian 0xAARRGGBB word per pixel (B, G, R, A bytes in memory).
+  kArgb32 = 1,
+
+  /// Semi-planar YUV 4:2:0, with a Y plane followed by a plane of interleaved
+  /// U and V samples. The alpha channel, if any, is dropped.
+  kNv12 = 2,
+
+  /// Packed 32-bit RGBA, single plane, with R, G, B, A bytes in memory. This
+  /// matches the R8G8B8A8 texture formats, and is the libyuv ABGR format.
+  kRgba32 = 3,
+
+  /// Packed 32-bit BGRA, single plane, with B, G, R, A bytes in memory. This
+  /// matches the B8G8R8A8 texture formats, and has the same layout as
+  /// |kArgb32|.
+  kBgra32 = 4,
+
+  /// Packed 24-bit RGB, single plane, with R, G, B bytes in memory. This is the
+  /// libyuv RAW format. The alpha channel, if any, is dropped.
+  kRgb24 = 5,
+};
+
+/// Color matrix used to convert YUV frames to RGB.
+enum class VideoColorMatrix : int32_t {
+  /// ITU-R BT.601, generally used by standard definition content and webcams.
+  kBt601 = 0,
+
+  /// ITU-R BT.709, generally used by high definition content.
+  kBt709 = 1,
+};
+
+/// Range of the YUV samples of a frame converted to RGB.
+enum class VideoColorRange : int32_t {
+  /// Limited (studio) range, with luma in [16:235] and chroma in [16:240].
+  kLimited = 0,
+
+  /// Full range, with all components in [0:255]. Only supported with
+  /// |VideoColorMatrix::kBt601| (JPEG).
+  kFull = 1,
+};
+
+/// Clockwise rotation to apply to a video frame for display. Equivalent to
+/// webrtc::VideoRotation.
+enum class VideoRotation : int32_t {
+  kRotation0 = 0,
+  kRotation90 = 90,
+  kRotation180 = 180,
+  kRotation270 = 270,
+};
+
+/// Timing information of a video frame. All times in microseconds are on the
+/// monotonic clock of |mrsGetClockTimeUs()|, which allows comparing them with
+/// the current time to schedule the frame presentation.
+struct VideoFrameTiming {
+  /// Time at which the frame should be rendered. For local frames this is the
+  /// capture time; for remote frames, this is the render time estimated by the
+  /// receiver from the capture time and the network jitter.
+  int64_t timestamp_us{};
+
+  /// Capture time of the frame on the clock of the sender, in milliseconds
+  /// since the NTP epoch (1900-01-01), or zero if unknown. For remote frames
+  /// this is estimated from the RTCP sender reports, and is the common clock
+  /// to synchronize the streams of a same sender.
+  int64_t ntp_time_ms{};
+
+  /// RTP timestamp of the frame, on the 90 kHz RTP video clock, or zero for
+  /// frames which were not sent over RTP.
+  uint32_t rtp_timestamp{};
+
+  /// Time at which the frame was received by the library from the capture
+  /// device or the decoder.
+  int64_t arrival_time_us{};
+};
+
+/// Description of a video frame and of its pixel data.
+struct VideoFrameInfo {
+  /// Handle to the reference-counted frame owning the pixel data. The handle is
+  /// only guaranteed valid for the duration of the callback delivering it,
+  /// unless a reference is acquired with |mrsVideoFrameAddRef()|.
+  VideoFrameHandle handle{};
+
+  /// Pixel format of the frame, which determines the layout of the planes.
+  VideoFrameFormat format{VideoFrameFormat::kI420A};
+
+  /// Frame width, in pixels.
+  int32_t width{};
+
+  /// Frame height, in pixels.
+  int32_t height{};
+
+  /// Pointers to the first byte of each plane, or null for unused planes.
+  const void* data[4]{};
+
+  /// Byte stride of each plane, or zero for unused planes.
+  int32_t stride[4]{};
+
+  /// Timing information of the frame. Frames converted or scaled from the same
+  /// source frame share the same timing.
+  VideoFrameTiming timing{};
+
+  /// Clockwise rotation to apply to the frame for display. This is always
+  /// |VideoRotation::kRotation0| unless the rotation is left to the consumer,
+  /// see |mrsPeerConnectionSetRemoteVideoApplyRotation()|.
+  VideoRotation rotation{VideoRotation::kRotation0};
+};
+
+/// Callback fired when a local or remote (depending on use) video frame is
+/// available to be consumed by the caller, as a reference-counted frame. The
+/// frame pixel data stays valid after the callback returned as long as the
+/// caller holds a reference to the frame handle, which allows consuming the
+/// frame asynchronously without copying it.
+using PeerConnectionVideoFrameHandleCallback =
+    void(MRS_CALL*)(void* user_data, const VideoFrameInfo* frame);
+
+/// Configuration of a video sink receiving the frames of a video track.
+struct VideoSinkConfiguration {
+  /// Pixel format the frames are delivered in. Each format is converted at most
+  /// once per frame, and shared by all the sinks requesting that format with
+  /// the same color matrix and range.
+  VideoFrameFormat format = VideoFrameFormat::kI420A;
+
+  /// Color matrix of the YUV to RGB conversion, for RGB formats only.
+  VideoColorMatrix color_matrix = VideoColorMatrix::kBt601;
+
+  /// Range of the YUV samples of the YUV to RGB conversion, for RGB formats
+  /// only.
+  VideoColorRange color_range = VideoColorRange::kLimited;
+
+  /// Maximum width of the delivered frames, or zero for no limit. Larger frames
+  /// are downscaled natively before conversion, preserving their aspect ratio.
+  int32_t max_width = 0;
+
+  /// Maximum height of the delivered frames, or zero for no limit. Larger
+  /// frames are downscaled natively before conversion, preserving their aspect
+  /// ratio.
+  int32_t max_height = 0;
+
+  /// Maximum rate at which frames are delivered, in frames per second, or zero
+  /// for no limit. Excess frames are dropped before any conversion, pacing the
+  /// delivered frames on their timestamp rather than on their arrival time.
+  double max_framerate = 0;
+
+  /// For RGB formats with an alpha channel, deliver the color channels of
+  /// frames with an alpha plane premultiplied by alpha, as expected by most
+  /// compositors. For BT.601 limited range, this is done in the same SIMD pass
+  /// as the conversion. Ignored for other formats and for opaque frames.
+  mrsBool premultiply_alpha = mrsBool::kFalse;
+};
+
+/// Configuration of a snapshot of the next frame of a video track.
+struct VideoSnapshotConfiguration {
+  /// Maximum width of the snapshot, or zero for no limit. Larger frames are
+  /// downscaled natively before encoding, preserving their aspect ratio.
+  int32_t max_width = 0;
+
+  /// Maximum height of the snapshot, or zero for no limit. Larger frames are
+  /// downscaled natively before encoding, preserving their aspect ratio.
+  int32_t max_height = 0;
+
+  /// JPEG quality, from 1 (smallest) to 100 (best).
+  int32_t quality = 85;
+};
+
+/// Callback completing a snapshot of a video track. On success, |data| points
+/// to the |size| bytes of the JPEG image, which are only valid for the duration
+/// of the callback. Otherwise |result| holds the error, and |data| is null.
+/// The callback is invoked on a process-wide worker thread, and may release
+/// the last references to the library objects, including the track.
+using VideoSnapshotCallback = void(MRS_CALL*)(void* user_data,
+                                              mrsResult result,
+                                              const void* data,
+                                              uint64_t size);
+
+/// Statistics of the asynchronous delivery of video frames.
+struct VideoDeliveryStats {
+  /// Number of frames delivered to the callbacks and sinks.
+  uint64_t delivered_frames = 0;
+
+  /// Number of frames dropped because the consumers were too slow.
+  uint64_t dropped_frames = 0;
+};
+
+/// Configuration of the detection of static frames of a local video track.
+struct StaticFrameDetectionConfiguration {
+  /// Enable the detection. When enabled, each frame is compared with the
+  /// previous one before encoding, and frames identical to the previous one are
+  /// dropped, saving the encoding and sending of unchanged content.
+  mrsBool enabled = mrsBool::kFalse;
+
+  /// Interval, in milliseconds of frame timestamps, at which a static frame is
+  /// still sent while the content does not change, or zero to drop all the
+  /// static frames. This refreshes the receivers and lets the encoder refine
+  /// the quality of the static content.
+  int32_t keepalive_interval_ms = 1000;
+};
+
+/// Statistics of the detection of static frames of a local video track.
+struct StaticFrameStats {
+  /// Number of frames compared with their previous frame.
+  uint64_t processed_frames = 0;
+
+  /// Number of frames identical to their previous frame.
+  uint64_t static_frames = 0;
+
+  /// Number of static frames dropped, that is not sent as keep-alive frames.
+  uint64_t dropped_frames = 0;
+};
+
+/// Statistics of a video frame queue.
+struct VideoFrameQueueStats {
+  /// Number of frames enqueued, including the ones dropped on overflow.
+  uint64_t enqueued_frames = 0;
+
+  /// Number of new frames returned for presentation.
+  uint64_t dequeued_frames = 0;
+
+  /// Number of frames dropped because a more recent frame was due at the time
+  /// of the presentation.
+  uint64_t late_frames = 0;
+
+  /// Number of frames dropped because the queue was full when enqueuing them.
+  uint64_t overflow_frames = 0;
+
+  /// Number of times a frame was presented again because no new frame was due.
+  uint64_t repeated_frames = 0;
+
+  /// Number of frames currently waiting in the queue.
+  uint32_t pending_frames = 0;
+};
+
+/// Kind of a native processor of the frames of a local video track.
+enum class VideoFrameProcessorKind : int32_t {
+  /// Crop the frames to the area |x|, |y|, |width|, |height|.
+  kCrop = 0,
+
+  /// Scale the frames to the resolution |width| x |height|.
+  kScale = 1,
+
+  /// Blur the area |x|, |y|, |width|, |height| of the frames with a box filter
+  /// of radius |blur_radius|, for example to hide private content.
+  kBlur = 2,
+
+  /// Alpha-blend the ARGB image |overlay_data| of |width| x |height| pixels
+  /// over the frames, with its top-left corner at |x|, |y|.
+  kOverlay = 3,
+
+  /// Invoke |callback| with each frame, to process its planes in place.
+  kCallback = 4,
+};
+
+/// Callback processing in place a video frame of a local video track before it
+/// is encoded. The frame is in |VideoFrameFormat::kI420A| format, without
+/// alpha plane, and its planes are writable for the duration of the call.
+/// Return |mrsBool::kFalse| to drop the frame.
+using VideoFrameProcessorCallback =
+    mrsBool(MRS_CALL*)(void* user_data, const VideoFrameInfo* frame);
+
+/// Configuration of a native processor of the frames of a local video track.
+/// Coordinates are in pixels of the frame entering the processor, and are
+/// rounded down to even values to match the chroma samples.
+struct VideoFrameProcessorConfiguration {
+  VideoFrameProcessorKind kind = VideoFrameProcessorKind::kCrop;
+
+  /// Left edge of the processed area, or of the overlay.
+  int32_t x = 0;
+
+  /// Top edge of the processed area, or of the overlay.
+  int32_t y = 0;
+
+  /// Width of the processed area, of the scaled frames, or of the overlay.
+  int32_t width = 0;
+
+  /// Height of the processed area, of the scaled frames, or of the overlay.
+  int32_t height = 0;
+
+  /// Radius of the box filter of |VideoFrameProcessorKind::kBlur|, in pixels.
+  int32_t blur_radius = 8;
+
+  /// Overlay image of |VideoFrameProcessorKind::kOverlay|, in 32-bit ARGB with
+  /// straight alpha. The image is copied when adding the processor.
+  const void* overlay_data = nullptr;
+
+  /// Byte stride of the rows of |overlay_data|.
+  int32_t overlay_stride = 0;
+
+  /// Callback of |VideoFrameProcessorKind::kCallback|.
+  VideoFrameProcessorCallback callback = nullptr;
+
+  /// User data passed to |callback|.
+  void* user_data = nullptr;
+};
+
+/// Statistics of a processor of the frames of a local video track.
+struct VideoFrameProcessorStats {
+  /// Number of frames processed.
+  uint64_t processed_frames = 0;
+
+  /// Number of frames dropped by the processor.
+  uint64_t dropped_frames = 0;
+
+  /// Total time spent processing frames, in microseconds.
+  int64_t total_time_us = 0;
+
+  /// Longest time spent processing a single frame, in microseconds.
+  int64_t max_time_us = 0;
+};
+
+/// Configuration of a video mosaic composing several video tracks into a
+/// single canvas.
+struct VideoMosaicConfiguration {
+  /// Pixel format of the canvas, either |VideoFrameFormat::kArgb32| or
+  /// |VideoFrameFormat::kI420A|.
+  VideoFrameFormat format = VideoFrameFormat::kArgb32;
+
+  /// Color matrix of the YUV to RGB conversion, for an ARGB canvas only.
+  VideoColorMatrix color_matrix = VideoColorMatrix::kBt601;
+
+  /// Range of the YUV samples of the YUV to RGB conversion for an ARGB canvas,
+  /// and of the background color of an I420A canvas.
+  VideoColorRange color_range = VideoColorRange::kLimited;
+
+  /// Number of columns of the grid of tiles.
+  int32_t columns = 2;
+
+  /// Number of rows of the grid of tiles.
+  int32_t rows = 2;
+
+  /// Draw the tiles in parallel on the process-wide worker pool. This requires
+  /// a peer connection to be alive when the mosaic is created; otherwise the
+  /// tiles are drawn on the composing thread.
+  mrsBool parallel = mrsBool::kFalse;
+};
+
+/// Statistics of a video mosaic.
+struct VideoMosaicStats {
+  /// Number of compositions which updated the canvas.
+  uint64_t composed_frames = 0;
+
+  /// Number of tiles drawn with a new frame.
+  uint64_t drawn_tiles = 0;
+
+  /// Number of frames replaced by a more recent frame of the same tile before
+  /// being composed.
+  uint64_t dropped_frames = 0;
+};
+
+/// Configuration of a ring of video frames in shared memory.
+struct SharedFrameRingConfiguration {
+  /// Number of frame slots of the ring. Readers can lag behind the writer by
+  /// up to this number of frames minus one before frames are overwritten.
+  int32_t num_slots = 4;
+
+  /// Maximum width of the frames, in pixels. Larger frames are dropped, so
+  /// this should match the maximum resolution of the sink writing the frames.
+  int32_t max_width = 1920;
+
+  /// Maximum height of the frames, in pixels. Larger frames are dropped, so
+  /// this should match the maximum resolution of the sink writing the frames.
+  int32_t max_height = 1080;
+};
+
+/// Statistics of a ring of video frames in shared memory.
+struct SharedFrameRingStats {
+  /// Number of frames written to the ring.
+  uint64_t written_frames = 0;
+
+  /// Number of frames dropped because they did not fit in a slot.
+  uint64_t dropped_frames = 0;
+};
+
+/// Configuration of the conversion of video frames into the planar float input
+/// tensors of machine learning models.
+///
+/// Each channel value is normalized as (value * |scale| - |mean|) / |std|,
+/// where value is the 8-bit RGB channel. The defaults map channels to [0:1];
+/// for example ImageNet models use a mean of {0.485, 0.456, 0.406} and a
+/// standard deviation of {0.229, 0.224, 0.225}.
+struct VideoTensorConfiguration {
+  /// Width of the tensor, in pixels.
+  int32_t width = 224;
+
+  /// Height of the tensor, in pixels.
+  int32_t height = 224;
+
+  /// Preserve the aspect ratio of the frames by fitting them into the tensor,
+  /// centered over a border of |letterbox_value|. Otherwise frames are
+  /// stretched to the tensor resolution.
+  mrsBool letterbox = mrsBool::kTrue;
+
+  /// 8-bit value of all channels of the letterbox border, before
+  /// normalization, for example 114 for YOLO models.
+  int32_t letterbox_value = 0;
+
+  /// Order the channel planes as B, G, R instead of R, G, B.
+  mrsBool bgr = mrsBool::kFalse;
+
+  /// Color matrix and range of the YUV to RGB conversion. BT.709 full range
+  /// is not supported.
+  VideoColorMatrix color_matrix = VideoColorMatrix::kBt601;
+  VideoColorRange color_range = VideoColorRange::kLimited;
+
+  /// Scale of the 8-bit channel values.
+  float scale = 1.0f / 255.0f;
+
+  /// Per-channel mean subtracted from the scaled values, in R, G, B order.
+  float mean[3] = {0.0f, 0.0f, 0.0f};
+
+  /// Per-channel standard deviation dividing the centered values, in R, G, B
+  /// order.
+  float std[3] = {1.0f, 1.0f, 1.0f};
+};
+
+/// Description of a tensor converted from a video frame.
+struct VideoTensorInfo {
+  /// Tensor data, as 3 contiguous planes of |height| rows of |width| floats,
+  /// that is in CHW layout.
+  const float* data = nullptr;
+
+  int32_t width = 0;
+  int32_t height = 0;
+
+  /// Area of the tensor covered by the frame, excluding the letterbox border,
+  /// to map the model output back to frame coordinates.
+  int32_t content_x = 0;
+  int32_t content_y = 0;
+  int32_t content_width = 0;
+  int32_t content_height = 0;
+
+  /// Timing information of the source frame.
+  VideoFrameTiming timing{};
+};
+
+/// Callback receiving the tensors converted from the frames of a video sink.
+/// The tensor data is only valid for the duration of the callback.
+using VideoTensorCallback = void(MRS_CALL*)(void* user_data,
+                                            const VideoTensorInfo* tensor);
+
+/// Identifier of a video sink registered with a video track. Zero is never a
+/// valid sink identifier.
+using VideoSinkId = uint32_t;
+
 /// Callback fired when a local or remote (depending on use) audio frame is
 /// available to be consumed by the caller, usually for local output.
 using PeerConnectionAudioFrameCallback =
@@ -240,6 +769,45 @@ using PeerConnectionAudioFrameCallback =
                     const uint32_t number_of_channels,
                     const uint32_t number_of_frames);
 
+/// Timing information of an audio frame.
+struct AudioFrameTiming {
+  /// Time at which the frame was received by the library, in microseconds on
+  /// the monotonic clock of |mrsGetClockTimeUs()|.
+  int64_t arrival_time_us{};
+
+  /// Position of the first sample of the frame in the audio stream, counted in
+  /// samples per channel since the callback was registered. This advances
+  /// continuously at the sampling rate, and is the media clock of the stream.
+  uint64_t sample_position{};
+};
+
+/// Description of an audio frame and of its sample data.
+struct AudioFrameInfo {
+  /// Pointer to the interleaved samples of the frame, valid only for the
+  /// duration of the callback.
+  const void* data{};
+
+  /// Number of bits per sample.
+  uint32_t bits_per_sample{};
+
+  /// Sampling rate, in Hz.
+  uint32_t sample_rate{};
+
+  /// Number of interleaved channels.
+  uint32_t number_of_channels{};
+
+  /// Number of samples per channel in the frame.
+  uint32_t number_of_frames{};
+
+  /// Timing information of the frame.
+  AudioFrameTiming timing{};
+};
+
+/// Callback fired when a local or remote (depending on use) audio frame is
+/// available to be consumed by the caller, with its timing information.
+using PeerConnectionAudioFrameInfoCallback =
+    void(MRS_CALL*)(void* user_data, const AudioFrameInfo* frame);
+
 /// Callback fired when a message is received on a data channel.
 using mrsDataChannelMessageCallback = void(MRS_CALL*)(void* user_data,
                                                       const void* data,
@@ -398,6 +966,90 @@ MRS_API void MRS_CALL mrsPeerConnectionRegisterARGBRemoteVideoFrameCallback(
     PeerConnectionARGBVideoFrameCallback callback,
     void* user_data) noexcept;
 
+/// Register a callback fired when a video frame from a video track was received
+/// from the remote peer. The frame is delivered as a reference-counted handle,
+/// which the callback can retain with |mrsVideoFrameAddRef()| to keep accessing
+/// the frame pixel data after the callback returned.
+MRS_API void MRS_CALL mrsPeerConnectionRegisterRemoteVideoFrameHandleCallback(
+    PeerConnectionHandle peerHandle,
+    PeerConnectionVideoFrameHandleCallback callback,
+    void* user_data) noexcept;
+
+/// Add a video sink receiving the video frames of the video tracks received
+/// from the remote peer, in the format specified by |config|. Any number of
+/// sinks can be added. On success, the identifier of the new sink is returned
+/// in |sink_id|, for later removal with |mrsPeerConnectionRemoveRemoteVideoSink|.
+///
+/// Frames converted to another format or downscaled to the maximum resolution
+/// of the sink are written into a bounded pool of buffers. Adding
+/// a reference to the frame handle with |mrsVideoFrameAddRef| checks the
+/// buffer out of the pool, and removing that reference returns it. A buffer is
+/// never overwritten while checked out, so consumers can keep a frame without
+/// copying it while the next frames are delivered.
+MRS_API mrsResult MRS_CALL mrsPeerConnectionAddRemoteVideoSink(
+    PeerConnectionHandle peerHandle,
+    VideoSinkConfiguration config,
+    PeerConnectionVideoFrameHandleCallback callback,
+    void* user_data,
+    VideoSinkId* sink_id) noexcept;
+
+/// Remove a video sink previously added with
+/// |mrsPeerConnectionAddRemoteVideoSink|. Once this call returns, the sink
+/// callback is not invoked anymore.
+MRS_API mrsResult MRS_CALL
+mrsPeerConnectionRemoveRemoteVideoSink(PeerConnectionHandle peerHandle,
+                                       VideoSinkId sink_id) noexcept;
+
+/// Capture a snapshot of the next video frame received from the remote peer,
+/// encoded natively as a JPEG image of the size and quality specified by
+/// |config|, and invoke |callback| once with the image. The encoding runs on
+/// a process-wide worker thread, so the callback is invoked asynchronously
+/// from that thread, and never from inside this call. See
+/// |mrsLocalVideoTrackCaptureSnapshot|.
+MRS_API mrsResult MRS_CALL mrsPeerConnectionCaptureRemoteVideoSnapshot(
+    PeerConnectionHandle peerHandle,
+    VideoSnapshotConfiguration config,
+    VideoSnapshotCallback callback,
+    void* user_data) noexcept;
+
+/// Enable or disable the parallel conversion of the remote video frames to
+/// ARGB. When enabled, high-resolution frames are split into bands of rows
+/// converted in parallel on a process-wide worker pool, which reduces the
+/// conversion latency at the expense of using more cores. Disabled by default.
+MRS_API mrsResult MRS_CALL
+mrsPeerConnectionSetRemoteVideoParallelConversion(
+    PeerConnectionHandle peerHandle,
+    mrsBool enabled) noexcept;
+
+/// Select whether the remote video frames are rotated before delivery. By
+/// default WebRTC rotates the frames of senders capturing in another
+/// orientation, which costs a full copy of each rotated frame. When disabled,
+/// the frames are delivered unrotated, and the rotation to apply for display
+/// is reported in |VideoFrameInfo::rotation|, for example for the renderer to
+/// rotate the texture coordinates instead. This applies to the callbacks and
+/// sinks of all the remote video tracks. Enabled by default.
+MRS_API mrsResult MRS_CALL
+mrsPeerConnectionSetRemoteVideoApplyRotation(PeerConnectionHandle peerHandle,
+                                             mrsBool enabled) noexcept;
+
+/// Enable or disable the asynchronous delivery of the remote video frames.
+/// When enabled, the frames are handed over to a dedicated delivery thread
+/// through a mailbox of |mailbox_size| frames, so that slow callbacks and sinks
+/// do not stall the decoder; if the consumers fall behind, the oldest pending
+/// frames are dropped in favor of the latest ones. A |mailbox_size| of zero
+/// disables the asynchronous delivery, which is the default. This must not be
+/// called from a video frame callback.
+MRS_API mrsResult MRS_CALL
+mrsPeerConnectionSetRemoteVideoAsyncDelivery(PeerConnectionHandle peerHandle,
+                                             int32_t mailbox_size) noexcept;
+
+/// Get the number of remote video frames delivered and dropped since the
+/// asynchronous delivery was last enabled.
+MRS_API mrsResult MRS_CALL
+mrsPeerConnectionGetRemoteVideoDeliveryStats(
+    PeerConnectionHandle peerHandle,
+    VideoDeliveryStats* stats) noexcept;
+
 /// Kind of video profile. Equivalent to org::webRtc::VideoProfileKind.
 enum class VideoProfileKind : int32_t {
   kUnspecified,
@@ -416,10 +1068,15 @@ enum class VideoProfileKind : int32_t {
 /// Register a callback fired when an audio frame is available from a local
 /// audio track, usually from a local audio capture device (local microphone).
 ///
+/// The frames are the raw audio of the capture device, delivered from the audio
+/// capture thread while a local audio track is added and enabled, and audio is
+/// sent to the remote peer. This is the audio before echo cancellation, noise
+/// suppression and gain control, so recordings may contain the remote audio
+/// played back by the speakers. The audio data is only valid during the call.
+///
 /// -- WARNING --
-/// Currently this callback is never fired, because the internal audio capture
-/// device implementation ignores any registration and only delivers its audio
-/// data to the internal WebRTC engine for sending to the remote peer.
+/// Currently this callback is never fired on UWP, where the audio device module
+/// is owned by the UWP wrapper and cannot be tapped.
 MRS_API void MRS_CALL mrsPeerConnectionRegisterLocalAudioFrameCallback(
     PeerConnectionHandle peerHandle,
     PeerConnectionAudioFrameCallback callback,
@@ -432,6 +1089,43 @@ MRS_API void MRS_CALL mrsPeerConnectionRegisterRemoteAudioFrameCallback(
     PeerConnectionAudioFrameCallback callback,
     void* user_data) noexcept;
 
+/// Register a callback fired when an audio frame is available from a local
+/// audio track, with its timing information. This is not exclusive with
+/// |mrsPeerConnectionRegisterLocalAudioFrameCallback|.
+///
+/// -- WARNING --
+/// Currently this callback is never fired on UWP, for the same reason as
+/// |mrsPeerConnectionRegisterLocalAudioFrameCallback|.
+MRS_API void MRS_CALL mrsPeerConnectionRegisterLocalAudioFrameInfoCallback(
+    PeerConnectionHandle peerHandle,
+    PeerConnectionAudioFrameInfoCallback callback,
+    void* user_data) noexcept;
+
+/// Register a callback fired when an audio frame from an audio track was
+/// received from the remote peer, with its timing information. This is not
+/// exclusive with |mrsPeerConnectionRegisterRemoteAudioFrameCallback|.
+MRS_API void MRS_CALL mrsPeerConnectionRegisterRemoteAudioFrameInfoCallback(
+    PeerConnectionHandle peerHandle,
+    PeerConnectionAudioFrameInfoCallback callback,
+    void* user_data) noexcept;
+
+/// Get the current time of the monotonic clock the video and audio frame
+/// timestamps are expressed in, in microseconds.
+MRS_API int64_t MRS_CALL mrsGetClockTimeUs() noexcept;
+
+/// Policy selecting the capture format of a local video capture device.
+enum class VideoCaptureFormatPolicy : int32_t {
+  /// Let WebRTC select the format, by resolution and framerate only. The
+  /// encoding selected among the formats of equal resolution and framerate
+  /// depends on the order the device lists them in.
+  kDefault = 0,
+
+  /// Select the format like |mrsVideoCaptureFormatSelect|, preferring among
+  /// the formats of equal resolution and framerate the encoding cheapest to
+  /// convert to I420.
+  kLowestCost = 1,
+};
+
 /// Configuration for opening a local video capture device.
 struct VideoDeviceConfiguration {
   /// Unique identifier of the video capture device to select, as returned by
@@ -477,6 +1171,13 @@ struct VideoDeviceConfiguration {
   /// When Mixed Reality Capture is enabled, enable or disable the recording
   /// indicator shown on screen.
   mrsBool enable_mrc_recording_indicator = mrsBool::kTrue;
+
+  /// Policy selecting the capture format among the formats of the device
+  /// matching |width|, |height| and |framerate|. The selected format can be
+  /// queried with |mrsLocalVideoTrackGetCaptureFormat|. This is last so that
+  /// the layout of the other fields is unchanged for existing callers, and
+  /// defaults to the format selection of WebRTC like before it was added.
+  VideoCaptureFormatPolicy format_policy = VideoCaptureFormatPolicy::kDefault;
 };
 
 /// Add a local video track from a local video capture device (webcam) to
@@ -493,6 +1194,67 @@ MRS_API mrsResult MRS_CALL mrsPeerConnectionAddLocalVideoTrack(
     VideoDeviceConfiguration config,
     LocalVideoTrackHandle* trackHandle) noexcept;
 
+/// Add a local video track producing the frames pushed by the application to
+/// an external video track source, to the collection of tracks to send to the
+/// remote peer. The track keeps a reference to the source. See
+/// |mrsExternalVideoTrackSourceCreate|.
+MRS_API mrsResult MRS_CALL
+mrsPeerConnectionAddLocalVideoTrackFromExternalSource(
+    PeerConnectionHandle peerHandle,
+    const char* track_name,
+    ExternalVideoTrackSourceHandle source_handle,
+    LocalVideoTrackHandle* trackHandle) noexcept;
+
+/// Configuration for reading the frames of a video track from a Y4M file.
+struct Y4mFileConfiguration {
+  /// Path of the Y4M (YUV4MPEG2) file to read, encoded in UTF-8. Only files in
+  /// 8-bit 4:2:0 chroma format are supported.
+  const char* path = nullptr;
+
+  /// Optional frame rate at which the frames are sent, in frame per second
+  /// (FPS), or zero to use the frame rate of the file.
+  double framerate = 0;
+
+  /// Send the frames again from the start of the file after the last one.
+  /// Otherwise the track stops producing frames at the end of the file.
+  mrsBool loop = mrsBool::kTrue;
+};
+
+/// Add a local video track reading its frames from a Y4M file, to the
+/// collection of tracks to send to the remote peer. The file is memory-mapped,
+/// and the frames are paced at the configured frame rate. This does not require
+/// any video capture device, and allows measuring the encoding and decoding
+/// throughput reproducibly. Fails with |MRS_E_NOTFOUND| if the file cannot be
+/// opened, or |MRS_E_INVALID_PARAMETER| if it is not a supported Y4M file.
+MRS_API mrsResult MRS_CALL mrsPeerConnectionAddLocalVideoTrackFromY4mFile(
+    PeerConnectionHandle peerHandle,
+    const char* track_name,
+    Y4mFileConfiguration config,
+    LocalVideoTrackHandle* trackHandle) noexcept;
+
+/// Configuration for generating the frames of a video track from a synthetic
+/// test pattern.
+struct TestPatternConfiguration {
+  /// Resolution width of the frames, in pixels, rounded up to an even value.
+  uint32_t width = 640;
+
+  /// Resolution height of the frames, in pixels, rounded up to an even value.
+  uint32_t height = 480;
+
+  /// Frame rate at which the frames are generated, in frame per second (FPS).
+  double framerate = 30;
+};
+
+/// Add a local video track producing a synthetic test pattern of scrolling
+/// color bars, to the collection of tracks to send to the remote peer. This
+/// does not require any video capture device, and allows measuring the
+/// encoding and decoding throughput reproducibly.
+MRS_API mrsResult MRS_CALL mrsPeerConnectionAddLocalVideoTrackFromTestPattern(
+    PeerConnectionHandle peerHandle,
+    const char* track_name,
+    TestPatternConfiguration config,
+    LocalVideoTrackHandle* trackHandle) noexcept;
+
 /// Add a local audio track from a local audio capture device (microphone) to
 /// the collection of tracks to send to the remote peer.
 MRS_API mrsResult MRS_CALL
@@ -47,6 +47,163 @@ void MRS_CALL mrsLocalVideoTrackRegisterARGBFrameCallback(
   }
 }
 
+void MRS_CALL mrsLocalVideoTrackRegisterFrameHandleCallback(
+    LocalVideoTrackHandle trackHandle,
+    PeerConnectionVideoFrameHandleCallback callback,
+    void* user_data) noexcept {
+  if (auto track = static_cast<LocalVideoTrack*>(trackHandle)) {
+    track->SetCallback(VideoFrameHandleCallback{callback, user_data});
+  }
+}
+
+mrsResult MRS_CALL
+mrsLocalVideoTrackAddSink(LocalVideoTrackHandle trackHandle,
+                          VideoSinkConfiguration config,
+                          PeerConnectionVideoFrameHandleCallback callback,
+                          void* user_data,
+                          VideoSinkId* sink_id) noexcept {
+  if (!callback || !sink_id) {
+    return MRS_E_INVALID_PARAMETER;
+  }
+  *sink_id = 0;
+  auto track = static_cast<LocalVideoTrack*>(trackHandle);
+  if (!track) {
+    return MRS_E_INVALID_PARAMETER;
+  }
+  return track->AddSink(config, VideoFrameHandleCallback{callback, user_data},
+                        *sink_id);
+}
+
+mrsResult MRS_CALL
+mrsLocalVideoTrackRemoveSink(LocalVideoTrackHandle trackHandle,
+                             VideoSinkId sink_id) noexcept {
+  auto track = static_cast<LocalVideoTrack*>(trackHandle);
+  if (!track) {
+    return MRS_E_INVALID_PARAMETER;
+  }
+  return track->RemoveSink(sink_id);
+}
+
+mrsResult MRS_CALL
+mrsLocalVideoTrackSetParallelConversion(LocalVideoTrackHandle trackHandle,
+                                        mrsBool enabled) noexcept {
+  auto track = static_cast<LocalVideoTrack*>(trackHandle);
+  if (!track) {
+    return MRS_E_INVALID_PARAMETER;
+  }
+  track->SetParallelConversion(enabled != mrsBool::kFalse);
+  return MRS_SUCCESS;
+}
+
+mrsResult MRS_CALL
+mrsLocalVideoTrackSetApplyRotation(LocalVideoTrackHandle trackHandle,
+                                   mrsBool enabled) noexcept {
+  auto track = static_cast<LocalVideoTrack*>(trackHandle);
+  if (!track) {
+    return MRS_E_INVALID_PARAMETER;
+  }
+  track->SetApplyRotation(enabled != mrsBool::kFalse);
+  return MRS_SUCCESS;
+}
+
+mrsResult MRS_CALL
+mrsLocalVideoTrackSetAsyncDelivery(LocalVideoTrackHandle trackHandle,
+                                   int32_t mailbox_size) noexcept {
+  auto track = static_cast<LocalVideoTrack*>(trackHandle);
+  if (!track) {
+    return MRS_E_INVALID_PARAMETER;
+  }
+  return track->SetAsyncDelivery(mailbox_size);
+}
+
+mrsResult MRS_CALL
+mrsLocalVideoTrackGetDeliveryStats(LocalVideoTrackHandle trackHandle,
+                                   VideoDeliveryStats* stats) noexcept {
+  auto track = static_cast<LocalVideoTrack*>(trackHandle);
+  if (!track || !stats) {
+    return MRS_E_INVALID_PARAMETER;
+  }
+  track->GetAsyncDeliveryStats(*stats);
+  return MRS_SUCCESS;
+}
+
+mrsResult MRS_CALL
+mrsLocalVideoTrackCaptureSnapshot(LocalVideoTrackHandle trackHandle,
+                                  VideoSnapshotConfiguration config,
+                                  VideoSnapshotCallback callback,
+                                  void* user_data) noexcept {
+  auto track = static_cast<LocalVideoTrack*>(trackHandle);
+  if (!track) {
+    return MRS_E_INVALID_PARAMETER;
+  }
+  return track->CaptureSnapshot(
+      config, VideoSnapshotReadyCallback{callback, user_data});
+}
+
+mrsResult MRS_CALL mrsLocalVideoTrackSetStaticFrameDetection(
+    LocalVideoTrackHandle trackHandle,
+    StaticFrameDetectionConfiguration config) noexcept {
+  auto track = static_cast<LocalVideoTrack*>(trackHandle);
+  if (!track) {
+    return MRS_E_INVALID_PARAMETER;
+  }
+  return track->SetStaticFrameDetection(config);
+}
+
+mrsResult MRS_CALL
+mrsLocalVideoTrackGetStaticFrameStats(LocalVideoTrackHandle trackHandle,
+                                      StaticFrameStats* stats) noexcept {
+  auto track = static_cast<LocalVideoTrack*>(trackHandle);
+  if (!track || !stats) {
+    return MRS_E_INVALID_PARAMETER;
+  }
+  return track->GetStaticFrameStats(*stats);
+}
+
+mrsResult MRS_CALL
+mrsLocalVideoTrackAddFrameProcessor(LocalVideoTrackHandle trackHandle,
+                                    VideoFrameProcessorConfiguration config,
+                                    int32_t* index) noexcept {
+  auto track = static_cast<LocalVideoTrack*>(trackHandle);
+  if (!track || !index) {
+    return MRS_E_INVALID_PARAMETER;
+  }
+  int processor_index = -1;
+  mrsResult result = track->AddFrameProcessor(config, processor_index);
+  *index = processor_index;
+  return result;
+}
+
+mrsResult MRS_CALL mrsLocalVideoTrackClearFrameProcessors(
+    LocalVideoTrackHandle trackHandle) noexcept {
+  auto track = static_cast<LocalVideoTrack*>(trackHandle);
+  if (!track) {
+    return MRS_E_INVALID_PARAMETER;
+  }
+  return track->ClearFrameProcessors();
+}
+
+mrsResult MRS_CALL mrsLocalVideoTrackGetFrameProcessorStats(
+    LocalVideoTrackHandle trackHandle,
+    int32_t index,
+    VideoFrameProcessorStats* stats) noexcept {
+  auto track = static_cast<LocalVideoTrack*>(trackHandle);
+  if (!track || !stats) {
+    return MRS_E_INVALID_PARAMETER;
+  }
+  return track->GetFrameProcessorStats(index, *stats);
+}
+
+mrsResult MRS_CALL
+mrsLocalVideoTrackGetCaptureFormat(LocalVideoTrackHandle trackHandle,
+                                   VideoCaptureFormatInfo* format) noexcept {
+  auto track = static_cast<LocalVideoTrack*>(trackHandle);
+  if (!track || !format) {
+    return MRS_E_INVALID_PARAMETER;
+  }
+  return track->GetCaptureFormat(*format);
+}
+
 mrsResult MRS_CALL
 mrsLocalVideoTrackSetEnabled(LocalVideoTrackHandle track_handle,
                              mrsBool enabled) noexcept {
@@ -36,6 +36,118 @@ MRS_API void MRS_CALL mrsLocalVideoTrackRegisterARGBFrameCallback(
     PeerConnectionARGBVideoFrameCallback callback,
     void* user_data) noexcept;
 
+/// Register a custom callback to be called when the local video track captured
+/// a frame. The captured frame is passed to the registered callback as a
+/// reference-counted I420 frame handle, which can be retained to access the
+/// frame after the callback returned.
+MRS_API void MRS_CALL mrsLocalVideoTrackRegisterFrameHandleCallback(
+    LocalVideoTrackHandle trackHandle,
+    PeerConnectionVideoFrameHandleCallback callback,
+    void* user_data) noexcept;
+
+/// Add a video sink receiving the frames captured by the local video track, in
+/// the format specified by |config|. Any number of sinks can be added. On
+/// success, the identifier of the new sink is returned in |sink_id|.
+MRS_API mrsResult MRS_CALL
+mrsLocalVideoTrackAddSink(LocalVideoTrackHandle trackHandle,
+                          VideoSinkConfiguration config,
+                          PeerConnectionVideoFrameHandleCallback callback,
+                          void* user_data,
+                          VideoSinkId* sink_id) noexcept;
+
+/// Remove a video sink previously added with |mrsLocalVideoTrackAddSink|. Once
+/// this call returns, the sink callback is not invoked anymore.
+MRS_API mrsResult MRS_CALL
+mrsLocalVideoTrackRemoveSink(LocalVideoTrackHandle trackHandle,
+                             VideoSinkId sink_id) noexcept;
+
+/// Enable or disable the parallel conversion to ARGB of the frames captured by
+/// the local video track. See
+/// |mrsPeerConnectionSetRemoteVideoParallelConversion|.
+MRS_API mrsResult MRS_CALL
+mrsLocalVideoTrackSetParallelConversion(LocalVideoTrackHandle trackHandle,
+                                        mrsBool enabled) noexcept;
+
+/// Select whether the frames captured by the local video track are rotated
+/// before delivery to its callbacks and sinks. See
+/// |mrsPeerConnectionSetRemoteVideoApplyRotation|.
+MRS_API mrsResult MRS_CALL
+mrsLocalVideoTrackSetApplyRotation(LocalVideoTrackHandle trackHandle,
+                                   mrsBool enabled) noexcept;
+
+/// Enable or disable the asynchronous delivery of the frames captured by the
+/// local video track. See |mrsPeerConnectionSetRemoteVideoAsyncDelivery|.
+MRS_API mrsResult MRS_CALL
+mrsLocalVideoTrackSetAsyncDelivery(LocalVideoTrackHandle trackHandle,
+                                   int32_t mailbox_size) noexcept;
+
+/// Get the number of frames captured by the local video track delivered and
+/// dropped since the asynchronous delivery was last enabled.
+MRS_API mrsResult MRS_CALL
+mrsLocalVideoTrackGetDeliveryStats(LocalVideoTrackHandle trackHandle,
+                                   VideoDeliveryStats* stats) noexcept;
+
+/// Capture a snapshot of the next frame of the local video track, encoded
+/// natively as a JPEG image of the size and quality specified by |config|, and
+/// invoke |callback| once with the image. The frame is encoded with the libjpeg
+/// bundled with WebRTC on a process-wide worker thread, from which the callback
+/// is invoked asynchronously, so taking periodic thumbnails neither converts
+/// the frames to ARGB nor stalls the frame delivery.
+MRS_API mrsResult MRS_CALL
+mrsLocalVideoTrackCaptureSnapshot(LocalVideoTrackHandle trackHandle,
+                                  VideoSnapshotConfiguration config,
+                                  VideoSnapshotCallback callback,
+                                  void* user_data) noexcept;
+
+/// Enable or disable the detection of static frames of the local video track.
+/// When enabled, frames identical to the previous one are dropped before
+/// encoding, except for keep-alive frames, which saves encoder CPU and
+/// bandwidth for mostly static content like slides or dashboards. Dropped
+/// frames are not delivered to the callbacks and sinks of the track either.
+MRS_API mrsResult MRS_CALL mrsLocalVideoTrackSetStaticFrameDetection(
+    LocalVideoTrackHandle trackHandle,
+    StaticFrameDetectionConfiguration config) noexcept;
+
+/// Get the statistics of the static frame detection of the local video track.
+/// All counters are zero if the detection is disabled.
+MRS_API mrsResult MRS_CALL
+mrsLocalVideoTrackGetStaticFrameStats(LocalVideoTrackHandle trackHandle,
+                                      StaticFrameStats* stats) noexcept;
+
+/// Append a native frame processor to the chain of processors run on the
+/// frames of the local video track before they are encoded and delivered to
+/// the callbacks and sinks of the track, and return its position in the chain
+/// in |index|. Processors run in the order they were added, on the thread
+/// delivering the frames of the track source, after the static frame
+/// detection. The built-in processors crop, scale, blur an area, or blend an
+/// overlay image using SIMD-accelerated helpers; callback processors let the
+/// application modify the frames in place.
+MRS_API mrsResult MRS_CALL
+mrsLocalVideoTrackAddFrameProcessor(LocalVideoTrackHandle trackHandle,
+                                    VideoFrameProcessorConfiguration config,
+                                    int32_t* index) noexcept;
+
+/// Remove all the frame processors of the local video track. Processors can
+/// still be running on the frame being delivered when this returns.
+MRS_API mrsResult MRS_CALL mrsLocalVideoTrackClearFrameProcessors(
+    LocalVideoTrackHandle trackHandle) noexcept;
+
+/// Get the statistics of the frame processor at position |index| in the chain
+/// of processors of the local video track, including the time spent in it.
+MRS_API mrsResult MRS_CALL mrsLocalVideoTrackGetFrameProcessorStats(
+    LocalVideoTrackHandle trackHandle,
+    int32_t index,
+    VideoFrameProcessorStats* stats) noexcept;
+
+/// Get the format the capture device of the local video track was opened in,
+/// with its estimated conversion cost, when selected with
+/// |VideoCaptureFormatPolicy::kLowestCost|. Fails with
+/// |MRS_E_INVALID_OPERATION| for tracks not backed by a capture device, or if
+/// the device does not list its formats and WebRTC selected the format.
+MRS_API mrsResult MRS_CALL
+mrsLocalVideoTrackGetCaptureFormat(LocalVideoTrackHandle trackHandle,
+                                   VideoCaptureFormatInfo* format) noexcept;
+
 /// Enable or disable a local video track. Enabled tracks output their media
 /// content as usual. Disabled track output some void media content (black video
 /// frames, silent audio frames). Enabling/disabling a track is a lightweight
@@ -0,0 +1,115 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+// This is a precompiled header, it must be on its own, followed by a blank
+// line, to prevent clang-format from reordering it with other headers.
+#include "pch.h"
+
+#include "interop/shared_frame_interop.h"
+#include "shared_frame_ring.h"
+
+using namespace Microsoft::MixedReality::WebRTC;
+
+mrsResult MRS_CALL
+mrsSharedFrameRingCreate(const char* name,
+                         SharedFrameRingConfiguration config,
+                         SharedFrameRingHandle* handle) noexcept {
+  if (!handle) {
+    return MRS_E_INVALID_PARAMETER;
+  }
+  *handle = nullptr;
+  rtc::scoped_refptr<SharedFrameRing> ring;
+  const mrsResult result = SharedFrameRing::Create(name, config, ring);
+  if (result != MRS_SUCCESS) {
+    return result;
+  }
+  *handle = ring.release();
+  return MRS_SUCCESS;
+}
+
+void MRS_CALL mrsSharedFrameRingAddRef(SharedFrameRingHandle handle) noexcept {
+  if (auto ring = static_cast<SharedFrameRing*>(handle)) {
+    ring->AddRef();
+  } else {
+    RTC_LOG(LS_WARNING)
+        << "Trying to add reference to NULL SharedFrameRing object.";
+  }
+}
+
+void MRS_CALL
+mrsSharedFrameRingRemoveRef(SharedFrameRingHandle handle) noexcept {
+  if (auto ring = static_cast<SharedFrameRing*>(handle)) {
+    ring->Release();
+  } else {
+    RTC_LOG(LS_WARNING) << "Trying to remove reference from NULL "
+                           "SharedFrameRing object.";
+  }
+}
+
+void MRS_CALL mrsSharedFrameRingWrite(void* user_data,
+                                      const VideoFrameInfo* frame) noexcept {
+  auto ring = static_cast<SharedFrameRing*>(user_data);
+  if (!ring || !frame) {
+    return;
+  }
+  ring->Write(*frame);
+}
+
+mrsResult MRS_CALL
+mrsSharedFrameRingGetStats(SharedFrameRingHandle handle,
+                           SharedFrameRingStats* stats) noexcept {
+  auto ring = static_cast<SharedFrameRing*>(handle);
+  if (!ring || !stats) {
+    return MRS_E_INVALID_PARAMETER;
+  }
+  ring->GetStats(*stats);
+  return MRS_SUCCESS;
+}
+
+mrsResult MRS_CALL
+mrsSharedFrameReaderOpen(const char* name,
+                         SharedFrameReaderHandle* handle) noexcept {
+  if (!handle) {
+    return MRS_E_INVALID_PARAMETER;
+  }
+  *handle = nullptr;
+  std::unique_ptr<SharedFrameReader> reader;
+  const mrsResult result = SharedFrameReader::Open(name, reader);
+  if (result != MRS_SUCCESS) {
+    return result;
+  }
+  *handle = reader.release();
+  return MRS_SUCCESS;
+}
+
+void MRS_CALL
+mrsSharedFrameReaderClose(SharedFrameReaderHandle handle) noexcept {
+  delete static_cast<SharedFrameReader*>(handle);
+}
+
+mrsResult MRS_CALL
+mrsSharedFrameReaderAcquire(SharedFrameReaderHandle handle,
+                            mrsBool latest,
+                            VideoFrameInfo* frame,
+                            uint64_t* sequence) noexcept {
+  auto reader = static_cast<SharedFrameReader*>(handle);
+  if (!reader || !frame || !sequence) {
+    return MRS_E_INVALID_PARAMETER;
+  }
+  if (!reader->Acquire(latest != mrsBool::kFalse, *frame, *sequence)) {
+    return MRS_E_NOTFOUND;
+  }
+  return MRS_SUCCESS;
+}
+
+mrsResult MRS_CALL
+mrsSharedFrameReaderRelease(SharedFrameReaderHandle handle,
+                            uint64_t sequence,
+                            mrsBool* valid) noexcept {
+  auto reader = static_cast<SharedFrameReader*>(handle);
+  if (!reader || !valid) {
+    return MRS_E_INVALID_PARAMETER;
+  }
+  *valid = (reader->Release(sequence) ? mrsBool::kTrue : mrsBool::kFalse);
+  return MRS_SUCCESS;
+}
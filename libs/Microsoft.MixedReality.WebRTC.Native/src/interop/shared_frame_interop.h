@@ -0,0 +1,97 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include "export.h"
+#include "interop/interop_api.h"
+
+extern "C" {
+
+//
+// Writer
+//
+
+/// Create a ring of |config.num_slots| video frames in the named shared memory
+/// region |name|, to export the frames of a video track to other processes
+/// with a single copy. On POSIX systems this is a shared memory object, as
+/// opened by |shm_open()|; on Windows this is a named file mapping. The ring
+/// is returned with one reference, to be released with
+/// |mrsSharedFrameRingRemoveRef()|, which removes the region.
+///
+/// The ring is fed by registering |mrsSharedFrameRingWrite| as the callback of
+/// a video sink of a single video track, with the ring handle as user data.
+/// Frames are written in the format of the sink, which should not deliver
+/// frames larger than the maximum resolution of the ring. The sink must be
+/// removed before the last reference to the ring is released.
+///
+/// Fails with |MRS_E_INVALID_OPERATION| if a region with the same name already
+/// exists, like a ring created by another live process. On POSIX systems, a
+/// region left over by a process which did not exit cleanly is not replaced
+/// either, and must be removed with |shm_unlink()| first.
+MRS_API mrsResult MRS_CALL
+mrsSharedFrameRingCreate(const char* name,
+                         SharedFrameRingConfiguration config,
+                         SharedFrameRingHandle* handle) noexcept;
+
+/// Add a reference to the shared frame ring associated with the given handle.
+MRS_API void MRS_CALL
+mrsSharedFrameRingAddRef(SharedFrameRingHandle handle) noexcept;
+
+/// Remove a reference from the shared frame ring associated with the given
+/// handle, destroying the ring with the last one.
+MRS_API void MRS_CALL
+mrsSharedFrameRingRemoveRef(SharedFrameRingHandle handle) noexcept;
+
+/// Copy a frame into the next slot of the ring |user_data| and publish it to
+/// the readers. This has the signature of a video sink callback, and is meant
+/// to be registered as such. Frames are written from a single thread.
+MRS_API void MRS_CALL
+mrsSharedFrameRingWrite(void* user_data, const VideoFrameInfo* frame) noexcept;
+
+/// Get the statistics of a shared frame ring. This can be called from any
+/// thread.
+MRS_API mrsResult MRS_CALL
+mrsSharedFrameRingGetStats(SharedFrameRingHandle handle,
+                           SharedFrameRingStats* stats) noexcept;
+
+//
+// Reader
+//
+
+/// Open the shared frame ring |name| for reading, typically from another
+/// process than the one writing the frames. Fails with |MRS_E_NOTFOUND| if the
+/// ring does not exist, or with |MRS_E_INVALID_PARAMETER| if the region is not
+/// a frame ring of a compatible version. The reader must be closed with
+/// |mrsSharedFrameReaderClose()|.
+MRS_API mrsResult MRS_CALL
+mrsSharedFrameReaderOpen(const char* name,
+                         SharedFrameReaderHandle* handle) noexcept;
+
+/// Close a reader opened with |mrsSharedFrameReaderOpen()|, unmapping the
+/// frames it acquired.
+MRS_API void MRS_CALL
+mrsSharedFrameReaderClose(SharedFrameReaderHandle handle) noexcept;
+
+/// Acquire the frame following the last one acquired, or the latest frame if
+/// |latest| is true, without copy. On success |frame| points into the shared
+/// memory, with a null |VideoFrameInfo::handle|, and |sequence| is the
+/// sequence number of the frame, starting at one. Frames overwritten before
+/// they could be acquired are skipped, which shows as a gap in the sequence
+/// numbers. Return |MRS_E_NOTFOUND| if no new frame is available.
+MRS_API mrsResult MRS_CALL
+mrsSharedFrameReaderAcquire(SharedFrameReaderHandle handle,
+                            mrsBool latest,
+                            VideoFrameInfo* frame,
+                            uint64_t* sequence) noexcept;
+
+/// End the access to the frame |sequence|. The writer never waits for the
+/// readers, so a frame can be overwritten while accessed by a reader lagging
+/// behind by the number of slots of the ring; on return, |valid| is false if
+/// that happened, and the data read from the frame must be discarded.
+MRS_API mrsResult MRS_CALL
+mrsSharedFrameReaderRelease(SharedFrameReaderHandle handle,
+                            uint64_t sequence,
+                            mrsBool* valid) noexcept;
+
+}  // extern "C"
@@ -0,0 +1,520 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+// This is a precompiled header, it must be on its own, followed by a blank
+// line, to prevent clang-format from reordering it with other headers.
+#include "pch.h"
+
+#include "interop/global_factory.h"
+#include "interop/video_frame_interop.h"
+#include "local_video_track.h"
+#include "peer_connection.h"
+#include "video_conversion.h"
+#include "video_frame_queue.h"
+#include "video_frame_ref.h"
+#include "video_mosaic.h"
+#include "video_tensor_converter.h"
+
+using namespace Microsoft::MixedReality::WebRTC;
+
+namespace {
+
+/// Callback of the video sinks of a frame queue, which hold a reference to the
+/// queue passed as user data.
+void MRS_CALL OnQueueSinkFrame(void* user_data,
+                               const VideoFrameInfo* frame) noexcept {
+  if (frame->handle) {
+    static_cast<VideoFrameQueue*>(user_data)->Enqueue(
+        static_cast<VideoFrameRef*>(frame->handle));
+  }
+}
+
+/// Callback of the video sinks of a mosaic tile passed as user data, which hold
+/// a reference to the mosaic owning the tile.
+void MRS_CALL OnMosaicSinkFrame(void* user_data,
+                                const VideoFrameInfo* frame) noexcept {
+  if (frame->handle) {
+    static_cast<VideoMosaic::Tile*>(user_data)->Enqueue(
+        static_cast<VideoFrameRef*>(frame->handle));
+  }
+}
+
+/// Callback of the video sinks of a tensor converter, which hold a reference
+/// to the converter passed as user data.
+void MRS_CALL OnTensorSinkFrame(void* user_data,
+                                const VideoFrameInfo* frame) noexcept {
+  static_cast<VideoTensorConverter*>(user_data)->OnFrame(*frame);
+}
+
+}  // namespace
+
+void MRS_CALL mrsVideoFrameAddRef(VideoFrameHandle handle) noexcept {
+  if (auto frame = static_cast<VideoFrameRef*>(handle)) {
+    frame->AddRef();
+  } else {
+    RTC_LOG(LS_WARNING)
+        << "Trying to add reference to NULL VideoFrameRef object.";
+  }
+}
+
+void MRS_CALL mrsVideoFrameRemoveRef(VideoFrameHandle handle) noexcept {
+  if (auto frame = static_cast<VideoFrameRef*>(handle)) {
+    frame->Release();
+  } else {
+    RTC_LOG(LS_WARNING) << "Trying to remove reference from NULL "
+                           "VideoFrameRef object.";
+  }
+}
+
+mrsResult MRS_CALL mrsVideoFrameGetInfo(VideoFrameHandle handle,
+                                        VideoFrameInfo* info) noexcept {
+  if (!info) {
+    return MRS_E_INVALID_PARAMETER;
+  }
+  auto frame = static_cast<VideoFrameRef*>(handle);
+  if (!frame) {
+    return MRS_E_INVALID_PARAMETER;
+  }
+  *info = frame->info();
+  return MRS_SUCCESS;
+}
+
+namespace {
+
+/// Validate and perform a conversion for |mrsVideoFrameConvert| and its
+/// variants.
+mrsResult ConvertFrame(const VideoFrameInfo* src,
+                       const VideoFrameInfo* dst,
+                       VideoColorMatrix matrix,
+                       VideoColorRange range,
+                       bool premultiply_alpha,
+                       mrsBool parallel) noexcept {
+  if (!src || !dst || (src->format != VideoFrameFormat::kI420A) ||
+      (src->width <= 0) || (src->height <= 0) ||
+      (dst->width != src->width) || (dst->height != src->height)) {
+    return MRS_E_INVALID_PARAMETER;
+  }
+  if (!src->data[0] || !src->data[1] || !src->data[2]) {
+    return MRS_E_INVALID_PARAMETER;
+  }
+  if (!IsConversionSupported(dst->format, matrix, range)) {
+    return MRS_E_INVALID_PARAMETER;
+  }
+  int bytes_per_pixel = 4;
+  if (dst->format == VideoFrameFormat::kNv12) {
+    bytes_per_pixel = 1;
+    if (!dst->data[1] || (dst->stride[1] < ((src->width + 1) / 2) * 2)) {
+      return MRS_E_INVALID_PARAMETER;
+    }
+  } else if (dst->format == VideoFrameFormat::kRgb24) {
+    bytes_per_pixel = 3;
+  }
+  if (!dst->data[0] || (dst->stride[0] < src->width * bytes_per_pixel)) {
+    return MRS_E_INVALID_PARAMETER;
+  }
+  std::shared_ptr<WorkerPool> pool;
+  if (parallel != mrsBool::kFalse) {
+    pool = GlobalFactory::Instance()->GetWorkerPool();
+  }
+  ConvertI420A(*src, *dst, matrix, range, premultiply_alpha, pool.get());
+  return MRS_SUCCESS;
+}
+
+}  // namespace
+
+mrsResult MRS_CALL
+mrsVideoFrameConvertToPremultipliedArgb(const VideoFrameInfo* src,
+                                        void* dst,
+                                        int32_t dst_stride,
+                                        mrsBool parallel) noexcept {
+  if (!src) {
+    return MRS_E_INVALID_PARAMETER;
+  }
+  VideoFrameInfo dst_info{};
+  dst_info.format = VideoFrameFormat::kArgb32;
+  dst_info.width = src->width;
+  dst_info.height = src->height;
+  dst_info.data[0] = dst;
+  dst_info.stride[0] = dst_stride;
+  return ConvertFrame(src, &dst_info, VideoColorMatrix::kBt601,
+                      VideoColorRange::kLimited, true, parallel);
+}
+
+mrsResult MRS_CALL mrsVideoFrameConvert(const VideoFrameInfo* src,
+                                        const VideoFrameInfo* dst,
+                                        VideoColorMatrix matrix,
+                                        VideoColorRange range,
+                                        mrsBool parallel) noexcept {
+  return ConvertFrame(src, dst, matrix, range, false, parallel);
+}
+
+mrsResult MRS_CALL mrsVideoFrameScale(const VideoFrameInfo* src,
+                                      const VideoFrameInfo* dst) noexcept {
+  if (!src || !dst || (src->format != VideoFrameFormat::kI420A) ||
+      (dst->format != VideoFrameFormat::kI420A) || (src->width <= 0) ||
+      (src->height <= 0) || (dst->width <= 0) || (dst->height <= 0)) {
+    return MRS_E_INVALID_PARAMETER;
+  }
+  for (int plane = 0; plane < 3; ++plane) {
+    if (!src->data[plane] || !dst->data[plane]) {
+      return MRS_E_INVALID_PARAMETER;
+    }
+  }
+  const int dst_chroma_width = (dst->width + 1) / 2;
+  if ((dst->stride[0] < dst->width) || (dst->stride[1] < dst_chroma_width) ||
+      (dst->stride[2] < dst_chroma_width) ||
+      (dst->data[3] && (dst->stride[3] < dst->width))) {
+    return MRS_E_INVALID_PARAMETER;
+  }
+  ScaleI420A(*src, *dst);
+  return MRS_SUCCESS;
+}
+
+mrsResult MRS_CALL mrsVideoFrameFitResolution(int32_t width,
+                                              int32_t height,
+                                              int32_t max_width,
+                                              int32_t max_height,
+                                              int32_t* out_width,
+                                              int32_t* out_height) noexcept {
+  if ((width <= 0) || (height <= 0) || (max_width < 0) || (max_height < 0) ||
+      !out_width || !out_height) {
+    return MRS_E_INVALID_PARAMETER;
+  }
+  int scaled_width;
+  int scaled_height;
+  FitResolution(width, height, max_width, max_height, &scaled_width,
+                &scaled_height);
+  *out_width = scaled_width;
+  *out_height = scaled_height;
+  return MRS_SUCCESS;
+}
+
+mrsResult MRS_CALL
+mrsVideoFrameQueueCreate(int32_t capacity,
+                         VideoFrameQueueHandle* handle) noexcept {
+  if (!handle) {
+    return MRS_E_INVALID_PARAMETER;
+  }
+  *handle = nullptr;
+  if (capacity <= 0) {
+    return MRS_E_INVALID_PARAMETER;
+  }
+  rtc::scoped_refptr<VideoFrameQueue> queue = VideoFrameQueue::Create(capacity);
+  *handle = queue.release();
+  return MRS_SUCCESS;
+}
+
+void MRS_CALL mrsVideoFrameQueueAddRef(VideoFrameQueueHandle handle) noexcept {
+  if (auto queue = static_cast<VideoFrameQueue*>(handle)) {
+    queue->AddRef();
+  } else {
+    RTC_LOG(LS_WARNING)
+        << "Trying to add reference to NULL VideoFrameQueue object.";
+  }
+}
+
+void MRS_CALL
+mrsVideoFrameQueueRemoveRef(VideoFrameQueueHandle handle) noexcept {
+  if (auto queue = static_cast<VideoFrameQueue*>(handle)) {
+    queue->Release();
+  } else {
+    RTC_LOG(LS_WARNING) << "Trying to remove reference from NULL "
+                           "VideoFrameQueue object.";
+  }
+}
+
+mrsResult MRS_CALL
+mrsVideoFrameQueueAddLocalVideoSink(VideoFrameQueueHandle handle,
+                                    LocalVideoTrackHandle track_handle,
+                                    VideoSinkConfiguration config,
+                                    VideoSinkId* sink_id) noexcept {
+  if (!sink_id) {
+    return MRS_E_INVALID_PARAMETER;
+  }
+  *sink_id = 0;
+  auto queue = static_cast<VideoFrameQueue*>(handle);
+  auto track = static_cast<LocalVideoTrack*>(track_handle);
+  if (!queue || !track) {
+    return MRS_E_INVALID_PARAMETER;
+  }
+  return track->AddSink(config,
+                        VideoFrameHandleCallback{&OnQueueSinkFrame, queue},
+                        *sink_id, queue);
+}
+
+mrsResult MRS_CALL
+mrsVideoFrameQueueAddRemoteVideoSink(VideoFrameQueueHandle handle,
+                                     PeerConnectionHandle peer_handle,
+                                     VideoSinkConfiguration config,
+                                     VideoSinkId* sink_id) noexcept {
+  if (!sink_id) {
+    return MRS_E_INVALID_PARAMETER;
+  }
+  *sink_id = 0;
+  auto queue = static_cast<VideoFrameQueue*>(handle);
+  if (!queue) {
+    return MRS_E_INVALID_PARAMETER;
+  }
+  auto peer = static_cast<PeerConnection*>(peer_handle);
+  if (!peer) {
+    return MRS_E_INVALID_PEER_HANDLE;
+  }
+  return peer->AddRemoteVideoSink(
+      config, VideoFrameHandleCallback{&OnQueueSinkFrame, queue}, *sink_id,
+      queue);
+}
+
+mrsResult MRS_CALL
+mrsVideoFrameQueueTryDequeue(VideoFrameQueueHandle handle,
+                             int64_t presentation_time_us,
+                             VideoFrameInfo* frame,
+                             mrsBool* is_new_frame) noexcept {
+  auto queue = static_cast<VideoFrameQueue*>(handle);
+  if (!queue || !frame || !is_new_frame) {
+    return MRS_E_INVALID_PARAMETER;
+  }
+  bool is_new = false;
+  VideoFrameRef* frame_ref = queue->TryDequeue(presentation_time_us, &is_new);
+  *is_new_frame = (is_new ? mrsBool::kTrue : mrsBool::kFalse);
+  if (!frame_ref) {
+    return MRS_E_NOTFOUND;
+  }
+  *frame = frame_ref->info();
+  return MRS_SUCCESS;
+}
+
+mrsResult MRS_CALL
+mrsVideoFrameQueueGetStats(VideoFrameQueueHandle handle,
+                           VideoFrameQueueStats* stats) noexcept {
+  auto queue = static_cast<VideoFrameQueue*>(handle);
+  if (!queue || !stats) {
+    return MRS_E_INVALID_PARAMETER;
+  }
+  queue->GetStats(*stats);
+  return MRS_SUCCESS;
+}
+
+mrsResult MRS_CALL mrsVideoMosaicCreate(VideoMosaicConfiguration config,
+                                        const VideoFrameInfo* canvas,
+                                        VideoMosaicHandle* handle) noexcept {
+  if (!handle) {
+    return MRS_E_INVALID_PARAMETER;
+  }
+  *handle = nullptr;
+  if (!canvas) {
+    return MRS_E_INVALID_PARAMETER;
+  }
+  std::shared_ptr<WorkerPool> pool;
+  if (config.parallel != mrsBool::kFalse) {
+    pool = GlobalFactory::Instance()->GetWorkerPool();
+  }
+  rtc::scoped_refptr<VideoMosaic> mosaic;
+  const mrsResult result =
+      VideoMosaic::Create(config, *canvas, std::move(pool), mosaic);
+  if (result != MRS_SUCCESS) {
+    return result;
+  }
+  *handle = mosaic.release();
+  return MRS_SUCCESS;
+}
+
+void MRS_CALL mrsVideoMosaicAddRef(VideoMosaicHandle handle) noexcept {
+  if (auto mosaic = static_cast<VideoMosaic*>(handle)) {
+    mosaic->AddRef();
+  } else {
+    RTC_LOG(LS_WARNING)
+        << "Trying to add reference to NULL VideoMosaic object.";
+  }
+}
+
+void MRS_CALL mrsVideoMosaicRemoveRef(VideoMosaicHandle handle) noexcept {
+  if (auto mosaic = static_cast<VideoMosaic*>(handle)) {
+    mosaic->Release();
+  } else {
+    RTC_LOG(LS_WARNING) << "Trying to remove reference from NULL "
+                           "VideoMosaic object.";
+  }
+}
+
+mrsResult MRS_CALL
+mrsVideoMosaicAddLocalVideoSink(VideoMosaicHandle handle,
+                                int32_t tile_index,
+                                LocalVideoTrackHandle track_handle,
+                                VideoSinkConfiguration config,
+                                VideoSinkId* sink_id) noexcept {
+  if (!sink_id) {
+    return MRS_E_INVALID_PARAMETER;
+  }
+  *sink_id = 0;
+  auto mosaic = static_cast<VideoMosaic*>(handle);
+  auto track = static_cast<LocalVideoTrack*>(track_handle);
+  if (!mosaic || !track || (tile_index < 0) ||
+      (tile_index >= mosaic->num_tiles()) ||
+      (config.format != VideoFrameFormat::kI420A)) {
+    return MRS_E_INVALID_PARAMETER;
+  }
+  return track->AddSink(
+      config,
+      VideoFrameHandleCallback{&OnMosaicSinkFrame, mosaic->tile(tile_index)},
+      *sink_id, mosaic);
+}
+
+mrsResult MRS_CALL
+mrsVideoMosaicAddRemoteVideoSink(VideoMosaicHandle handle,
+                                 int32_t tile_index,
+                                 PeerConnectionHandle peer_handle,
+                                 VideoSinkConfiguration config,
+                                 VideoSinkId* sink_id) noexcept {
+  if (!sink_id) {
+    return MRS_E_INVALID_PARAMETER;
+  }
+  *sink_id = 0;
+  auto mosaic = static_cast<VideoMosaic*>(handle);
+  if (!mosaic || (tile_index < 0) || (tile_index >= mosaic->num_tiles()) ||
+      (config.format != VideoFrameFormat::kI420A)) {
+    return MRS_E_INVALID_PARAMETER;
+  }
+  auto peer = static_cast<PeerConnection*>(peer_handle);
+  if (!peer) {
+    return MRS_E_INVALID_PEER_HANDLE;
+  }
+  return peer->AddRemoteVideoSink(
+      config,
+      VideoFrameHandleCallback{&OnMosaicSinkFrame, mosaic->tile(tile_index)},
+      *sink_id, mosaic);
+}
+
+mrsResult MRS_CALL mrsVideoMosaicClearTile(VideoMosaicHandle handle,
+                                           int32_t tile_index) noexcept {
+  auto mosaic = static_cast<VideoMosaic*>(handle);
+  if (!mosaic || (tile_index < 0) || (tile_index >= mosaic->num_tiles())) {
+    return MRS_E_INVALID_PARAMETER;
+  }
+  mosaic->tile(tile_index)->Clear();
+  return MRS_SUCCESS;
+}
+
+mrsResult MRS_CALL mrsVideoMosaicCompose(VideoMosaicHandle handle,
+                                         mrsBool* updated) noexcept {
+  auto mosaic = static_cast<VideoMosaic*>(handle);
+  if (!mosaic || !updated) {
+    return MRS_E_INVALID_PARAMETER;
+  }
+  *updated = (mosaic->Compose() ? mrsBool::kTrue : mrsBool::kFalse);
+  return MRS_SUCCESS;
+}
+
+mrsResult MRS_CALL mrsVideoMosaicGetStats(VideoMosaicHandle handle,
+                                          VideoMosaicStats* stats) noexcept {
+  auto mosaic = static_cast<VideoMosaic*>(handle);
+  if (!mosaic || !stats) {
+    return MRS_E_INVALID_PARAMETER;
+  }
+  mosaic->GetStats(*stats);
+  return MRS_SUCCESS;
+}
+
+mrsResult MRS_CALL
+mrsVideoTensorConverterCreate(VideoTensorConfiguration config,
+                              VideoTensorCallback callback,
+                              void* user_data,
+                              VideoTensorConverterHandle* handle) noexcept {
+  if (!handle) {
+    return MRS_E_INVALID_PARAMETER;
+  }
+  *handle = nullptr;
+  rtc::scoped_refptr<VideoTensorConverter> converter;
+  const mrsResult result = VideoTensorConverter::Create(
+      config, VideoTensorReadyCallback{callback, user_data}, converter);
+  if (result != MRS_SUCCESS) {
+    return result;
+  }
+  *handle = converter.release();
+  return MRS_SUCCESS;
+}
+
+void MRS_CALL
+mrsVideoTensorConverterAddRef(VideoTensorConverterHandle handle) noexcept {
+  if (auto converter = static_cast<VideoTensorConverter*>(handle)) {
+    converter->AddRef();
+  } else {
+    RTC_LOG(LS_WARNING)
+        << "Trying to add reference to NULL VideoTensorConverter object.";
+  }
+}
+
+void MRS_CALL
+mrsVideoTensorConverterRemoveRef(VideoTensorConverterHandle handle) noexcept {
+  if (auto converter = static_cast<VideoTensorConverter*>(handle)) {
+    converter->Release();
+  } else {
+    RTC_LOG(LS_WARNING) << "Trying to remove reference from NULL "
+                           "VideoTensorConverter object.";
+  }
+}
+
+mrsResult MRS_CALL
+mrsVideoTensorConverterGetTensorSize(VideoTensorConverterHandle handle,
+                                     uint64_t* size) noexcept {
+  auto converter = static_cast<VideoTensorConverter*>(handle);
+  if (!converter || !size) {
+    return MRS_E_INVALID_PARAMETER;
+  }
+  *size = converter->tensor_size();
+  return MRS_SUCCESS;
+}
+
+mrsResult MRS_CALL
+mrsVideoTensorConverterConvert(VideoTensorConverterHandle handle,
+                               const VideoFrameInfo* frame,
+                               float* tensor,
+                               uint64_t tensor_size,
+                               VideoTensorInfo* info) noexcept {
+  auto converter = static_cast<VideoTensorConverter*>(handle);
+  if (!converter || !frame || !tensor || !info ||
+      (tensor_size < converter->tensor_size())) {
+    return MRS_E_INVALID_PARAMETER;
+  }
+  return converter->Convert(*frame, tensor, *info);
+}
+
+mrsResult MRS_CALL
+mrsVideoTensorConverterAddLocalVideoSink(VideoTensorConverterHandle handle,
+                                         LocalVideoTrackHandle track_handle,
+                                         VideoSinkConfiguration config,
+                                         VideoSinkId* sink_id) noexcept {
+  if (!sink_id) {
+    return MRS_E_INVALID_PARAMETER;
+  }
+  *sink_id = 0;
+  auto converter = static_cast<VideoTensorConverter*>(handle);
+  auto track = static_cast<LocalVideoTrack*>(track_handle);
+  if (!converter || !track || (config.format != VideoFrameFormat::kI420A)) {
+    return MRS_E_INVALID_PARAMETER;
+  }
+  return track->AddSink(config,
+                        VideoFrameHandleCallback{&OnTensorSinkFrame, converter},
+                        *sink_id, converter);
+}
+
+mrsResult MRS_CALL
+mrsVideoTensorConverterAddRemoteVideoSink(VideoTensorConverterHandle handle,
+                                          PeerConnectionHandle peer_handle,
+                                          VideoSinkConfiguration config,
+                                          VideoSinkId* sink_id) noexcept {
+  if (!sink_id) {
+    return MRS_E_INVALID_PARAMETER;
+  }
+  *sink_id = 0;
+  auto converter = static_cast<VideoTensorConverter*>(handle);
+  if (!converter || (config.format != VideoFrameFormat::kI420A)) {
+    return MRS_E_INVALID_PARAMETER;
+  }
+  auto peer = static_cast<PeerConnection*>(peer_handle);
+  if (!peer) {
+    return MRS_E_INVALID_PEER_HANDLE;
+  }
+  return peer->AddRemoteVideoSink(
+      config, VideoFrameHandleCallback{&OnTensorSinkFrame, converter},
+      *sink_id, converter);
+}
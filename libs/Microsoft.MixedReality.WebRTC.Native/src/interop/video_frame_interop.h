@@ -0,0 +1,284 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include "export.h"
+#include "interop/interop_api.h"
+
+extern "C" {
+
+//
+// Wrapper
+//
+
+/// Add a reference to the native video frame associated with the given handle.
+/// The frame pixel data stays valid as long as at least one reference is held.
+MRS_API void MRS_CALL mrsVideoFrameAddRef(VideoFrameHandle handle) noexcept;
+
+/// Remove a reference from the native video frame associated with the given
+/// handle. Once the last reference is removed, the frame is destroyed and any
+/// pointer to its pixel data becomes invalid.
+MRS_API void MRS_CALL mrsVideoFrameRemoveRef(VideoFrameHandle handle) noexcept;
+
+/// Get the description of a video frame, including the pointers to its planes.
+/// The caller must hold a reference to the frame for the entire time it
+/// accesses the frame pixel data.
+MRS_API mrsResult MRS_CALL mrsVideoFrameGetInfo(VideoFrameHandle handle,
+                                                VideoFrameInfo* info) noexcept;
+
+//
+// Conversion
+//
+
+/// Convert the I420 or I420A frame |src| to BT.601 limited range 32-bit ARGB
+/// into the caller-owned buffer |dst| of byte stride |dst_stride|, which must
+/// hold at least |src->height| rows of |src->width| pixels. For frames with an
+/// alpha plane, the color channels are premultiplied by alpha in the same SIMD
+/// pass as the conversion, which saves compositors a separate premultiplication
+/// pass. For other frames, this is the same as |mrsVideoFrameConvert()| to
+/// ARGB. If |parallel| is true, frames of high enough resolution are converted
+/// in parallel on the process-wide worker pool, which only exists while a peer
+/// connection is alive; otherwise they are converted on the calling thread.
+MRS_API mrsResult MRS_CALL
+mrsVideoFrameConvertToPremultipliedArgb(const VideoFrameInfo* src,
+                                        void* dst,
+                                        int32_t dst_stride,
+                                        mrsBool parallel) noexcept;
+
+/// Convert the I420 or I420A frame |src| into the caller-owned frame |dst|, in
+/// the format of |dst|. The frame |dst| must have the same resolution as |src|,
+/// and its planes and strides must describe caller-owned buffers large enough
+/// for that format. The color matrix and range select the YUV to RGB
+/// conversion, and are ignored for YUV formats. If |parallel| is true, frames
+/// of high enough resolution are converted in parallel on the process-wide
+/// worker pool, like |mrsVideoFrameConvertToPremultipliedArgb()|.
+MRS_API mrsResult MRS_CALL mrsVideoFrameConvert(const VideoFrameInfo* src,
+                                                const VideoFrameInfo* dst,
+                                                VideoColorMatrix matrix,
+                                                VideoColorRange range,
+                                                mrsBool parallel) noexcept;
+
+/// Scale the I420 or I420A frame |src| into the caller-owned I420 or I420A
+/// frame |dst|, at the resolution of |dst|. The planes and strides of |dst|
+/// must describe caller-owned buffers large enough for that resolution. The
+/// alpha plane is scaled only if both frames have one.
+MRS_API mrsResult MRS_CALL
+mrsVideoFrameScale(const VideoFrameInfo* src,
+                   const VideoFrameInfo* dst) noexcept;
+
+/// Compute the resolution a frame of |width| x |height| pixels is downscaled to
+/// for a video sink with the given maximum resolution, as specified by
+/// |VideoSinkConfiguration|.
+MRS_API mrsResult MRS_CALL
+mrsVideoFrameFitResolution(int32_t width,
+                           int32_t height,
+                           int32_t max_width,
+                           int32_t max_height,
+                           int32_t* out_width,
+                           int32_t* out_height) noexcept;
+
+//
+// Queue
+//
+
+/// Create a queue of up to |capacity| video frames ordered by presentation
+/// time. The queue is returned with one reference, to be released with
+/// |mrsVideoFrameQueueRemoveRef()|.
+///
+/// The queue is fed by the video sinks added with
+/// |mrsVideoFrameQueueAddLocalVideoSink()| and
+/// |mrsVideoFrameQueueAddRemoteVideoSink()|, of any number of video tracks.
+MRS_API mrsResult MRS_CALL
+mrsVideoFrameQueueCreate(int32_t capacity,
+                         VideoFrameQueueHandle* handle) noexcept;
+
+/// Add a reference to the video frame queue associated with the given handle.
+MRS_API void MRS_CALL
+mrsVideoFrameQueueAddRef(VideoFrameQueueHandle handle) noexcept;
+
+/// Remove a reference from the video frame queue associated with the given
+/// handle, destroying the queue and releasing its frames with the last one.
+MRS_API void MRS_CALL
+mrsVideoFrameQueueRemoveRef(VideoFrameQueueHandle handle) noexcept;
+
+/// Add a video sink enqueuing the frames captured by the local video track
+/// |track_handle| into the queue |handle|, without copying them. Frames can be
+/// enqueued by several sinks concurrently, and are dropped if the queue is
+/// full. The sink holds a reference to the queue until it is removed with
+/// |mrsLocalVideoTrackRemoveSink()| and done with its last frame.
+MRS_API mrsResult MRS_CALL
+mrsVideoFrameQueueAddLocalVideoSink(VideoFrameQueueHandle handle,
+                                    LocalVideoTrackHandle track_handle,
+                                    VideoSinkConfiguration config,
+                                    VideoSinkId* sink_id) noexcept;
+
+/// Add a video sink enqueuing the remote video frames of the peer connection
+/// |peer_handle| into the queue |handle|, like
+/// |mrsVideoFrameQueueAddLocalVideoSink()|. The sink is removed with
+/// |mrsPeerConnectionRemoveRemoteVideoSink()|.
+MRS_API mrsResult MRS_CALL
+mrsVideoFrameQueueAddRemoteVideoSink(VideoFrameQueueHandle handle,
+                                     PeerConnectionHandle peer_handle,
+                                     VideoSinkConfiguration config,
+                                     VideoSinkId* sink_id) noexcept;
+
+/// Get the frame to present at |presentation_time_us|, on the clock of
+/// |mrsGetClockTimeUs()|. This is the latest frame whose
+/// |VideoFrameTiming::timestamp_us| is due at that time; older due frames are
+/// dropped as late. If no new frame is due, the last frame is returned again,
+/// and |is_new_frame| is false. The returned frame is valid until the next
+/// call, unless a reference is acquired with |mrsVideoFrameAddRef()|. Return
+/// |MRS_E_NOTFOUND| if no frame was ever due. Frames are dequeued from a
+/// single thread, which can be different from the enqueuing thread.
+MRS_API mrsResult MRS_CALL
+mrsVideoFrameQueueTryDequeue(VideoFrameQueueHandle handle,
+                             int64_t presentation_time_us,
+                             VideoFrameInfo* frame,
+                             mrsBool* is_new_frame) noexcept;
+
+/// Get the statistics of a video frame queue. This can be called from any
+/// thread.
+MRS_API mrsResult MRS_CALL
+mrsVideoFrameQueueGetStats(VideoFrameQueueHandle handle,
+                           VideoFrameQueueStats* stats) noexcept;
+
+//
+// Mosaic
+//
+
+/// Create a mosaic composing the frames of several video tracks into the
+/// caller-owned |canvas|, on a grid of tiles described by |config|. The canvas
+/// must be in the format of the configuration, must outlive the mosaic, and is
+/// cleared to black. The mosaic is returned with one reference, to be released
+/// with |mrsVideoMosaicRemoveRef()|.
+///
+/// Each tile is fed by the video sinks added with
+/// |mrsVideoMosaicAddLocalVideoSink()| and |mrsVideoMosaicAddRemoteVideoSink()|.
+/// A tile keeps the frame delivered last, from whichever thread, so it shows a
+/// single track only if fed by that track.
+MRS_API mrsResult MRS_CALL
+mrsVideoMosaicCreate(VideoMosaicConfiguration config,
+                     const VideoFrameInfo* canvas,
+                     VideoMosaicHandle* handle) noexcept;
+
+/// Add a reference to the video mosaic associated with the given handle.
+MRS_API void MRS_CALL
+mrsVideoMosaicAddRef(VideoMosaicHandle handle) noexcept;
+
+/// Remove a reference from the video mosaic associated with the given handle,
+/// destroying the mosaic and releasing its pending frames with the last one.
+MRS_API void MRS_CALL
+mrsVideoMosaicRemoveRef(VideoMosaicHandle handle) noexcept;
+
+/// Add a video sink handing over the frames captured by the local video track
+/// |track_handle| to the tile |tile_index| of the mosaic |handle|, in row-major
+/// order of the grid, without copying them. The sink must deliver I420A frames.
+/// A frame not composed yet is replaced by the next one. The sink holds a
+/// reference to the mosaic until it is removed with
+/// |mrsLocalVideoTrackRemoveSink()| and done with its last frame.
+MRS_API mrsResult MRS_CALL
+mrsVideoMosaicAddLocalVideoSink(VideoMosaicHandle handle,
+                                int32_t tile_index,
+                                LocalVideoTrackHandle track_handle,
+                                VideoSinkConfiguration config,
+                                VideoSinkId* sink_id) noexcept;
+
+/// Add a video sink handing over the remote video frames of the peer
+/// connection |peer_handle| to the tile |tile_index| of the mosaic |handle|,
+/// like |mrsVideoMosaicAddLocalVideoSink()|. The sink is removed with
+/// |mrsPeerConnectionRemoveRemoteVideoSink()|.
+MRS_API mrsResult MRS_CALL
+mrsVideoMosaicAddRemoteVideoSink(VideoMosaicHandle handle,
+                                 int32_t tile_index,
+                                 PeerConnectionHandle peer_handle,
+                                 VideoSinkConfiguration config,
+                                 VideoSinkId* sink_id) noexcept;
+
+/// Clear the tile |tile_index| to black at the next composition, for example
+/// once its video track was removed.
+MRS_API mrsResult MRS_CALL
+mrsVideoMosaicClearTile(VideoMosaicHandle handle, int32_t tile_index) noexcept;
+
+/// Scale and draw into the canvas the tiles which received a new frame since
+/// the last call, leaving the other tiles untouched. On return, |updated| is
+/// true if the canvas changed. The canvas must not be accessed during this
+/// call. The canvas is composed from a single thread, which can be different
+/// from the threads feeding the tiles.
+MRS_API mrsResult MRS_CALL mrsVideoMosaicCompose(VideoMosaicHandle handle,
+                                                 mrsBool* updated) noexcept;
+
+/// Get the statistics of a video mosaic. This can be called from any thread.
+MRS_API mrsResult MRS_CALL
+mrsVideoMosaicGetStats(VideoMosaicHandle handle,
+                       VideoMosaicStats* stats) noexcept;
+
+//
+// Tensor conversion
+//
+
+/// Create a converter of video frames into the planar float tensors described
+/// by |config|, for the input of machine learning models. The converter is
+/// returned with one reference, to be released with
+/// |mrsVideoTensorConverterRemoveRef()|.
+///
+/// Frames are converted either into caller-owned tensors with
+/// |mrsVideoTensorConverterConvert()|, or, for the video sinks added with
+/// |mrsVideoTensorConverterAddLocalVideoSink()| and
+/// |mrsVideoTensorConverterAddRemoteVideoSink()|, into a tensor owned by the
+/// converter and passed to |callback|.
+MRS_API mrsResult MRS_CALL
+mrsVideoTensorConverterCreate(VideoTensorConfiguration config,
+                              VideoTensorCallback callback,
+                              void* user_data,
+                              VideoTensorConverterHandle* handle) noexcept;
+
+/// Add a reference to the tensor converter associated with the given handle.
+MRS_API void MRS_CALL
+mrsVideoTensorConverterAddRef(VideoTensorConverterHandle handle) noexcept;
+
+/// Remove a reference from the tensor converter associated with the given
+/// handle, destroying the converter with the last one.
+MRS_API void MRS_CALL
+mrsVideoTensorConverterRemoveRef(VideoTensorConverterHandle handle) noexcept;
+
+/// Get the number of floats of the tensors of the converter, which is 3 times
+/// the number of pixels of the tensor.
+MRS_API mrsResult MRS_CALL
+mrsVideoTensorConverterGetTensorSize(VideoTensorConverterHandle handle,
+                                     uint64_t* size) noexcept;
+
+/// Convert the I420 or I420A frame |frame| into the caller-owned |tensor| of
+/// |tensor_size| floats, for example the input buffer of an inference runtime,
+/// and describe the result in |info|. Fails with |MRS_E_INVALID_PARAMETER| if
+/// the tensor is too small for the converter.
+MRS_API mrsResult MRS_CALL
+mrsVideoTensorConverterConvert(VideoTensorConverterHandle handle,
+                               const VideoFrameInfo* frame,
+                               float* tensor,
+                               uint64_t tensor_size,
+                               VideoTensorInfo* info) noexcept;
+
+/// Add a video sink converting the frames captured by the local video track
+/// |track_handle| with the tensor converter |handle|, and passing the tensors
+/// to the callback of the converter. The sink must deliver I420A frames; its
+/// maximum resolution and framerate can limit the cost of the conversions.
+/// The sink holds a reference to the converter until it is removed with
+/// |mrsLocalVideoTrackRemoveSink()| and done with its last frame.
+MRS_API mrsResult MRS_CALL
+mrsVideoTensorConverterAddLocalVideoSink(VideoTensorConverterHandle handle,
+                                         LocalVideoTrackHandle track_handle,
+                                         VideoSinkConfiguration config,
+                                         VideoSinkId* sink_id) noexcept;
+
+/// Add a video sink converting the remote video frames of the peer connection
+/// |peer_handle| with the tensor converter |handle|, like
+/// |mrsVideoTensorConverterAddLocalVideoSink()|. The sink is removed with
+/// |mrsPeerConnectionRemoveRemoteVideoSink()|.
+MRS_API mrsResult MRS_CALL
+mrsVideoTensorConverterAddRemoteVideoSink(VideoTensorConverterHandle handle,
+                                          PeerConnectionHandle peer_handle,
+                                          VideoSinkConfiguration config,
+                                          VideoSinkId* sink_id) noexcept;
+
+}  // extern "C"
@@ -0,0 +1,212 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+// This is a precompiled header, it must be on its own, followed by a blank
+// line, to prevent clang-format from reordering it with other headers.
+#include "pch.h"
+
+#include <csetjmp>
+#include <cstdio>
+
+// libjpeg is a C library; the header is not wrapped for C++.
+extern "C" {
+#include "third_party/libjpeg_turbo/jpeglib.h"
+}
+
+#include "jpeg_encoder.h"
+
+namespace {
+
+using namespace Microsoft::MixedReality::WebRTC;
+
+/// Size of the chunks the output buffer grows by.
+constexpr size_t kOutputChunkSize = 16 * 1024;
+
+/// Error manager returning to the encoder with |longjmp()| instead of exiting
+/// the process, which is the default behavior of libjpeg.
+struct ErrorManager {
+  jpeg_error_mgr pub;
+  std::jmp_buf jump_buffer;
+};
+
+void OnError(j_common_ptr cinfo) {
+  auto manager = reinterpret_cast<ErrorManager*>(cinfo->err);
+  char message[JMSG_LENGTH_MAX];
+  (*cinfo->err->format_message)(cinfo, message);
+  RTC_LOG(LS_ERROR) << "Failed to encode JPEG image: " << message;
+  std::longjmp(manager->jump_buffer, 1);
+}
+
+void OnOutputMessage(j_common_ptr /*cinfo*/) {}
+
+/// Destination manager writing into a growing vector.
+struct VectorDestination {
+  jpeg_destination_mgr pub;
+  std::vector<uint8_t>* output;
+};
+
+void InitDestination(j_compress_ptr cinfo) {
+  auto dest = reinterpret_cast<VectorDestination*>(cinfo->dest);
+  dest->output->resize(kOutputChunkSize);
+  dest->pub.next_output_byte = dest->output->data();
+  dest->pub.free_in_buffer = dest->output->size();
+}
+
+boolean EmptyOutputBuffer(j_compress_ptr cinfo) {
+  // libjpeg only calls this once the whole buffer is full.
+  auto dest = reinterpret_cast<VectorDestination*>(cinfo->dest);
+  const size_t used = dest->output->size();
+  dest->output->resize(used + kOutputChunkSize);
+  dest->pub.next_output_byte = dest->output->data() + used;
+  dest->pub.free_in_buffer = kOutputChunkSize;
+  return TRUE;
+}
+
+void TermDestination(j_compress_ptr cinfo) {
+  auto dest = reinterpret_cast<VectorDestination*>(cinfo->dest);
+  dest->output->resize(dest->output->size() - dest->pub.free_in_buffer);
+}
+
+/// Lookup tables expanding limited-range samples to the full range.
+struct RangeTables {
+  RangeTables() noexcept {
+    for (int i = 0; i < 256; ++i) {
+      const long y = std::lround((i - 16) * 255.0 / 219.0);
+      const long c = std::lround((i - 128) * 255.0 / 224.0) + 128;
+      luma[i] = static_cast<JSAMPLE>(std::clamp(y, 0L, 255L));
+      chroma[i] = static_cast<JSAMPLE>(std::clamp(c, 0L, 255L));
+    }
+  }
+  JSAMPLE luma[256];
+  JSAMPLE chroma[256];
+};
+
+/// Copy |num_rows| rows of |width| samples of |plane| starting at |row| into
+/// |dst| rows of |dst_width| samples, expanding the range with |table|. Rows
+/// past |height| and samples past |width| replicate the last ones, as libjpeg
+/// expects raw data padded to whole blocks.
+void CopyRows(const uint8_t* plane,
+              int stride,
+              int width,
+              int height,
+              int row,
+              int num_rows,
+              const JSAMPLE* table,
+              JSAMPLE* dst,
+              int dst_width,
+              JSAMPROW* rows) noexcept {
+  for (int j = 0; j < num_rows; ++j) {
+    const uint8_t* src =
+        plane + static_cast<ptrdiff_t>(std::min(row + j, height - 1)) * stride;
+    JSAMPLE* const out = dst + static_cast<ptrdiff_t>(j) * dst_width;
+    for (int i = 0; i < width; ++i) {
+      out[i] = table[src[i]];
+    }
+    std::fill(out + width, out + dst_width, out[width - 1]);
+    rows[j] = out;
+  }
+}
+
+/// Run the libjpeg compression of |frame|. This is kept free of objects with
+/// destructors, which |longjmp()| would skip on error.
+bool Compress(jpeg_compress_struct& cinfo,
+              VectorDestination& dest,
+              const VideoFrameInfo& frame,
+              int quality,
+              JSAMPLE* y_rows,
+              JSAMPLE* u_rows,
+              JSAMPLE* v_rows,
+              int padded_width) noexcept {
+  ErrorManager& error = *reinterpret_cast<ErrorManager*>(cinfo.err);
+  if (setjmp(error.jump_buffer)) {
+    return false;
+  }
+
+  // This clears all the fields of |cinfo| except the error manager.
+  jpeg_create_compress(&cinfo);
+  cinfo.dest = &dest.pub;
+  cinfo.image_width = frame.width;
+  cinfo.image_height = frame.height;
+  cinfo.input_components = 3;
+  cinfo.in_color_space = JCS_YCbCr;
+  jpeg_set_defaults(&cinfo);
+  jpeg_set_quality(&cinfo, quality, TRUE);
+  cinfo.raw_data_in = TRUE;
+  cinfo.comp_info[0].h_samp_factor = 2;
+  cinfo.comp_info[0].v_samp_factor = 2;
+  cinfo.comp_info[1].h_samp_factor = 1;
+  cinfo.comp_info[1].v_samp_factor = 1;
+  cinfo.comp_info[2].h_samp_factor = 1;
+  cinfo.comp_info[2].v_samp_factor = 1;
+  jpeg_start_compress(&cinfo, TRUE);
+
+  static const RangeTables tables;
+  const int chroma_width = (frame.width + 1) / 2;
+  const int chroma_height = (frame.height + 1) / 2;
+  const int padded_chroma_width = padded_width / 2;
+  JSAMPROW y_pointers[2 * DCTSIZE];
+  JSAMPROW u_pointers[DCTSIZE];
+  JSAMPROW v_pointers[DCTSIZE];
+  JSAMPARRAY planes[3] = {y_pointers, u_pointers, v_pointers};
+  while (cinfo.next_scanline < cinfo.image_height) {
+    // One row of 16x16 MCUs, with 8 chroma rows per 16 luma rows.
+    const int row = static_cast<int>(cinfo.next_scanline);
+    CopyRows(static_cast<const uint8_t*>(frame.data[0]), frame.stride[0],
+             frame.width, frame.height, row, 2 * DCTSIZE, tables.luma, y_rows,
+             padded_width, y_pointers);
+    CopyRows(static_cast<const uint8_t*>(frame.data[1]), frame.stride[1],
+             chroma_width, chroma_height, row / 2, DCTSIZE, tables.chroma,
+             u_rows, padded_chroma_width, u_pointers);
+    CopyRows(static_cast<const uint8_t*>(frame.data[2]), frame.stride[2],
+             chroma_width, chroma_height, row / 2, DCTSIZE, tables.chroma,
+             v_rows, padded_chroma_width, v_pointers);
+    jpeg_write_raw_data(&cinfo, planes, 2 * DCTSIZE);
+  }
+  jpeg_finish_compress(&cinfo);
+  return true;
+}
+
+}  // namespace
+
+namespace Microsoft::MixedReality::WebRTC {
+
+bool EncodeJpeg(const VideoFrameInfo& frame,
+                int quality,
+                std::vector<uint8_t>& jpeg) noexcept {
+  if ((frame.format != VideoFrameFormat::kI420A) || (frame.width <= 0) ||
+      (frame.height <= 0) || !frame.data[0] || !frame.data[1] ||
+      !frame.data[2]) {
+    return false;
+  }
+
+  // Scratch rows for one row of MCUs, padded to whole MCUs.
+  constexpr int kMcuSize = 2 * DCTSIZE;
+  const int padded_width = (frame.width + kMcuSize - 1) & ~(kMcuSize - 1);
+  std::vector<JSAMPLE> scratch(static_cast<size_t>(padded_width) * 3 *
+                               DCTSIZE);
+  JSAMPLE* const y_rows = scratch.data();
+  JSAMPLE* const u_rows = y_rows + padded_width * 2 * DCTSIZE;
+  JSAMPLE* const v_rows = u_rows + padded_width / 2 * DCTSIZE;
+
+  jpeg_compress_struct cinfo{};
+  ErrorManager error{};
+  cinfo.err = jpeg_std_error(&error.pub);
+  error.pub.error_exit = &OnError;
+  error.pub.output_message = &OnOutputMessage;
+  VectorDestination dest{};
+  dest.pub.init_destination = &InitDestination;
+  dest.pub.empty_output_buffer = &EmptyOutputBuffer;
+  dest.pub.term_destination = &TermDestination;
+  dest.output = &jpeg;
+
+  const bool success =
+      Compress(cinfo, dest, frame, std::clamp(quality, 1, 100), y_rows, u_rows,
+               v_rows, padded_width);
+  jpeg_destroy_compress(&cinfo);
+  if (!success) {
+    jpeg.clear();
+  }
+  return success;
+}
+
+}  // namespace Microsoft::MixedReality::WebRTC
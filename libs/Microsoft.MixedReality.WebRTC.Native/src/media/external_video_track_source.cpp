@@ -0,0 +1,237 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+// This is a precompiled header, it must be on its own, followed by a blank
+// line, to prevent clang-format from reordering it with other headers.
+#include "pch.h"
+
+#include "common_video/include/i420_buffer_pool.h"
+#include "common_video/include/video_frame_buffer.h"
+
+#include "external_video_track_source.h"
+
+namespace Microsoft::MixedReality::WebRTC {
+
+/// Thread-safe wrapper for |webrtc::I420BufferPool|, which must otherwise be
+/// used from a single thread at a time.
+class ExternalVideoTrackSource::BufferPool {
+ public:
+  rtc::scoped_refptr<webrtc::I420Buffer> CreateBuffer(int width, int height) {
+    auto lock = std::scoped_lock{mutex_};
+    return pool_.CreateBuffer(width, height);
+  }
+
+ private:
+  std::mutex mutex_;
+  webrtc::I420BufferPool pool_;
+};
+
+}  // namespace Microsoft::MixedReality::WebRTC
+
+namespace {
+
+using namespace Microsoft::MixedReality::WebRTC;
+
+const uint8_t* Plane(const VideoFrameInfo& frame, int plane) noexcept {
+  return static_cast<const uint8_t*>(frame.data[plane]);
+}
+
+/// Convert an I420, I420A, NV12 or ARGB frame to I420 into |dst|.
+void ConvertToI420(const VideoFrameInfo& src, webrtc::I420Buffer& dst) {
+  uint8_t* yptr = dst.MutableDataY();
+  uint8_t* uptr = dst.MutableDataU();
+  uint8_t* vptr = dst.MutableDataV();
+  switch (src.format) {
+    case VideoFrameFormat::kI420A:
+      libyuv::I420Copy(Plane(src, 0), src.stride[0], Plane(src, 1),
+                       src.stride[1], Plane(src, 2), src.stride[2], yptr,
+                       dst.StrideY(), uptr, dst.StrideU(), vptr, dst.StrideV(),
+                       src.width, src.height);
+      break;
+    case VideoFrameFormat::kNv12:
+      libyuv::NV12ToI420(Plane(src, 0), src.stride[0], Plane(src, 1),
+                         src.stride[1], yptr, dst.StrideY(), uptr,
+                         dst.StrideU(), vptr, dst.StrideV(), src.width,
+                         src.height);
+      break;
+    case VideoFrameFormat::kArgb32:
+      libyuv::ARGBToI420(Plane(src, 0), src.stride[0], yptr, dst.StrideY(),
+                         uptr, dst.StrideU(), vptr, dst.StrideV(), src.width,
+                         src.height);
+      break;
+    default:
+      RTC_NOTREACHED();
+      break;
+  }
+}
+
+/// Frame buffer wrapping the NV12 or ARGB pixel data of an application frame
+/// without copying it, converted to I420 on demand for the consumers which
+/// need it.
+///
+/// The conversion is done at most once, into a pooled buffer, and shared by
+/// all the consumers of the frame, like the encoders of several peer
+/// connections sending the same source and the local sinks. Once converted,
+/// the application buffers are not needed anymore, so the release callback is
+/// invoked right away instead of on destruction.
+class ExternalFrameBuffer : public webrtc::VideoFrameBuffer {
+ public:
+  ExternalFrameBuffer(const VideoFrameInfo& frame,
+                      ExternalVideoFrameReleaseCallback release_callback,
+                      std::function<rtc::scoped_refptr<webrtc::I420Buffer>(
+                          int, int)> create_buffer) noexcept
+      : frame_(frame),
+        release_callback_(release_callback),
+        create_buffer_(std::move(create_buffer)) {}
+
+  ~ExternalFrameBuffer() override {
+    if (!i420_buffer_) {
+      release_callback_();
+    }
+  }
+
+  Type type() const override { return Type::kNative; }
+  int width() const override { return frame_.width; }
+  int height() const override { return frame_.height; }
+
+  rtc::scoped_refptr<webrtc::I420BufferInterface> ToI420() override {
+    auto lock = std::scoped_lock{mutex_};
+    if (!i420_buffer_) {
+      rtc::scoped_refptr<webrtc::I420Buffer> buffer =
+          create_buffer_(frame_.width, frame_.height);
+      ConvertToI420(frame_, *buffer);
+      i420_buffer_ = std::move(buffer);
+      release_callback_();
+    }
+    return i420_buffer_;
+  }
+
+ private:
+  const VideoFrameInfo frame_;
+  const ExternalVideoFrameReleaseCallback release_callback_;
+  const std::function<rtc::scoped_refptr<webrtc::I420Buffer>(int, int)>
+      create_buffer_;
+
+  std::mutex mutex_;
+
+  /// Frame converted by the first call to |ToI420()|, after which the
+  /// application buffers of |frame_| are released and must not be accessed.
+  rtc::scoped_refptr<webrtc::I420BufferInterface> i420_buffer_;
+};
+
+/// Check that |frame| describes a frame which can be pushed to the source.
+bool IsValidFrame(const VideoFrameInfo& frame) noexcept {
+  if ((frame.width <= 0) || (frame.height <= 0) || !frame.data[0]) {
+    return false;
+  }
+  switch (frame.rotation) {
+    case VideoRotation::kRotation0:
+    case VideoRotation::kRotation90:
+    case VideoRotation::kRotation180:
+    case VideoRotation::kRotation270:
+      break;
+    default:
+      return false;
+  }
+  const int chroma_width = (frame.width + 1) / 2;
+  switch (frame.format) {
+    case VideoFrameFormat::kI420A:
+      return frame.data[1] && frame.data[2] &&
+             (frame.stride[0] >= frame.width) &&
+             (frame.stride[1] >= chroma_width) &&
+             (frame.stride[2] >= chroma_width) &&
+             (!frame.data[3] || (frame.stride[3] >= frame.width));
+    case VideoFrameFormat::kNv12:
+      return frame.data[1] && (frame.stride[0] >= frame.width) &&
+             (frame.stride[1] >= chroma_width * 2);
+    case VideoFrameFormat::kArgb32:
+      return (frame.stride[0] >= frame.width * 4);
+    default:
+      return false;
+  }
+}
+
+}  // namespace
+
+namespace Microsoft::MixedReality::WebRTC {
+
+rtc::scoped_refptr<ExternalVideoTrackSource>
+ExternalVideoTrackSource::Create() noexcept {
+  return new rtc::RefCountedObject<ExternalVideoTrackSource>();
+}
+
+ExternalVideoTrackSource::ExternalVideoTrackSource() noexcept
+    : source_pool_(std::make_shared<BufferPool>()),
+      adapted_pool_(std::make_shared<BufferPool>()) {}
+
+mrsResult ExternalVideoTrackSource::PushFrame(
+    const VideoFrameInfo& frame,
+    ExternalVideoFrameReleaseCallback release_callback) noexcept {
+  if (!IsValidFrame(frame)) {
+    release_callback();
+    return MRS_E_INVALID_PARAMETER;
+  }
+  const int64_t timestamp_us =
+      (frame.timing.timestamp_us != 0 ? frame.timing.timestamp_us
+                                      : rtc::TimeMicros());
+  int adapted_width;
+  int adapted_height;
+  int crop_width;
+  int crop_height;
+  int crop_x;
+  int crop_y;
+  if (!AdaptFrame(frame.width, frame.height, timestamp_us, &adapted_width,
+                  &adapted_height, &crop_width, &crop_height, &crop_x,
+                  &crop_y)) {
+    // Dropped to honor the frame rate requested by the sinks.
+    release_callback();
+    return MRS_SUCCESS;
+  }
+
+  rtc::scoped_refptr<webrtc::VideoFrameBuffer> buffer;
+  if (!release_callback) {
+    // Copy the frame before returning, converting it to I420 at once.
+    rtc::scoped_refptr<webrtc::I420Buffer> i420_buffer =
+        source_pool_->CreateBuffer(frame.width, frame.height);
+    ConvertToI420(frame, *i420_buffer);
+    buffer = std::move(i420_buffer);
+  } else if (frame.format == VideoFrameFormat::kI420A) {
+    auto release = [release_callback]() { release_callback(); };
+    if (frame.data[3]) {
+      buffer = webrtc::WrapI420ABuffer(
+          frame.width, frame.height, Plane(frame, 0), frame.stride[0],
+          Plane(frame, 1), frame.stride[1], Plane(frame, 2), frame.stride[2],
+          Plane(frame, 3), frame.stride[3], release);
+    } else {
+      buffer = webrtc::WrapI420Buffer(
+          frame.width, frame.height, Plane(frame, 0), frame.stride[0],
+          Plane(frame, 1), frame.stride[1], Plane(frame, 2), frame.stride[2],
+          release);
+    }
+  } else {
+    std::shared_ptr<BufferPool> pool = source_pool_;
+    buffer = new rtc::RefCountedObject<ExternalFrameBuffer>(
+        frame, release_callback, [pool](int width, int height) {
+          return pool->CreateBuffer(width, height);
+        });
+  }
+
+  if ((adapted_width != frame.width) || (adapted_height != frame.height)) {
+    // Downscale as requested by the encoder adaptation, releasing the
+    // application buffers once done.
+    rtc::scoped_refptr<webrtc::I420BufferInterface> i420_buffer =
+        buffer->ToI420();
+    rtc::scoped_refptr<webrtc::I420Buffer> scaled_buffer =
+        adapted_pool_->CreateBuffer(adapted_width, adapted_height);
+    scaled_buffer->CropAndScaleFrom(*i420_buffer, crop_x, crop_y, crop_width,
+                                    crop_height);
+    buffer = std::move(scaled_buffer);
+  }
+
+  OnFrame(webrtc::VideoFrame(
+      buffer, static_cast<webrtc::VideoRotation>(frame.rotation),
+      timestamp_us));
+  return MRS_SUCCESS;
+}
+
+}  // namespace Microsoft::MixedReality::WebRTC
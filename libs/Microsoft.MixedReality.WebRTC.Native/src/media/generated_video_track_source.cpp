@@ -0,0 +1,90 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+// This is a precompiled header, it must be on its own, followed by a blank
+// line, to prevent clang-format from reordering it with other headers.
+#include "pch.h"
+
+#include "generated_video_track_source.h"
+
+namespace {
+
+/// Release callback of the generated frames, releasing the reference to the
+/// owner of their pixel data.
+void MRS_CALL ReleaseFrameOwner(void* user_data) noexcept {
+  static_cast<rtc::RefCountInterface*>(user_data)->Release();
+}
+
+}  // namespace
+
+namespace Microsoft::MixedReality::WebRTC {
+
+rtc::scoped_refptr<GeneratedVideoTrackSource> GeneratedVideoTrackSource::Create(
+    std::unique_ptr<VideoFrameGenerator> generator,
+    double framerate) noexcept {
+  RTC_DCHECK(generator);
+  rtc::scoped_refptr<GeneratedVideoTrackSource> source =
+      new rtc::RefCountedObject<GeneratedVideoTrackSource>(std::move(generator),
+                                                           framerate);
+  source->Start();
+  return source;
+}
+
+GeneratedVideoTrackSource::GeneratedVideoTrackSource(
+    std::unique_ptr<VideoFrameGenerator> generator,
+    double framerate) noexcept
+    : generator_(std::move(generator)),
+      frame_interval_us_(static_cast<int64_t>(
+          rtc::kNumMicrosecsPerSec /
+          (framerate > 0.0 ? framerate : generator_->framerate()))) {
+  RTC_DCHECK_GT(frame_interval_us_, 0);
+}
+
+GeneratedVideoTrackSource::~GeneratedVideoTrackSource() {
+  {
+    auto lock = std::scoped_lock{mutex_};
+    stopping_ = true;
+  }
+  cv_.notify_one();
+  if (thread_.joinable()) {
+    thread_.join();
+  }
+}
+
+void GeneratedVideoTrackSource::Start() noexcept {
+  thread_ = std::thread([this]() { Run(); });
+}
+
+void GeneratedVideoTrackSource::Run() noexcept {
+  const int64_t start_time_us = rtc::TimeMicros();
+  int64_t frame_index = 0;
+  std::unique_lock<std::mutex> lock{mutex_};
+  for (;;) {
+    const int64_t due_time_us =
+        start_time_us + frame_index * frame_interval_us_;
+    const auto delay =
+        std::chrono::microseconds(due_time_us - rtc::TimeMicros());
+    if (cv_.wait_for(lock, delay, [this]() { return stopping_; })) {
+      return;
+    }
+
+    // Generate and push the frame without holding the lock, so that the
+    // source can be destroyed in the meantime without waiting for the delay.
+    lock.unlock();
+    VideoFrameInfo frame{};
+    rtc::scoped_refptr<rtc::RefCountInterface> owner;
+    if (!generator_->NextFrame(frame, owner)) {
+      return;  // end of stream
+    }
+    RTC_DCHECK(owner);
+    frame.timing.timestamp_us = due_time_us;
+    PushFrame(frame, ExternalVideoFrameReleaseCallback{&ReleaseFrameOwner,
+                                                       owner.release()});
+    lock.lock();
+
+    const int64_t elapsed_us = rtc::TimeMicros() - start_time_us;
+    frame_index = std::max(frame_index + 1, elapsed_us / frame_interval_us_);
+  }
+}
+
+}  // namespace Microsoft::MixedReality::WebRTC
@@ -12,15 +12,17 @@ LocalVideoTrack::LocalVideoTrack(
     PeerConnection& owner,
     rtc::scoped_refptr<webrtc::VideoTrackInterface> track,
     rtc::scoped_refptr<webrtc::RtpSenderInterface> sender,
-    mrsLocalVideoTrackInteropHandle interop_handle) noexcept
+    rtc::scoped_refptr<ProcessedVideoTrackSource> source,
+    mrsLocalVideoTrackInteropHandle interop_handle,
+    std::optional<VideoCaptureFormatInfo> capture_format) noexcept
     : owner_(&owner),
       track_(std::move(track)),
       sender_(std::move(sender)),
-      interop_handle_(interop_handle) {
+      source_(std::move(source)),
+      interop_handle_(interop_handle),
+      capture_format_(std::move(capture_format)) {
   RTC_CHECK(owner_);
-  rtc::VideoSinkWants sink_settings{};
-  sink_settings.rotation_applied = true;
-  track_->AddOrUpdateSink(this, sink_settings);
+  track_->AddOrUpdateSink(this, GetSinkWants());
 }
 
 LocalVideoTrack::~LocalVideoTrack() {
@@ -39,6 +41,63 @@ void LocalVideoTrack::SetEnabled(bool enabled) const noexcept {
   track_->set_enabled(enabled);
 }
 
+void LocalVideoTrack::SetApplyRotation(bool apply_rotation) noexcept {
+  VideoFrameObserver::SetApplyRotation(apply_rotation);
+  track_->AddOrUpdateSink(this, GetSinkWants());
+}
+
+mrsResult LocalVideoTrack::SetStaticFrameDetection(
+    const StaticFrameDetectionConfiguration& config) noexcept {
+  if (!source_) {
+    return MRS_E_INVALID_OPERATION;
+  }
+  return source_->SetStaticFrameDetection(config);
+}
+
+mrsResult LocalVideoTrack::GetStaticFrameStats(StaticFrameStats& stats) const
+    noexcept {
+  if (!source_) {
+    return MRS_E_INVALID_OPERATION;
+  }
+  source_->GetStaticFrameStats(stats);
+  return MRS_SUCCESS;
+}
+
+mrsResult LocalVideoTrack::AddFrameProcessor(
+    const VideoFrameProcessorConfiguration& config,
+    int& index) noexcept {
+  if (!source_) {
+    return MRS_E_INVALID_OPERATION;
+  }
+  return source_->AddFrameProcessor(config, index);
+}
+
+mrsResult LocalVideoTrack::ClearFrameProcessors() noexcept {
+  if (!source_) {
+    return MRS_E_INVALID_OPERATION;
+  }
+  source_->ClearFrameProcessors();
+  return MRS_SUCCESS;
+}
+
+mrsResult LocalVideoTrack::GetFrameProcessorStats(
+    int index,
+    VideoFrameProcessorStats& stats) const noexcept {
+  if (!source_) {
+    return MRS_E_INVALID_OPERATION;
+  }
+  return source_->GetFrameProcessorStats(index, stats);
+}
+
+mrsResult LocalVideoTrack::GetCaptureFormat(
+    VideoCaptureFormatInfo& format) const noexcept {
+  if (!capture_format_) {
+    return MRS_E_INVALID_OPERATION;
+  }
+  format = *capture_format_;
+  return MRS_SUCCESS;
+}
+
 void LocalVideoTrack::RemoveFromPeerConnection(
     webrtc::PeerConnectionInterface& peer) {
   if (sender_) {
@@ -48,4 +107,4 @@ void LocalVideoTrack::RemoveFromPeerConnection(
   }
 }
 
-}  // namespace Microsoft::MixedReality::WebRTC
+}  // namespace Microsoft::MixedReality::WebRTC
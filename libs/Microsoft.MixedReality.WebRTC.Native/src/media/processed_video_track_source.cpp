@@ -0,0 +1,168 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+// This is a precompiled header, it must be on its own, followed by a blank
+// line, to prevent clang-format from reordering it with other headers.
+#include "pch.h"
+
+#include "processed_video_track_source.h"
+
+namespace Microsoft::MixedReality::WebRTC {
+
+rtc::scoped_refptr<ProcessedVideoTrackSource> ProcessedVideoTrackSource::Create(
+    rtc::scoped_refptr<webrtc::VideoTrackSourceInterface> source) noexcept {
+  RTC_DCHECK(source);
+  return new rtc::RefCountedObject<ProcessedVideoTrackSource>(
+      std::move(source));
+}
+
+ProcessedVideoTrackSource::ProcessedVideoTrackSource(
+    rtc::scoped_refptr<webrtc::VideoTrackSourceInterface> source) noexcept
+    : source_(std::move(source)) {
+  source_->RegisterObserver(this);
+}
+
+ProcessedVideoTrackSource::~ProcessedVideoTrackSource() {
+  source_->UnregisterObserver(this);
+  source_->RemoveSink(this);
+}
+
+mrsResult ProcessedVideoTrackSource::SetStaticFrameDetection(
+    const StaticFrameDetectionConfiguration& config) noexcept {
+  if (config.keepalive_interval_ms < 0) {
+    return MRS_E_INVALID_PARAMETER;
+  }
+  std::shared_ptr<StaticFrameDetector> detector;
+  if (config.enabled != mrsBool::kFalse) {
+    detector = std::make_shared<StaticFrameDetector>(
+        config.keepalive_interval_ms * rtc::kNumMicrosecsPerMillisec);
+  }
+  stages_.Update([&detector](Stages& stages) {
+    stages.static_frame_detector = detector;
+  });
+  return MRS_SUCCESS;
+}
+
+void ProcessedVideoTrackSource::GetStaticFrameStats(
+    StaticFrameStats& stats) const noexcept {
+  stats = StaticFrameStats{};
+  stages_.Read([&stats](const Stages& stages) {
+    if (stages.static_frame_detector) {
+      stages.static_frame_detector->GetStats(stats);
+    }
+  });
+}
+
+mrsResult ProcessedVideoTrackSource::AddFrameProcessor(
+    const VideoFrameProcessorConfiguration& config,
+    int& index) noexcept {
+  std::unique_ptr<VideoFrameProcessor> processor;
+  mrsResult result = VideoFrameProcessor::Create(config, processor);
+  if (result != MRS_SUCCESS) {
+    return result;
+  }
+  auto stage = std::make_shared<ProcessorStage>(std::move(processor));
+  stages_.Update([&stage, &index](Stages& stages) {
+    index = static_cast<int>(stages.processors.size());
+    stages.processors.push_back(stage);
+  });
+  return MRS_SUCCESS;
+}
+
+void ProcessedVideoTrackSource::ClearFrameProcessors() noexcept {
+  stages_.Update([](Stages& stages) { stages.processors.clear(); });
+}
+
+mrsResult ProcessedVideoTrackSource::GetFrameProcessorStats(
+    int index,
+    VideoFrameProcessorStats& stats) const noexcept {
+  mrsResult result = MRS_E_INVALID_PARAMETER;
+  stages_.Read([index, &stats, &result](const Stages& stages) {
+    if ((index < 0) || (index >= static_cast<int>(stages.processors.size()))) {
+      return;
+    }
+    const ProcessorStage& stage = *stages.processors[index];
+    stats.processed_frames =
+        stage.processed_frames.load(std::memory_order_relaxed);
+    stats.dropped_frames = stage.dropped_frames.load(std::memory_order_relaxed);
+    stats.total_time_us = stage.total_time_us.load(std::memory_order_relaxed);
+    stats.max_time_us = stage.max_time_us.load(std::memory_order_relaxed);
+    result = MRS_SUCCESS;
+  });
+  return result;
+}
+
+void ProcessedVideoTrackSource::AddOrUpdateSink(
+    rtc::VideoSinkInterface<webrtc::VideoFrame>* sink,
+    const rtc::VideoSinkWants& wants) {
+  auto lock = std::scoped_lock{sink_mutex_};
+  broadcaster_.AddOrUpdateSink(sink, wants);
+  source_->AddOrUpdateSink(this, broadcaster_.wants());
+}
+
+void ProcessedVideoTrackSource::RemoveSink(
+    rtc::VideoSinkInterface<webrtc::VideoFrame>* sink) {
+  auto lock = std::scoped_lock{sink_mutex_};
+  broadcaster_.RemoveSink(sink);
+  if (broadcaster_.frame_wanted()) {
+    source_->AddOrUpdateSink(this, broadcaster_.wants());
+  } else {
+    // Stop the source from producing frames nobody consumes.
+    source_->RemoveSink(this);
+  }
+}
+
+void ProcessedVideoTrackSource::OnFrame(const webrtc::VideoFrame& frame) {
+  bool forward = true;
+  rtc::scoped_refptr<webrtc::I420BufferInterface> processed;
+  stages_.Read([this, &frame, &forward, &processed](const Stages& stages) {
+    if (stages.static_frame_detector) {
+      forward = stages.static_frame_detector->ShouldForward(frame);
+    }
+    if (forward && !stages.processors.empty()) {
+      processed = RunProcessors(stages.processors, frame);
+      forward = (processed != nullptr);
+    }
+  });
+  if (!forward) {
+    return;
+  }
+  if (processed) {
+    broadcaster_.OnFrame(webrtc::VideoFrame(processed, frame.rotation(),
+                                            frame.timestamp_us()));
+  } else {
+    broadcaster_.OnFrame(frame);
+  }
+}
+
+void ProcessedVideoTrackSource::OnDiscardedFrame() {
+  broadcaster_.OnDiscardedFrame();
+}
+
+rtc::scoped_refptr<webrtc::I420BufferInterface>
+ProcessedVideoTrackSource::RunProcessors(
+    const std::vector<std::shared_ptr<ProcessorStage>>& processors,
+    const webrtc::VideoFrame& frame) noexcept {
+  // The source frame may be shared with other consumers, so it is only copied
+  // into a pooled buffer before the first processor modifying it in place.
+  ProcessedFrame processed(frame.video_frame_buffer()->ToI420(),
+                           frame.timestamp_us(), buffer_pool_);
+  for (auto&& stage : processors) {
+    const int64_t start_us = rtc::TimeMicros();
+    const bool keep = stage->processor->Process(processed);
+    const int64_t elapsed_us = rtc::TimeMicros() - start_us;
+    stage->processed_frames.fetch_add(1, std::memory_order_relaxed);
+    stage->total_time_us.fetch_add(elapsed_us, std::memory_order_relaxed);
+    if (elapsed_us > stage->max_time_us.load(std::memory_order_relaxed)) {
+      // Single writer, the thread delivering the source frames.
+      stage->max_time_us.store(elapsed_us, std::memory_order_relaxed);
+    }
+    if (!keep) {
+      stage->dropped_frames.fetch_add(1, std::memory_order_relaxed);
+      return nullptr;
+    }
+  }
+  return processed.Release();
+}
+
+}  // namespace Microsoft::MixedReality::WebRTC
@@ -0,0 +1,81 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+// This is a precompiled header, it must be on its own, followed by a blank
+// line, to prevent clang-format from reordering it with other headers.
+#include "pch.h"
+
+#include "static_frame_detector.h"
+
+namespace {
+
+/// Initial value of the DJB2 hash.
+constexpr uint32_t kDjb2Seed = 5381;
+
+}  // namespace
+
+namespace Microsoft::MixedReality::WebRTC {
+
+StaticFrameDetector::StaticFrameDetector(int64_t keepalive_interval_us) noexcept
+    : keepalive_interval_us_(keepalive_interval_us) {}
+
+bool StaticFrameDetector::ShouldForward(
+    const webrtc::VideoFrame& frame) noexcept {
+  processed_frames_.fetch_add(1, std::memory_order_relaxed);
+  rtc::scoped_refptr<webrtc::I420BufferInterface> buffer =
+      frame.video_frame_buffer()->ToI420();
+  if (!UpdateHashes(*buffer)) {
+    last_forwarded_us_ = frame.timestamp_us();
+    return true;
+  }
+  static_frames_.fetch_add(1, std::memory_order_relaxed);
+  if ((keepalive_interval_us_ > 0) &&
+      (frame.timestamp_us() - last_forwarded_us_ >= keepalive_interval_us_)) {
+    last_forwarded_us_ = frame.timestamp_us();
+    return true;
+  }
+  dropped_frames_.fetch_add(1, std::memory_order_relaxed);
+  return false;
+}
+
+void StaticFrameDetector::GetStats(StaticFrameStats& stats) const noexcept {
+  stats.processed_frames = processed_frames_.load(std::memory_order_relaxed);
+  stats.static_frames = static_frames_.load(std::memory_order_relaxed);
+  stats.dropped_frames = dropped_frames_.load(std::memory_order_relaxed);
+}
+
+bool StaticFrameDetector::UpdateHashes(
+    const webrtc::I420BufferInterface& frame) noexcept {
+  const int width = frame.width();
+  const int height = frame.height();
+  const int chroma_width = frame.ChromaWidth();
+  const int chroma_height = frame.ChromaHeight();
+  bool is_static = true;
+  if ((width != width_) || (height != height_)) {
+    width_ = width;
+    height_ = height;
+    row_hashes_.assign(static_cast<size_t>(height + chroma_height), 0);
+    is_static = false;
+  }
+
+  // Hash all rows even once a difference is found, to compare the next frame.
+  uint32_t* hash = row_hashes_.data();
+  const uint8_t* y = frame.DataY();
+  for (int row = 0; row < height; ++row, ++hash, y += frame.StrideY()) {
+    const uint32_t h = libyuv::HashDjb2(y, width, kDjb2Seed);
+    is_static = is_static && (h == *hash);
+    *hash = h;
+  }
+  const uint8_t* u = frame.DataU();
+  const uint8_t* v = frame.DataV();
+  for (int row = 0; row < chroma_height;
+       ++row, ++hash, u += frame.StrideU(), v += frame.StrideV()) {
+    const uint32_t h = libyuv::HashDjb2(
+        v, chroma_width, libyuv::HashDjb2(u, chroma_width, kDjb2Seed));
+    is_static = is_static && (h == *hash);
+    *hash = h;
+  }
+  return is_static;
+}
+
+}  // namespace Microsoft::MixedReality::WebRTC
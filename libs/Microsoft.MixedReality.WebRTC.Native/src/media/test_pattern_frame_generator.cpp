@@ -0,0 +1,92 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+// This is a precompiled header, it must be on its own, followed by a blank
+// line, to prevent clang-format from reordering it with other headers.
+#include "pch.h"
+
+#include "video_frame_generator.h"
+
+namespace {
+
+/// Limited-range BT.601 YUV color.
+struct YuvColor {
+  uint8_t y;
+  uint8_t u;
+  uint8_t v;
+};
+
+/// 75% color bars: white, yellow, cyan, green, magenta, red, blue, black.
+constexpr YuvColor kColorBars[] = {
+    {180, 128, 128}, {162, 44, 142}, {131, 156, 44}, {112, 72, 58},
+    {84, 184, 198},  {65, 100, 212}, {35, 212, 114}, {16, 128, 128}};
+constexpr int kNumColorBars = sizeof(kColorBars) / sizeof(kColorBars[0]);
+
+/// Horizontal scrolling of the pattern per frame, in pixels. This must be
+/// even to scroll the chroma planes by whole samples.
+constexpr int kScrollPerFrame = 4;
+
+}  // namespace
+
+namespace Microsoft::MixedReality::WebRTC {
+
+TestPatternFrameGenerator::TestPatternFrameGenerator(int width,
+                                                     int height,
+                                                     double framerate) noexcept
+    : width_((width + 1) & ~1),
+      height_((height + 1) & ~1),
+      framerate_(framerate) {
+  RTC_DCHECK_GT(width_, 0);
+  RTC_DCHECK_GT(height_, 0);
+
+  // Render the pattern twice side by side, so that any window of the frame
+  // width starting in the first half wraps around seamlessly.
+  pattern_ = webrtc::I420Buffer::Create(width_ * 2, height_);
+  const int bars_height = (height_ * 3 / 4) & ~1;
+  for (int y = 0; y < height_; ++y) {
+    uint8_t* const row = pattern_->MutableDataY() + y * pattern_->StrideY();
+    for (int x = 0; x < width_; ++x) {
+      const uint8_t luma =
+          (y < bars_height)
+              ? kColorBars[x * kNumColorBars / width_].y
+              : static_cast<uint8_t>(16 + x * 219 / std::max(width_ - 1, 1));
+      row[x] = luma;
+      row[x + width_] = luma;
+    }
+  }
+  const int chroma_width = width_ / 2;
+  for (int y = 0; y < height_ / 2; ++y) {
+    uint8_t* const u_row = pattern_->MutableDataU() + y * pattern_->StrideU();
+    uint8_t* const v_row = pattern_->MutableDataV() + y * pattern_->StrideV();
+    for (int x = 0; x < chroma_width; ++x) {
+      YuvColor color{0, 128, 128};
+      if (y * 2 < bars_height) {
+        color = kColorBars[x * 2 * kNumColorBars / width_];
+      }
+      u_row[x] = u_row[x + chroma_width] = color.u;
+      v_row[x] = v_row[x + chroma_width] = color.v;
+    }
+  }
+}
+
+bool TestPatternFrameGenerator::NextFrame(
+    VideoFrameInfo& frame,
+    rtc::scoped_refptr<rtc::RefCountInterface>& owner) noexcept {
+  const int offset = static_cast<int>(
+      (frame_index_++ * kScrollPerFrame) % static_cast<int64_t>(width_));
+  frame.format = VideoFrameFormat::kI420A;
+  frame.width = width_;
+  frame.height = height_;
+  frame.data[0] = pattern_->DataY() + offset;
+  frame.data[1] = pattern_->DataU() + offset / 2;
+  frame.data[2] = pattern_->DataV() + offset / 2;
+  frame.data[3] = nullptr;
+  frame.stride[0] = pattern_->StrideY();
+  frame.stride[1] = pattern_->StrideU();
+  frame.stride[2] = pattern_->StrideV();
+  frame.stride[3] = 0;
+  owner = pattern_;
+  return true;
+}
+
+}  // namespace Microsoft::MixedReality::WebRTC
@@ -0,0 +1,317 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#include "pch.h"
+
+#include "video_capture_device_cache.h"
+#include "video_capture_format.h"
+
+namespace {
+
+using namespace Microsoft::MixedReality::WebRTC;
+
+#if !defined(WINUWP)
+
+/// Device interface classes of the video capture devices enumerated by
+/// DirectShow: KSCATEGORY_VIDEO, and KSCATEGORY_VIDEO_CAMERA for cameras only
+/// registered under it since Windows 10.
+const GUID kVideoDeviceInterfaceClasses[] = {
+    {0x6994AD05,
+     0x93EF,
+     0x11D0,
+     {0xA3, 0xCC, 0x00, 0xA0, 0xC9, 0x22, 0x31, 0x96}},
+    {0xE5323777,
+     0xF976,
+     0x4F5B,
+     {0x9B, 0x55, 0xB9, 0x46, 0x99, 0xC4, 0x6E, 0x44}},
+};
+
+DWORD CALLBACK OnDeviceInterfaceChange(HCMNOTIFICATION /*notification*/,
+                                       PVOID context,
+                                       CM_NOTIFY_ACTION action,
+                                       PCM_NOTIFY_EVENT_DATA /*event_data*/,
+                                       DWORD /*event_data_size*/) {
+  if ((action == CM_NOTIFY_ACTION_DEVICEINTERFACEARRIVAL) ||
+      (action == CM_NOTIFY_ACTION_DEVICEINTERFACEREMOVAL)) {
+    static_cast<VideoCaptureDeviceCache*>(context)->Invalidate();
+  }
+  return ERROR_SUCCESS;
+}
+
+/// Convert a WebRTC VideoType format into its FOURCC counterpart.
+uint32_t FourCCFromVideoType(webrtc::VideoType videoType) {
+  switch (videoType) {
+    default:
+    case webrtc::VideoType::kUnknown:
+      return (uint32_t)libyuv::FOURCC_ANY;
+    case webrtc::VideoType::kI420:
+      return (uint32_t)libyuv::FOURCC_I420;
+    case webrtc::VideoType::kIYUV:
+      return (uint32_t)libyuv::FOURCC_IYUV;
+    case webrtc::VideoType::kRGB24:
+      // this seems unintuitive, but is how defined in the core implementation
+      return (uint32_t)libyuv::FOURCC_24BG;
+    case webrtc::VideoType::kABGR:
+      return (uint32_t)libyuv::FOURCC_ABGR;
+    case webrtc::VideoType::kARGB:
+      return (uint32_t)libyuv::FOURCC_ARGB;
+    case webrtc::VideoType::kARGB4444:
+      return (uint32_t)libyuv::FOURCC_R444;
+    case webrtc::VideoType::kRGB565:
+      return (uint32_t)libyuv::FOURCC_RGBP;
+    case webrtc::VideoType::kARGB1555:
+      return (uint32_t)libyuv::FOURCC_RGBO;
+    case webrtc::VideoType::kYUY2:
+      return (uint32_t)libyuv::FOURCC_YUY2;
+    case webrtc::VideoType::kYV12:
+      return (uint32_t)libyuv::FOURCC_YV12;
+    case webrtc::VideoType::kUYVY:
+      return (uint32_t)libyuv::FOURCC_UYVY;
+    case webrtc::VideoType::kMJPEG:
+      return (uint32_t)libyuv::FOURCC_MJPG;
+    case webrtc::VideoType::kNV21:
+      return (uint32_t)libyuv::FOURCC_NV21;
+    case webrtc::VideoType::kNV12:
+      return (uint32_t)libyuv::FOURCC_NV12;
+    case webrtc::VideoType::kBGRA:
+      return (uint32_t)libyuv::FOURCC_BGRA;
+  };
+}
+
+#endif  // !defined(WINUWP)
+
+}  // namespace
+
+namespace Microsoft::MixedReality::WebRTC {
+
+VideoCaptureDeviceCache& VideoCaptureDeviceCache::Instance() noexcept {
+  static VideoCaptureDeviceCache cache;
+  return cache;
+}
+
+void VideoCaptureDeviceCache::StopWatching() noexcept {
+  // The notifications invalidate the cache, so do not hold its lock while
+  // waiting for them.
+#if defined(WINUWP)
+  if (watcher_) {
+    watcher_.Stop();
+    watcher_ = nullptr;
+  }
+#else   // defined(WINUWP)
+  // This waits for the callbacks in progress to return.
+  for (HCMNOTIFICATION notification : notifications_) {
+    CM_Unregister_Notification(notification);
+  }
+  notifications_.clear();
+#endif  // defined(WINUWP)
+  auto lock = std::scoped_lock{mutex_};
+  watching_ = false;
+  ++generation_;
+  devices_.reset();
+  formats_.clear();
+}
+
+uint64_t VideoCaptureDeviceCache::generation() const noexcept {
+  auto lock = std::scoped_lock{mutex_};
+  return generation_;
+}
+
+bool VideoCaptureDeviceCache::TryGetDevices(
+    std::vector<CachedVideoCaptureDevice>& devices) const {
+  auto lock = std::scoped_lock{mutex_};
+  if (!devices_) {
+    return false;
+  }
+  devices = *devices_;
+  return true;
+}
+
+bool VideoCaptureDeviceCache::TryGetFormats(
+    const std::string& device_id,
+    std::vector<VideoCaptureFormatInfo>& formats) const {
+  auto lock = std::scoped_lock{mutex_};
+  auto it = formats_.find(device_id);
+  if (it == formats_.end()) {
+    return false;
+  }
+  formats = it->second;
+  return true;
+}
+
+void VideoCaptureDeviceCache::StoreDevices(
+    uint64_t generation,
+    std::vector<CachedVideoCaptureDevice> devices) {
+  auto lock = std::scoped_lock{mutex_};
+  if (watching_ && (generation == generation_)) {
+    devices_ = std::move(devices);
+  }
+}
+
+void VideoCaptureDeviceCache::StoreFormats(
+    uint64_t generation,
+    const std::string& device_id,
+    std::vector<VideoCaptureFormatInfo> formats) {
+  auto lock = std::scoped_lock{mutex_};
+  if (watching_ && (generation == generation_)) {
+    formats_[device_id] = std::move(formats);
+  }
+}
+
+void VideoCaptureDeviceCache::Invalidate() noexcept {
+  auto lock = std::scoped_lock{mutex_};
+  ++generation_;
+  devices_.reset();
+  formats_.clear();
+}
+
+#if defined(WINUWP)
+
+void VideoCaptureDeviceCache::StartWatching() noexcept {
+  using namespace winrt::Windows::Devices::Enumeration;
+  {
+    auto lock = std::scoped_lock{mutex_};
+    if (watching_) {
+      return;
+    }
+    watching_ = true;
+  }
+  try {
+    watcher_ = DeviceInformation::CreateWatcher(DeviceClass::VideoCapture);
+    // The watcher first reports the devices already present, then signals the
+    // end of its initial enumeration, after which all events are changes.
+    auto ready = std::make_shared<std::atomic_bool>(false);
+    watcher_.Added([this, ready](auto&&, auto&&) {
+      if (*ready) {
+        Invalidate();
+      }
+    });
+    watcher_.Removed([this, ready](auto&&, auto&&) {
+      if (*ready) {
+        Invalidate();
+      }
+    });
+    watcher_.EnumerationCompleted(
+        [ready](auto&&, auto&&) { ready->store(true); });
+    watcher_.Start();
+  } catch (const winrt::hresult_error& error) {
+    RTC_LOG(LS_WARNING) << "Failed to watch for video capture device changes: "
+                        << winrt::to_string(error.message());
+    watcher_ = nullptr;
+  }
+}
+
+#else   // defined(WINUWP)
+
+void VideoCaptureDeviceCache::StartWatching() noexcept {
+  {
+    auto lock = std::scoped_lock{mutex_};
+    if (watching_) {
+      return;
+    }
+    watching_ = true;
+  }
+  for (const GUID& interface_class : kVideoDeviceInterfaceClasses) {
+    CM_NOTIFY_FILTER filter{};
+    filter.cbSize = sizeof(filter);
+    filter.FilterType = CM_NOTIFY_FILTER_TYPE_DEVICEINTERFACE;
+    filter.u.DeviceInterface.ClassGuid = interface_class;
+    HCMNOTIFICATION notification{};
+    if (CM_Register_Notification(&filter, this, &OnDeviceInterfaceChange,
+                                 &notification) == CR_SUCCESS) {
+      notifications_.push_back(notification);
+    } else {
+      RTC_LOG(LS_WARNING)
+          << "Failed to watch for video capture device changes.";
+    }
+  }
+}
+
+bool VideoCaptureDeviceCache::Refresh() noexcept {
+  auto refresh_lock = std::scoped_lock{refresh_mutex_};
+  // A device changing while probing makes the results stale, so probe again.
+  constexpr int kMaxAttempts = 3;
+  for (int attempt = 0; attempt < kMaxAttempts; ++attempt) {
+    uint64_t generation;
+    {
+      auto lock = std::scoped_lock{mutex_};
+      if (!watching_) {
+        return false;
+      }
+      if (devices_) {
+        return true;
+      }
+      generation = generation_;
+    }
+    std::vector<CachedVideoCaptureDevice> devices;
+    std::unordered_map<std::string, std::vector<VideoCaptureFormatInfo>>
+        formats;
+    if (!Probe(devices, formats)) {
+      return false;
+    }
+    auto lock = std::scoped_lock{mutex_};
+    if (watching_ && (generation == generation_)) {
+      devices_ = std::move(devices);
+      formats_ = std::move(formats);
+      return true;
+    }
+  }
+  return false;
+}
+
+bool VideoCaptureDeviceCache::GetDevices(
+    std::vector<CachedVideoCaptureDevice>& devices) noexcept {
+  if (TryGetDevices(devices) || (Refresh() && TryGetDevices(devices))) {
+    return true;
+  }
+  // Not watching, so the results cannot be cached.
+  std::unordered_map<std::string, std::vector<VideoCaptureFormatInfo>> formats;
+  devices.clear();
+  return Probe(devices, formats);
+}
+
+bool VideoCaptureDeviceCache::Probe(
+    std::vector<CachedVideoCaptureDevice>& devices,
+    std::unordered_map<std::string, std::vector<VideoCaptureFormatInfo>>&
+        formats) noexcept {
+  std::unique_ptr<webrtc::VideoCaptureModule::DeviceInfo> info(
+      webrtc::VideoCaptureFactory::CreateDeviceInfo());
+  if (!info) {
+    return false;
+  }
+  const int num_devices = info->NumberOfDevices();
+  for (int device_idx = 0; device_idx < num_devices; ++device_idx) {
+    constexpr uint32_t kSize = 256;
+    char name[kSize] = {0};
+    char id[kSize] = {0};
+    if (info->GetDeviceName(device_idx, name, kSize, id, kSize) == -1) {
+      continue;
+    }
+    devices.push_back(CachedVideoCaptureDevice{id, name});
+
+    // Formats of unknown encoding are skipped, as they cannot be selected.
+    std::vector<VideoCaptureFormatInfo>& device_formats = formats[id];
+    const int32_t num_capabilities = info->NumberOfCapabilities(id);
+    for (int32_t cap_idx = 0; cap_idx < num_capabilities; ++cap_idx) {
+      webrtc::VideoCaptureCapability capability{};
+      if (info->GetCapability(id, cap_idx, capability) == -1) {
+        continue;
+      }
+      VideoCaptureFormatInfo format{};
+      format.width = capability.width;
+      format.height = capability.height;
+      format.framerate = capability.maxFPS;
+      format.encoding = FourCCFromVideoType(capability.videoType);
+      if (format.encoding == libyuv::FOURCC_ANY) {
+        continue;
+      }
+      format.cost = GetCaptureFormatCost(format.width, format.height,
+                                         format.framerate, format.encoding);
+      device_formats.push_back(format);
+    }
+  }
+  return true;
+}
+
+#endif  // defined(WINUWP)
+
+}  // namespace Microsoft::MixedReality::WebRTC
@@ -0,0 +1,221 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#include "pch.h"
+
+#include "video_capture_format.h"
+
+namespace {
+
+using namespace Microsoft::MixedReality::WebRTC;
+
+/// Capture format WebRTC defaults to when the resolution or framerate is not
+/// constrained.
+constexpr uint32_t kDefaultWidth = 640;
+constexpr uint32_t kDefaultHeight = 480;
+constexpr double kDefaultFramerate = 30.0;
+
+/// Check if |framerate| passes the framerate constraint |constraint|, which
+/// WebRTC checks with integer bounds.
+bool MatchesFramerate(double framerate, double constraint) noexcept {
+  if (constraint <= 0.0) {
+    return true;
+  }
+  return (framerate >= std::floor(constraint)) &&
+         (framerate <= std::ceil(constraint));
+}
+
+}  // namespace
+
+namespace Microsoft::MixedReality::WebRTC {
+
+uint32_t GetCaptureEncodingPixelCost(uint32_t encoding) noexcept {
+  switch (encoding) {
+    // Native, copied to the frame buffer.
+    case libyuv::FOURCC_I420:
+    case libyuv::FOURCC_IYUV:
+    case libyuv::FOURCC_YV12:
+      return 1;
+    // Semi-planar, chroma deinterleaved.
+    case libyuv::FOURCC_NV12:
+    case libyuv::FOURCC_NV21:
+      return 2;
+    // Packed 4:2:2, unpacked and chroma subsampled.
+    case libyuv::FOURCC_YUY2:
+    case libyuv::FOURCC_UYVY:
+      return 3;
+    // Packed RGB, color converted.
+    case libyuv::FOURCC_ARGB:
+    case libyuv::FOURCC_BGRA:
+    case libyuv::FOURCC_ABGR:
+    case libyuv::FOURCC_24BG:
+    case libyuv::FOURCC_RAW:
+    case libyuv::FOURCC_RGBP:
+    case libyuv::FOURCC_RGBO:
+    case libyuv::FOURCC_R444:
+      return 6;
+    // JPEG decoded, then converted.
+    case libyuv::FOURCC_MJPG:
+      return 20;
+    default:
+      return 32;
+  }
+}
+
+uint64_t GetCaptureFormatCost(uint32_t width,
+                              uint32_t height,
+                              double framerate,
+                              uint32_t encoding) noexcept {
+  const double pixels_per_second =
+      static_cast<double>(width) * height * std::max(framerate, 0.0);
+  return static_cast<uint64_t>(pixels_per_second *
+                               GetCaptureEncodingPixelCost(encoding));
+}
+
+int SelectCaptureFormat(const VideoCaptureFormatInfo* formats,
+                        size_t count,
+                        uint32_t width,
+                        uint32_t height,
+                        double framerate) noexcept {
+  const int64_t target_area =
+      (width > 0 ? width : kDefaultWidth) *
+      static_cast<int64_t>(height > 0 ? height : kDefaultHeight);
+  const double target_framerate =
+      (framerate > 0.0 ? framerate : kDefaultFramerate);
+  int best = -1;
+  int64_t best_area_distance = 0;
+  double best_framerate_distance = 0.0;
+  uint32_t best_pixel_cost = 0;
+  for (size_t i = 0; i < count; ++i) {
+    const VideoCaptureFormatInfo& format = formats[i];
+    if (((width > 0) && (format.width != width)) ||
+        ((height > 0) && (format.height != height)) ||
+        !MatchesFramerate(format.framerate, framerate)) {
+      continue;
+    }
+    const int64_t area_distance = std::abs(
+        static_cast<int64_t>(format.width) * format.height - target_area);
+    const double framerate_distance =
+        std::abs(format.framerate - target_framerate);
+    const uint32_t pixel_cost = GetCaptureEncodingPixelCost(format.encoding);
+    if ((best < 0) || (area_distance < best_area_distance) ||
+        ((area_distance == best_area_distance) &&
+         ((framerate_distance < best_framerate_distance) ||
+          ((framerate_distance == best_framerate_distance) &&
+           (pixel_cost < best_pixel_cost))))) {
+      best = static_cast<int>(i);
+      best_area_distance = area_distance;
+      best_framerate_distance = framerate_distance;
+      best_pixel_cost = pixel_cost;
+    }
+  }
+  return best;
+}
+
+bool SelectLowestCostCaptureFormat(
+    std::unique_ptr<cricket::VideoCapturer>& capturer,
+    const VideoDeviceConfiguration& config,
+    VideoCaptureFormatInfo& selected) noexcept {
+  const std::vector<cricket::VideoFormat>* supported_formats =
+      capturer->GetSupportedFormats();
+  if (!supported_formats || supported_formats->empty()) {
+    RTC_LOG(LS_INFO) << "Video capture device does not list its formats; "
+                        "using the default format selection.";
+    return false;
+  }
+  std::vector<VideoCaptureFormatInfo> formats;
+  formats.reserve(supported_formats->size());
+  for (const cricket::VideoFormat& format : *supported_formats) {
+    VideoCaptureFormatInfo info;
+    info.width = format.width;
+    info.height = format.height;
+    info.framerate = cricket::VideoFormat::IntervalToFpsFloat(format.interval);
+    info.encoding = format.fourcc;
+    formats.push_back(info);
+  }
+  const int index = SelectCaptureFormat(formats.data(), formats.size(),
+                                        config.width, config.height,
+                                        config.framerate);
+  if (index < 0) {
+    RTC_LOG(LS_WARNING) << "No video capture format matches the constraints; "
+                           "using the default format selection.";
+    return false;
+  }
+  selected = formats[index];
+  selected.cost = GetCaptureFormatCost(selected.width, selected.height,
+                                       selected.framerate, selected.encoding);
+  const cricket::VideoFormat& format = (*supported_formats)[index];
+  RTC_LOG(LS_INFO) << "Selected video capture format " << format.ToString()
+                   << " with estimated conversion cost " << selected.cost;
+  capturer = std::make_unique<SelectedFormatVideoCapturer>(std::move(capturer),
+                                                           format);
+  return true;
+}
+
+SelectedFormatVideoCapturer::SelectedFormatVideoCapturer(
+    std::unique_ptr<cricket::VideoCapturer> capturer,
+    const cricket::VideoFormat& format) noexcept
+    : capturer_(std::move(capturer)), format_(format) {
+  SetId(capturer_->GetId());
+  SetSupportedFormats({format_});
+  capturer_->SignalStateChange.connect(
+      this, &SelectedFormatVideoCapturer::OnStateChange);
+}
+
+SelectedFormatVideoCapturer::~SelectedFormatVideoCapturer() {
+  capturer_->SignalStateChange.disconnect(this);
+  capturer_->RemoveSink(this);
+}
+
+cricket::CaptureState SelectedFormatVideoCapturer::Start(
+    const cricket::VideoFormat& format) {
+  capturer_->AddOrUpdateSink(this, GetSinkWants());
+  if (!capturer_->StartCapturing(format)) {
+    capturer_->RemoveSink(this);
+    return cricket::CS_FAILED;
+  }
+  SetCaptureFormat(&format);
+  return capturer_->capture_state();
+}
+
+void SelectedFormatVideoCapturer::Stop() {
+  capturer_->Stop();
+  capturer_->RemoveSink(this);
+  SetCaptureFormat(nullptr);
+}
+
+bool SelectedFormatVideoCapturer::IsRunning() {
+  return capturer_->IsRunning();
+}
+
+bool SelectedFormatVideoCapturer::IsScreencast() const {
+  return capturer_->IsScreencast();
+}
+
+void SelectedFormatVideoCapturer::OnFrame(const webrtc::VideoFrame& frame) {
+  // The wrapped capturer already adapted and rotated the frame as requested
+  // by the sink wants forwarded to it.
+  cricket::VideoCapturer::OnFrame(frame, frame.width(), frame.height());
+}
+
+bool SelectedFormatVideoCapturer::GetPreferredFourccs(
+    std::vector<uint32_t>* fourccs) {
+  fourccs->assign(1, format_.fourcc);
+  return true;
+}
+
+void SelectedFormatVideoCapturer::OnSinkWantsChanged(
+    const rtc::VideoSinkWants& wants) {
+  cricket::VideoCapturer::OnSinkWantsChanged(wants);
+  if (IsRunning()) {
+    capturer_->AddOrUpdateSink(this, wants);
+  }
+}
+
+void SelectedFormatVideoCapturer::OnStateChange(
+    cricket::VideoCapturer* /*capturer*/,
+    cricket::CaptureState state) {
+  SetCaptureState(state);
+}
+
+}  // namespace Microsoft::MixedReality::WebRTC
@@ -0,0 +1,352 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+// This is a precompiled header, it must be on its own, followed by a blank
+// line, to prevent clang-format from reordering it with other headers.
+#include "pch.h"
+
+#include "common_video/include/i420_buffer_pool.h"
+
+#include "video_frame_processor.h"
+
+namespace {
+
+using namespace Microsoft::MixedReality::WebRTC;
+
+/// Area of a frame, with even origin.
+struct Area {
+  int x;
+  int y;
+  int width;
+  int height;
+};
+
+/// Clip the area of |config| to a |width| x |height| frame, rounding its origin
+/// down to even coordinates. Return false if the clipped area is empty.
+bool ClipArea(const VideoFrameProcessorConfiguration& config,
+              int width,
+              int height,
+              Area& area) noexcept {
+  area.x = config.x & ~1;
+  area.y = config.y & ~1;
+  area.width = std::min(config.width, width - area.x);
+  area.height = std::min(config.height, height - area.y);
+  return (area.width > 0) && (area.height > 0);
+}
+
+uint8_t* PlaneAt(uint8_t* plane, int stride, int x, int y) noexcept {
+  return plane + static_cast<ptrdiff_t>(y) * stride + x;
+}
+
+const uint8_t* PlaneAt(const uint8_t* plane,
+                       int stride,
+                       int x,
+                       int y) noexcept {
+  return plane + static_cast<ptrdiff_t>(y) * stride + x;
+}
+
+class CropProcessor : public VideoFrameProcessor {
+ public:
+  explicit CropProcessor(const VideoFrameProcessorConfiguration& config)
+      : config_(config) {}
+
+  bool Process(ProcessedFrame& frame) noexcept override {
+    const webrtc::I420BufferInterface& buffer = frame.buffer();
+    Area area;
+    // Frames not covered by the area are left unchanged.
+    if (!ClipArea(config_, buffer.width(), buffer.height(), area) ||
+        ((area.width == buffer.width()) && (area.height == buffer.height()))) {
+      return true;
+    }
+    rtc::scoped_refptr<webrtc::I420Buffer> cropped =
+        pool_.CreateBuffer(area.width, area.height);
+    if (!cropped) {
+      return false;
+    }
+    CropI420(buffer, area.x, area.y, *cropped);
+    frame.SetBuffer(std::move(cropped));
+    return true;
+  }
+
+ private:
+  const VideoFrameProcessorConfiguration config_;
+  webrtc::I420BufferPool pool_;
+};
+
+class ScaleProcessor : public VideoFrameProcessor {
+ public:
+  ScaleProcessor(int width, int height) : width_(width), height_(height) {}
+
+  bool Process(ProcessedFrame& frame) noexcept override {
+    const webrtc::I420BufferInterface& buffer = frame.buffer();
+    if ((width_ == buffer.width()) && (height_ == buffer.height())) {
+      return true;
+    }
+    rtc::scoped_refptr<webrtc::I420Buffer> scaled =
+        pool_.CreateBuffer(width_, height_);
+    if (!scaled) {
+      return false;
+    }
+    ScaleI420(buffer, *scaled);
+    frame.SetBuffer(std::move(scaled));
+    return true;
+  }
+
+ private:
+  const int width_;
+  const int height_;
+  webrtc::I420BufferPool pool_;
+};
+
+class BlurProcessor : public VideoFrameProcessor {
+ public:
+  explicit BlurProcessor(const VideoFrameProcessorConfiguration& config)
+      : config_(config) {}
+
+  bool Process(ProcessedFrame& frame) noexcept override {
+    Area area;
+    if (!ClipArea(config_, frame.buffer().width(), frame.buffer().height(),
+                  area)) {
+      return true;
+    }
+    webrtc::I420Buffer* buffer = frame.MutableBuffer();
+    if (!buffer) {
+      return false;
+    }
+    BoxBlurI420(*buffer, area.x, area.y, area.width, area.height,
+                config_.blur_radius, scratch_);
+    return true;
+  }
+
+ private:
+  const VideoFrameProcessorConfiguration config_;
+  rtc::scoped_refptr<webrtc::I420Buffer> scratch_;
+};
+
+class OverlayProcessor : public VideoFrameProcessor {
+ public:
+  explicit OverlayProcessor(const VideoFrameProcessorConfiguration& config)
+      : config_(config),
+        overlay_(static_cast<size_t>(config.width) * config.height * 4) {
+    // Premultiply the overlay once, as expected by |libyuv::ARGBBlend()|.
+    libyuv::ARGBAttenuate(static_cast<const uint8_t*>(config.overlay_data),
+                          config.overlay_stride, overlay_.data(),
+                          config.width * 4, config.width, config.height);
+    config_.overlay_data = nullptr;
+  }
+
+  bool Process(ProcessedFrame& frame) noexcept override {
+    Area area;
+    if (!ClipArea(config_, frame.buffer().width(), frame.buffer().height(),
+                  area)) {
+      return true;
+    }
+    webrtc::I420Buffer* buffer = frame.MutableBuffer();
+    if (!buffer) {
+      return false;
+    }
+    BlendArgbOverI420(*buffer, area.x, area.y, area.width, area.height,
+                      overlay_.data(), config_.width * 4, scratch_);
+    return true;
+  }
+
+ private:
+  VideoFrameProcessorConfiguration config_;
+
+  /// Copy of the overlay image, with premultiplied alpha.
+  std::vector<uint8_t> overlay_;
+
+  /// ARGB conversion of the area covered by the overlay.
+  std::vector<uint8_t> scratch_;
+};
+
+class CallbackProcessor : public VideoFrameProcessor {
+ public:
+  CallbackProcessor(VideoFrameProcessorCallback callback, void* user_data)
+      : callback_(callback), user_data_(user_data) {}
+
+  bool Process(ProcessedFrame& frame) noexcept override {
+    // The callback may modify the frame in place.
+    webrtc::I420Buffer* buffer = frame.MutableBuffer();
+    if (!buffer) {
+      return false;
+    }
+    VideoFrameInfo info{};
+    info.format = VideoFrameFormat::kI420A;
+    info.width = buffer->width();
+    info.height = buffer->height();
+    info.data[0] = buffer->MutableDataY();
+    info.data[1] = buffer->MutableDataU();
+    info.data[2] = buffer->MutableDataV();
+    info.stride[0] = buffer->StrideY();
+    info.stride[1] = buffer->StrideU();
+    info.stride[2] = buffer->StrideV();
+    info.timing.timestamp_us = frame.timestamp_us();
+    return (callback_(user_data_, &info) != mrsBool::kFalse);
+  }
+
+ private:
+  const VideoFrameProcessorCallback callback_;
+  void* const user_data_;
+};
+
+}  // namespace
+
+namespace Microsoft::MixedReality::WebRTC {
+
+ProcessedFrame::ProcessedFrame(
+    rtc::scoped_refptr<webrtc::I420BufferInterface> source,
+    int64_t timestamp_us,
+    webrtc::I420BufferPool& pool) noexcept
+    : buffer_(std::move(source)), timestamp_us_(timestamp_us), pool_(pool) {}
+
+webrtc::I420Buffer* ProcessedFrame::MutableBuffer() noexcept {
+  if (!mutable_buffer_) {
+    mutable_buffer_ = pool_.CreateBuffer(buffer_->width(), buffer_->height());
+    if (!mutable_buffer_) {
+      return nullptr;
+    }
+    CropI420(*buffer_, 0, 0, *mutable_buffer_);
+    buffer_ = mutable_buffer_;
+  }
+  return mutable_buffer_.get();
+}
+
+void ProcessedFrame::SetBuffer(
+    rtc::scoped_refptr<webrtc::I420Buffer> buffer) noexcept {
+  mutable_buffer_ = std::move(buffer);
+  buffer_ = mutable_buffer_;
+}
+
+void CropI420(const webrtc::I420BufferInterface& src,
+              int x,
+              int y,
+              webrtc::I420Buffer& dst) noexcept {
+  RTC_DCHECK_EQ(0, x % 2);
+  RTC_DCHECK_EQ(0, y % 2);
+  libyuv::I420Copy(PlaneAt(src.DataY(), src.StrideY(), x, y), src.StrideY(),
+                   PlaneAt(src.DataU(), src.StrideU(), x / 2, y / 2),
+                   src.StrideU(),
+                   PlaneAt(src.DataV(), src.StrideV(), x / 2, y / 2),
+                   src.StrideV(), dst.MutableDataY(), dst.StrideY(),
+                   dst.MutableDataU(), dst.StrideU(), dst.MutableDataV(),
+                   dst.StrideV(), dst.width(), dst.height());
+}
+
+void ScaleI420(const webrtc::I420BufferInterface& src,
+               webrtc::I420Buffer& dst) noexcept {
+  libyuv::I420Scale(src.DataY(), src.StrideY(), src.DataU(), src.StrideU(),
+                    src.DataV(), src.StrideV(), src.width(), src.height(),
+                    dst.MutableDataY(), dst.StrideY(), dst.MutableDataU(),
+                    dst.StrideU(), dst.MutableDataV(), dst.StrideV(),
+                    dst.width(), dst.height(), libyuv::kFilterBox);
+}
+
+void BoxBlurI420(webrtc::I420Buffer& buffer,
+                 int x,
+                 int y,
+                 int width,
+                 int height,
+                 int radius,
+                 rtc::scoped_refptr<webrtc::I420Buffer>& scratch) noexcept {
+  RTC_DCHECK_EQ(0, x % 2);
+  RTC_DCHECK_EQ(0, y % 2);
+  const int filter_size = 2 * radius + 1;
+  const int small_width = std::max(1, width / filter_size);
+  const int small_height = std::max(1, height / filter_size);
+  if (!scratch || (scratch->width() != small_width) ||
+      (scratch->height() != small_height)) {
+    scratch = webrtc::I420Buffer::Create(small_width, small_height);
+  }
+  uint8_t* const y_plane =
+      PlaneAt(buffer.MutableDataY(), buffer.StrideY(), x, y);
+  uint8_t* const u_plane =
+      PlaneAt(buffer.MutableDataU(), buffer.StrideU(), x / 2, y / 2);
+  uint8_t* const v_plane =
+      PlaneAt(buffer.MutableDataV(), buffer.StrideV(), x / 2, y / 2);
+  libyuv::I420Scale(y_plane, buffer.StrideY(), u_plane, buffer.StrideU(),
+                    v_plane, buffer.StrideV(), width, height,
+                    scratch->MutableDataY(), scratch->StrideY(),
+                    scratch->MutableDataU(), scratch->StrideU(),
+                    scratch->MutableDataV(), scratch->StrideV(), small_width,
+                    small_height, libyuv::kFilterBox);
+  libyuv::I420Scale(scratch->DataY(), scratch->StrideY(), scratch->DataU(),
+                    scratch->StrideU(), scratch->DataV(), scratch->StrideV(),
+                    small_width, small_height, y_plane, buffer.StrideY(),
+                    u_plane, buffer.StrideU(), v_plane, buffer.StrideV(),
+                    width, height, libyuv::kFilterBilinear);
+}
+
+void BlendArgbOverI420(webrtc::I420Buffer& buffer,
+                       int x,
+                       int y,
+                       int width,
+                       int height,
+                       const uint8_t* overlay,
+                       int overlay_stride,
+                       std::vector<uint8_t>& scratch) noexcept {
+  RTC_DCHECK_EQ(0, x % 2);
+  RTC_DCHECK_EQ(0, y % 2);
+  const int scratch_stride = width * 4;
+  scratch.resize(static_cast<size_t>(scratch_stride) * height);
+  uint8_t* const y_plane =
+      PlaneAt(buffer.MutableDataY(), buffer.StrideY(), x, y);
+  uint8_t* const u_plane =
+      PlaneAt(buffer.MutableDataU(), buffer.StrideU(), x / 2, y / 2);
+  uint8_t* const v_plane =
+      PlaneAt(buffer.MutableDataV(), buffer.StrideV(), x / 2, y / 2);
+  libyuv::I420ToARGB(y_plane, buffer.StrideY(), u_plane, buffer.StrideU(),
+                     v_plane, buffer.StrideV(), scratch.data(), scratch_stride,
+                     width, height);
+  libyuv::ARGBBlend(overlay, overlay_stride, scratch.data(), scratch_stride,
+                    scratch.data(), scratch_stride, width, height);
+  libyuv::ARGBToI420(scratch.data(), scratch_stride, y_plane, buffer.StrideY(),
+                     u_plane, buffer.StrideU(), v_plane, buffer.StrideV(),
+                     width, height);
+}
+
+mrsResult VideoFrameProcessor::Create(
+    const VideoFrameProcessorConfiguration& config,
+    std::unique_ptr<VideoFrameProcessor>& processor) noexcept {
+  switch (config.kind) {
+    case VideoFrameProcessorKind::kCrop:
+      if ((config.x < 0) || (config.y < 0) || (config.width <= 0) ||
+          (config.height <= 0)) {
+        return MRS_E_INVALID_PARAMETER;
+      }
+      processor = std::make_unique<CropProcessor>(config);
+      return MRS_SUCCESS;
+    case VideoFrameProcessorKind::kScale:
+      if ((config.width <= 0) || (config.height <= 0)) {
+        return MRS_E_INVALID_PARAMETER;
+      }
+      processor = std::make_unique<ScaleProcessor>(config.width, config.height);
+      return MRS_SUCCESS;
+    case VideoFrameProcessorKind::kBlur:
+      if ((config.x < 0) || (config.y < 0) || (config.width <= 0) ||
+          (config.height <= 0) || (config.blur_radius <= 0)) {
+        return MRS_E_INVALID_PARAMETER;
+      }
+      processor = std::make_unique<BlurProcessor>(config);
+      return MRS_SUCCESS;
+    case VideoFrameProcessorKind::kOverlay:
+      if ((config.x < 0) || (config.y < 0) || (config.width <= 0) ||
+          (config.height <= 0) || !config.overlay_data ||
+          (config.overlay_stride < config.width * 4)) {
+        return MRS_E_INVALID_PARAMETER;
+      }
+      processor = std::make_unique<OverlayProcessor>(config);
+      return MRS_SUCCESS;
+    case VideoFrameProcessorKind::kCallback:
+      if (!config.callback) {
+        return MRS_E_INVALID_PARAMETER;
+      }
+      processor = std::make_unique<CallbackProcessor>(config.callback,
+                                                      config.user_data);
+      return MRS_SUCCESS;
+    default:
+      return MRS_E_INVALID_PARAMETER;
+  }
+}
+
+}  // namespace Microsoft::MixedReality::WebRTC
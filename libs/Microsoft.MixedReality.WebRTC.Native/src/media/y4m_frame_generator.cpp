@@ -0,0 +1,247 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+// This is a precompiled header, it must be on its own, followed by a blank
+// line, to prevent clang-format from reordering it with other headers.
+#include "pch.h"
+
+#include <charconv>
+
+#if defined(WEBRTC_WIN)
+#include "rtc_base/stringutils.h"
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "video_frame_generator.h"
+
+namespace {
+
+/// Magic string starting a Y4M stream header.
+constexpr std::string_view kStreamMagic{"YUV4MPEG2"};
+
+/// Magic string starting a Y4M frame header.
+constexpr std::string_view kFrameMagic{"FRAME"};
+
+/// Parse a positive integer filling the entire string |str|.
+bool ParsePositiveInt(std::string_view str, int& value) noexcept {
+  const char* const end = str.data() + str.size();
+  auto [ptr, ec] = std::from_chars(str.data(), end, value);
+  return (ec == std::errc{}) && (ptr == end) && (value > 0);
+}
+
+}  // namespace
+
+namespace Microsoft::MixedReality::WebRTC {
+
+/// Read-only memory mapping of an entire file, shared by the frames pointing
+/// into it.
+class Y4mFrameGenerator::MappedFile : public rtc::RefCountInterface {
+ public:
+  /// Map the file at |path|, encoded in UTF-8, or return null on failure.
+  static rtc::scoped_refptr<MappedFile> Open(const char* path) noexcept {
+    rtc::scoped_refptr<MappedFile> file =
+        new rtc::RefCountedObject<MappedFile>();
+#if defined(WEBRTC_WIN)
+    const std::wstring wide_path = rtc::ToUtf16(path, strlen(path));
+    HANDLE handle = CreateFile2(wide_path.c_str(), GENERIC_READ,
+                                FILE_SHARE_READ, OPEN_EXISTING, nullptr);
+    if (handle == INVALID_HANDLE_VALUE) {
+      return nullptr;
+    }
+    LARGE_INTEGER size{};
+    if (GetFileSizeEx(handle, &size) && (size.QuadPart > 0)) {
+      // The view keeps the mapping alive after its handle is closed.
+      HANDLE mapping = CreateFileMappingFromApp(handle, nullptr,
+                                                PAGE_READONLY, 0, nullptr);
+      if (mapping) {
+        file->data_ = static_cast<const uint8_t*>(
+            MapViewOfFileFromApp(mapping, FILE_MAP_READ, 0, 0));
+        file->size_ = static_cast<size_t>(size.QuadPart);
+        CloseHandle(mapping);
+      }
+    }
+    CloseHandle(handle);
+#else
+    const int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+      return nullptr;
+    }
+    struct stat st {};
+    if ((fstat(fd, &st) == 0) && (st.st_size > 0)) {
+      void* data = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ,
+                        MAP_PRIVATE, fd, 0);
+      if (data != MAP_FAILED) {
+        file->data_ = static_cast<const uint8_t*>(data);
+        file->size_ = static_cast<size_t>(st.st_size);
+      }
+    }
+    close(fd);
+#endif
+    return (file->data_ ? file : nullptr);
+  }
+
+  inline const uint8_t* data() const noexcept { return data_; }
+  inline size_t size() const noexcept { return size_; }
+
+ protected:
+  ~MappedFile() override {
+    if (!data_) {
+      return;
+    }
+#if defined(WEBRTC_WIN)
+    UnmapViewOfFile(data_);
+#else
+    munmap(const_cast<uint8_t*>(data_), size_);
+#endif
+  }
+
+ private:
+  const uint8_t* data_ = nullptr;
+  size_t size_ = 0;
+};
+
+mrsResult Y4mFrameGenerator::Open(
+    const char* path,
+    bool loop,
+    std::unique_ptr<Y4mFrameGenerator>& generator) noexcept {
+  if (!path || !*path) {
+    return MRS_E_INVALID_PARAMETER;
+  }
+  rtc::scoped_refptr<MappedFile> file = MappedFile::Open(path);
+  if (!file) {
+    RTC_LOG(LS_ERROR) << "Failed to map Y4M file " << path;
+    return MRS_E_NOTFOUND;
+  }
+  std::unique_ptr<Y4mFrameGenerator> y4m{
+      new Y4mFrameGenerator(std::move(file), loop)};
+  if (!y4m->Parse()) {
+    RTC_LOG(LS_ERROR) << "Invalid or unsupported Y4M file " << path;
+    return MRS_E_INVALID_PARAMETER;
+  }
+  generator = std::move(y4m);
+  return MRS_SUCCESS;
+}
+
+Y4mFrameGenerator::Y4mFrameGenerator(rtc::scoped_refptr<MappedFile> file,
+                                     bool loop) noexcept
+    : file_(std::move(file)), loop_(loop) {}
+
+Y4mFrameGenerator::~Y4mFrameGenerator() = default;
+
+bool Y4mFrameGenerator::Parse() noexcept {
+  const std::string_view content{reinterpret_cast<const char*>(file_->data()),
+                                 file_->size()};
+
+  // Stream header, with space-separated parameters
+  const size_t header_end = content.find('\n');
+  if ((header_end == std::string_view::npos) ||
+      (content.substr(0, kStreamMagic.size()) != kStreamMagic)) {
+    return false;
+  }
+  std::string_view params =
+      content.substr(kStreamMagic.size(), header_end - kStreamMagic.size());
+  while (!params.empty()) {
+    const size_t start = params.find_first_not_of(' ');
+    if (start == std::string_view::npos) {
+      break;
+    }
+    params.remove_prefix(start);
+    const std::string_view param = params.substr(0, params.find(' '));
+    params.remove_prefix(param.size());
+    const std::string_view value = param.substr(1);
+    switch (param[0]) {
+      case 'W':
+        if (!ParsePositiveInt(value, width_)) {
+          return false;
+        }
+        break;
+      case 'H':
+        if (!ParsePositiveInt(value, height_)) {
+          return false;
+        }
+        break;
+      case 'F': {
+        const size_t sep = value.find(':');
+        int num;
+        int den;
+        if ((sep == std::string_view::npos) ||
+            !ParsePositiveInt(value.substr(0, sep), num) ||
+            !ParsePositiveInt(value.substr(sep + 1), den)) {
+          return false;
+        }
+        framerate_ = static_cast<double>(num) / den;
+        break;
+      }
+      case 'C':
+        // Only 8-bit 4:2:0 is supported; the chroma siting is ignored.
+        if ((value != "420") && (value != "420jpeg") &&
+            (value != "420paldv") && (value != "420mpeg2")) {
+          return false;
+        }
+        break;
+      default:
+        // Interlacing, aspect ratio, and extensions are ignored.
+        break;
+    }
+  }
+  if ((width_ <= 0) || (height_ <= 0)) {
+    return false;
+  }
+
+  // Frames, each with a header line followed by the planar pixel data
+  const size_t chroma_size =
+      static_cast<size_t>((width_ + 1) / 2) * ((height_ + 1) / 2);
+  const size_t frame_size =
+      static_cast<size_t>(width_) * height_ + 2 * chroma_size;
+  size_t offset = header_end + 1;
+  while (offset < content.size()) {
+    const size_t frame_header_end = content.find('\n', offset);
+    if ((frame_header_end == std::string_view::npos) ||
+        (content.substr(offset, kFrameMagic.size()) != kFrameMagic)) {
+      break;  // ignore trailing data after the last frame
+    }
+    const size_t data_offset = frame_header_end + 1;
+    if (content.size() - data_offset < frame_size) {
+      break;  // ignore a truncated last frame
+    }
+    frame_offsets_.push_back(data_offset);
+    offset = data_offset + frame_size;
+  }
+  return !frame_offsets_.empty();
+}
+
+bool Y4mFrameGenerator::NextFrame(
+    VideoFrameInfo& frame,
+    rtc::scoped_refptr<rtc::RefCountInterface>& owner) noexcept {
+  if (next_frame_ >= frame_offsets_.size()) {
+    if (!loop_) {
+      return false;
+    }
+    next_frame_ = 0;
+  }
+  const uint8_t* const y = file_->data() + frame_offsets_[next_frame_++];
+  const int chroma_width = (width_ + 1) / 2;
+  const int chroma_height = (height_ + 1) / 2;
+  const uint8_t* const u = y + static_cast<size_t>(width_) * height_;
+  const uint8_t* const v =
+      u + static_cast<size_t>(chroma_width) * chroma_height;
+  frame.format = VideoFrameFormat::kI420A;
+  frame.width = width_;
+  frame.height = height_;
+  frame.data[0] = y;
+  frame.data[1] = u;
+  frame.data[2] = v;
+  frame.data[3] = nullptr;
+  frame.stride[0] = width_;
+  frame.stride[1] = chroma_width;
+  frame.stride[2] = chroma_width;
+  frame.stride[3] = 0;
+  owner = file_;
+  return true;
+}
+
+}  // namespace Microsoft::MixedReality::WebRTC
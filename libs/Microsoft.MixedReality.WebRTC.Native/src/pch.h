@@ -59,6 +59,7 @@
 #include "modules/audio_processing/include/audio_processing.h"
 #include "modules/video_capture/video_capture_factory.h"
 #include "rtc_base/memory/aligned_malloc.h"
+#include "rtc_base/timeutils.h"
 
 // libyuv from WebRTC repository for color conversion
 #include "libyuv.h"
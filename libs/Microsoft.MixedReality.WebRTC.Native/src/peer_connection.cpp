@@ -5,6 +5,7 @@
 // line, to prevent clang-format from reordering it with other headers.
 #include "pch.h"
 
+#include "audio_capture_tap.h"
 #include "audio_frame_observer.h"
 #include "data_channel.h"
 #include "local_video_track.h"
@@ -120,7 +121,9 @@ PeerConnection::~PeerConnection() noexcept {
 
 webrtc::RTCErrorOr<rtc::scoped_refptr<LocalVideoTrack>>
 PeerConnection::AddLocalVideoTrack(
-    rtc::scoped_refptr<webrtc::VideoTrackInterface> video_track) noexcept {
+    rtc::scoped_refptr<webrtc::VideoTrackInterface> video_track,
+    rtc::scoped_refptr<ProcessedVideoTrackSource> source,
+    std::optional<VideoCaptureFormatInfo> capture_format) noexcept {
   if (IsClosed()) {
     return webrtc::RTCError(webrtc::RTCErrorType::UNSUPPORTED_OPERATION,
                             "The peer connection is closed.");
@@ -130,7 +133,7 @@ PeerConnection::AddLocalVideoTrack(
     rtc::scoped_refptr<LocalVideoTrack> track =
         new rtc::RefCountedObject<LocalVideoTrack>(
             *this, std::move(video_track), std::move(result.MoveValue()),
-            nullptr);
+            std::move(source), nullptr, std::move(capture_format));
     {
       rtc::CritScope lock(&tracks_mutex_);
       local_video_tracks_.push_back(track);
@@ -182,9 +185,10 @@ bool PeerConnection::AddLocalAudioTrack(
     // Reuse the existing sender.
     if (local_audio_sender_->SetTrack(audio_track.get())) {
       if (auto* sink = local_audio_observer_.get()) {
-        // FIXME - Current implementation of AddSink() for the local audio
-        // capture device is no-op. So this callback is never fired.
-        audio_track->AddSink(sink);
+        // AddSink() on the local audio track is a no-op, as its audio does
+        // not flow through the track; tap the audio device module instead,
+        // delivering only while the track is enabled.
+        AudioCaptureTap::Instance().AddSink(sink, audio_track);
       }
       local_audio_track_ = std::move(audio_track);
       return true;
@@ -194,9 +198,10 @@ bool PeerConnection::AddLocalAudioTrack(
     auto result = peer_->AddTrack(audio_track, {kAudioVideoStreamId});
     if (result.ok()) {
       if (auto* sink = local_audio_observer_.get()) {
-        // FIXME - Current implementation of AddSink() for the local audio
-        // capture device is no-op. So this callback is never fired.
-        audio_track->AddSink(sink);
+        // AddSink() on the local audio track is a no-op, as its audio does
+        // not flow through the track; tap the audio device module instead,
+        // delivering only while the track is enabled.
+        AudioCaptureTap::Instance().AddSink(sink, audio_track);
       }
       local_audio_sender_ = result.value();
       local_audio_track_ = std::move(audio_track);
@@ -210,7 +215,7 @@ void PeerConnection::RemoveLocalAudioTrack() noexcept {
   if (!local_audio_track_)
     return;
   if (auto* sink = local_audio_observer_.get()) {
-    local_audio_track_->RemoveSink(sink);
+    AudioCaptureTap::Instance().RemoveSink(sink);
   }
   local_audio_sender_->SetTrack(nullptr);
   local_audio_track_ = nullptr;
@@ -686,11 +691,8 @@ void PeerConnection::OnAddTrack(
   } else if (trackKindStr == webrtc::MediaStreamTrackInterface::kVideoKind) {
     trackKind = TrackKind::kVideoTrack;
     if (auto* sink = remote_video_observer_.get()) {
-      rtc::VideoSinkWants sink_settings{};
-      sink_settings.rotation_applied =
-          true;  // no exposed API for caller to handle rotation
       auto video_track = static_cast<webrtc::VideoTrackInterface*>(track.get());
-      video_track->AddOrUpdateSink(sink, sink_settings);
+      video_track->AddOrUpdateSink(sink, sink->GetSinkWants());
     }
   } else {
     return;
@@ -706,6 +708,32 @@ void PeerConnection::OnAddTrack(
   }
 }
 
+mrsResult PeerConnection::SetRemoteVideoApplyRotation(
+    bool apply_rotation) noexcept {
+  if (!remote_video_observer_) {
+    return MRS_E_INVALID_OPERATION;
+  }
+  remote_video_observer_->SetApplyRotation(apply_rotation);
+
+  // Update the sink settings of the remote video tracks already added.
+  if (peer_) {
+    const rtc::VideoSinkWants sink_settings =
+        remote_video_observer_->GetSinkWants();
+    for (auto&& receiver : peer_->GetReceivers()) {
+      rtc::scoped_refptr<webrtc::MediaStreamTrackInterface> track =
+          receiver->track();
+      if (track &&
+          (track->kind() == webrtc::MediaStreamTrackInterface::kVideoKind)) {
+        auto video_track =
+            static_cast<webrtc::VideoTrackInterface*>(track.get());
+        video_track->AddOrUpdateSink(remote_video_observer_.get(),
+                                     sink_settings);
+      }
+    }
+  }
+  return MRS_SUCCESS;
+}
+
 void PeerConnection::OnRemoveTrack(
     rtc::scoped_refptr<webrtc::RtpReceiverInterface> receiver) noexcept {
   RTC_LOG(LS_INFO) << "Removed track #" << receiver->id() << " of type "
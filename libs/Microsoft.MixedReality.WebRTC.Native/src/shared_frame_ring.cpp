@@ -0,0 +1,459 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+// This is a precompiled header, it must be on its own, followed by a blank
+// line, to prevent clang-format from reordering it with other headers.
+#include "pch.h"
+
+#if defined(WEBRTC_WIN)
+#include "rtc_base/stringutils.h"
+#else
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "shared_frame_ring.h"
+
+namespace {
+
+using namespace Microsoft::MixedReality::WebRTC;
+
+/// Magic number starting the shared memory region, "MRSF" in memory.
+constexpr uint32_t kRingMagic = 0x4653524D;
+
+/// Version of the layout of the region, incremented on incompatible changes.
+constexpr uint32_t kRingVersion = 1;
+
+/// Alignment of the headers and planes in the region, one cache line.
+constexpr size_t kAlignment = 64;
+
+/// Header at the start of the region, followed by the slot headers and then
+/// by the pixel data of the slots.
+struct RingHeader {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t num_slots;
+  uint32_t reserved;
+
+  /// Byte size of the pixel data of each slot.
+  uint64_t slot_size;
+
+  /// Offset of the pixel data of the first slot from the start of the region.
+  uint64_t data_offset;
+
+  /// Sequence number of the latest frame published, or zero if none.
+  std::atomic<uint64_t> sequence;
+};
+
+/// Header of a slot, describing the frame it holds.
+struct SlotHeader {
+  /// Sequence number of the frame in the slot, starting at one, or zero while
+  /// the slot is being written.
+  std::atomic<uint64_t> sequence;
+
+  VideoFrameFormat format;
+  int32_t width;
+  int32_t height;
+  VideoRotation rotation;
+
+  /// Offset of each plane from the start of the slot pixel data.
+  uint32_t offset[4];
+
+  /// Byte stride of each plane, or zero for unused planes.
+  int32_t stride[4];
+
+  VideoFrameTiming timing;
+};
+
+// The sequence numbers are shared between processes.
+static_assert(std::atomic<uint64_t>::is_always_lock_free,
+              "Shared memory atomics must be lock-free.");
+
+constexpr size_t AlignUp(size_t value) noexcept {
+  return (value + kAlignment - 1) & ~(kAlignment - 1);
+}
+
+constexpr size_t kSlotHeadersOffset = AlignUp(sizeof(RingHeader));
+constexpr size_t kSlotHeaderSize = AlignUp(sizeof(SlotHeader));
+
+/// Get the byte size of the rows and the number of rows of |plane| for a frame
+/// of the given format and resolution. Return false if the format has no such
+/// plane.
+bool GetPlaneSize(VideoFrameFormat format,
+                  int plane,
+                  int width,
+                  int height,
+                  int* row_bytes,
+                  int* rows) noexcept {
+  const int chroma_width = (width + 1) / 2;
+  const int chroma_height = (height + 1) / 2;
+  switch (format) {
+    case VideoFrameFormat::kI420A:
+      *row_bytes = ((plane == 1) || (plane == 2) ? chroma_width : width);
+      *rows = ((plane == 1) || (plane == 2) ? chroma_height : height);
+      return true;
+    case VideoFrameFormat::kNv12:
+      *row_bytes = (plane == 1 ? chroma_width * 2 : width);
+      *rows = (plane == 1 ? chroma_height : height);
+      return (plane < 2);
+    case VideoFrameFormat::kArgb32:
+    case VideoFrameFormat::kRgba32:
+    case VideoFrameFormat::kBgra32:
+      *row_bytes = width * 4;
+      *rows = height;
+      return (plane == 0);
+    case VideoFrameFormat::kRgb24:
+      *row_bytes = width * 3;
+      *rows = height;
+      return (plane == 0);
+    default:
+      return false;
+  }
+}
+
+RingHeader* GetHeader(const SharedMemory& memory) noexcept {
+  return reinterpret_cast<RingHeader*>(memory.data());
+}
+
+SlotHeader* GetSlot(const SharedMemory& memory, uint64_t sequence) noexcept {
+  const RingHeader* header = GetHeader(memory);
+  const size_t index = static_cast<size_t>((sequence - 1) % header->num_slots);
+  return reinterpret_cast<SlotHeader*>(memory.data() + kSlotHeadersOffset +
+                                       index * kSlotHeaderSize);
+}
+
+uint8_t* GetSlotData(const SharedMemory& memory, uint64_t sequence) noexcept {
+  const RingHeader* header = GetHeader(memory);
+  const uint64_t index = (sequence - 1) % header->num_slots;
+  return memory.data() + header->data_offset + index * header->slot_size;
+}
+
+}  // namespace
+
+namespace Microsoft::MixedReality::WebRTC {
+
+std::unique_ptr<SharedMemory> SharedMemory::Create(
+    const char* name,
+    size_t size,
+    bool* already_exists) noexcept {
+  *already_exists = false;
+  std::unique_ptr<SharedMemory> memory{new SharedMemory()};
+#if defined(WEBRTC_WIN)
+  const std::wstring wide_name = rtc::ToUtf16(name, strlen(name));
+  memory->mapping_ = CreateFileMappingFromApp(
+      INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, size, wide_name.c_str());
+  if (!memory->mapping_) {
+    return nullptr;
+  }
+  // A region with the same name is still mapped by a live process.
+  if (GetLastError() == ERROR_ALREADY_EXISTS) {
+    *already_exists = true;
+    return nullptr;
+  }
+  memory->data_ = static_cast<uint8_t*>(
+      MapViewOfFileFromApp(memory->mapping_, FILE_MAP_WRITE, 0, size));
+#else
+  const std::string path = (name[0] == '/' ? name : std::string("/") + name);
+  // Never replace an existing region, which may still be written or read by
+  // another process, so that the new region also starts zero-filled. Regions
+  // left over by a process which did not exit cleanly must be removed by the
+  // application.
+  const int fd = shm_open(path.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+  if (fd < 0) {
+    *already_exists = (errno == EEXIST);
+    return nullptr;
+  }
+  struct stat st {};
+  if (fstat(fd, &st) != 0) {
+    close(fd);
+    shm_unlink(path.c_str());
+    return nullptr;
+  }
+  memory->owned_name_ = path;
+  memory->owned_device_ = st.st_dev;
+  memory->owned_inode_ = st.st_ino;
+  if (ftruncate(fd, static_cast<off_t>(size)) == 0) {
+    void* data =
+        mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (data != MAP_FAILED) {
+      memory->data_ = static_cast<uint8_t*>(data);
+    }
+  }
+  close(fd);
+#endif
+  if (!memory->data_) {
+    return nullptr;
+  }
+  memory->size_ = size;
+  return memory;
+}
+
+std::unique_ptr<SharedMemory> SharedMemory::Open(const char* name) noexcept {
+  std::unique_ptr<SharedMemory> memory{new SharedMemory()};
+#if defined(WEBRTC_WIN)
+  const std::wstring wide_name = rtc::ToUtf16(name, strlen(name));
+  memory->mapping_ =
+      OpenFileMappingFromApp(FILE_MAP_READ, FALSE, wide_name.c_str());
+  if (!memory->mapping_) {
+    return nullptr;
+  }
+  memory->data_ = static_cast<uint8_t*>(
+      MapViewOfFileFromApp(memory->mapping_, FILE_MAP_READ, 0, 0));
+  MEMORY_BASIC_INFORMATION info{};
+  if (memory->data_ &&
+      VirtualQuery(memory->data_, &info, sizeof(info)) == sizeof(info)) {
+    memory->size_ = info.RegionSize;
+  }
+#else
+  const std::string path = (name[0] == '/' ? name : std::string("/") + name);
+  const int fd = shm_open(path.c_str(), O_RDONLY, 0);
+  if (fd < 0) {
+    return nullptr;
+  }
+  struct stat st {};
+  if ((fstat(fd, &st) == 0) && (st.st_size > 0)) {
+    void* data = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ,
+                      MAP_SHARED, fd, 0);
+    if (data != MAP_FAILED) {
+      memory->data_ = static_cast<uint8_t*>(data);
+      memory->size_ = static_cast<size_t>(st.st_size);
+    }
+  }
+  close(fd);
+#endif
+  if (memory->size_ == 0) {
+    return nullptr;
+  }
+  return memory;
+}
+
+SharedMemory::~SharedMemory() {
+#if defined(WEBRTC_WIN)
+  if (data_) {
+    UnmapViewOfFile(data_);
+  }
+  if (mapping_) {
+    CloseHandle(mapping_);
+  }
+#else
+  if (data_) {
+    munmap(data_, size_);
+  }
+  if (!owned_name_.empty()) {
+    // Only remove the name if it still refers to the region created.
+    const int fd = shm_open(owned_name_.c_str(), O_RDONLY, 0);
+    if (fd >= 0) {
+      struct stat st {};
+      if ((fstat(fd, &st) == 0) && (st.st_dev == owned_device_) &&
+          (st.st_ino == owned_inode_)) {
+        shm_unlink(owned_name_.c_str());
+      }
+      close(fd);
+    }
+  }
+#endif
+}
+
+mrsResult SharedFrameRing::Create(
+    const char* name,
+    const SharedFrameRingConfiguration& config,
+    rtc::scoped_refptr<SharedFrameRing>& ring) noexcept {
+  if (!name || !*name || (config.num_slots < 2) || (config.max_width <= 0) ||
+      (config.max_height <= 0)) {
+    return MRS_E_INVALID_PARAMETER;
+  }
+  // Large enough for 4 bytes per pixel, plus the alignment padding of up to
+  // 4 planes.
+  const uint64_t slot_size =
+      AlignUp(static_cast<uint64_t>(config.max_width) * config.max_height * 4) +
+      4 * kAlignment;
+  const uint64_t data_offset =
+      AlignUp(kSlotHeadersOffset + config.num_slots * kSlotHeaderSize);
+  const uint64_t total_size = data_offset + config.num_slots * slot_size;
+  if (total_size > std::numeric_limits<size_t>::max()) {
+    return MRS_E_INVALID_PARAMETER;
+  }
+  bool already_exists = false;
+  std::unique_ptr<SharedMemory> memory = SharedMemory::Create(
+      name, static_cast<size_t>(total_size), &already_exists);
+  if (!memory) {
+    if (already_exists) {
+      RTC_LOG(LS_ERROR) << "Shared memory frame ring " << name
+                        << " already exists";
+      return MRS_E_INVALID_OPERATION;
+    }
+    RTC_LOG(LS_ERROR) << "Failed to create shared memory frame ring " << name;
+    return MRS_E_UNKNOWN;
+  }
+
+  // The region is zero-filled, so only the layout needs to be written. The
+  // magic number is written last, so that readers opening the region early
+  // reject it instead of reading a partial header.
+  RingHeader* header = GetHeader(*memory);
+  header->version = kRingVersion;
+  header->num_slots = static_cast<uint32_t>(config.num_slots);
+  header->slot_size = slot_size;
+  header->data_offset = data_offset;
+  std::atomic_thread_fence(std::memory_order_release);
+  header->magic = kRingMagic;
+
+  ring = new rtc::RefCountedObject<SharedFrameRing>(std::move(memory));
+  return MRS_SUCCESS;
+}
+
+SharedFrameRing::SharedFrameRing(std::unique_ptr<SharedMemory> memory) noexcept
+    : memory_(std::move(memory)) {}
+
+void SharedFrameRing::Write(const VideoFrameInfo& frame) noexcept {
+  RingHeader* header = GetHeader(*memory_);
+
+  // Lay out the planes contiguously, each starting on a cache line.
+  uint32_t offsets[4]{};
+  int32_t strides[4]{};
+  int rows[4]{};
+  size_t size = 0;
+  for (int plane = 0; plane < 4; ++plane) {
+    int row_bytes = 0;
+    if (!frame.data[plane] || !GetPlaneSize(frame.format, plane, frame.width,
+                                            frame.height, &row_bytes,
+                                            &rows[plane])) {
+      continue;
+    }
+    offsets[plane] = static_cast<uint32_t>(size);
+    strides[plane] = row_bytes;
+    size += AlignUp(static_cast<size_t>(row_bytes) * rows[plane]);
+  }
+  if ((size == 0) || (size > header->slot_size)) {
+    dropped_count_.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+
+  // Clear the slot sequence number while writing, so that readers of the
+  // previous frame of the slot detect it was overwritten.
+  const uint64_t sequence = ++sequence_;
+  SlotHeader* slot = GetSlot(*memory_, sequence);
+  slot->sequence.store(0, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  slot->format = frame.format;
+  slot->width = frame.width;
+  slot->height = frame.height;
+  slot->rotation = frame.rotation;
+  slot->timing = frame.timing;
+  uint8_t* const data = GetSlotData(*memory_, sequence);
+  for (int plane = 0; plane < 4; ++plane) {
+    slot->offset[plane] = offsets[plane];
+    slot->stride[plane] = strides[plane];
+    if (strides[plane] > 0) {
+      libyuv::CopyPlane(static_cast<const uint8_t*>(frame.data[plane]),
+                        frame.stride[plane], data + offsets[plane],
+                        strides[plane], strides[plane], rows[plane]);
+    }
+  }
+  slot->sequence.store(sequence, std::memory_order_release);
+  header->sequence.store(sequence, std::memory_order_release);
+  written_count_.fetch_add(1, std::memory_order_relaxed);
+}
+
+void SharedFrameRing::GetStats(SharedFrameRingStats& stats) const noexcept {
+  stats.written_frames = written_count_.load(std::memory_order_relaxed);
+  stats.dropped_frames = dropped_count_.load(std::memory_order_relaxed);
+}
+
+mrsResult SharedFrameReader::Open(
+    const char* name,
+    std::unique_ptr<SharedFrameReader>& reader) noexcept {
+  if (!name || !*name) {
+    return MRS_E_INVALID_PARAMETER;
+  }
+  std::unique_ptr<SharedMemory> memory = SharedMemory::Open(name);
+  if (!memory) {
+    return MRS_E_NOTFOUND;
+  }
+  if (memory->size() < kSlotHeadersOffset) {
+    return MRS_E_INVALID_PARAMETER;
+  }
+  const RingHeader* header = GetHeader(*memory);
+  if (header->magic != kRingMagic) {
+    return MRS_E_INVALID_PARAMETER;
+  }
+  std::atomic_thread_fence(std::memory_order_acquire);
+  const uint64_t num_slots = header->num_slots;
+  const uint64_t headers_size =
+      kSlotHeadersOffset + num_slots * kSlotHeaderSize;
+  if ((header->version != kRingVersion) || (num_slots < 2) ||
+      (header->data_offset < headers_size) ||
+      (header->data_offset + num_slots * header->slot_size > memory->size())) {
+    return MRS_E_INVALID_PARAMETER;
+  }
+  reader.reset(new SharedFrameReader(std::move(memory)));
+  return MRS_SUCCESS;
+}
+
+SharedFrameReader::SharedFrameReader(
+    std::unique_ptr<SharedMemory> memory) noexcept
+    : memory_(std::move(memory)) {}
+
+bool SharedFrameReader::Acquire(bool latest,
+                                VideoFrameInfo& frame,
+                                uint64_t& sequence) noexcept {
+  const RingHeader* header = GetHeader(*memory_);
+  const uint64_t newest = header->sequence.load(std::memory_order_acquire);
+  if (newest <= last_sequence_) {
+    return false;
+  }
+  const uint64_t num_slots = header->num_slots;
+  const uint64_t oldest = (newest > num_slots ? newest - num_slots + 1 : 1);
+  uint64_t next = (latest ? newest : std::max(last_sequence_ + 1, oldest));
+  for (; next <= newest; ++next) {
+    const SlotHeader* slot = GetSlot(*memory_, next);
+    if (slot->sequence.load(std::memory_order_acquire) != next) {
+      continue;  // overwritten
+    }
+    VideoFrameInfo info{};
+    info.format = slot->format;
+    info.width = slot->width;
+    info.height = slot->height;
+    info.rotation = slot->rotation;
+    info.timing = slot->timing;
+    const uint8_t* const data = GetSlotData(*memory_, next);
+    bool valid = (info.width > 0) && (info.height > 0);
+    for (int plane = 0; valid && (plane < 4); ++plane) {
+      if (slot->stride[plane] <= 0) {
+        continue;
+      }
+      int row_bytes = 0;
+      int rows = 0;
+      valid = GetPlaneSize(info.format, plane, info.width, info.height,
+                           &row_bytes, &rows) &&
+              (slot->stride[plane] == row_bytes) &&
+              (slot->offset[plane] + static_cast<uint64_t>(row_bytes) * rows <=
+               header->slot_size);
+      info.data[plane] = data + slot->offset[plane];
+      info.stride[plane] = slot->stride[plane];
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (!valid || (slot->sequence.load(std::memory_order_relaxed) != next)) {
+      continue;  // overwritten while reading the header
+    }
+    frame = info;
+    sequence = next;
+    last_sequence_ = next;
+    return true;
+  }
+  last_sequence_ = newest;
+  return false;
+}
+
+bool SharedFrameReader::Release(uint64_t sequence) const noexcept {
+  if (sequence == 0) {
+    return false;
+  }
+  std::atomic_thread_fence(std::memory_order_acquire);
+  return (GetSlot(*memory_, sequence)->sequence.load(
+              std::memory_order_relaxed) == sequence);
+}
+
+}  // namespace Microsoft::MixedReality::WebRTC
@@ -0,0 +1,325 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+// This is a precompiled header, it must be on its own, followed by a blank
+// line, to prevent clang-format from reordering it with other headers.
+#include "pch.h"
+
+#include "video_conversion.h"
+#include "worker_pool.h"
+
+namespace {
+
+using namespace Microsoft::MixedReality::WebRTC;
+
+/// Minimum number of pixels of a frame for the conversion to be split, below
+/// which the cost of dispatching to the workers outweighs the gain.
+constexpr int kMinParallelPixels = 1280 * 720;
+
+/// Minimum number of rows per band. This is even, so that all bands but the
+/// last one start and end on chroma row boundaries.
+constexpr int kMinBandRows = 64;
+
+/// Number of rows converted at once through an intermediate ARGB strip, for
+/// the conversions without a dedicated libyuv kernel. This is even, and small
+/// enough for the strip to stay in cache between the two steps.
+constexpr int kStripRows = 16;
+
+/// Get the vertical subsampling factor of a plane of the given format.
+int PlaneRowDivisor(VideoFrameFormat format, int plane) noexcept {
+  switch (format) {
+    case VideoFrameFormat::kI420A:
+      return ((plane == 1) || (plane == 2) ? 2 : 1);
+    case VideoFrameFormat::kNv12:
+      return (plane == 1 ? 2 : 1);
+    default:
+      return 1;
+  }
+}
+
+/// Get a view of the rows [row_begin:row_end[ of |frame|. |row_begin| must be
+/// even.
+VideoFrameInfo SliceRows(const VideoFrameInfo& frame,
+                         int row_begin,
+                         int row_end) noexcept {
+  VideoFrameInfo slice = frame;
+  slice.height = row_end - row_begin;
+  for (int plane = 0; plane < 4; ++plane) {
+    if (frame.data[plane]) {
+      const int row = row_begin / PlaneRowDivisor(frame.format, plane);
+      slice.data[plane] =
+          static_cast<const uint8_t*>(frame.data[plane]) +
+          static_cast<ptrdiff_t>(row) * frame.stride[plane];
+    }
+  }
+  return slice;
+}
+
+const uint8_t* Plane(const VideoFrameInfo& frame, int plane) noexcept {
+  return static_cast<const uint8_t*>(frame.data[plane]);
+}
+
+uint8_t* MutablePlane(const VideoFrameInfo& frame, int plane) noexcept {
+  return static_cast<uint8_t*>(const_cast<void*>(frame.data[plane]));
+}
+
+/// Convert the color planes of |src| to opaque ARGB with the given color
+/// matrix and range, ignoring the alpha plane if any.
+void ConvertColorToArgb(const VideoFrameInfo& src,
+                        uint8_t* dst,
+                        int dst_stride,
+                        VideoColorMatrix matrix,
+                        VideoColorRange range) noexcept {
+  const uint8_t* yptr = Plane(src, 0);
+  const uint8_t* uptr = Plane(src, 1);
+  const uint8_t* vptr = Plane(src, 2);
+  if (matrix == VideoColorMatrix::kBt709) {
+    libyuv::H420ToARGB(yptr, src.stride[0], uptr, src.stride[1], vptr,
+                       src.stride[2], dst, dst_stride, src.width, src.height);
+  } else if (range == VideoColorRange::kFull) {
+    libyuv::J420ToARGB(yptr, src.stride[0], uptr, src.stride[1], vptr,
+                       src.stride[2], dst, dst_stride, src.width, src.height);
+  } else {
+    libyuv::I420ToARGB(yptr, src.stride[0], uptr, src.stride[1], vptr,
+                       src.stride[2], dst, dst_stride, src.width, src.height);
+  }
+}
+
+/// Convert |src| to ARGB with the given color matrix and range, including
+/// the alpha plane if any. If |premultiply_alpha| is true, the color channels
+/// of frames with an alpha plane are multiplied by their alpha.
+void ConvertToArgb(const VideoFrameInfo& src,
+                   uint8_t* dst,
+                   int dst_stride,
+                   VideoColorMatrix matrix,
+                   VideoColorRange range,
+                   bool premultiply_alpha) noexcept {
+  const uint8_t* aptr = Plane(src, 3);
+  if (!aptr) {
+    ConvertColorToArgb(src, dst, dst_stride, matrix, range);
+    return;
+  }
+  if ((matrix == VideoColorMatrix::kBt601) &&
+      (range == VideoColorRange::kLimited)) {
+    // Convert, merge alpha, and premultiply in a single SIMD pass.
+    libyuv::I420AlphaToARGB(Plane(src, 0), src.stride[0], Plane(src, 1),
+                            src.stride[1], Plane(src, 2), src.stride[2], aptr,
+                            src.stride[3], dst, dst_stride, src.width,
+                            src.height, premultiply_alpha ? 1 : 0);
+    return;
+  }
+
+  // There is no single-pass kernel for the other color spaces, so merge the
+  // alpha plane and premultiply in strips, while the converted rows are still
+  // in cache.
+  for (int row = 0; row < src.height; row += kStripRows) {
+    const int row_end = std::min(row + kStripRows, src.height);
+    const VideoFrameInfo slice = SliceRows(src, row, row_end);
+    uint8_t* const dst_rows = dst + static_cast<ptrdiff_t>(row) * dst_stride;
+    ConvertColorToArgb(slice, dst_rows, dst_stride, matrix, range);
+    libyuv::ARGBCopyYToAlpha(Plane(slice, 3), slice.stride[3], dst_rows,
+                             dst_stride, slice.width, slice.height);
+    if (premultiply_alpha) {
+      libyuv::ARGBAttenuate(dst_rows, dst_stride, dst_rows, dst_stride,
+                            slice.width, slice.height);
+    }
+  }
+}
+
+/// Repack the ARGB pixels |src| into the packed format of |dst|.
+void RepackArgb(const uint8_t* src,
+                int src_stride,
+                const VideoFrameInfo& dst) noexcept {
+  uint8_t* const dst_ptr = MutablePlane(dst, 0);
+  switch (dst.format) {
+    case VideoFrameFormat::kRgba32:
+      // R, G, B, A bytes, that is libyuv ABGR.
+      libyuv::ARGBToABGR(src, src_stride, dst_ptr, dst.stride[0], dst.width,
+                         dst.height);
+      break;
+    case VideoFrameFormat::kRgb24:
+      // R, G, B bytes, that is libyuv RAW.
+      libyuv::ARGBToRAW(src, src_stride, dst_ptr, dst.stride[0], dst.width,
+                        dst.height);
+      break;
+    default:
+      RTC_NOTREACHED();
+      break;
+  }
+}
+
+/// Convert |src| to the packed format of |dst| in strips of |kStripRows| rows,
+/// going through an intermediate ARGB strip which stays in cache.
+void ConvertThroughArgbStrips(const VideoFrameInfo& src,
+                              const VideoFrameInfo& dst,
+                              VideoColorMatrix matrix,
+                              VideoColorRange range,
+                              bool premultiply_alpha) noexcept {
+  thread_local std::vector<uint8_t> strip;
+  const int strip_stride = src.width * 4;
+  strip.resize(static_cast<size_t>(strip_stride) * kStripRows);
+  for (int row = 0; row < src.height; row += kStripRows) {
+    const int row_end = std::min(row + kStripRows, src.height);
+    ConvertToArgb(SliceRows(src, row, row_end), strip.data(), strip_stride,
+                  matrix, range, premultiply_alpha);
+    RepackArgb(strip.data(), strip_stride, SliceRows(dst, row, row_end));
+  }
+}
+
+/// Convert |src| into |dst|, both views of the same rows of their frame.
+void ConvertSlice(const VideoFrameInfo& src,
+                  const VideoFrameInfo& dst,
+                  VideoColorMatrix matrix,
+                  VideoColorRange range,
+                  bool premultiply_alpha) noexcept {
+  const uint8_t* yptr = Plane(src, 0);
+  const uint8_t* uptr = Plane(src, 1);
+  const uint8_t* vptr = Plane(src, 2);
+  const bool has_alpha = (src.data[3] != nullptr);
+  const bool is_default_color = (matrix == VideoColorMatrix::kBt601) &&
+                                (range == VideoColorRange::kLimited);
+  uint8_t* const dst_ptr = MutablePlane(dst, 0);
+  switch (dst.format) {
+    // B, G, R, A bytes, that is libyuv ARGB.
+    case VideoFrameFormat::kArgb32:
+    case VideoFrameFormat::kBgra32:
+      ConvertToArgb(src, dst_ptr, dst.stride[0], matrix, range,
+                    premultiply_alpha);
+      break;
+    case VideoFrameFormat::kNv12:
+      libyuv::I420ToNV12(yptr, src.stride[0], uptr, src.stride[1], vptr,
+                         src.stride[2], dst_ptr, dst.stride[0],
+                         MutablePlane(dst, 1), dst.stride[1], src.width,
+                         src.height);
+      break;
+    case VideoFrameFormat::kRgba32:
+      if (is_default_color && !has_alpha) {
+        libyuv::I420ToABGR(yptr, src.stride[0], uptr, src.stride[1], vptr,
+                           src.stride[2], dst_ptr, dst.stride[0], src.width,
+                           src.height);
+      } else {
+        ConvertThroughArgbStrips(src, dst, matrix, range, premultiply_alpha);
+      }
+      break;
+    case VideoFrameFormat::kRgb24:
+      if (is_default_color) {
+        libyuv::I420ToRAW(yptr, src.stride[0], uptr, src.stride[1], vptr,
+                          src.stride[2], dst_ptr, dst.stride[0], src.width,
+                          src.height);
+      } else {
+        // No alpha channel to premultiply.
+        ConvertThroughArgbStrips(src, dst, matrix, range, false);
+      }
+      break;
+    default:
+      RTC_NOTREACHED();
+      break;
+  }
+}
+
+}  // namespace
+
+namespace Microsoft::MixedReality::WebRTC {
+
+bool IsConversionSupported(VideoFrameFormat format,
+                           VideoColorMatrix matrix,
+                           VideoColorRange range) noexcept {
+  const bool valid_matrix = (matrix == VideoColorMatrix::kBt601) ||
+                            (matrix == VideoColorMatrix::kBt709);
+  const bool valid_range = (range == VideoColorRange::kLimited) ||
+                           (range == VideoColorRange::kFull);
+  if (!valid_matrix || !valid_range) {
+    return false;
+  }
+  switch (format) {
+    case VideoFrameFormat::kNv12:
+      return true;
+    case VideoFrameFormat::kArgb32:
+    case VideoFrameFormat::kRgba32:
+    case VideoFrameFormat::kBgra32:
+    case VideoFrameFormat::kRgb24:
+      // libyuv has no BT.709 full range kernels.
+      return (matrix == VideoColorMatrix::kBt601) ||
+             (range == VideoColorRange::kLimited);
+    default:
+      return false;
+  }
+}
+
+void ConvertI420A(const VideoFrameInfo& src,
+                  const VideoFrameInfo& dst,
+                  VideoColorMatrix matrix,
+                  VideoColorRange range,
+                  bool premultiply_alpha,
+                  WorkerPool* pool) noexcept {
+  RTC_DCHECK(IsConversionSupported(dst.format, matrix, range));
+  RTC_DCHECK_EQ(src.width, dst.width);
+  RTC_DCHECK_EQ(src.height, dst.height);
+  if (!pool || (src.width * src.height < kMinParallelPixels)) {
+    ConvertSlice(src, dst, matrix, range, premultiply_alpha);
+    return;
+  }
+
+  // Split into one band per thread, including the calling thread, with an
+  // even number of rows per band.
+  const int max_bands = std::max(src.height / kMinBandRows, 1);
+  const int num_bands = std::min(pool->num_threads() + 1, max_bands);
+  const int band_rows = ((src.height + num_bands - 1) / num_bands + 1) & ~1;
+  pool->ParallelFor(num_bands, [&](int band) {
+    const int row_begin = band * band_rows;
+    const int row_end = std::min(row_begin + band_rows, src.height);
+    if (row_begin < row_end) {
+      ConvertSlice(SliceRows(src, row_begin, row_end),
+                   SliceRows(dst, row_begin, row_end), matrix, range,
+                   premultiply_alpha);
+    }
+  });
+}
+
+void FitResolution(int width,
+                   int height,
+                   int max_width,
+                   int max_height,
+                   int* out_width,
+                   int* out_height) noexcept {
+  RTC_DCHECK(out_width && out_height);
+  const bool fits_width = (max_width <= 0) || (width <= max_width);
+  const bool fits_height = (max_height <= 0) || (height <= max_height);
+  if (fits_width && fits_height) {
+    *out_width = width;
+    *out_height = height;
+    return;
+  }
+  // Use the most constraining dimension, in 64-bit to avoid overflows.
+  int64_t num = 1;
+  int64_t den = 1;
+  if (!fits_width) {
+    num = max_width;
+    den = width;
+  }
+  if (!fits_height && (max_height * den < num * height)) {
+    num = max_height;
+    den = height;
+  }
+  const int scaled_width = static_cast<int>(width * num / den) & ~1;
+  const int scaled_height = static_cast<int>(height * num / den) & ~1;
+  *out_width = std::max(scaled_width, 2);
+  *out_height = std::max(scaled_height, 2);
+}
+
+void ScaleI420A(const VideoFrameInfo& src, const VideoFrameInfo& dst) noexcept {
+  RTC_DCHECK(src.format == VideoFrameFormat::kI420A);
+  RTC_DCHECK(dst.format == VideoFrameFormat::kI420A);
+  libyuv::I420Scale(Plane(src, 0), src.stride[0], Plane(src, 1), src.stride[1],
+                    Plane(src, 2), src.stride[2], src.width, src.height,
+                    MutablePlane(dst, 0), dst.stride[0], MutablePlane(dst, 1),
+                    dst.stride[1], MutablePlane(dst, 2), dst.stride[2],
+                    dst.width, dst.height, libyuv::kFilterBox);
+  if (src.data[3] && dst.data[3]) {
+    libyuv::ScalePlane(Plane(src, 3), src.stride[3], src.width, src.height,
+                       MutablePlane(dst, 3), dst.stride[3], dst.width,
+                       dst.height, libyuv::kFilterBox);
+  }
+}
+
+}  // namespace Microsoft::MixedReality::WebRTC
@@ -0,0 +1,61 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+// This is a precompiled header, it must be on its own, followed by a blank
+// line, to prevent clang-format from reordering it with other headers.
+#include "pch.h"
+
+#include "video_frame_mailbox.h"
+
+namespace Microsoft::MixedReality::WebRTC {
+
+VideoFrameMailbox::VideoFrameMailbox(int capacity, DeliverFunc deliver)
+    : capacity_(capacity),
+      deliver_(std::move(deliver)),
+      thread_([this]() { Run(); }) {
+  RTC_DCHECK_GT(capacity, 0);
+}
+
+VideoFrameMailbox::~VideoFrameMailbox() {
+  RTC_DCHECK(!IsDeliveryThread());
+  {
+    auto lock = std::scoped_lock{mutex_};
+    stopping_ = true;
+  }
+  cv_.notify_one();
+  thread_.join();
+}
+
+void VideoFrameMailbox::Post(const webrtc::VideoFrame& frame,
+                             int64_t post_time_us) {
+  {
+    auto lock = std::scoped_lock{mutex_};
+    if (frames_.size() >= static_cast<size_t>(capacity_)) {
+      frames_.pop_front();
+      dropped_count_.fetch_add(1, std::memory_order_relaxed);
+    }
+    frames_.push_back(PendingFrame{frame, post_time_us});
+  }
+  cv_.notify_one();
+}
+
+void VideoFrameMailbox::Run() {
+  std::unique_lock<std::mutex> lock{mutex_};
+  for (;;) {
+    cv_.wait(lock, [this]() { return stopping_ || !frames_.empty(); });
+    if (stopping_) {
+      return;
+    }
+    PendingFrame pending = std::move(frames_.front());
+    frames_.pop_front();
+
+    // Deliver without holding the lock, so that the producer can post the
+    // next frames in the meantime.
+    lock.unlock();
+    deliver_(pending.frame, pending.post_time_us);
+    delivered_count_.fetch_add(1, std::memory_order_relaxed);
+    lock.lock();
+  }
+}
+
+}  // namespace Microsoft::MixedReality::WebRTC
@@ -4,120 +4,544 @@
 
 #include "pch.h"
 
+#include "absl/container/inlined_vector.h"
+#include "common_video/include/video_frame_buffer.h"
+
+#include "interop/global_factory.h"
+#include "jpeg_encoder.h"
+#include "video_conversion.h"
 #include "video_frame_observer.h"
+#include "video_frame_ref.h"
 
 namespace {
 
 // Aligning pointer to 64 bytes for improved performance, e.g. use SIMD.
 constexpr int kBufferAlignment = 64;
 
+/// Process-wide pool of the buffers into which |PixelBuffer::ToI420()|
+/// converts, shared by all observers since few frames are converted back.
+Microsoft::MixedReality::WebRTC::PixelBufferPool& ConversionPool() noexcept {
+  static Microsoft::MixedReality::WebRTC::PixelBufferPool pool;
+  return pool;
+}
+
 }  // namespace
 
 namespace Microsoft::MixedReality::WebRTC {
 
-ArgbBuffer::ArgbBuffer(int width, int height, int stride) noexcept
-    : width_(width),
-      height_(height),
-      stride_(stride),
-      data_(static_cast<uint8_t*>(
-          webrtc::AlignedMalloc(ArgbDataSize(height, stride),
-                                kBufferAlignment))) {
+rtc::scoped_refptr<PixelBuffer> PixelBuffer::Create(VideoFrameFormat format,
+                                                   int width,
+                                                   int height,
+                                                   bool alpha) {
+  return new rtc::RefCountedObject<PixelBuffer>(format, width, height, alpha);
+}
+
+PixelBuffer::PixelBuffer(VideoFrameFormat format,
+                         int width,
+                         int height,
+                         bool alpha) noexcept
+    : format_(format), width_(width), height_(height) {
   RTC_DCHECK_GT(width, 0);
   RTC_DCHECK_GT(height, 0);
-  RTC_DCHECK_GE(stride, 4 * width);
+  const int chroma_width = (width + 1) / 2;
+  const int chroma_height = (height + 1) / 2;
+  int rows[4]{};
+  switch (format) {
+    case VideoFrameFormat::kI420A:
+      num_planes_ = (alpha ? 4 : 3);
+      stride_[0] = stride_[3] = width;
+      stride_[1] = stride_[2] = chroma_width;
+      rows[0] = rows[3] = height;
+      rows[1] = rows[2] = chroma_height;
+      break;
+    case VideoFrameFormat::kNv12:
+      num_planes_ = 2;
+      stride_[0] = width;
+      stride_[1] = chroma_width * 2;
+      rows[0] = height;
+      rows[1] = chroma_height;
+      break;
+    case VideoFrameFormat::kRgb24:
+      num_planes_ = 1;
+      stride_[0] = width * 3;
+      rows[0] = height;
+      break;
+    default:
+      RTC_DCHECK(format == VideoFrameFormat::kArgb32 ||
+                 format == VideoFrameFormat::kRgba32 ||
+                 format == VideoFrameFormat::kBgra32);
+      num_planes_ = 1;
+      stride_[0] = width * 4;
+      rows[0] = height;
+      break;
+  }
+  for (int plane = 0; plane < num_planes_; ++plane) {
+    // Keep all planes aligned like the first one.
+    offset_[plane] = (size_ + kBufferAlignment - 1) & ~(kBufferAlignment - 1);
+    size_ = offset_[plane] + static_cast<size_t>(rows[plane]) * stride_[plane];
+  }
+  data_.reset(
+      static_cast<uint8_t*>(webrtc::AlignedMalloc(size_, kBufferAlignment)));
 }
 
-rtc::scoped_refptr<webrtc::I420BufferInterface> ArgbBuffer::ToI420() {
-  rtc::scoped_refptr<webrtc::I420Buffer> i420_buffer =
-      webrtc::I420Buffer::Create(width_, height_, stride_, stride_ / 2,
-                                 stride_ / 2);
-  libyuv::ARGBToI420(Data(), Stride(), i420_buffer->MutableDataY(),
-                     i420_buffer->StrideY(), i420_buffer->MutableDataU(),
-                     i420_buffer->StrideU(), i420_buffer->MutableDataV(),
-                     i420_buffer->StrideV(), width_, height_);
-  return i420_buffer;
+rtc::scoped_refptr<webrtc::I420BufferInterface> PixelBuffer::ToI420() {
+  if (format_ == VideoFrameFormat::kI420A) {
+    // Reference the planes in place, keeping this buffer alive meanwhile.
+    rtc::scoped_refptr<PixelBuffer> self(this);
+    return webrtc::WrapI420Buffer(width_, height_, Data(0), Stride(0), Data(1),
+                                  Stride(1), Data(2), Stride(2), [self]() {});
+  }
+  auto lock = std::scoped_lock{i420_mutex_};
+  if (i420_buffer_) {
+    return i420_buffer_;
+  }
+  rtc::scoped_refptr<PixelBuffer> i420_buffer = ConversionPool().Checkout(
+      VideoFrameFormat::kI420A, width_, height_);
+  uint8_t* const yptr = i420_buffer->Data(0);
+  uint8_t* const uptr = i420_buffer->Data(1);
+  uint8_t* const vptr = i420_buffer->Data(2);
+  const int ystride = i420_buffer->Stride(0);
+  const int ustride = i420_buffer->Stride(1);
+  const int vstride = i420_buffer->Stride(2);
+  switch (format_) {
+    case VideoFrameFormat::kArgb32:
+    case VideoFrameFormat::kBgra32:
+      libyuv::ARGBToI420(Data(), Stride(), yptr, ystride, uptr, ustride, vptr,
+                         vstride, width_, height_);
+      break;
+    case VideoFrameFormat::kNv12:
+      libyuv::NV12ToI420(Data(0), Stride(0), Data(1), Stride(1), yptr, ystride,
+                         uptr, ustride, vptr, vstride, width_, height_);
+      break;
+    case VideoFrameFormat::kRgba32:
+      libyuv::ABGRToI420(Data(), Stride(), yptr, ystride, uptr, ustride, vptr,
+                         vstride, width_, height_);
+      break;
+    case VideoFrameFormat::kRgb24:
+      libyuv::RAWToI420(Data(), Stride(), yptr, ystride, uptr, ustride, vptr,
+                        vstride, width_, height_);
+      break;
+    default:
+      RTC_NOTREACHED();
+      break;
+  }
+  i420_buffer_ = i420_buffer->ToI420();
+  return i420_buffer_;
+}
+
+rtc::scoped_refptr<PixelBuffer> PixelBufferPool::Checkout(
+    VideoFrameFormat format,
+    int width,
+    int height,
+    bool alpha) {
+  // Alpha only applies to I420A, so ignore it otherwise to share buckets.
+  alpha = alpha && (format == VideoFrameFormat::kI420A);
+  auto lock = std::scoped_lock{mutex_};
+  const uint64_t now = ++checkout_count_;
+  auto matches = [format, width, height, alpha](const Bucket& bucket) {
+    return (bucket.format == format) && (bucket.width == width) &&
+           (bucket.height == height) && (bucket.alpha == alpha);
+  };
+
+  // Trim the other buckets not used recently, deallocating their free buffers.
+  // Buffers still checked out are freed on return.
+  buckets_.erase(std::remove_if(buckets_.begin(), buckets_.end(),
+                                [&matches, now](const Bucket& bucket) {
+                                  return !matches(bucket) &&
+                                         (now - bucket.last_checkout >
+                                          kTrimAfterCheckouts);
+                                }),
+                 buckets_.end());
+
+  // Release the conversions of the buffers returned to the pool, which would
+  // otherwise pin buffers of the conversion pool while unused. The pool holds
+  // the only reference to a returned buffer, and only hands it out again under
+  // its mutex, so no consumer can access the conversion concurrently.
+  for (const Bucket& bucket : buckets_) {
+    for (const PooledBuffer& buffer : bucket.buffers) {
+      if (buffer->HasOneRef()) {
+        buffer->i420_buffer_ = nullptr;
+      }
+    }
+  }
+
+  auto it = std::find_if(buckets_.begin(), buckets_.end(), matches);
+  if (it == buckets_.end()) {
+    buckets_.push_back(Bucket{format, width, height, alpha, now, {}});
+    it = buckets_.end() - 1;
+  }
+  it->last_checkout = now;
+
+  // A buffer is free if the pool holds its only reference.
+  for (const PooledBuffer& buffer : it->buffers) {
+    if (buffer->HasOneRef()) {
+      return buffer;
+    }
+  }
+  PooledBuffer buffer =
+      new rtc::RefCountedObject<PixelBuffer>(format, width, height, alpha);
+  if (it->buffers.size() < static_cast<size_t>(capacity_)) {
+    it->buffers.push_back(buffer);
+  }
+  return buffer;
+}
+
+VideoFrameObserver::~VideoFrameObserver() {
+  // Stop the delivery thread before destroying the members it accesses.
+  ReplaceMailbox(nullptr);
+  for (const SnapshotRequest& request : snapshot_requests_) {
+    request.callback(MRS_E_INVALID_OPERATION, nullptr, 0);
+  }
 }
 
 void VideoFrameObserver::SetCallback(
     I420AFrameReadyCallback callback) noexcept {
-  auto lock = std::scoped_lock{mutex_};
-  i420a_callback_ = std::move(callback);
+  callbacks_.Update([&callback](Callbacks& callbacks) {
+    callbacks.i420a_callback = callback;
+  });
 }
 
 void VideoFrameObserver::SetCallback(ARGBFrameReadyCallback callback) noexcept {
-  auto lock = std::scoped_lock{mutex_};
-  argb_callback_ = std::move(callback);
+  callbacks_.Update([&callback](Callbacks& callbacks) {
+    callbacks.argb_callback = callback;
+  });
 }
 
-ArgbBuffer* VideoFrameObserver::GetArgbScratchBuffer(int width, int height) {
-  const size_t needed_size = ArgbDataSize(width, height);
-  if (auto* buffer = argb_scratch_buffer_.get()) {
-    if (buffer->Size() >= needed_size) {
-      return buffer;
+void VideoFrameObserver::SetCallback(
+    VideoFrameHandleCallback callback) noexcept {
+  callbacks_.Update([&callback](Callbacks& callbacks) {
+    callbacks.frame_handle_callback = callback;
+  });
+}
+
+mrsResult VideoFrameObserver::AddSink(
+    const VideoSinkConfiguration& config,
+    VideoFrameHandleCallback callback,
+    VideoSinkId& sink_id,
+    rtc::scoped_refptr<rtc::RefCountInterface> owner) noexcept {
+  if (!callback) {
+    return MRS_E_INVALID_PARAMETER;
+  }
+  if ((config.format != VideoFrameFormat::kI420A) &&
+      !IsConversionSupported(config.format, config.color_matrix,
+                             config.color_range)) {
+    return MRS_E_INVALID_PARAMETER;
+  }
+  if ((config.max_width < 0) || (config.max_height < 0) ||
+      !(config.max_framerate >= 0.0)) {
+    return MRS_E_INVALID_PARAMETER;
+  }
+  std::shared_ptr<FrameRateLimiter> rate_limiter;
+  if (config.max_framerate > 0.0) {
+    rate_limiter = std::make_shared<FrameRateLimiter>(config.max_framerate);
+  }
+  sink_id = next_sink_id_++;
+  callbacks_.Update([&](Callbacks& callbacks) {
+    callbacks.sinks.push_back(
+        Sink{sink_id, config, callback, rate_limiter, owner});
+  });
+  return MRS_SUCCESS;
+}
+
+mrsResult VideoFrameObserver::RemoveSink(VideoSinkId sink_id) noexcept {
+  bool found = false;
+  callbacks_.Update([sink_id, &found](Callbacks& callbacks) {
+    auto it = std::find_if(callbacks.sinks.begin(), callbacks.sinks.end(),
+                           [sink_id](const Sink& sink) {
+                             return (sink.id == sink_id);
+                           });
+    if (it != callbacks.sinks.end()) {
+      callbacks.sinks.erase(it);
+      found = true;
     }
+  });
+  return (found ? MRS_SUCCESS : MRS_E_INVALID_PARAMETER);
+}
+
+void VideoFrameObserver::SetParallelConversion(bool enabled) noexcept {
+  // Acquire the pool outside of the update, which cannot fail.
+  std::shared_ptr<WorkerPool> pool;
+  if (enabled) {
+    pool = GlobalFactory::Instance()->GetWorkerPool();
   }
-  argb_scratch_buffer_ = ArgbBuffer::Create(width, height);
-  return argb_scratch_buffer_.get();
+  callbacks_.Update([&pool](Callbacks& callbacks) {
+    callbacks.worker_pool = pool;
+  });
+}
+
+void VideoFrameObserver::SetApplyRotation(bool apply_rotation) noexcept {
+  apply_rotation_.store(apply_rotation, std::memory_order_relaxed);
+}
+
+rtc::VideoSinkWants VideoFrameObserver::GetSinkWants() const noexcept {
+  rtc::VideoSinkWants sink_settings{};
+  sink_settings.rotation_applied =
+      apply_rotation_.load(std::memory_order_relaxed);
+  return sink_settings;
+}
+
+mrsResult VideoFrameObserver::SetAsyncDelivery(int mailbox_size) noexcept {
+  if (mailbox_size < 0) {
+    return MRS_E_INVALID_PARAMETER;
+  }
+  bool is_delivery_thread = false;
+  callbacks_.Read([&is_delivery_thread](const Callbacks& callbacks) {
+    is_delivery_thread =
+        (callbacks.mailbox && callbacks.mailbox->IsDeliveryThread());
+  });
+  if (is_delivery_thread) {
+    // The delivery thread cannot join itself.
+    return MRS_E_INVALID_OPERATION;
+  }
+  std::shared_ptr<VideoFrameMailbox> mailbox;
+  if (mailbox_size > 0) {
+    mailbox = std::make_shared<VideoFrameMailbox>(
+        mailbox_size,
+        [this](const webrtc::VideoFrame& frame, int64_t arrival_time_us) {
+          callbacks_.Read([&](const Callbacks& callbacks) {
+            DispatchFrame(callbacks, frame, arrival_time_us);
+          });
+        });
+  }
+  ReplaceMailbox(std::move(mailbox));
+  return MRS_SUCCESS;
+}
+
+void VideoFrameObserver::GetAsyncDeliveryStats(
+    VideoDeliveryStats& stats) const noexcept {
+  stats = VideoDeliveryStats{};
+  callbacks_.Read([&stats](const Callbacks& callbacks) {
+    if (callbacks.mailbox) {
+      stats.delivered_frames = callbacks.mailbox->delivered_count();
+      stats.dropped_frames = callbacks.mailbox->dropped_count();
+    }
+  });
+}
+
+mrsResult VideoFrameObserver::CaptureSnapshot(
+    const VideoSnapshotConfiguration& config,
+    VideoSnapshotReadyCallback callback) noexcept {
+  if (!callback || (config.max_width < 0) || (config.max_height < 0) ||
+      (config.quality < 1) || (config.quality > 100)) {
+    return MRS_E_INVALID_PARAMETER;
+  }
+  auto lock = std::scoped_lock{snapshot_mutex_};
+  snapshot_requests_.push_back(SnapshotRequest{config, std::move(callback)});
+  snapshot_pending_.store(true, std::memory_order_release);
+  return MRS_SUCCESS;
+}
+
+void VideoFrameObserver::ReplaceMailbox(
+    std::shared_ptr<VideoFrameMailbox> mailbox) noexcept {
+  std::shared_ptr<VideoFrameMailbox> prev_mailbox;
+  callbacks_.Update([&](Callbacks& callbacks) {
+    prev_mailbox = callbacks.mailbox;
+    callbacks.mailbox = mailbox;
+  });
+  // The previous snapshot, which was the only other owner, was released by
+  // the update, so this stops and joins the previous delivery thread.
+  prev_mailbox.reset();
+}
+
+rtc::scoped_refptr<VideoFrameRef> VideoFrameObserver::Convert(
+    const VideoFrameInfo& src,
+    const VideoSinkConfiguration& config,
+    WorkerPool* pool) {
+  rtc::scoped_refptr<PixelBuffer> buffer =
+      buffer_pool_.Checkout(config.format, src.width, src.height);
+  rtc::scoped_refptr<VideoFrameRef> frame_ref =
+      VideoFrameRef::CreateFromPixelBuffer(std::move(buffer));
+  ConvertI420A(src, frame_ref->info(), config.color_matrix, config.color_range,
+               config.premultiply_alpha != mrsBool::kFalse, pool);
+  frame_ref->SetMetadata(src.timing, src.rotation);
+  return frame_ref;
+}
+
+rtc::scoped_refptr<VideoFrameRef> VideoFrameObserver::Scale(
+    const VideoFrameInfo& src,
+    int width,
+    int height) {
+  rtc::scoped_refptr<PixelBuffer> buffer = buffer_pool_.Checkout(
+      VideoFrameFormat::kI420A, width, height, src.data[3] != nullptr);
+  rtc::scoped_refptr<VideoFrameRef> frame_ref =
+      VideoFrameRef::CreateFromPixelBuffer(std::move(buffer));
+  ScaleI420A(src, frame_ref->info());
+  frame_ref->SetMetadata(src.timing, src.rotation);
+  return frame_ref;
 }
 
 void VideoFrameObserver::OnFrame(const webrtc::VideoFrame& frame) noexcept {
-  auto lock = std::scoped_lock{mutex_};
-  if (!i420a_callback_ && !argb_callback_)
-    return;
+  const int64_t arrival_time_us = rtc::TimeMicros();
+  callbacks_.Read([&](const Callbacks& callbacks) {
+    if (!callbacks.mailbox) {
+      DispatchFrame(callbacks, frame, arrival_time_us);
+      return;
+    }
+    // Hand the frame over to the delivery thread, without holding on to the
+    // decoder buffers if nobody consumes the frame.
+    const bool has_consumer =
+        (callbacks.i420a_callback || callbacks.argb_callback ||
+         callbacks.frame_handle_callback ||
+         snapshot_pending_.load(std::memory_order_acquire) ||
+         std::any_of(callbacks.sinks.begin(), callbacks.sinks.end(),
+                     [&frame](const Sink& sink) {
+                       return (!sink.rate_limiter ||
+                               sink.rate_limiter->IsDue(frame.timestamp_us()));
+                     }));
+    if (has_consumer) {
+      callbacks.mailbox->Post(frame, arrival_time_us);
+    }
+  });
+}
 
-  rtc::scoped_refptr<webrtc::VideoFrameBuffer> buffer(
-      frame.video_frame_buffer());
-
-  const int width = frame.width();
-  const int height = frame.height();
-
-  if (buffer->type() != webrtc::VideoFrameBuffer::Type::kI420A) {
-    // The buffer is not encoded in I420 with alpha channel; use I420 without
-    // alpha channel as interchange format for the callback, and convert the
-    // buffer to that (or do nothing if already in I420).
-    rtc::scoped_refptr<webrtc::I420BufferInterface> i420_buffer =
-        buffer->ToI420();
-    const uint8_t* yptr = i420_buffer->DataY();
-    const uint8_t* uptr = i420_buffer->DataU();
-    const uint8_t* vptr = i420_buffer->DataV();
-    const uint8_t* aptr = nullptr;
-
-    if (i420a_callback_) {
-      i420a_callback_(yptr, uptr, vptr, aptr, i420_buffer->StrideY(),
-                      i420_buffer->StrideU(), i420_buffer->StrideV(), 0, width,
-                      height);
+void VideoFrameObserver::DispatchFrame(const Callbacks& callbacks,
+                                       const webrtc::VideoFrame& frame,
+                                       int64_t arrival_time_us) noexcept {
+  // Skip the sinks limiting their frame rate before touching the frame, so
+  // that the frames dropped for all consumers are not even converted to I420.
+  absl::InlinedVector<const Sink*, 4> due_sinks;
+  for (const Sink& sink : callbacks.sinks) {
+    if (!sink.rate_limiter ||
+        sink.rate_limiter->TryDeliver(frame.timestamp_us())) {
+      due_sinks.push_back(&sink);
     }
+  }
+  const bool snapshot_due = snapshot_pending_.load(std::memory_order_acquire);
+  if (!callbacks.i420a_callback && !callbacks.argb_callback &&
+      !callbacks.frame_handle_callback && due_sinks.empty() && !snapshot_due)
+    return;
+
+  // Wrap the frame buffer into a reference-counted frame. If the buffer is not
+  // encoded in I420 or I420A, this converts it to I420, which is used as the
+  // interchange format for all callbacks and the source of other conversions.
+  VideoFrameTiming timing{};
+  timing.timestamp_us = frame.timestamp_us();
+  timing.ntp_time_ms = frame.ntp_time_ms();
+  timing.rtp_timestamp = frame.timestamp();
+  timing.arrival_time_us = arrival_time_us;
+  rtc::scoped_refptr<VideoFrameRef> frame_ref =
+      VideoFrameRef::Create(frame.video_frame_buffer());
+  frame_ref->SetMetadata(timing,
+                         static_cast<VideoRotation>(frame.rotation()));
+  const VideoFrameInfo& info = frame_ref->info();
+
+  if (callbacks.frame_handle_callback) {
+    // The callee can acquire a reference to keep the frame alive after the
+    // callback returns; otherwise the frame is released below.
+    callbacks.frame_handle_callback(&info);
+  }
+
+  if (callbacks.i420a_callback) {
+    callbacks.i420a_callback(info.data[0], info.data[1], info.data[2],
+                             info.data[3], info.stride[0], info.stride[1],
+                             info.stride[2], info.stride[3], info.width,
+                             info.height);
+  }
 
-    if (argb_callback_) {
-      ArgbBuffer* const argb_buffer = GetArgbScratchBuffer(width, height);
-      libyuv::I420ToARGB(yptr, i420_buffer->StrideY(), uptr,
-                         i420_buffer->StrideU(), vptr, i420_buffer->StrideV(),
-                         argb_buffer->Data(), argb_buffer->Stride(), width,
-                         height);
-      argb_callback_(argb_buffer->Data(), argb_buffer->Stride(), width, height);
+  // Scale at most once per resolution, on first use, and share the result
+  // with all the sinks requesting it. There is no libyuv kernel scaling and
+  // converting at once, so frames are scaled first in I420A, which also makes
+  // the conversion below cheaper.
+  struct ScaledFrame {
+    int width;
+    int height;
+    rtc::scoped_refptr<VideoFrameRef> frame_ref;
+  };
+  absl::InlinedVector<ScaledFrame, 2> scaled_frames;
+  auto get_scaled = [&](const VideoSinkConfiguration& config)
+      -> const VideoFrameInfo& {
+    int width;
+    int height;
+    FitResolution(info.width, info.height, config.max_width, config.max_height,
+                  &width, &height);
+    if ((width == info.width) && (height == info.height)) {
+      return info;
     }
+    for (const ScaledFrame& scaled : scaled_frames) {
+      if ((scaled.width == width) && (scaled.height == height)) {
+        return scaled.frame_ref->info();
+      }
+    }
+    scaled_frames.push_back(
+        ScaledFrame{width, height, Scale(info, width, height)});
+    return scaled_frames.back().frame_ref->info();
+  };
 
-  } else {
-    // The buffer is encoded in I420 with alpha channel, use it directly.
-    webrtc::I420ABufferInterface* i420a_buffer = buffer->GetI420A();
-    const uint8_t* yptr = i420a_buffer->DataY();
-    const uint8_t* uptr = i420a_buffer->DataU();
-    const uint8_t* vptr = i420a_buffer->DataV();
-    const uint8_t* aptr = i420a_buffer->DataA();
-
-    if (i420a_callback_) {
-      i420a_callback_(yptr, uptr, vptr, aptr, i420a_buffer->StrideY(),
-                      i420a_buffer->StrideU(), i420a_buffer->StrideV(),
-                      i420a_buffer->StrideA(), width, height);
+  // Convert at most once per resolution, format and color conversion, on
+  // first use, and share the result with the ARGB callback and all the sinks
+  // requesting it.
+  struct ConvertedFrame {
+    VideoSinkConfiguration config;
+    rtc::scoped_refptr<VideoFrameRef> frame_ref;
+  };
+  absl::InlinedVector<ConvertedFrame, 4> converted_frames;
+  auto get_converted = [&](const VideoSinkConfiguration& config)
+      -> const VideoFrameInfo& {
+    const VideoFrameInfo& src = get_scaled(config);
+    if (config.format == VideoFrameFormat::kI420A) {
+      return src;
+    }
+    for (const ConvertedFrame& converted : converted_frames) {
+      const VideoFrameInfo& converted_info = converted.frame_ref->info();
+      if ((converted.config.format == config.format) &&
+          (converted.config.color_matrix == config.color_matrix) &&
+          (converted.config.color_range == config.color_range) &&
+          (converted.config.premultiply_alpha == config.premultiply_alpha) &&
+          (converted_info.width == src.width) &&
+          (converted_info.height == src.height)) {
+        return converted_info;
+      }
     }
+    converted_frames.push_back(ConvertedFrame{
+        config, Convert(src, config, callbacks.worker_pool.get())});
+    return converted_frames.back().frame_ref->info();
+  };
 
-    if (argb_callback_) {
-      ArgbBuffer* const argb_buffer = GetArgbScratchBuffer(width, height);
-      libyuv::I420AlphaToARGB(
-          yptr, i420a_buffer->StrideY(), uptr, i420a_buffer->StrideU(), vptr,
-          i420a_buffer->StrideV(), aptr, i420a_buffer->StrideA(),
-          argb_buffer->Data(), argb_buffer->Stride(), width, height, 0);
-      argb_callback_(argb_buffer->Data(), argb_buffer->Stride(), width, height);
+  for (const Sink* sink : due_sinks) {
+    sink->callback(&get_converted(sink->config));
+  }
+
+  if (callbacks.argb_callback) {
+    VideoSinkConfiguration argb_config{};
+    argb_config.format = VideoFrameFormat::kArgb32;
+    const VideoFrameInfo& argb_info = get_converted(argb_config);
+    callbacks.argb_callback(argb_info.data[0], argb_info.stride[0],
+                            argb_info.width, argb_info.height);
+  }
+
+  if (snapshot_due) {
+    std::vector<SnapshotRequest> requests;
+    {
+      auto lock = std::scoped_lock{snapshot_mutex_};
+      requests.swap(snapshot_requests_);
+      snapshot_pending_.store(false, std::memory_order_relaxed);
+    }
+    // Encode off the delivery thread, retaining the frame, which is shared
+    // with the sinks requesting the same resolution, and the pool, since the
+    // callback can shut down the library by releasing its last object. If the
+    // library is already shut down, encode on the delivery thread instead.
+    std::shared_ptr<WorkerPool> pool =
+        GlobalFactory::Instance()->GetWorkerPool();
+    for (SnapshotRequest& request : requests) {
+      VideoSinkConfiguration scale_config{};
+      scale_config.max_width = request.config.max_width;
+      scale_config.max_height = request.config.max_height;
+      rtc::scoped_refptr<VideoFrameRef> snapshot(
+          static_cast<VideoFrameRef*>(get_scaled(scale_config).handle));
+      std::function<void()> encode = [pool, snapshot = std::move(snapshot),
+                                      request]() {
+        std::vector<uint8_t> jpeg;
+        if (EncodeJpeg(snapshot->info(), request.config.quality, jpeg)) {
+          request.callback(MRS_SUCCESS, jpeg.data(), jpeg.size());
+        } else {
+          request.callback(MRS_E_UNKNOWN, nullptr, 0);
+        }
+      };
+      if (pool) {
+        pool->Post(std::move(encode));
+      } else {
+        encode();
+      }
     }
   }
 }
@@ -0,0 +1,98 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+// This is a precompiled header, it must be on its own, followed by a blank
+// line, to prevent clang-format from reordering it with other headers.
+#include "pch.h"
+
+#include "video_frame_queue.h"
+#include "video_frame_ref.h"
+
+namespace Microsoft::MixedReality::WebRTC {
+
+rtc::scoped_refptr<VideoFrameQueue> VideoFrameQueue::Create(
+    int capacity) noexcept {
+  return new rtc::RefCountedObject<VideoFrameQueue>(capacity);
+}
+
+VideoFrameQueue::VideoFrameQueue(int capacity) noexcept
+    : capacity_(capacity), slots_(new Slot[capacity]) {
+  RTC_DCHECK_GT(capacity, 0);
+  for (int i = 0; i < capacity; ++i) {
+    slots_[i].sequence.store(static_cast<uint64_t>(i),
+                             std::memory_order_relaxed);
+  }
+}
+
+void VideoFrameQueue::Enqueue(
+    rtc::scoped_refptr<VideoFrameRef> frame) noexcept {
+  // Reserve the slot at the write index, unless not consumed yet.
+  uint64_t pos = tail_.load(std::memory_order_relaxed);
+  Slot* slot;
+  for (;;) {
+    slot = &slots_[pos % capacity_];
+    const uint64_t sequence = slot->sequence.load(std::memory_order_acquire);
+    if (sequence == pos) {
+      if (tail_.compare_exchange_weak(pos, pos + 1,
+                                      std::memory_order_relaxed)) {
+        break;
+      }
+    } else if (sequence < pos) {
+      overflow_count_.fetch_add(1, std::memory_order_relaxed);
+      return;
+    } else {
+      // Another producer reserved this slot first.
+      pos = tail_.load(std::memory_order_relaxed);
+    }
+  }
+  slot->frame = std::move(frame);
+  slot->sequence.store(pos + 1, std::memory_order_release);
+}
+
+VideoFrameRef* VideoFrameQueue::TryDequeue(int64_t presentation_time_us,
+                                           bool* is_new_frame) noexcept {
+  // Consume all the frames published and due, keeping only the latest one.
+  uint64_t head = head_.load(std::memory_order_relaxed);
+  rtc::scoped_refptr<VideoFrameRef> frame;
+  for (;;) {
+    Slot& slot = slots_[head % capacity_];
+    if ((slot.sequence.load(std::memory_order_acquire) != head + 1) ||
+        (slot.frame->info().timing.timestamp_us > presentation_time_us)) {
+      break;
+    }
+    if (frame) {
+      late_count_.fetch_add(1, std::memory_order_relaxed);
+    }
+    frame = std::move(slot.frame);
+    slot.sequence.store(head + capacity_, std::memory_order_release);
+    ++head;
+  }
+  head_.store(head, std::memory_order_release);
+
+  if (frame) {
+    current_ = std::move(frame);
+    dequeued_count_.fetch_add(1, std::memory_order_relaxed);
+    *is_new_frame = true;
+  } else {
+    if (current_) {
+      repeated_count_.fetch_add(1, std::memory_order_relaxed);
+    }
+    *is_new_frame = false;
+  }
+  return current_.get();
+}
+
+void VideoFrameQueue::GetStats(VideoFrameQueueStats& stats) const noexcept {
+  const uint64_t head = head_.load(std::memory_order_acquire);
+  const uint64_t tail = tail_.load(std::memory_order_acquire);
+  stats.enqueued_frames =
+      tail + overflow_count_.load(std::memory_order_relaxed);
+  stats.dequeued_frames = dequeued_count_.load(std::memory_order_relaxed);
+  stats.late_frames = late_count_.load(std::memory_order_relaxed);
+  stats.overflow_frames = overflow_count_.load(std::memory_order_relaxed);
+  stats.repeated_frames = repeated_count_.load(std::memory_order_relaxed);
+  stats.pending_frames =
+      static_cast<uint32_t>(tail > head ? tail - head : 0);
+}
+
+}  // namespace Microsoft::MixedReality::WebRTC
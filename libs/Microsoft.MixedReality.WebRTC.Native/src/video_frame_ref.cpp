@@ -0,0 +1,65 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+// This is a precompiled header, it must be on its own, followed by a blank
+// line, to prevent clang-format from reordering it with other headers.
+#include "pch.h"
+
+#include "video_frame_observer.h"
+#include "video_frame_ref.h"
+
+namespace Microsoft::MixedReality::WebRTC {
+
+rtc::scoped_refptr<VideoFrameRef> VideoFrameRef::Create(
+    rtc::scoped_refptr<webrtc::VideoFrameBuffer> buffer) noexcept {
+  VideoFrameInfo info{};
+  info.format = VideoFrameFormat::kI420A;
+  info.width = buffer->width();
+  info.height = buffer->height();
+  if (buffer->type() == webrtc::VideoFrameBuffer::Type::kI420A) {
+    const webrtc::I420ABufferInterface* i420a_buffer = buffer->GetI420A();
+    info.data[0] = i420a_buffer->DataY();
+    info.data[1] = i420a_buffer->DataU();
+    info.data[2] = i420a_buffer->DataV();
+    info.data[3] = i420a_buffer->DataA();
+    info.stride[0] = i420a_buffer->StrideY();
+    info.stride[1] = i420a_buffer->StrideU();
+    info.stride[2] = i420a_buffer->StrideV();
+    info.stride[3] = i420a_buffer->StrideA();
+  } else {
+    // Use I420 without alpha channel as interchange format, and convert the
+    // buffer to that (or do nothing if already in I420).
+    rtc::scoped_refptr<webrtc::I420BufferInterface> i420_buffer =
+        buffer->ToI420();
+    info.data[0] = i420_buffer->DataY();
+    info.data[1] = i420_buffer->DataU();
+    info.data[2] = i420_buffer->DataV();
+    info.stride[0] = i420_buffer->StrideY();
+    info.stride[1] = i420_buffer->StrideU();
+    info.stride[2] = i420_buffer->StrideV();
+    buffer = std::move(i420_buffer);
+  }
+  return new rtc::RefCountedObject<VideoFrameRef>(std::move(buffer), info);
+}
+
+rtc::scoped_refptr<VideoFrameRef> VideoFrameRef::CreateFromPixelBuffer(
+    rtc::scoped_refptr<PixelBuffer> buffer) noexcept {
+  VideoFrameInfo info{};
+  info.format = buffer->format();
+  info.width = buffer->width();
+  info.height = buffer->height();
+  for (int plane = 0; plane < buffer->num_planes(); ++plane) {
+    info.data[plane] = buffer->Data(plane);
+    info.stride[plane] = buffer->Stride(plane);
+  }
+  return new rtc::RefCountedObject<VideoFrameRef>(std::move(buffer), info);
+}
+
+VideoFrameRef::VideoFrameRef(
+    rtc::scoped_refptr<webrtc::VideoFrameBuffer> buffer,
+    const VideoFrameInfo& info) noexcept
+    : buffer_(std::move(buffer)), info_(info) {
+  info_.handle = GetHandle();
+}
+
+}  // namespace Microsoft::MixedReality::WebRTC
@@ -0,0 +1,289 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+// This is a precompiled header, it must be on its own, followed by a blank
+// line, to prevent clang-format from reordering it with other headers.
+#include "pch.h"
+
+#include "absl/container/inlined_vector.h"
+
+#include "video_conversion.h"
+#include "video_frame_ref.h"
+#include "video_mosaic.h"
+#include "worker_pool.h"
+
+namespace {
+
+using namespace Microsoft::MixedReality::WebRTC;
+
+/// Opaque black in 32-bit ARGB.
+constexpr uint32_t kArgbBlack = 0xFF000000u;
+
+uint8_t* MutablePlane(const VideoFrameInfo& frame, int plane) noexcept {
+  return static_cast<uint8_t*>(const_cast<void*>(frame.data[plane]));
+}
+
+/// Compute the largest resolution fitting in a |tile_width| x |tile_height|
+/// tile which preserves the aspect ratio of a |width| x |height| frame, with
+/// even dimensions. Unlike |FitResolution()|, this also upscales small frames.
+void FitToTile(int width,
+               int height,
+               int tile_width,
+               int tile_height,
+               int* out_width,
+               int* out_height) noexcept {
+  int fit_width = tile_width;
+  int fit_height = tile_height;
+  if (static_cast<int64_t>(width) * tile_height >=
+      static_cast<int64_t>(height) * tile_width) {
+    fit_height = static_cast<int>(static_cast<int64_t>(tile_width) * height /
+                                  width);
+  } else {
+    fit_width = static_cast<int>(static_cast<int64_t>(tile_height) * width /
+                                 height);
+  }
+  *out_width = std::max(2, fit_width & ~1);
+  *out_height = std::max(2, fit_height & ~1);
+}
+
+/// Get a view of the area of |canvas| at (x, y) of size w x h. The coordinates
+/// must be even for I420A canvases.
+VideoFrameInfo CanvasArea(const VideoFrameInfo& canvas,
+                          int x,
+                          int y,
+                          int w,
+                          int h) noexcept {
+  VideoFrameInfo area = canvas;
+  area.width = w;
+  area.height = h;
+  auto offset = [&](int plane, int col, int row) {
+    area.data[plane] = static_cast<const uint8_t*>(canvas.data[plane]) +
+                       static_cast<ptrdiff_t>(row) * canvas.stride[plane] + col;
+  };
+  if (canvas.format == VideoFrameFormat::kArgb32) {
+    offset(0, x * 4, y);
+  } else {
+    offset(0, x, y);
+    offset(1, x / 2, y / 2);
+    offset(2, x / 2, y / 2);
+    if (canvas.data[3]) {
+      offset(3, x, y);
+    }
+  }
+  return area;
+}
+
+}  // namespace
+
+namespace Microsoft::MixedReality::WebRTC {
+
+VideoMosaic::Tile::~Tile() noexcept {
+  if (VideoFrameRef* frame = pending_.exchange(nullptr)) {
+    frame->Release();
+  }
+}
+
+void VideoMosaic::Tile::Enqueue(
+    rtc::scoped_refptr<VideoFrameRef> frame) noexcept {
+  if (!frame || (frame->info().format != VideoFrameFormat::kI420A)) {
+    return;
+  }
+  VideoFrameRef* previous =
+      pending_.exchange(frame.release(), std::memory_order_acq_rel);
+  if (previous) {
+    previous->Release();
+    mosaic_->dropped_count_.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+void VideoMosaic::Tile::Clear() noexcept {
+  clear_requested_.store(true, std::memory_order_release);
+}
+
+mrsResult VideoMosaic::Create(
+    const VideoMosaicConfiguration& config,
+    const VideoFrameInfo& canvas,
+    std::shared_ptr<WorkerPool> pool,
+    rtc::scoped_refptr<VideoMosaic>& mosaic) noexcept {
+  if ((config.columns <= 0) || (config.rows <= 0) ||
+      (canvas.format != config.format) || (canvas.width <= 0) ||
+      (canvas.height <= 0)) {
+    return MRS_E_INVALID_PARAMETER;
+  }
+  if (config.format == VideoFrameFormat::kArgb32) {
+    if (!canvas.data[0] || (canvas.stride[0] < canvas.width * 4) ||
+        !IsConversionSupported(config.format, config.color_matrix,
+                               config.color_range)) {
+      return MRS_E_INVALID_PARAMETER;
+    }
+  } else if (config.format == VideoFrameFormat::kI420A) {
+    const int chroma_width = (canvas.width + 1) / 2;
+    if (!canvas.data[0] || !canvas.data[1] || !canvas.data[2] ||
+        (canvas.stride[0] < canvas.width) ||
+        (canvas.stride[1] < chroma_width) ||
+        (canvas.stride[2] < chroma_width) ||
+        (canvas.data[3] && (canvas.stride[3] < canvas.width))) {
+      return MRS_E_INVALID_PARAMETER;
+    }
+  } else {
+    return MRS_E_INVALID_PARAMETER;
+  }
+  // Each tile must be at least 2x2 pixels once rounded down to even sizes.
+  if ((canvas.width / config.columns < 2) ||
+      (canvas.height / config.rows < 2)) {
+    return MRS_E_INVALID_PARAMETER;
+  }
+  mosaic = new rtc::RefCountedObject<VideoMosaic>(config, canvas,
+                                                  std::move(pool));
+  return MRS_SUCCESS;
+}
+
+VideoMosaic::VideoMosaic(const VideoMosaicConfiguration& config,
+                         const VideoFrameInfo& canvas,
+                         std::shared_ptr<WorkerPool> pool) noexcept
+    : config_(config),
+      canvas_(canvas),
+      pool_(std::move(pool)),
+      num_tiles_(config.columns * config.rows),
+      tiles_(new Tile[num_tiles_]) {
+  // Even tile sizes keep the chroma samples of the tiles of an I420A canvas
+  // disjoint, so that tiles can be drawn concurrently.
+  const int tile_width = (canvas.width / config.columns) & ~1;
+  const int tile_height = (canvas.height / config.rows) & ~1;
+  for (int i = 0; i < num_tiles_; ++i) {
+    Tile& tile = tiles_[i];
+    tile.mosaic_ = this;
+    tile.x_ = (i % config.columns) * tile_width;
+    tile.y_ = (i / config.columns) * tile_height;
+    tile.width_ = tile_width;
+    tile.height_ = tile_height;
+  }
+  FillBackground(0, 0, canvas.width, canvas.height);
+}
+
+bool VideoMosaic::Compose() noexcept {
+  // Collect the new frames, holding the reference handed over by the tiles.
+  absl::InlinedVector<std::pair<Tile*, VideoFrameRef*>, 16> updates;
+  bool cleared = false;
+  for (int i = 0; i < num_tiles_; ++i) {
+    Tile& tile = tiles_[i];
+    VideoFrameRef* frame =
+        tile.pending_.exchange(nullptr, std::memory_order_acq_rel);
+    if (tile.clear_requested_.exchange(false, std::memory_order_acquire)) {
+      if (frame) {
+        frame->Release();
+        frame = nullptr;
+      }
+      FillBackground(tile.x_, tile.y_, tile.width_, tile.height_);
+      tile.frame_width_ = 0;
+      tile.frame_height_ = 0;
+      cleared = true;
+    }
+    if (frame) {
+      updates.emplace_back(&tile, frame);
+    }
+  }
+
+  const int num_updates = static_cast<int>(updates.size());
+  auto draw = [&](int index) {
+    Draw(*updates[index].first, updates[index].second->info());
+  };
+  if (pool_ && (num_updates > 1)) {
+    pool_->ParallelFor(num_updates, draw);
+  } else {
+    for (int i = 0; i < num_updates; ++i) {
+      draw(i);
+    }
+  }
+  for (auto&& update : updates) {
+    update.second->Release();
+  }
+
+  if (num_updates > 0) {
+    drawn_count_.fetch_add(num_updates, std::memory_order_relaxed);
+  }
+  if ((num_updates > 0) || cleared) {
+    composed_count_.fetch_add(1, std::memory_order_relaxed);
+    return true;
+  }
+  return false;
+}
+
+void VideoMosaic::GetStats(VideoMosaicStats& stats) const noexcept {
+  stats.composed_frames = composed_count_.load(std::memory_order_relaxed);
+  stats.drawn_tiles = drawn_count_.load(std::memory_order_relaxed);
+  stats.dropped_frames = dropped_count_.load(std::memory_order_relaxed);
+}
+
+void VideoMosaic::FillBackground(int x, int y, int w, int h) noexcept {
+  if (canvas_.format == VideoFrameFormat::kArgb32) {
+    libyuv::ARGBRect(MutablePlane(canvas_, 0), canvas_.stride[0], x, y, w, h,
+                     kArgbBlack);
+    return;
+  }
+  const int black_y =
+      (config_.color_range == VideoColorRange::kFull ? 0 : 16);
+  libyuv::I420Rect(MutablePlane(canvas_, 0), canvas_.stride[0],
+                   MutablePlane(canvas_, 1), canvas_.stride[1],
+                   MutablePlane(canvas_, 2), canvas_.stride[2], x, y, w, h,
+                   black_y, 128, 128);
+  if (canvas_.data[3]) {
+    const VideoFrameInfo area = CanvasArea(canvas_, x, y, w, h);
+    libyuv::SetPlane(MutablePlane(area, 3), area.stride[3], w, h, 255);
+  }
+}
+
+void VideoMosaic::Draw(Tile& tile, const VideoFrameInfo& frame) noexcept {
+  int width;
+  int height;
+  FitToTile(frame.width, frame.height, tile.width_, tile.height_, &width,
+            &height);
+
+  // Clear the letterbox bars when the frame resolution changes.
+  if ((frame.width != tile.frame_width_) ||
+      (frame.height != tile.frame_height_)) {
+    FillBackground(tile.x_, tile.y_, tile.width_, tile.height_);
+    tile.frame_width_ = frame.width;
+    tile.frame_height_ = frame.height;
+  }
+  const int x = tile.x_ + (((tile.width_ - width) / 2) & ~1);
+  const int y = tile.y_ + (((tile.height_ - height) / 2) & ~1);
+  const VideoFrameInfo dst = CanvasArea(canvas_, x, y, width, height);
+
+  if (canvas_.format == VideoFrameFormat::kI420A) {
+    ScaleI420A(frame, dst);
+    if (dst.data[3] && !frame.data[3]) {
+      libyuv::SetPlane(MutablePlane(dst, 3), dst.stride[3], width, height,
+                       255);
+    }
+    return;
+  }
+
+  // Scale in YUV before converting, which touches fewer samples than scaling
+  // the converted ARGB frame.
+  VideoFrameInfo scaled = frame;
+  if ((width != frame.width) || (height != frame.height)) {
+    if (!tile.scaled_ || (tile.scaled_->width() != width) ||
+        (tile.scaled_->height() != height)) {
+      tile.scaled_ = webrtc::I420Buffer::Create(width, height);
+    }
+    scaled.width = width;
+    scaled.height = height;
+    scaled.data[0] = tile.scaled_->MutableDataY();
+    scaled.data[1] = tile.scaled_->MutableDataU();
+    scaled.data[2] = tile.scaled_->MutableDataV();
+    scaled.stride[0] = tile.scaled_->StrideY();
+    scaled.stride[1] = tile.scaled_->StrideU();
+    scaled.stride[2] = tile.scaled_->StrideV();
+    if (frame.data[3]) {
+      tile.scaled_alpha_.resize(static_cast<size_t>(width) * height);
+      scaled.data[3] = tile.scaled_alpha_.data();
+      scaled.stride[3] = width;
+    }
+    ScaleI420A(frame, scaled);
+  }
+  ConvertI420A(scaled, dst, config_.color_matrix, config_.color_range, false,
+               nullptr);
+}
+
+}  // namespace Microsoft::MixedReality::WebRTC
@@ -0,0 +1,237 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+// This is a precompiled header, it must be on its own, followed by a blank
+// line, to prevent clang-format from reordering it with other headers.
+#include "pch.h"
+
+#include "video_tensor_converter.h"
+
+namespace {
+
+using namespace Microsoft::MixedReality::WebRTC;
+
+/// Number of rows converted at once to ARGB. This is even, and small enough
+/// for the ARGB strip to stay in cache until normalized.
+constexpr int kStripRows = 16;
+
+const uint8_t* Plane(const VideoFrameInfo& frame, int plane) noexcept {
+  return static_cast<const uint8_t*>(frame.data[plane]);
+}
+
+/// Convert I420 planes to ARGB with the libyuv kernel of the given color
+/// matrix and range. BT.709 full range has no kernel, and is not supported.
+void ConvertToArgb(const uint8_t* y_plane,
+                   int y_stride,
+                   const uint8_t* u_plane,
+                   int u_stride,
+                   const uint8_t* v_plane,
+                   int v_stride,
+                   uint8_t* dst,
+                   int dst_stride,
+                   int width,
+                   int height,
+                   VideoColorMatrix matrix,
+                   VideoColorRange range) noexcept {
+  if (matrix == VideoColorMatrix::kBt709) {
+    libyuv::H420ToARGB(y_plane, y_stride, u_plane, u_stride, v_plane, v_stride,
+                       dst, dst_stride, width, height);
+  } else if (range == VideoColorRange::kFull) {
+    libyuv::J420ToARGB(y_plane, y_stride, u_plane, u_stride, v_plane, v_stride,
+                       dst, dst_stride, width, height);
+  } else {
+    libyuv::I420ToARGB(y_plane, y_stride, u_plane, u_stride, v_plane, v_stride,
+                       dst, dst_stride, width, height);
+  }
+}
+
+/// Compute the largest resolution fitting in |max_width| x |max_height| which
+/// preserves the aspect ratio of a |width| x |height| frame, upscaling small
+/// frames.
+void FitToTensor(int width,
+                 int height,
+                 int max_width,
+                 int max_height,
+                 int* out_width,
+                 int* out_height) noexcept {
+  if (static_cast<int64_t>(width) * max_height >=
+      static_cast<int64_t>(height) * max_width) {
+    *out_width = max_width;
+    *out_height = static_cast<int>(static_cast<int64_t>(max_width) * height /
+                                   width);
+  } else {
+    *out_width = static_cast<int>(static_cast<int64_t>(max_height) * width /
+                                  height);
+    *out_height = max_height;
+  }
+  *out_width = std::max(*out_width, 1);
+  *out_height = std::max(*out_height, 1);
+}
+
+}  // namespace
+
+namespace Microsoft::MixedReality::WebRTC {
+
+mrsResult VideoTensorConverter::Create(
+    const VideoTensorConfiguration& config,
+    VideoTensorReadyCallback callback,
+    rtc::scoped_refptr<VideoTensorConverter>& converter) noexcept {
+  // libyuv has no BT.709 full range kernel.
+  const bool valid_color =
+      ((config.color_matrix == VideoColorMatrix::kBt601) &&
+       ((config.color_range == VideoColorRange::kLimited) ||
+        (config.color_range == VideoColorRange::kFull))) ||
+      ((config.color_matrix == VideoColorMatrix::kBt709) &&
+       (config.color_range == VideoColorRange::kLimited));
+  if ((config.width <= 0) || (config.height <= 0) || !valid_color ||
+      (config.letterbox_value < 0) || (config.letterbox_value > 255) ||
+      (config.std[0] == 0.0f) || (config.std[1] == 0.0f) ||
+      (config.std[2] == 0.0f)) {
+    return MRS_E_INVALID_PARAMETER;
+  }
+  converter =
+      new rtc::RefCountedObject<VideoTensorConverter>(config, callback);
+  return MRS_SUCCESS;
+}
+
+VideoTensorConverter::VideoTensorConverter(
+    const VideoTensorConfiguration& config,
+    VideoTensorReadyCallback callback) noexcept
+    : config_(config), callback_(callback) {
+  // Shifts of the R, G and B channels in the little-endian ARGB pixels.
+  constexpr int kShifts[3] = {16, 8, 0};
+  for (int i = 0; i < 3; ++i) {
+    // Source channel of the output plane, and its normalization.
+    const int c = (config.bgr != mrsBool::kFalse) ? 2 - i : i;
+    channels_[i].shift = kShifts[c];
+    channels_[i].scale = config.scale / config.std[c];
+    channels_[i].bias = -config.mean[c] / config.std[c];
+    border_[i] = config.letterbox_value * channels_[i].scale +
+                 channels_[i].bias;
+  }
+}
+
+mrsResult VideoTensorConverter::Convert(const VideoFrameInfo& frame,
+                                        float* tensor,
+                                        VideoTensorInfo& info) noexcept {
+  if ((frame.format != VideoFrameFormat::kI420A) || (frame.width <= 0) ||
+      (frame.height <= 0) || !tensor) {
+    return MRS_E_INVALID_PARAMETER;
+  }
+  auto lock = std::scoped_lock{mutex_};
+  ConvertLocked(frame, tensor, info);
+  return MRS_SUCCESS;
+}
+
+void VideoTensorConverter::OnFrame(const VideoFrameInfo& frame) noexcept {
+  if ((frame.format != VideoFrameFormat::kI420A) || (frame.width <= 0) ||
+      (frame.height <= 0) || !callback_) {
+    return;
+  }
+  auto lock = std::scoped_lock{mutex_};
+  tensor_.resize(tensor_size());
+  VideoTensorInfo info;
+  ConvertLocked(frame, tensor_.data(), info);
+  callback_(&info);
+}
+
+void VideoTensorConverter::ConvertLocked(const VideoFrameInfo& frame,
+                                         float* tensor,
+                                         VideoTensorInfo& info) noexcept {
+  const int width = config_.width;
+  const int height = config_.height;
+  int content_width = width;
+  int content_height = height;
+  if (config_.letterbox != mrsBool::kFalse) {
+    FitToTensor(frame.width, frame.height, width, height, &content_width,
+                &content_height);
+  }
+  const int content_x = (width - content_width) / 2;
+  const int content_y = (height - content_height) / 2;
+
+  // Scale the YUV planes, which is cheaper than scaling the float planes.
+  const uint8_t* y_plane = Plane(frame, 0);
+  const uint8_t* u_plane = Plane(frame, 1);
+  const uint8_t* v_plane = Plane(frame, 2);
+  int y_stride = frame.stride[0];
+  int u_stride = frame.stride[1];
+  int v_stride = frame.stride[2];
+  if ((content_width != frame.width) || (content_height != frame.height)) {
+    if (!scaled_ || (scaled_->width() != content_width) ||
+        (scaled_->height() != content_height)) {
+      scaled_ = webrtc::I420Buffer::Create(content_width, content_height);
+    }
+    libyuv::I420Scale(y_plane, y_stride, u_plane, u_stride, v_plane, v_stride,
+                      frame.width, frame.height, scaled_->MutableDataY(),
+                      scaled_->StrideY(), scaled_->MutableDataU(),
+                      scaled_->StrideU(), scaled_->MutableDataV(),
+                      scaled_->StrideV(), content_width, content_height,
+                      libyuv::kFilterBox);
+    y_plane = scaled_->DataY();
+    u_plane = scaled_->DataU();
+    v_plane = scaled_->DataV();
+    y_stride = scaled_->StrideY();
+    u_stride = scaled_->StrideU();
+    v_stride = scaled_->StrideV();
+  }
+
+  const size_t plane_size = static_cast<size_t>(width) * height;
+  float* const planes[3] = {tensor, tensor + plane_size,
+                            tensor + 2 * plane_size};
+  const int content_end_x = content_x + content_width;
+  const int content_end_y = content_y + content_height;
+  for (int i = 0; i < 3; ++i) {
+    float* const plane = planes[i];
+    std::fill_n(plane, static_cast<size_t>(content_y) * width, border_[i]);
+    for (int row = content_y; row < content_end_y; ++row) {
+      float* const row_ptr = plane + static_cast<size_t>(row) * width;
+      std::fill_n(row_ptr, content_x, border_[i]);
+      std::fill_n(row_ptr + content_end_x, width - content_end_x, border_[i]);
+    }
+    std::fill(plane + static_cast<size_t>(content_end_y) * width,
+              plane + plane_size, border_[i]);
+  }
+
+  // Convert in strips, and normalize each channel of the strip into its plane
+  // while the strip is still in cache. libyuv clamps the channels.
+  strip_.resize(static_cast<size_t>(content_width) * kStripRows);
+  uint8_t* const strip = reinterpret_cast<uint8_t*>(strip_.data());
+  const int strip_stride = content_width * 4;
+  for (int row = 0; row < content_height; row += kStripRows) {
+    const int num_rows = std::min(kStripRows, content_height - row);
+    ConvertToArgb(y_plane + static_cast<ptrdiff_t>(row) * y_stride, y_stride,
+                  u_plane + static_cast<ptrdiff_t>(row / 2) * u_stride,
+                  u_stride,
+                  v_plane + static_cast<ptrdiff_t>(row / 2) * v_stride,
+                  v_stride, strip, strip_stride, content_width, num_rows,
+                  config_.color_matrix, config_.color_range);
+    for (int i = 0; i < 3; ++i) {
+      const int shift = channels_[i].shift;
+      const float scale = channels_[i].scale;
+      const float bias = channels_[i].bias;
+      for (int strip_row = 0; strip_row < num_rows; ++strip_row) {
+        const uint32_t* const src =
+            strip_.data() + static_cast<size_t>(strip_row) * content_width;
+        float* const dst =
+            planes[i] +
+            static_cast<size_t>(content_y + row + strip_row) * width +
+            content_x;
+        for (int x = 0; x < content_width; ++x) {
+          const int value = static_cast<int>((src[x] >> shift) & 0xFFu);
+          dst[x] = value * scale + bias;
+        }
+      }
+    }
+  }
+
+  info.data = tensor;
+  info.width = width;
+  info.height = height;
+  info.content_x = content_x;
+  info.content_y = content_y;
+  info.content_width = content_width;
+  info.content_height = content_height;
+  info.timing = frame.timing;
+}
+
+}  // namespace Microsoft::MixedReality::WebRTC
@@ -0,0 +1,116 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+// This is a precompiled header, it must be on its own, followed by a blank
+// line, to prevent clang-format from reordering it with other headers.
+#include "pch.h"
+
+#include "worker_pool.h"
+
+namespace Microsoft::MixedReality::WebRTC {
+
+WorkerPool::WorkerPool(int num_threads) {
+  threads_.reserve(num_threads);
+  for (int i = 0; i < num_threads; ++i) {
+    threads_.emplace_back([this]() { Run(); });
+  }
+}
+
+WorkerPool::~WorkerPool() {
+  RTC_DCHECK(!IsCurrent());
+  {
+    auto lock = std::scoped_lock{mutex_};
+    RTC_DCHECK(jobs_.empty());
+    stopping_ = true;
+  }
+  cv_.notify_all();
+  for (std::thread& thread : threads_) {
+    thread.join();
+  }
+}
+
+bool WorkerPool::IsCurrent() const noexcept {
+  const std::thread::id id = std::this_thread::get_id();
+  return std::any_of(
+      threads_.begin(), threads_.end(),
+      [id](const std::thread& thread) { return (thread.get_id() == id); });
+}
+
+void WorkerPool::ParallelFor(int count, const std::function<void(int)>& func) {
+  if ((count <= 1) || threads_.empty()) {
+    for (int i = 0; i < count; ++i) {
+      func(i);
+    }
+    return;
+  }
+
+  Job job{&func, count, 0, count};
+  std::unique_lock<std::mutex> lock{mutex_};
+  jobs_.push_back(&job);
+  lock.unlock();
+  cv_.notify_all();
+
+  // Help with the job until all indices are started.
+  lock.lock();
+  while (job.next < job.count) {
+    const int index = job.next++;
+    if (job.next == job.count) {
+      jobs_.erase(std::find(jobs_.begin(), jobs_.end(), &job));
+    }
+    lock.unlock();
+    func(index);
+    lock.lock();
+    --job.pending;
+  }
+
+  // Wait for the invocations started by the workers. Workers only access the
+  // job while holding the mutex, so it can be destroyed once this returns.
+  job.done.wait(lock, [&job]() { return (job.pending == 0); });
+}
+
+void WorkerPool::Post(std::function<void()> task) {
+  if (threads_.empty()) {
+    task();
+    return;
+  }
+  {
+    auto lock = std::scoped_lock{mutex_};
+    tasks_.push_back(std::move(task));
+  }
+  cv_.notify_one();
+}
+
+void WorkerPool::Run() {
+  std::unique_lock<std::mutex> lock{mutex_};
+  for (;;) {
+    cv_.wait(lock, [this]() {
+      return (stopping_ || !jobs_.empty() || !tasks_.empty());
+    });
+    if (jobs_.empty()) {
+      if (tasks_.empty()) {
+        return;  // stopping
+      }
+      {
+        std::function<void()> task = std::move(tasks_.front());
+        tasks_.pop_front();
+        lock.unlock();
+        task();
+      }
+      lock.lock();
+      continue;
+    }
+    Job* const job = jobs_.front();
+    const int index = job->next++;
+    if (job->next == job->count) {
+      jobs_.pop_front();
+    }
+    lock.unlock();
+    (*job->func)(index);
+    lock.lock();
+    if (--job->pending == 0) {
+      job->done.notify_one();
+    }
+  }
+}
+
+}  // namespace Microsoft::MixedReality::WebRTC
@@ -16,6 +16,9 @@ using AudioFrameCallback = InteropCallback<const void*,
                                            const uint32_t,
                                            const uint32_t>;
 
+// PeerConnectionAudioFrameInfoCallback
+using AudioFrameInfoCallback = InteropCallback<const AudioFrameInfo*>;
+
 bool IsSilent_uint8(const uint8_t* data,
                     uint32_t size,
                     uint8_t& min,
@@ -196,4 +199,90 @@ TEST(AudioTrack, Muted) {
                                                     nullptr);
 }
 
+TEST(AudioTrack, FrameTiming) {
+  LocalPeerPairRaii pair;
+
+  ASSERT_EQ(MRS_SUCCESS, mrsPeerConnectionAddLocalAudioTrack(pair.pc1()));
+
+  // The sample position advances continuously with the delivered samples
+  uint32_t call_count = 0;
+  uint64_t next_sample_position = 0;
+  int64_t last_arrival_time_us = 0;
+  AudioFrameInfoCallback audio_cb = [&](const AudioFrameInfo* frame) {
+    ASSERT_NE(nullptr, frame);
+    ASSERT_NE(nullptr, frame->data);
+    ASSERT_LT(0u, frame->number_of_frames);
+    ASSERT_EQ(next_sample_position, frame->timing.sample_position);
+    ASSERT_LE(last_arrival_time_us, frame->timing.arrival_time_us);
+    next_sample_position += frame->number_of_frames;
+    last_arrival_time_us = frame->timing.arrival_time_us;
+    ++call_count;
+  };
+  mrsPeerConnectionRegisterRemoteAudioFrameInfoCallback(pair.pc2(),
+                                                        CB(audio_cb));
+
+  pair.ConnectAndWait();
+
+  Event ev;
+  ev.WaitFor(5s);
+  ASSERT_LT(50u, call_count);  // at least 10 CPS
+  ASSERT_LE(last_arrival_time_us, mrsGetClockTimeUs());
+
+  mrsPeerConnectionRegisterRemoteAudioFrameInfoCallback(pair.pc2(), nullptr,
+                                                        nullptr);
+}
+
+TEST(AudioTrack, LocalFrames) {
+  LocalPeerPairRaii pair;
+
+  ASSERT_EQ(MRS_SUCCESS, mrsPeerConnectionAddLocalAudioTrack(pair.pc1()));
+
+  // The local frames are the raw 16-bit audio of the capture device, tapped
+  // from the audio device module, and stop while the track is disabled
+  std::atomic<uint32_t> call_count{0};
+  AudioFrameCallback audio_cb = [&call_count](const void* audio_data,
+                                              const uint32_t bits_per_sample,
+                                              const uint32_t sample_rate,
+                                              const uint32_t number_of_channels,
+                                              const uint32_t number_of_frames) {
+    ASSERT_NE(nullptr, audio_data);
+    ASSERT_EQ(16u, bits_per_sample);
+    ASSERT_LT(0u, sample_rate);
+    ASSERT_LT(0u, number_of_channels);
+    ASSERT_EQ(sample_rate / 100, number_of_frames);  // 10 ms chunks
+    ++call_count;
+  };
+  mrsPeerConnectionRegisterLocalAudioFrameCallback(pair.pc1(), CB(audio_cb));
+
+  pair.ConnectAndWait();
+
+  Event ev;
+  ev.WaitFor(5s);
+  ASSERT_LT(50u, call_count.load());  // at least 10 CPS
+
+  // No frame is delivered while the track is disabled, apart from a frame
+  // possibly in flight when disabling it
+  ASSERT_EQ(MRS_SUCCESS, mrsPeerConnectionSetLocalAudioTrackEnabled(
+                             pair.pc1(), mrsBool::kFalse));
+  ev.WaitFor(100ms);
+  const uint32_t disabled_count = call_count.load();
+  ev.WaitFor(1s);
+  ASSERT_EQ(disabled_count, call_count.load());
+
+  // Delivery resumes once the track is enabled again
+  ASSERT_EQ(MRS_SUCCESS, mrsPeerConnectionSetLocalAudioTrackEnabled(
+                             pair.pc1(), mrsBool::kTrue));
+  ev.WaitFor(1s);
+  ASSERT_LT(disabled_count, call_count.load());
+
+  // No frame is delivered once the track is removed
+  mrsPeerConnectionRemoveLocalAudioTrack(pair.pc1());
+  const uint32_t removed_count = call_count.load();
+  ev.WaitFor(1s);
+  ASSERT_EQ(removed_count, call_count.load());
+
+  mrsPeerConnectionRegisterLocalAudioFrameCallback(pair.pc1(), nullptr,
+                                                   nullptr);
+}
+
 #endif  // MRSW_EXCLUDE_DEVICE_TESTS
@@ -0,0 +1,579 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#include "pch.h"
+
+#include "interop/external_video_track_source_interop.h"
+#include "interop/interop_api.h"
+#include "interop/local_video_track_interop.h"
+#include "interop/video_frame_interop.h"
+
+namespace {
+
+// PeerConnectionVideoFrameHandleCallback
+using VideoFrameHandleCallback = InteropCallback<const VideoFrameInfo*>;
+
+/// Application-owned ARGB frames pushed without copy, and released by the
+/// source once not used anymore.
+struct ArgbFramePool {
+  static constexpr int kWidth = 320;
+  static constexpr int kHeight = 240;
+
+  explicit ArgbFramePool(int num_frames) : frames(num_frames) {
+    for (std::vector<uint8_t>& frame : frames) {
+      frame.resize(kWidth * kHeight * 4, 0x80);
+    }
+  }
+
+  static void MRS_CALL OnRelease(void* user_data) {
+    auto pool = static_cast<ArgbFramePool*>(user_data);
+    ++pool->release_count;
+  }
+
+  VideoFrameInfo GetInfo(int index) const {
+    VideoFrameInfo info{};
+    info.format = VideoFrameFormat::kArgb32;
+    info.width = kWidth;
+    info.height = kHeight;
+    info.data[0] = frames[index % frames.size()].data();
+    info.stride[0] = kWidth * 4;
+    return info;
+  }
+
+  std::vector<std::vector<uint8_t>> frames;
+  std::atomic_uint32_t release_count{0};
+};
+
+}  // namespace
+
+TEST(ExternalVideoTrackSource, InvalidParams) {
+  ExternalVideoTrackSourceHandle source{};
+  ASSERT_EQ(MRS_E_INVALID_PARAMETER,
+            mrsExternalVideoTrackSourceCreate(nullptr));
+  ASSERT_EQ(MRS_SUCCESS, mrsExternalVideoTrackSourceCreate(&source));
+  ASSERT_NE(nullptr, source);
+
+  // The release callback is invoked even on failure
+  ArgbFramePool pool(1);
+  VideoFrameInfo frame = pool.GetInfo(0);
+  frame.stride[0] = ArgbFramePool::kWidth;
+  ASSERT_EQ(MRS_E_INVALID_PARAMETER,
+            mrsExternalVideoTrackSourcePushFrame(
+                source, &frame, &ArgbFramePool::OnRelease, &pool));
+  frame.format = VideoFrameFormat::kRgb24;
+  ASSERT_EQ(MRS_E_INVALID_PARAMETER,
+            mrsExternalVideoTrackSourcePushFrame(
+                source, &frame, &ArgbFramePool::OnRelease, &pool));
+  ASSERT_EQ(MRS_E_INVALID_PARAMETER,
+            mrsExternalVideoTrackSourcePushFrame(
+                nullptr, &frame, &ArgbFramePool::OnRelease, &pool));
+  frame = pool.GetInfo(0);
+  frame.rotation = static_cast<VideoRotation>(45);
+  ASSERT_EQ(MRS_E_INVALID_PARAMETER,
+            mrsExternalVideoTrackSourcePushFrame(
+                source, &frame, &ArgbFramePool::OnRelease, &pool));
+  ASSERT_EQ(4u, pool.release_count.load());
+
+  mrsExternalVideoTrackSourceRemoveRef(source);
+}
+
+// Send frames pushed by the application, without any capture device.
+TEST(ExternalVideoTrackSource, Simple) {
+  // Outlives the peer connections, which release the frames on destruction
+  ArgbFramePool pool(4);
+  uint32_t num_pushed = 0;
+  {
+    LocalPeerPairRaii pair;
+
+    ExternalVideoTrackSourceHandle source{};
+    ASSERT_EQ(MRS_SUCCESS, mrsExternalVideoTrackSourceCreate(&source));
+    LocalVideoTrackHandle track_handle{};
+    ASSERT_EQ(MRS_SUCCESS,
+              mrsPeerConnectionAddLocalVideoTrackFromExternalSource(
+                  pair.pc1(), "external_video_track", source, &track_handle));
+    ASSERT_NE(nullptr, track_handle);
+
+    std::atomic_uint32_t local_count{0};
+    VideoFrameHandleCallback local_cb = [&](const VideoFrameInfo* frame) {
+      ASSERT_EQ(ArgbFramePool::kWidth, frame->width);
+      ASSERT_EQ(ArgbFramePool::kHeight, frame->height);
+      ++local_count;
+    };
+    mrsLocalVideoTrackRegisterFrameHandleCallback(track_handle, CB(local_cb));
+    std::atomic_uint32_t remote_count{0};
+    VideoFrameHandleCallback remote_cb = [&](const VideoFrameInfo* frame) {
+      ASSERT_LT(0, frame->width);
+      ASSERT_LT(0, frame->height);
+      ++remote_count;
+    };
+    mrsPeerConnectionRegisterRemoteVideoFrameHandleCallback(pair.pc2(),
+                                                            CB(remote_cb));
+
+    pair.ConnectAndWait();
+
+    // Push frames at ~30 fps from the application thread
+    const auto end = std::chrono::steady_clock::now() + 3s;
+    while (std::chrono::steady_clock::now() < end) {
+      const VideoFrameInfo frame = pool.GetInfo(num_pushed);
+      ASSERT_EQ(MRS_SUCCESS,
+                mrsExternalVideoTrackSourcePushFrame(
+                    source, &frame, &ArgbFramePool::OnRelease, &pool));
+      ++num_pushed;
+      std::this_thread::sleep_for(33ms);
+    }
+
+    mrsLocalVideoTrackRegisterFrameHandleCallback(track_handle, nullptr,
+                                                  nullptr);
+    mrsPeerConnectionRegisterRemoteVideoFrameHandleCallback(pair.pc2(),
+                                                            nullptr, nullptr);
+    ASSERT_LT(0u, local_count.load());
+    ASSERT_LT(0u, remote_count.load());
+
+    ASSERT_EQ(MRS_SUCCESS,
+              mrsPeerConnectionRemoveLocalVideoTrack(pair.pc1(), track_handle));
+    mrsLocalVideoTrackRemoveRef(track_handle);
+    mrsExternalVideoTrackSourceRemoveRef(source);
+  }
+
+  // All frames are released once the track and source are destroyed
+  ASSERT_EQ(num_pushed, pool.release_count.load());
+}
+
+// Sinks limiting their frame rate receive frames paced on their timestamp.
+TEST(ExternalVideoTrackSource, SinkFrameRateLimit) {
+  PCRaii pc;
+
+  ExternalVideoTrackSourceHandle source{};
+  ASSERT_EQ(MRS_SUCCESS, mrsExternalVideoTrackSourceCreate(&source));
+  LocalVideoTrackHandle track_handle{};
+  ASSERT_EQ(MRS_SUCCESS,
+            mrsPeerConnectionAddLocalVideoTrackFromExternalSource(
+                pc.handle(), "external_video_track", source, &track_handle));
+
+  uint32_t full_rate_count = 0;
+  VideoFrameHandleCallback full_rate_cb = [&](const VideoFrameInfo*) {
+    ++full_rate_count;
+  };
+  VideoSinkConfiguration full_rate_config{};
+  VideoSinkId full_rate_sink{};
+  ASSERT_EQ(MRS_SUCCESS,
+            mrsLocalVideoTrackAddSink(track_handle, full_rate_config,
+                                      CB(full_rate_cb), &full_rate_sink));
+
+  uint32_t limited_count = 0;
+  int64_t last_timestamp_us = 0;
+  VideoFrameHandleCallback limited_cb = [&](const VideoFrameInfo* frame) {
+    ASSERT_EQ(VideoFrameFormat::kArgb32, frame->format);
+    if (limited_count > 0) {
+      ASSERT_NEAR(100000, frame->timing.timestamp_us - last_timestamp_us, 1);
+    }
+    last_timestamp_us = frame->timing.timestamp_us;
+    ++limited_count;
+  };
+  VideoSinkConfiguration limited_config{};
+  limited_config.format = VideoFrameFormat::kArgb32;
+  limited_config.max_framerate = 10.0;
+  VideoSinkId limited_sink{};
+  ASSERT_EQ(MRS_SUCCESS,
+            mrsLocalVideoTrackAddSink(track_handle, limited_config,
+                                      CB(limited_cb), &limited_sink));
+
+  // Negative rates are invalid
+  limited_config.max_framerate = -1.0;
+  VideoSinkId invalid_sink{};
+  ASSERT_EQ(MRS_E_INVALID_PARAMETER,
+            mrsLocalVideoTrackAddSink(track_handle, limited_config,
+                                      CB(limited_cb), &invalid_sink));
+
+  // Push 3 seconds of 30 fps frames at once; the pacing only depends on the
+  // frame timestamps, not on the time the frames are pushed.
+  ArgbFramePool pool(1);
+  for (int i = 0; i < 90; ++i) {
+    VideoFrameInfo frame = pool.GetInfo(0);
+    frame.timing.timestamp_us = 1000000 + i * 33333;
+    ASSERT_EQ(MRS_SUCCESS,
+              mrsExternalVideoTrackSourcePushFrame(source, &frame, nullptr,
+                                                   nullptr));
+  }
+  ASSERT_EQ(90u, full_rate_count);
+  ASSERT_EQ(30u, limited_count);
+
+  ASSERT_EQ(MRS_SUCCESS,
+            mrsLocalVideoTrackRemoveSink(track_handle, full_rate_sink));
+  ASSERT_EQ(MRS_SUCCESS,
+            mrsLocalVideoTrackRemoveSink(track_handle, limited_sink));
+  ASSERT_EQ(MRS_SUCCESS,
+            mrsPeerConnectionRemoveLocalVideoTrack(pc.handle(), track_handle));
+  mrsLocalVideoTrackRemoveRef(track_handle);
+  mrsExternalVideoTrackSourceRemoveRef(source);
+}
+
+// Frames identical to the previous one are dropped, except keep-alive frames.
+TEST(ExternalVideoTrackSource, StaticFrameDetection) {
+  PCRaii pc;
+
+  ExternalVideoTrackSourceHandle source{};
+  ASSERT_EQ(MRS_SUCCESS, mrsExternalVideoTrackSourceCreate(&source));
+  LocalVideoTrackHandle track_handle{};
+  ASSERT_EQ(MRS_SUCCESS,
+            mrsPeerConnectionAddLocalVideoTrackFromExternalSource(
+                pc.handle(), "external_video_track", source, &track_handle));
+
+  StaticFrameDetectionConfiguration config{};
+  config.enabled = mrsBool::kTrue;
+  config.keepalive_interval_ms = -1;
+  ASSERT_EQ(MRS_E_INVALID_PARAMETER,
+            mrsLocalVideoTrackSetStaticFrameDetection(track_handle, config));
+  config.keepalive_interval_ms = 1000;
+  ASSERT_EQ(MRS_SUCCESS,
+            mrsLocalVideoTrackSetStaticFrameDetection(track_handle, config));
+
+  uint32_t frame_count = 0;
+  VideoFrameHandleCallback frame_cb = [&](const VideoFrameInfo*) {
+    ++frame_count;
+  };
+  mrsLocalVideoTrackRegisterFrameHandleCallback(track_handle, CB(frame_cb));
+
+  // 3 seconds of the same 30 fps frame: only the first frame and one
+  // keep-alive frame per second are forwarded.
+  ArgbFramePool pool(2);
+  std::fill(pool.frames[1].begin(), pool.frames[1].end(), uint8_t{0x40});
+  int64_t timestamp_us = 1000000;
+  for (int i = 0; i < 90; ++i, timestamp_us += 33333) {
+    VideoFrameInfo frame = pool.GetInfo(0);
+    frame.timing.timestamp_us = timestamp_us;
+    ASSERT_EQ(MRS_SUCCESS,
+              mrsExternalVideoTrackSourcePushFrame(source, &frame, nullptr,
+                                                   nullptr));
+  }
+  ASSERT_EQ(3u, frame_count);
+
+  // Changed content is forwarded at once
+  VideoFrameInfo frame = pool.GetInfo(1);
+  frame.timing.timestamp_us = timestamp_us;
+  ASSERT_EQ(MRS_SUCCESS, mrsExternalVideoTrackSourcePushFrame(
+                             source, &frame, nullptr, nullptr));
+  ASSERT_EQ(4u, frame_count);
+
+  StaticFrameStats stats{};
+  ASSERT_EQ(MRS_SUCCESS,
+            mrsLocalVideoTrackGetStaticFrameStats(track_handle, &stats));
+  ASSERT_EQ(91u, stats.processed_frames);
+  ASSERT_EQ(89u, stats.static_frames);
+  ASSERT_EQ(87u, stats.dropped_frames);
+
+  // Once disabled, all frames are forwarded
+  config.enabled = mrsBool::kFalse;
+  ASSERT_EQ(MRS_SUCCESS,
+            mrsLocalVideoTrackSetStaticFrameDetection(track_handle, config));
+  ASSERT_EQ(MRS_SUCCESS, mrsExternalVideoTrackSourcePushFrame(
+                             source, &frame, nullptr, nullptr));
+  ASSERT_EQ(5u, frame_count);
+
+  mrsLocalVideoTrackRegisterFrameHandleCallback(track_handle, nullptr,
+                                                nullptr);
+  ASSERT_EQ(MRS_SUCCESS,
+            mrsPeerConnectionRemoveLocalVideoTrack(pc.handle(), track_handle));
+  mrsLocalVideoTrackRemoveRef(track_handle);
+  mrsExternalVideoTrackSourceRemoveRef(source);
+}
+
+// ARGB frames are converted to I420 once for all their consumers, and their
+// application buffers are released as soon as they are converted, even if the
+// frame is still in use.
+TEST(ExternalVideoTrackSource, ReleaseAfterConversion) {
+  PCRaii pc;
+
+  ExternalVideoTrackSourceHandle source{};
+  ASSERT_EQ(MRS_SUCCESS, mrsExternalVideoTrackSourceCreate(&source));
+  LocalVideoTrackHandle track_handle{};
+  ASSERT_EQ(MRS_SUCCESS,
+            mrsPeerConnectionAddLocalVideoTrackFromExternalSource(
+                pc.handle(), "external_video_track", source, &track_handle));
+
+  // Retain the I420 frames delivered to a sink
+  std::vector<VideoFrameHandle> frames;
+  VideoFrameHandleCallback frame_cb = [&](const VideoFrameInfo* frame) {
+    mrsVideoFrameAddRef(frame->handle);
+    frames.push_back(frame->handle);
+  };
+  VideoSinkId sink_id{};
+  ASSERT_EQ(MRS_SUCCESS,
+            mrsLocalVideoTrackAddSink(track_handle, VideoSinkConfiguration{},
+                                      CB(frame_cb), &sink_id));
+
+  ArgbFramePool pool(2);
+  for (int i = 0; i < 2; ++i) {
+    const VideoFrameInfo frame = pool.GetInfo(i);
+    ASSERT_EQ(MRS_SUCCESS,
+              mrsExternalVideoTrackSourcePushFrame(
+                  source, &frame, &ArgbFramePool::OnRelease, &pool));
+  }
+  ASSERT_EQ(2u, frames.size());
+  ASSERT_EQ(2u, pool.release_count.load());
+
+  // The converted frames stay valid after the release
+  for (VideoFrameHandle handle : frames) {
+    VideoFrameInfo info{};
+    ASSERT_EQ(MRS_SUCCESS, mrsVideoFrameGetInfo(handle, &info));
+    ASSERT_EQ(VideoFrameFormat::kI420A, info.format);
+    ASSERT_NEAR(126, static_cast<const uint8_t*>(info.data[0])[0], 1);
+    mrsVideoFrameRemoveRef(handle);
+  }
+
+  ASSERT_EQ(MRS_SUCCESS, mrsLocalVideoTrackRemoveSink(track_handle, sink_id));
+  ASSERT_EQ(MRS_SUCCESS,
+            mrsPeerConnectionRemoveLocalVideoTrack(pc.handle(), track_handle));
+  mrsLocalVideoTrackRemoveRef(track_handle);
+  mrsExternalVideoTrackSourceRemoveRef(source);
+}
+
+// A sink removing and re-adding itself from its own callback neither deadlocks
+// with nor loses updates to sinks concurrently added and removed elsewhere.
+TEST(ExternalVideoTrackSource, RemoveSinkFromCallback) {
+  PCRaii pc;
+
+  ExternalVideoTrackSourceHandle source{};
+  ASSERT_EQ(MRS_SUCCESS, mrsExternalVideoTrackSourceCreate(&source));
+  LocalVideoTrackHandle track_handle{};
+  ASSERT_EQ(MRS_SUCCESS,
+            mrsPeerConnectionAddLocalVideoTrackFromExternalSource(
+                pc.handle(), "external_video_track", source, &track_handle));
+
+  // Each frame reaches the single self-replacing sink registered when the
+  // frame was delivered, so exactly once.
+  uint32_t self_count = 0;
+  VideoSinkId self_sink{};
+  VideoFrameHandleCallback self_cb = [&](const VideoFrameInfo*) {
+    ++self_count;
+    ASSERT_EQ(MRS_SUCCESS,
+              mrsLocalVideoTrackRemoveSink(track_handle, self_sink));
+    ASSERT_EQ(MRS_SUCCESS,
+              mrsLocalVideoTrackAddSink(track_handle, VideoSinkConfiguration{},
+                                        CB(self_cb), &self_sink));
+  };
+  ASSERT_EQ(MRS_SUCCESS,
+            mrsLocalVideoTrackAddSink(track_handle, VideoSinkConfiguration{},
+                                      CB(self_cb), &self_sink));
+
+  // Churn other sinks from another thread
+  std::atomic_bool stop{false};
+  VideoFrameHandleCallback churn_cb = [](const VideoFrameInfo*) {};
+  std::thread churn([&]() {
+    while (!stop.load()) {
+      VideoSinkId sink_id{};
+      ASSERT_EQ(MRS_SUCCESS,
+                mrsLocalVideoTrackAddSink(track_handle,
+                                          VideoSinkConfiguration{},
+                                          CB(churn_cb), &sink_id));
+      ASSERT_EQ(MRS_SUCCESS,
+                mrsLocalVideoTrackRemoveSink(track_handle, sink_id));
+    }
+  });
+
+  ArgbFramePool pool(1);
+  constexpr uint32_t kNumFrames = 300;
+  for (uint32_t i = 0; i < kNumFrames; ++i) {
+    const VideoFrameInfo frame = pool.GetInfo(0);
+    ASSERT_EQ(MRS_SUCCESS, mrsExternalVideoTrackSourcePushFrame(
+                               source, &frame, nullptr, nullptr));
+  }
+  stop.store(true);
+  churn.join();
+  ASSERT_EQ(kNumFrames, self_count);
+
+  ASSERT_EQ(MRS_SUCCESS, mrsLocalVideoTrackRemoveSink(track_handle, self_sink));
+  ASSERT_EQ(MRS_SUCCESS,
+            mrsPeerConnectionRemoveLocalVideoTrack(pc.handle(), track_handle));
+  mrsLocalVideoTrackRemoveRef(track_handle);
+  mrsExternalVideoTrackSourceRemoveRef(source);
+}
+
+// Frames of several tracks enqueued concurrently into the same frame queue are
+// all accounted for, and dequeued intact.
+TEST(ExternalVideoTrackSource, FrameQueueProducers) {
+  constexpr int kNumProducers = 2;
+  constexpr int kNumFrames = 200;
+  VideoFrameQueueHandle queue{};
+  ASSERT_EQ(MRS_SUCCESS, mrsVideoFrameQueueCreate(8, &queue));
+  {
+    PCRaii pcs[kNumProducers];
+    ExternalVideoTrackSourceHandle sources[kNumProducers]{};
+    LocalVideoTrackHandle tracks[kNumProducers]{};
+    VideoSinkId sinks[kNumProducers]{};
+    for (int i = 0; i < kNumProducers; ++i) {
+      ASSERT_EQ(MRS_SUCCESS, mrsExternalVideoTrackSourceCreate(&sources[i]));
+      ASSERT_EQ(MRS_SUCCESS,
+                mrsPeerConnectionAddLocalVideoTrackFromExternalSource(
+                    pcs[i].handle(), "external_video_track", sources[i],
+                    &tracks[i]));
+      ASSERT_EQ(MRS_SUCCESS,
+                mrsVideoFrameQueueAddLocalVideoSink(
+                    queue, tracks[i], VideoSinkConfiguration{}, &sinks[i]));
+    }
+
+    // Push from one thread per track, all frames being already due
+    ArgbFramePool pool(1);
+    std::atomic_int num_running{kNumProducers};
+    std::vector<std::thread> producers;
+    for (int i = 0; i < kNumProducers; ++i) {
+      producers.emplace_back([&, i]() {
+        for (int j = 0; j < kNumFrames; ++j) {
+          VideoFrameInfo frame = pool.GetInfo(0);
+          frame.timing.timestamp_us = 1 + j;
+          mrsExternalVideoTrackSourcePushFrame(sources[i], &frame, nullptr,
+                                               nullptr);
+        }
+        --num_running;
+      });
+    }
+    VideoFrameInfo frame{};
+    mrsBool is_new_frame = mrsBool::kFalse;
+    while (num_running.load() > 0) {
+      if ((mrsVideoFrameQueueTryDequeue(queue, INT64_MAX, &frame,
+                                        &is_new_frame) == MRS_SUCCESS) &&
+          (is_new_frame == mrsBool::kTrue)) {
+        ASSERT_EQ(ArgbFramePool::kWidth, frame.width);
+        ASSERT_EQ(ArgbFramePool::kHeight, frame.height);
+      }
+    }
+    for (std::thread& producer : producers) {
+      producer.join();
+    }
+
+    for (int i = 0; i < kNumProducers; ++i) {
+      ASSERT_EQ(MRS_SUCCESS, mrsLocalVideoTrackRemoveSink(tracks[i], sinks[i]));
+      ASSERT_EQ(MRS_SUCCESS, mrsPeerConnectionRemoveLocalVideoTrack(
+                                 pcs[i].handle(), tracks[i]));
+      mrsLocalVideoTrackRemoveRef(tracks[i]);
+      mrsExternalVideoTrackSourceRemoveRef(sources[i]);
+    }
+  }
+
+  VideoFrameQueueStats stats{};
+  ASSERT_EQ(MRS_SUCCESS, mrsVideoFrameQueueGetStats(queue, &stats));
+  ASSERT_EQ((uint64_t)kNumProducers * kNumFrames, stats.enqueued_frames);
+  ASSERT_EQ(stats.enqueued_frames,
+            stats.dequeued_frames + stats.late_frames + stats.overflow_frames +
+                stats.pending_frames);
+  mrsVideoFrameQueueRemoveRef(queue);
+}
+
+// Frame processors run in order before the frames are delivered to the sinks.
+TEST(ExternalVideoTrackSource, FrameProcessors) {
+  PCRaii pc;
+
+  ExternalVideoTrackSourceHandle source{};
+  ASSERT_EQ(MRS_SUCCESS, mrsExternalVideoTrackSourceCreate(&source));
+  LocalVideoTrackHandle track_handle{};
+  ASSERT_EQ(MRS_SUCCESS,
+            mrsPeerConnectionAddLocalVideoTrackFromExternalSource(
+                pc.handle(), "external_video_track", source, &track_handle));
+
+  VideoFrameProcessorConfiguration config{};
+  int32_t index = -1;
+  uint32_t callback_count = 0;
+  ASSERT_EQ(MRS_E_INVALID_PARAMETER,
+            mrsLocalVideoTrackAddFrameProcessor(track_handle, config, &index));
+
+  // Crop to the top-left quarter, with a white square in its corner
+  config.width = 160;
+  config.height = 120;
+  ASSERT_EQ(MRS_SUCCESS,
+            mrsLocalVideoTrackAddFrameProcessor(track_handle, config, &index));
+  ASSERT_EQ(0, index);
+  std::vector<uint32_t> overlay(16 * 16, 0xFFFFFFFFu);
+  config = VideoFrameProcessorConfiguration{};
+  config.kind = VideoFrameProcessorKind::kOverlay;
+  config.width = 16;
+  config.height = 16;
+  config.overlay_data = overlay.data();
+  config.overlay_stride = 16 * 4;
+  ASSERT_EQ(MRS_SUCCESS,
+            mrsLocalVideoTrackAddFrameProcessor(track_handle, config, &index));
+  config = VideoFrameProcessorConfiguration{};
+  config.kind = VideoFrameProcessorKind::kBlur;
+  config.x = 80;
+  config.width = 80;
+  config.height = 120;
+  ASSERT_EQ(MRS_SUCCESS,
+            mrsLocalVideoTrackAddFrameProcessor(track_handle, config, &index));
+  config = VideoFrameProcessorConfiguration{};
+  config.kind = VideoFrameProcessorKind::kScale;
+  config.width = 80;
+  config.height = 60;
+  ASSERT_EQ(MRS_SUCCESS,
+            mrsLocalVideoTrackAddFrameProcessor(track_handle, config, &index));
+
+  // Drop every other frame
+  std::function<bool(const VideoFrameInfo*)> process_cb =
+      [&](const VideoFrameInfo* frame) {
+        EXPECT_EQ(80, frame->width);
+        EXPECT_EQ(60, frame->height);
+        return (++callback_count % 2 == 0);
+      };
+  config = VideoFrameProcessorConfiguration{};
+  config.kind = VideoFrameProcessorKind::kCallback;
+  config.callback = [](void* user_data,
+                       const VideoFrameInfo* frame) -> mrsBool {
+    auto cb = static_cast<std::function<bool(const VideoFrameInfo*)>*>(
+        user_data);
+    return ((*cb)(frame) ? mrsBool::kTrue : mrsBool::kFalse);
+  };
+  config.user_data = &process_cb;
+  ASSERT_EQ(MRS_SUCCESS,
+            mrsLocalVideoTrackAddFrameProcessor(track_handle, config, &index));
+  ASSERT_EQ(4, index);
+
+  uint32_t frame_count = 0;
+  VideoFrameHandleCallback frame_cb = [&](const VideoFrameInfo* frame) {
+    ++frame_count;
+    ASSERT_EQ(80, frame->width);
+    ASSERT_EQ(60, frame->height);
+    const auto y_plane = static_cast<const uint8_t*>(frame->data[0]);
+    ASSERT_LT(200, y_plane[0]);
+    ASSERT_NEAR(126, y_plane[frame->stride[0] * 30 + 20], 2);
+  };
+  mrsLocalVideoTrackRegisterFrameHandleCallback(track_handle, CB(frame_cb));
+
+  ArgbFramePool pool(1);
+  for (int i = 0; i < 4; ++i) {
+    const VideoFrameInfo frame = pool.GetInfo(0);
+    ASSERT_EQ(MRS_SUCCESS, mrsExternalVideoTrackSourcePushFrame(
+                               source, &frame, nullptr, nullptr));
+  }
+  ASSERT_EQ(4u, callback_count);
+  ASSERT_EQ(2u, frame_count);
+
+  VideoFrameProcessorStats stats{};
+  ASSERT_EQ(MRS_E_INVALID_PARAMETER,
+            mrsLocalVideoTrackGetFrameProcessorStats(track_handle, 5, &stats));
+  ASSERT_EQ(MRS_SUCCESS,
+            mrsLocalVideoTrackGetFrameProcessorStats(track_handle, 0, &stats));
+  ASSERT_EQ(4u, stats.processed_frames);
+  ASSERT_EQ(0u, stats.dropped_frames);
+  ASSERT_LE(stats.max_time_us, stats.total_time_us);
+  ASSERT_EQ(MRS_SUCCESS,
+            mrsLocalVideoTrackGetFrameProcessorStats(track_handle, 4, &stats));
+  ASSERT_EQ(4u, stats.processed_frames);
+  ASSERT_EQ(2u, stats.dropped_frames);
+
+  // Without processors, the source frames are forwarded as is
+  ASSERT_EQ(MRS_SUCCESS, mrsLocalVideoTrackClearFrameProcessors(track_handle));
+  frame_cb = [&](const VideoFrameInfo* frame) {
+    ++frame_count;
+    ASSERT_EQ(320, frame->width);
+  };
+  mrsLocalVideoTrackRegisterFrameHandleCallback(track_handle, CB(frame_cb));
+  const VideoFrameInfo frame = pool.GetInfo(0);
+  ASSERT_EQ(MRS_SUCCESS, mrsExternalVideoTrackSourcePushFrame(
+                             source, &frame, nullptr, nullptr));
+  ASSERT_EQ(3u, frame_count);
+
+  mrsLocalVideoTrackRegisterFrameHandleCallback(track_handle, nullptr,
+                                                nullptr);
+  ASSERT_EQ(MRS_SUCCESS,
+            mrsPeerConnectionRemoveLocalVideoTrack(pc.handle(), track_handle));
+  mrsLocalVideoTrackRemoveRef(track_handle);
+  mrsExternalVideoTrackSourceRemoveRef(source);
+}
@@ -0,0 +1,157 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#include "pch.h"
+
+#include <filesystem>
+#include <fstream>
+
+#include "interop/interop_api.h"
+#include "interop/local_video_track_interop.h"
+
+namespace {
+
+// PeerConnectionVideoFrameHandleCallback
+using VideoFrameHandleCallback = InteropCallback<const VideoFrameInfo*>;
+
+/// Temporary file deleted on destruction.
+struct TempFile {
+  explicit TempFile(const char* name)
+      : path(std::filesystem::temp_directory_path() / name) {}
+  ~TempFile() {
+    std::error_code ec;
+    std::filesystem::remove(path, ec);
+  }
+  std::filesystem::path path;
+};
+
+/// Write a Y4M file of |num_frames| frames of the given resolution, each
+/// filled with a different luma value.
+void WriteY4mFile(const std::filesystem::path& path,
+                  int width,
+                  int height,
+                  int num_frames) {
+  std::ofstream file(path, std::ios::binary);
+  file << "YUV4MPEG2 W" << width << " H" << height
+       << " F30:1 Ip A1:1 C420jpeg\n";
+  const size_t luma_size = static_cast<size_t>(width) * height;
+  const size_t chroma_size = 2 * ((width + 1) / 2) * ((height + 1) / 2);
+  for (int i = 0; i < num_frames; ++i) {
+    file << "FRAME\n";
+    const std::string luma(luma_size, static_cast<char>(16 + i * 32));
+    const std::string chroma(chroma_size, static_cast<char>(128));
+    file.write(luma.data(), luma.size());
+    file.write(chroma.data(), chroma.size());
+  }
+}
+
+/// Send the frames of a local video track from |pc1| to |pc2| for |duration|,
+/// checking their resolution, and return the number of frames received.
+uint32_t CountRemoteFrames(LocalPeerPairRaii& pair,
+                           int width,
+                           int height,
+                           std::chrono::milliseconds duration) {
+  std::atomic_uint32_t frame_count{0};
+  VideoFrameHandleCallback frame_cb = [&](const VideoFrameInfo* frame) {
+    EXPECT_EQ(width, frame->width);
+    EXPECT_EQ(height, frame->height);
+    ++frame_count;
+  };
+  mrsPeerConnectionRegisterRemoteVideoFrameHandleCallback(pair.pc2(),
+                                                          CB(frame_cb));
+  pair.ConnectAndWait();
+  Event ev;
+  ev.WaitFor(duration);
+  mrsPeerConnectionRegisterRemoteVideoFrameHandleCallback(pair.pc2(), nullptr,
+                                                          nullptr);
+  return frame_count.load();
+}
+
+}  // namespace
+
+TEST(GeneratedVideoTrackSource, TestPatternInvalidParams) {
+  PCRaii pc;
+  LocalVideoTrackHandle track_handle{};
+  TestPatternConfiguration config{};
+  config.width = 0;
+  ASSERT_EQ(MRS_E_INVALID_PARAMETER,
+            mrsPeerConnectionAddLocalVideoTrackFromTestPattern(
+                pc.handle(), "test_pattern", config, &track_handle));
+  config = TestPatternConfiguration{};
+  config.framerate = 0.0;
+  ASSERT_EQ(MRS_E_INVALID_PARAMETER,
+            mrsPeerConnectionAddLocalVideoTrackFromTestPattern(
+                pc.handle(), "test_pattern", config, &track_handle));
+  ASSERT_EQ(nullptr, track_handle);
+}
+
+TEST(GeneratedVideoTrackSource, TestPattern) {
+  LocalPeerPairRaii pair;
+
+  TestPatternConfiguration config{};
+  config.width = 320;
+  config.height = 240;
+  config.framerate = 30.0;
+  LocalVideoTrackHandle track_handle{};
+  ASSERT_EQ(MRS_SUCCESS,
+            mrsPeerConnectionAddLocalVideoTrackFromTestPattern(
+                pair.pc1(), "test_pattern", config, &track_handle));
+  ASSERT_NE(nullptr, track_handle);
+
+  const uint32_t frame_count = CountRemoteFrames(pair, 320, 240, 3s);
+  ASSERT_LT(30u, frame_count);  // at least 10 FPS
+
+  mrsLocalVideoTrackRemoveRef(track_handle);
+}
+
+TEST(GeneratedVideoTrackSource, Y4mFileInvalidParams) {
+  PCRaii pc;
+  LocalVideoTrackHandle track_handle{};
+  Y4mFileConfiguration config{};
+  ASSERT_EQ(MRS_E_INVALID_PARAMETER,
+            mrsPeerConnectionAddLocalVideoTrackFromY4mFile(
+                pc.handle(), "y4m_file", config, &track_handle));
+
+  TempFile missing_file("mrsw_missing.y4m");
+  const std::string missing_path = missing_file.path.u8string();
+  config.path = missing_path.c_str();
+  ASSERT_EQ(MRS_E_NOTFOUND,
+            mrsPeerConnectionAddLocalVideoTrackFromY4mFile(
+                pc.handle(), "y4m_file", config, &track_handle));
+
+  // Unsupported 4:4:4 chroma format
+  TempFile invalid_file("mrsw_invalid.y4m");
+  {
+    std::ofstream file(invalid_file.path, std::ios::binary);
+    file << "YUV4MPEG2 W16 H16 F30:1 C444\nFRAME\n"
+         << std::string(16 * 16 * 3, '\0');
+  }
+  const std::string invalid_path = invalid_file.path.u8string();
+  config.path = invalid_path.c_str();
+  ASSERT_EQ(MRS_E_INVALID_PARAMETER,
+            mrsPeerConnectionAddLocalVideoTrackFromY4mFile(
+                pc.handle(), "y4m_file", config, &track_handle));
+  ASSERT_EQ(nullptr, track_handle);
+}
+
+TEST(GeneratedVideoTrackSource, Y4mFile) {
+  TempFile y4m_file("mrsw_test.y4m");
+  WriteY4mFile(y4m_file.path, 176, 144, 5);
+  const std::string path = y4m_file.path.u8string();
+
+  LocalPeerPairRaii pair;
+
+  // The file is shorter than the test, and loops
+  Y4mFileConfiguration config{};
+  config.path = path.c_str();
+  config.loop = mrsBool::kTrue;
+  LocalVideoTrackHandle track_handle{};
+  ASSERT_EQ(MRS_SUCCESS, mrsPeerConnectionAddLocalVideoTrackFromY4mFile(
+                             pair.pc1(), "y4m_file", config, &track_handle));
+  ASSERT_NE(nullptr, track_handle);
+
+  const uint32_t frame_count = CountRemoteFrames(pair, 176, 144, 3s);
+  ASSERT_LT(30u, frame_count);  // at least 10 FPS
+
+  mrsLocalVideoTrackRemoveRef(track_handle);
+}
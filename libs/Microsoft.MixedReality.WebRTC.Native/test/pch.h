@@ -7,9 +7,13 @@
 #include <SDKDDKVer.h>
 #include <cassert>
 
+#include <atomic>
 #include <condition_variable>
+#include <deque>
 #include <functional>
 #include <mutex>
+#include <thread>
+#include <unordered_set>
 
 using namespace std::chrono_literals;
 
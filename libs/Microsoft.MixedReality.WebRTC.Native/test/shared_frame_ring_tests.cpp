@@ -0,0 +1,172 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#include "pch.h"
+
+#include "interop/interop_api.h"
+#include "interop/shared_frame_interop.h"
+
+namespace {
+
+constexpr char kRingName[] = "mrsw_test_frame_ring";
+
+/// I420 frame with padded rows, filled with a uniform luma value.
+struct PaddedI420Frame {
+  static constexpr int kWidth = 64;
+  static constexpr int kHeight = 48;
+  static constexpr int kPadding = 16;
+
+  explicit PaddedI420Frame(uint8_t luma)
+      : y((kWidth + kPadding) * kHeight, luma),
+        u((kWidth / 2 + kPadding) * (kHeight / 2), 0x40),
+        v(u.size(), 0xC0) {
+    info.format = VideoFrameFormat::kI420A;
+    info.width = kWidth;
+    info.height = kHeight;
+    info.data[0] = y.data();
+    info.data[1] = u.data();
+    info.data[2] = v.data();
+    info.stride[0] = kWidth + kPadding;
+    info.stride[1] = kWidth / 2 + kPadding;
+    info.stride[2] = kWidth / 2 + kPadding;
+    info.timing.timestamp_us = luma * 1000;
+  }
+
+  std::vector<uint8_t> y;
+  std::vector<uint8_t> u;
+  std::vector<uint8_t> v;
+  VideoFrameInfo info{};
+};
+
+/// Check that the shared |frame| has the content of |expected|.
+void CheckFrame(const PaddedI420Frame& expected, const VideoFrameInfo& frame) {
+  ASSERT_EQ(nullptr, frame.handle);
+  ASSERT_EQ(VideoFrameFormat::kI420A, frame.format);
+  ASSERT_EQ(PaddedI420Frame::kWidth, frame.width);
+  ASSERT_EQ(PaddedI420Frame::kHeight, frame.height);
+  ASSERT_EQ(nullptr, frame.data[3]);
+  ASSERT_EQ(expected.info.timing.timestamp_us, frame.timing.timestamp_us);
+  for (int plane = 0; plane < 3; ++plane) {
+    const int width = (plane == 0 ? frame.width : frame.width / 2);
+    const int height = (plane == 0 ? frame.height : frame.height / 2);
+    ASSERT_LE(width, frame.stride[plane]);
+    auto src = static_cast<const uint8_t*>(expected.info.data[plane]);
+    auto dst = static_cast<const uint8_t*>(frame.data[plane]);
+    for (int j = 0; j < height; ++j) {
+      ASSERT_EQ(0, memcmp(src + j * expected.info.stride[plane],
+                          dst + j * frame.stride[plane], width));
+    }
+  }
+}
+
+}  // namespace
+
+TEST(SharedFrameRing, InvalidParams) {
+  SharedFrameRingHandle ring{};
+  SharedFrameRingConfiguration config{};
+  ASSERT_EQ(MRS_E_INVALID_PARAMETER,
+            mrsSharedFrameRingCreate(nullptr, config, &ring));
+  config.num_slots = 1;
+  ASSERT_EQ(MRS_E_INVALID_PARAMETER,
+            mrsSharedFrameRingCreate(kRingName, config, &ring));
+  config = SharedFrameRingConfiguration{};
+  config.max_width = 0;
+  ASSERT_EQ(MRS_E_INVALID_PARAMETER,
+            mrsSharedFrameRingCreate(kRingName, config, &ring));
+  ASSERT_EQ(nullptr, ring);
+
+  SharedFrameReaderHandle reader{};
+  ASSERT_EQ(MRS_E_NOTFOUND,
+            mrsSharedFrameReaderOpen("mrsw_missing_frame_ring", &reader));
+  ASSERT_EQ(nullptr, reader);
+}
+
+TEST(SharedFrameRing, NameInUse) {
+  SharedFrameRingConfiguration config{};
+  config.num_slots = 2;
+  config.max_width = PaddedI420Frame::kWidth;
+  config.max_height = PaddedI420Frame::kHeight;
+  SharedFrameRingHandle ring{};
+  ASSERT_EQ(MRS_SUCCESS, mrsSharedFrameRingCreate(kRingName, config, &ring));
+  ASSERT_NE(nullptr, ring);
+
+  // The region of a live ring is never replaced
+  SharedFrameRingHandle ring2{};
+  ASSERT_EQ(MRS_E_INVALID_OPERATION,
+            mrsSharedFrameRingCreate(kRingName, config, &ring2));
+  ASSERT_EQ(nullptr, ring2);
+  SharedFrameReaderHandle reader{};
+  ASSERT_EQ(MRS_SUCCESS, mrsSharedFrameReaderOpen(kRingName, &reader));
+  mrsSharedFrameReaderClose(reader);
+
+  // The name is available again once the ring is destroyed
+  mrsSharedFrameRingRemoveRef(ring);
+  ASSERT_EQ(MRS_SUCCESS, mrsSharedFrameRingCreate(kRingName, config, &ring));
+  mrsSharedFrameRingRemoveRef(ring);
+}
+
+TEST(SharedFrameRing, WriteRead) {
+  SharedFrameRingConfiguration config{};
+  config.num_slots = 3;
+  config.max_width = PaddedI420Frame::kWidth;
+  config.max_height = PaddedI420Frame::kHeight;
+  SharedFrameRingHandle ring{};
+  ASSERT_EQ(MRS_SUCCESS, mrsSharedFrameRingCreate(kRingName, config, &ring));
+  ASSERT_NE(nullptr, ring);
+  SharedFrameReaderHandle reader{};
+  ASSERT_EQ(MRS_SUCCESS, mrsSharedFrameReaderOpen(kRingName, &reader));
+  ASSERT_NE(nullptr, reader);
+
+  // Nothing written yet
+  VideoFrameInfo frame{};
+  uint64_t sequence = 0;
+  ASSERT_EQ(MRS_E_NOTFOUND, mrsSharedFrameReaderAcquire(
+                                reader, mrsBool::kFalse, &frame, &sequence));
+
+  // Frames are read in place, without the padding of the source rows
+  std::vector<std::unique_ptr<PaddedI420Frame>> frames;
+  for (int i = 0; i < 5; ++i) {
+    frames.emplace_back(std::make_unique<PaddedI420Frame>((uint8_t)(i + 1)));
+  }
+  mrsSharedFrameRingWrite(ring, &frames[0]->info);
+  ASSERT_EQ(MRS_SUCCESS, mrsSharedFrameReaderAcquire(reader, mrsBool::kFalse,
+                                                     &frame, &sequence));
+  ASSERT_EQ(1u, sequence);
+  CheckFrame(*frames[0], frame);
+  mrsBool valid = mrsBool::kFalse;
+  ASSERT_EQ(MRS_SUCCESS, mrsSharedFrameReaderRelease(reader, 1, &valid));
+  ASSERT_EQ(mrsBool::kTrue, valid);
+
+  // The writer overwrites the frames of a reader lagging behind
+  for (int i = 1; i < 5; ++i) {
+    mrsSharedFrameRingWrite(ring, &frames[i]->info);
+  }
+  ASSERT_EQ(MRS_SUCCESS, mrsSharedFrameReaderRelease(reader, 1, &valid));
+  ASSERT_EQ(mrsBool::kFalse, valid);
+
+  // The reader resumes from the oldest frame still available
+  ASSERT_EQ(MRS_SUCCESS, mrsSharedFrameReaderAcquire(reader, mrsBool::kFalse,
+                                                     &frame, &sequence));
+  ASSERT_EQ(3u, sequence);
+  CheckFrame(*frames[2], frame);
+  ASSERT_EQ(MRS_SUCCESS, mrsSharedFrameReaderAcquire(reader, mrsBool::kTrue,
+                                                     &frame, &sequence));
+  ASSERT_EQ(5u, sequence);
+  CheckFrame(*frames[4], frame);
+  ASSERT_EQ(MRS_SUCCESS, mrsSharedFrameReaderRelease(reader, 5, &valid));
+  ASSERT_EQ(mrsBool::kTrue, valid);
+  ASSERT_EQ(MRS_E_NOTFOUND, mrsSharedFrameReaderAcquire(
+                                reader, mrsBool::kFalse, &frame, &sequence));
+
+  // Frames larger than the slots are dropped
+  VideoFrameInfo large_frame = frames[0]->info;
+  large_frame.width = 16 * PaddedI420Frame::kWidth;
+  mrsSharedFrameRingWrite(ring, &large_frame);
+  SharedFrameRingStats stats{};
+  ASSERT_EQ(MRS_SUCCESS, mrsSharedFrameRingGetStats(ring, &stats));
+  ASSERT_EQ(5u, stats.written_frames);
+  ASSERT_EQ(1u, stats.dropped_frames);
+
+  mrsSharedFrameReaderClose(reader);
+  mrsSharedFrameRingRemoveRef(ring);
+}
@@ -0,0 +1,129 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#include "pch.h"
+
+#include "interop/interop_api.h"
+#include "interop/local_video_track_interop.h"
+
+namespace {
+
+constexpr uint32_t FourCC(char a, char b, char c, char d) {
+  return static_cast<uint32_t>(a) | (static_cast<uint32_t>(b) << 8) |
+         (static_cast<uint32_t>(c) << 16) | (static_cast<uint32_t>(d) << 24);
+}
+
+constexpr uint32_t kI420 = FourCC('I', '4', '2', '0');
+constexpr uint32_t kNV12 = FourCC('N', 'V', '1', '2');
+constexpr uint32_t kYUY2 = FourCC('Y', 'U', 'Y', '2');
+constexpr uint32_t kMJPG = FourCC('M', 'J', 'P', 'G');
+
+VideoCaptureFormatInfo Format(uint32_t width,
+                              uint32_t height,
+                              double framerate,
+                              uint32_t encoding) {
+  VideoCaptureFormatInfo format{};
+  format.width = width;
+  format.height = height;
+  format.framerate = framerate;
+  format.encoding = encoding;
+  return format;
+}
+
+}  // namespace
+
+TEST(VideoCaptureFormat, Cost) {
+  const uint64_t i420 = mrsVideoCaptureFormatGetCost(1280, 720, 30.0, kI420);
+  const uint64_t nv12 = mrsVideoCaptureFormatGetCost(1280, 720, 30.0, kNV12);
+  const uint64_t yuy2 = mrsVideoCaptureFormatGetCost(1280, 720, 30.0, kYUY2);
+  const uint64_t mjpg = mrsVideoCaptureFormatGetCost(1280, 720, 30.0, kMJPG);
+  ASSERT_EQ(1280u * 720u * 30u, i420);
+  ASSERT_LT(i420, nv12);
+  ASSERT_LT(nv12, yuy2);
+  ASSERT_LT(yuy2, mjpg);
+  ASSERT_LT(mjpg, mrsVideoCaptureFormatGetCost(1280, 720, 30.0, 0));
+
+  // Cost scales with the resolution and framerate
+  ASSERT_EQ(i420 * 2, mrsVideoCaptureFormatGetCost(1280, 720, 60.0, kI420));
+  ASSERT_EQ(0u, mrsVideoCaptureFormatGetCost(1280, 720, 0.0, kI420));
+}
+
+TEST(VideoCaptureFormat, Select) {
+  // Typical webcam listing MJPG first for each resolution
+  const VideoCaptureFormatInfo formats[] = {
+      Format(1280, 720, 30.0, kMJPG), Format(1280, 720, 30.0, kYUY2),
+      Format(1280, 720, 30.0, kNV12), Format(1280, 720, 10.0, kI420),
+      Format(640, 480, 30.0, kMJPG),  Format(640, 480, 30.0, kYUY2),
+      Format(320, 240, 30.0, kI420),
+  };
+  const uint32_t count = static_cast<uint32_t>(std::size(formats));
+
+  // Same resolution and framerate, cheapest encoding
+  VideoCaptureFormatInfo selected{};
+  ASSERT_EQ(MRS_SUCCESS, mrsVideoCaptureFormatSelect(formats, count, 1280, 720,
+                                                     30.0, &selected));
+  ASSERT_EQ(1280u, selected.width);
+  ASSERT_EQ(720u, selected.height);
+  ASSERT_EQ(30.0, selected.framerate);
+  ASSERT_EQ(kNV12, selected.encoding);
+  ASSERT_EQ(mrsVideoCaptureFormatGetCost(1280, 720, 30.0, kNV12),
+            selected.cost);
+
+  // Unconstrained framerate prefers 30 FPS over a cheaper encoding
+  ASSERT_EQ(MRS_SUCCESS, mrsVideoCaptureFormatSelect(formats, count, 1280, 720,
+                                                     0.0, &selected));
+  ASSERT_EQ(30.0, selected.framerate);
+  ASSERT_EQ(kNV12, selected.encoding);
+  ASSERT_EQ(MRS_SUCCESS, mrsVideoCaptureFormatSelect(formats, count, 1280, 720,
+                                                     10.0, &selected));
+  ASSERT_EQ(kI420, selected.encoding);
+
+  // Unconstrained resolution defaults to 640x480
+  ASSERT_EQ(MRS_SUCCESS,
+            mrsVideoCaptureFormatSelect(formats, count, 0, 0, 0.0, &selected));
+  ASSERT_EQ(640u, selected.width);
+  ASSERT_EQ(480u, selected.height);
+  ASSERT_EQ(kYUY2, selected.encoding);
+
+  // Framerates are matched with integer bounds
+  const VideoCaptureFormatInfo ntsc[] = {Format(640, 480, 29.97, kMJPG),
+                                         Format(640, 480, 29.97, kI420)};
+  ASSERT_EQ(MRS_SUCCESS,
+            mrsVideoCaptureFormatSelect(ntsc, 2, 640, 480, 29.97, &selected));
+  ASSERT_EQ(kI420, selected.encoding);
+  ASSERT_EQ(MRS_SUCCESS,
+            mrsVideoCaptureFormatSelect(ntsc, 2, 640, 480, 29.5, &selected));
+  ASSERT_EQ(kI420, selected.encoding);
+}
+
+TEST(VideoCaptureFormat, SelectNotFound) {
+  const VideoCaptureFormatInfo formats[] = {Format(640, 480, 30.0, kMJPG)};
+  VideoCaptureFormatInfo selected{};
+  ASSERT_EQ(MRS_E_INVALID_PARAMETER,
+            mrsVideoCaptureFormatSelect(nullptr, 1, 0, 0, 0.0, &selected));
+  ASSERT_EQ(MRS_E_INVALID_PARAMETER,
+            mrsVideoCaptureFormatSelect(formats, 1, 0, 0, 0.0, nullptr));
+  ASSERT_EQ(MRS_E_NOTFOUND,
+            mrsVideoCaptureFormatSelect(nullptr, 0, 0, 0, 0.0, &selected));
+  ASSERT_EQ(MRS_E_NOTFOUND, mrsVideoCaptureFormatSelect(formats, 1, 1280, 720,
+                                                        0.0, &selected));
+  ASSERT_EQ(MRS_E_NOTFOUND, mrsVideoCaptureFormatSelect(formats, 1, 640, 480,
+                                                        15.0, &selected));
+}
+
+// Tracks not backed by a capture device have no capture format.
+TEST(VideoCaptureFormat, NoCaptureDevice) {
+  PCRaii pc;
+  LocalVideoTrackHandle track_handle{};
+  ASSERT_EQ(MRS_SUCCESS, mrsPeerConnectionAddLocalVideoTrackFromTestPattern(
+                             pc.handle(), "test_pattern",
+                             TestPatternConfiguration{}, &track_handle));
+  VideoCaptureFormatInfo format{};
+  ASSERT_EQ(MRS_E_INVALID_PARAMETER,
+            mrsLocalVideoTrackGetCaptureFormat(track_handle, nullptr));
+  ASSERT_EQ(MRS_E_INVALID_OPERATION,
+            mrsLocalVideoTrackGetCaptureFormat(track_handle, &format));
+  ASSERT_EQ(MRS_SUCCESS,
+            mrsPeerConnectionRemoveLocalVideoTrack(pc.handle(), track_handle));
+  mrsLocalVideoTrackRemoveRef(track_handle);
+}
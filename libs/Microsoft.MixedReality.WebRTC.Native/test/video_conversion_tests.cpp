@@ -0,0 +1,453 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#include "pch.h"
+
+#include "libyuv.h"
+
+#include "interop/interop_api.h"
+#include "interop/video_frame_interop.h"
+#include "video_conversion.h"
+#include "worker_pool.h"
+
+using namespace Microsoft::MixedReality::WebRTC;
+
+namespace {
+
+/// Synthetic I420 frame filled with a gradient pattern.
+struct TestI420Frame {
+  TestI420Frame(int width, int height)
+      : y(static_cast<size_t>(width) * height),
+        u(static_cast<size_t>((width + 1) / 2) * ((height + 1) / 2)),
+        v(u.size()) {
+    const int chroma_width = (width + 1) / 2;
+    const int chroma_height = (height + 1) / 2;
+    for (int j = 0; j < height; ++j) {
+      for (int i = 0; i < width; ++i) {
+        y[static_cast<size_t>(j) * width + i] = (uint8_t)(i + j);
+      }
+    }
+    for (int j = 0; j < chroma_height; ++j) {
+      for (int i = 0; i < chroma_width; ++i) {
+        u[static_cast<size_t>(j) * chroma_width + i] = (uint8_t)i;
+        v[static_cast<size_t>(j) * chroma_width + i] = (uint8_t)j;
+      }
+    }
+    info.format = VideoFrameFormat::kI420A;
+    info.width = width;
+    info.height = height;
+    info.data[0] = y.data();
+    info.data[1] = u.data();
+    info.data[2] = v.data();
+    info.stride[0] = width;
+    info.stride[1] = chroma_width;
+    info.stride[2] = chroma_width;
+  }
+
+  /// Add an alpha plane filled with a horizontal gradient.
+  void AddAlpha() {
+    a.resize(y.size());
+    for (int j = 0; j < info.height; ++j) {
+      for (int i = 0; i < info.width; ++i) {
+        a[static_cast<size_t>(j) * info.width + i] = (uint8_t)(i * 3);
+      }
+    }
+    info.data[3] = a.data();
+    info.stride[3] = info.width;
+  }
+
+  /// Fill all the samples of each plane with a constant value.
+  void Fill(uint8_t y_value, uint8_t u_value, uint8_t v_value) {
+    std::fill(y.begin(), y.end(), y_value);
+    std::fill(u.begin(), u.end(), u_value);
+    std::fill(v.begin(), v.end(), v_value);
+  }
+
+  std::vector<uint8_t> y;
+  std::vector<uint8_t> u;
+  std::vector<uint8_t> v;
+  std::vector<uint8_t> a;
+  VideoFrameInfo info{};
+};
+
+/// Caller-owned destination frame for |mrsVideoFrameConvert|.
+struct TestDstFrame {
+  TestDstFrame(VideoFrameFormat format, int width, int height) {
+    int bytes_per_pixel = 4;
+    if (format == VideoFrameFormat::kNv12) {
+      bytes_per_pixel = 1;
+      const int chroma_height = (height + 1) / 2;
+      uv.resize(static_cast<size_t>((width + 1) / 2) * 2 * chroma_height);
+    } else if (format == VideoFrameFormat::kRgb24) {
+      bytes_per_pixel = 3;
+    }
+    data.resize(static_cast<size_t>(width) * bytes_per_pixel * height);
+    info.format = format;
+    info.width = width;
+    info.height = height;
+    info.data[0] = data.data();
+    info.stride[0] = width * bytes_per_pixel;
+    if (!uv.empty()) {
+      info.data[1] = uv.data();
+      info.stride[1] = ((width + 1) / 2) * 2;
+    }
+  }
+
+  std::vector<uint8_t> data;
+  std::vector<uint8_t> uv;
+  VideoFrameInfo info{};
+};
+
+/// Per-frame conversion timings.
+struct ConversionStats {
+  double avg_ms{};
+  double max_ms{};
+};
+
+/// Measure the conversion of |src| to BT.601 limited range ARGB into |dst|,
+/// split over |pool| if not null.
+ConversionStats MeasureConversion(const VideoFrameInfo& src,
+                                  const VideoFrameInfo& dst,
+                                  WorkerPool* pool,
+                                  int num_frames) {
+  using clock = std::chrono::steady_clock;
+  ConversionStats stats;
+  clock::duration total{};
+  clock::duration max{};
+  for (int i = 0; i < num_frames; ++i) {
+    const auto start = clock::now();
+    ConvertI420A(src, dst, VideoColorMatrix::kBt601, VideoColorRange::kLimited,
+                 false, pool);
+    const auto duration = clock::now() - start;
+    total += duration;
+    max = std::max(max, duration);
+  }
+  stats.avg_ms =
+      std::chrono::duration<double, std::milli>(total).count() / num_frames;
+  stats.max_ms = std::chrono::duration<double, std::milli>(max).count();
+  return stats;
+}
+
+}  // namespace
+
+TEST(VideoConversion, ArgbInvalidParams) {
+  TestI420Frame frame(64, 32);
+  TestDstFrame dst(VideoFrameFormat::kArgb32, 64, 32);
+  ASSERT_EQ(MRS_E_INVALID_PARAMETER,
+            mrsVideoFrameConvert(nullptr, &dst.info, VideoColorMatrix::kBt601,
+                                 VideoColorRange::kLimited, mrsBool::kFalse));
+  dst.info.data[0] = nullptr;
+  ASSERT_EQ(MRS_E_INVALID_PARAMETER,
+            mrsVideoFrameConvert(&frame.info, &dst.info,
+                                 VideoColorMatrix::kBt601,
+                                 VideoColorRange::kLimited, mrsBool::kFalse));
+  dst.info.data[0] = dst.data.data();
+  dst.info.stride[0] = 64 * 4 - 1;
+  ASSERT_EQ(MRS_E_INVALID_PARAMETER,
+            mrsVideoFrameConvert(&frame.info, &dst.info,
+                                 VideoColorMatrix::kBt601,
+                                 VideoColorRange::kLimited, mrsBool::kFalse));
+}
+
+TEST(VideoConversion, PackedFormats) {
+  constexpr int kWidth = 64;
+  constexpr int kHeight = 34;
+  TestI420Frame frame(kWidth, kHeight);
+  TestDstFrame argb(VideoFrameFormat::kArgb32, kWidth, kHeight);
+  TestDstFrame rgba(VideoFrameFormat::kRgba32, kWidth, kHeight);
+  TestDstFrame bgra(VideoFrameFormat::kBgra32, kWidth, kHeight);
+  TestDstFrame rgb24(VideoFrameFormat::kRgb24, kWidth, kHeight);
+  for (TestDstFrame* dst : {&argb, &rgba, &bgra, &rgb24}) {
+    ASSERT_EQ(MRS_SUCCESS,
+              mrsVideoFrameConvert(&frame.info, &dst->info,
+                                   VideoColorMatrix::kBt601,
+                                   VideoColorRange::kLimited, mrsBool::kFalse));
+  }
+
+  // All formats hold the same pixels, with a different byte order. ARGB is
+  // B, G, R, A in memory.
+  ASSERT_EQ(argb.data, bgra.data);
+  for (size_t i = 0; i < static_cast<size_t>(kWidth) * kHeight; ++i) {
+    const uint8_t* ref = &argb.data[i * 4];
+    const uint8_t* p = &rgba.data[i * 4];  // R, G, B, A
+    ASSERT_EQ(ref[2], p[0]);
+    ASSERT_EQ(ref[1], p[1]);
+    ASSERT_EQ(ref[0], p[2]);
+    ASSERT_EQ(ref[3], p[3]);
+    p = &rgb24.data[i * 3];  // R, G, B
+    ASSERT_EQ(ref[2], p[0]);
+    ASSERT_EQ(ref[1], p[1]);
+    ASSERT_EQ(ref[0], p[2]);
+  }
+}
+
+// The packed formats are named after their byte order in memory, for both the
+// direct and the strip conversions.
+TEST(VideoConversion, PackedByteOrder) {
+  constexpr int kWidth = 16;
+  constexpr int kHeight = 16;
+  struct Red {
+    VideoColorMatrix matrix;
+    uint8_t y, u, v;
+  };
+  constexpr Red kReds[] = {{VideoColorMatrix::kBt601, 81, 90, 240},
+                           {VideoColorMatrix::kBt709, 63, 102, 240}};
+  struct Layout {
+    VideoFrameFormat format;
+    int bytes_per_pixel;
+    int r, g, b, a;
+  };
+  constexpr Layout kLayouts[] = {{VideoFrameFormat::kArgb32, 4, 2, 1, 0, 3},
+                                 {VideoFrameFormat::kBgra32, 4, 2, 1, 0, 3},
+                                 {VideoFrameFormat::kRgba32, 4, 0, 1, 2, 3},
+                                 {VideoFrameFormat::kRgb24, 3, 0, 1, 2, -1}};
+  for (const Red& red : kReds) {
+    for (bool alpha : {false, true}) {
+      TestI420Frame frame(kWidth, kHeight);
+      frame.Fill(red.y, red.u, red.v);
+      if (alpha) {
+        frame.AddAlpha();
+        std::fill(frame.a.begin(), frame.a.end(), (uint8_t)0x40);
+      }
+      for (const Layout& layout : kLayouts) {
+        TestDstFrame dst(layout.format, kWidth, kHeight);
+        ASSERT_EQ(MRS_SUCCESS, mrsVideoFrameConvert(&frame.info, &dst.info,
+                                                    red.matrix,
+                                                    VideoColorRange::kLimited,
+                                                    mrsBool::kFalse));
+        for (int i = 0; i < kWidth * kHeight; ++i) {
+          const uint8_t* p = &dst.data[i * layout.bytes_per_pixel];
+          ASSERT_LE(245, p[layout.r]) << "format " << (int)layout.format;
+          ASSERT_GE(10, p[layout.g]) << "format " << (int)layout.format;
+          ASSERT_GE(10, p[layout.b]) << "format " << (int)layout.format;
+          if (layout.a >= 0) {
+            ASSERT_EQ(alpha ? 0x40 : 0xFF, p[layout.a]);
+          }
+        }
+      }
+    }
+  }
+}
+
+TEST(VideoConversion, Nv12) {
+  constexpr int kWidth = 64;
+  constexpr int kHeight = 34;
+  TestI420Frame frame(kWidth, kHeight);
+  TestDstFrame nv12(VideoFrameFormat::kNv12, kWidth, kHeight);
+  ASSERT_EQ(MRS_SUCCESS,
+            mrsVideoFrameConvert(&frame.info, &nv12.info,
+                                 VideoColorMatrix::kBt601,
+                                 VideoColorRange::kLimited, mrsBool::kFalse));
+  ASSERT_EQ(frame.y, nv12.data);
+  for (size_t i = 0; i < frame.u.size(); ++i) {
+    ASSERT_EQ(frame.u[i], nv12.uv[i * 2]);
+    ASSERT_EQ(frame.v[i], nv12.uv[i * 2 + 1]);
+  }
+}
+
+TEST(VideoConversion, ColorMatrixAndRange) {
+  constexpr int kWidth = 16;
+  constexpr int kHeight = 16;
+  TestI420Frame frame(kWidth, kHeight);
+  auto convert = [&frame](VideoColorMatrix matrix, VideoColorRange range,
+                          VideoFrameFormat format) {
+    TestDstFrame dst(format, kWidth, kHeight);
+    EXPECT_EQ(MRS_SUCCESS, mrsVideoFrameConvert(&frame.info, &dst.info, matrix,
+                                                range, mrsBool::kFalse));
+    return dst.data;
+  };
+
+  // Limited range white is full range light gray
+  frame.Fill(235, 128, 128);
+  const auto limited = convert(VideoColorMatrix::kBt601,
+                               VideoColorRange::kLimited,
+                               VideoFrameFormat::kArgb32);
+  const auto full = convert(VideoColorMatrix::kBt601, VideoColorRange::kFull,
+                            VideoFrameFormat::kArgb32);
+  ASSERT_LE(254, limited[0]);
+  ASSERT_NEAR(235, full[0], 1);
+
+  // The matrix only affects colors, and applies to all RGB formats
+  frame.Fill(128, 64, 192);
+  for (VideoFrameFormat format :
+       {VideoFrameFormat::kArgb32, VideoFrameFormat::kRgba32,
+        VideoFrameFormat::kBgra32, VideoFrameFormat::kRgb24}) {
+    ASSERT_NE(convert(VideoColorMatrix::kBt601, VideoColorRange::kLimited,
+                      format),
+              convert(VideoColorMatrix::kBt709, VideoColorRange::kLimited,
+                      format));
+  }
+
+  // BT.709 full range is not supported
+  TestDstFrame dst(VideoFrameFormat::kArgb32, kWidth, kHeight);
+  ASSERT_EQ(MRS_E_INVALID_PARAMETER,
+            mrsVideoFrameConvert(&frame.info, &dst.info,
+                                 VideoColorMatrix::kBt709,
+                                 VideoColorRange::kFull, mrsBool::kFalse));
+}
+
+// Compare the single-threaded and parallel I420 to ARGB conversions. Both
+// must produce the same result; the parallel one should have a lower latency
+// on multi-core machines.
+TEST(VideoConversion, ArgbParallelBenchmark) {
+  // Same pool size as the process-wide pool of the library.
+  const int num_cores = static_cast<int>(std::thread::hardware_concurrency());
+  WorkerPool pool(std::max(num_cores - 1, 1));
+
+  struct Resolution {
+    const char* name;
+    int width;
+    int height;
+  };
+  constexpr Resolution kResolutions[] = {{"1080p", 1920, 1080},
+                                         {"4K", 3840, 2160}};
+  constexpr int kNumFrames = 60;
+  for (const Resolution& res : kResolutions) {
+    TestI420Frame frame(res.width, res.height);
+    TestDstFrame serial_dst(VideoFrameFormat::kArgb32, res.width, res.height);
+    TestDstFrame parallel_dst(VideoFrameFormat::kArgb32, res.width,
+                              res.height);
+
+    const ConversionStats serial =
+        MeasureConversion(frame.info, serial_dst.info, nullptr, kNumFrames);
+    const ConversionStats parallel =
+        MeasureConversion(frame.info, parallel_dst.info, &pool, kNumFrames);
+    // Both paths produce the same result
+    ASSERT_EQ(serial_dst.data, parallel_dst.data);
+    printf(
+        "%s serial:   avg %.2f ms, max %.2f ms, %.1f fps\n"
+        "%s parallel: avg %.2f ms, max %.2f ms, %.1f fps\n",
+        res.name, serial.avg_ms, serial.max_ms, 1000.0 / serial.avg_ms,
+        res.name, parallel.avg_ms, parallel.max_ms, 1000.0 / parallel.avg_ms);
+  }
+}
+
+TEST(VideoConversion, PremultipliedArgb) {
+  constexpr int kWidth = 64;
+  constexpr int kHeight = 34;
+  TestI420Frame frame(kWidth, kHeight);
+  frame.AddAlpha();
+  TestDstFrame straight(VideoFrameFormat::kArgb32, kWidth, kHeight);
+  std::vector<uint8_t> premultiplied(straight.data.size());
+  ConvertI420A(frame.info, straight.info, VideoColorMatrix::kBt601,
+               VideoColorRange::kLimited, false, nullptr);
+  ASSERT_EQ(MRS_SUCCESS, mrsVideoFrameConvertToPremultipliedArgb(
+                             &frame.info, premultiplied.data(), kWidth * 4,
+                             mrsBool::kFalse));
+
+  // Same alpha, and colors scaled by alpha up to rounding
+  for (size_t i = 0; i < straight.data.size(); i += 4) {
+    const int alpha = straight.data[i + 3];
+    ASSERT_EQ(alpha, premultiplied[i + 3]);
+    for (size_t c = 0; c < 3; ++c) {
+      ASSERT_NEAR(straight.data[i + c] * alpha / 255, premultiplied[i + c], 1);
+    }
+  }
+
+  // Opaque frames are unchanged
+  frame.info.data[3] = nullptr;
+  ConvertI420A(frame.info, straight.info, VideoColorMatrix::kBt601,
+               VideoColorRange::kLimited, false, nullptr);
+  ASSERT_EQ(MRS_SUCCESS, mrsVideoFrameConvertToPremultipliedArgb(
+                             &frame.info, premultiplied.data(), kWidth * 4,
+                             mrsBool::kFalse));
+  ASSERT_EQ(straight.data, premultiplied);
+}
+
+// Compare premultiplying alpha during the conversion with the SIMD conversion
+// and attenuation passes of libyuv run one after the other over the frame, as
+// done by compositors consuming straight alpha.
+TEST(VideoConversion, PremultipliedArgbBenchmark) {
+  using clock = std::chrono::steady_clock;
+  constexpr int kWidth = 1920;
+  constexpr int kHeight = 1080;
+  constexpr int kNumFrames = 60;
+  TestI420Frame frame(kWidth, kHeight);
+  frame.AddAlpha();
+  std::vector<uint8_t> two_pass(static_cast<size_t>(kWidth) * kHeight * 4);
+  std::vector<uint8_t> one_pass(two_pass.size());
+
+  clock::duration two_pass_total{};
+  clock::duration one_pass_total{};
+  for (int i = 0; i < kNumFrames; ++i) {
+    auto start = clock::now();
+    libyuv::I420AlphaToARGB(frame.y.data(), frame.info.stride[0],
+                            frame.u.data(), frame.info.stride[1],
+                            frame.v.data(), frame.info.stride[2],
+                            frame.a.data(), frame.info.stride[3],
+                            two_pass.data(), kWidth * 4, kWidth, kHeight,
+                            /* attenuate */ 0);
+    libyuv::ARGBAttenuate(two_pass.data(), kWidth * 4, two_pass.data(),
+                          kWidth * 4, kWidth, kHeight);
+    two_pass_total += clock::now() - start;
+
+    start = clock::now();
+    mrsVideoFrameConvertToPremultipliedArgb(&frame.info, one_pass.data(),
+                                            kWidth * 4, mrsBool::kFalse);
+    one_pass_total += clock::now() - start;
+  }
+  for (size_t i = 0; i < two_pass.size(); ++i) {
+    ASSERT_NEAR(two_pass[i], one_pass[i], 1);
+  }
+
+  const double two_pass_ms =
+      std::chrono::duration<double, std::milli>(two_pass_total).count() /
+      kNumFrames;
+  const double one_pass_ms =
+      std::chrono::duration<double, std::milli>(one_pass_total).count() /
+      kNumFrames;
+  printf(
+      "1080p libyuv convert + attenuate: avg %.2f ms\n"
+      "1080p premultiplied conversion:  avg %.2f ms (%.1fx)\n",
+      two_pass_ms, one_pass_ms, two_pass_ms / one_pass_ms);
+}
+
+TEST(VideoConversion, FitResolution) {
+  int32_t width = 0;
+  int32_t height = 0;
+  ASSERT_EQ(MRS_SUCCESS,
+            mrsVideoFrameFitResolution(1920, 1080, 0, 0, &width, &height));
+  ASSERT_EQ(1920, width);
+  ASSERT_EQ(1080, height);
+
+  // Never upscale
+  ASSERT_EQ(MRS_SUCCESS,
+            mrsVideoFrameFitResolution(640, 480, 1280, 720, &width, &height));
+  ASSERT_EQ(640, width);
+  ASSERT_EQ(480, height);
+
+  // Most constraining dimension wins, aspect ratio preserved
+  ASSERT_EQ(MRS_SUCCESS,
+            mrsVideoFrameFitResolution(1920, 1080, 320, 320, &width, &height));
+  ASSERT_EQ(320, width);
+  ASSERT_EQ(180, height);
+  ASSERT_EQ(MRS_SUCCESS,
+            mrsVideoFrameFitResolution(1920, 1080, 0, 240, &width, &height));
+  ASSERT_EQ(426, width);
+  ASSERT_EQ(240, height);
+
+  ASSERT_EQ(MRS_E_INVALID_PARAMETER,
+            mrsVideoFrameFitResolution(1920, 1080, -1, 0, &width, &height));
+}
+
+TEST(VideoConversion, Scale) {
+  constexpr int kWidth = 64;
+  constexpr int kHeight = 32;
+  TestI420Frame frame(kWidth, kHeight);
+  frame.Fill(200, 100, 50);
+  TestI420Frame scaled(kWidth / 4, kHeight / 4);
+  ASSERT_EQ(MRS_SUCCESS, mrsVideoFrameScale(&frame.info, &scaled.info));
+
+  // Box filtering a constant frame yields the same constant
+  for (uint8_t y : scaled.y) {
+    ASSERT_EQ(200, y);
+  }
+  for (size_t i = 0; i < scaled.u.size(); ++i) {
+    ASSERT_EQ(100, scaled.u[i]);
+    ASSERT_EQ(50, scaled.v[i]);
+  }
+
+  TestDstFrame argb(VideoFrameFormat::kArgb32, kWidth / 4, kHeight / 4);
+  ASSERT_EQ(MRS_E_INVALID_PARAMETER,
+            mrsVideoFrameScale(&frame.info, &argb.info));
+}
@@ -0,0 +1,167 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#include "pch.h"
+
+#include "interop/interop_api.h"
+#include "interop/local_video_track_interop.h"
+#include "interop/video_frame_interop.h"
+
+namespace {
+
+/// Opaque black in 32-bit ARGB.
+constexpr uint32_t kBlack = 0xFF000000u;
+
+/// Caller-owned ARGB canvas.
+struct ArgbCanvas {
+  ArgbCanvas(int width, int height)
+      : pixels(static_cast<size_t>(width) * height, 0u) {
+    info.format = VideoFrameFormat::kArgb32;
+    info.width = width;
+    info.height = height;
+    info.data[0] = pixels.data();
+    info.stride[0] = width * 4;
+  }
+
+  /// Count the pixels of the given area which are not black.
+  int CountNonBlack(int x, int y, int w, int h) const {
+    int count = 0;
+    for (int j = y; j < y + h; ++j) {
+      for (int i = x; i < x + w; ++i) {
+        if (pixels[static_cast<size_t>(j) * info.width + i] != kBlack) {
+          ++count;
+        }
+      }
+    }
+    return count;
+  }
+
+  std::vector<uint32_t> pixels;
+  VideoFrameInfo info{};
+};
+
+}  // namespace
+
+TEST(VideoMosaic, InvalidParams) {
+  ArgbCanvas canvas(64, 48);
+  VideoMosaicConfiguration config{};
+  VideoMosaicHandle mosaic{};
+  ASSERT_EQ(MRS_E_INVALID_PARAMETER,
+            mrsVideoMosaicCreate(config, nullptr, &mosaic));
+  config.columns = 0;
+  ASSERT_EQ(MRS_E_INVALID_PARAMETER,
+            mrsVideoMosaicCreate(config, &canvas.info, &mosaic));
+  config = VideoMosaicConfiguration{};
+  config.format = VideoFrameFormat::kI420A;
+  ASSERT_EQ(MRS_E_INVALID_PARAMETER,
+            mrsVideoMosaicCreate(config, &canvas.info, &mosaic));
+  config = VideoMosaicConfiguration{};
+  config.columns = 64;  // tiles narrower than 2 pixels
+  ASSERT_EQ(MRS_E_INVALID_PARAMETER,
+            mrsVideoMosaicCreate(config, &canvas.info, &mosaic));
+  ASSERT_EQ(nullptr, mosaic);
+
+  // The canvas is cleared on creation
+  config = VideoMosaicConfiguration{};
+  ASSERT_EQ(MRS_SUCCESS, mrsVideoMosaicCreate(config, &canvas.info, &mosaic));
+  ASSERT_NE(nullptr, mosaic);
+  ASSERT_EQ(0, canvas.CountNonBlack(0, 0, 64, 48));
+
+  VideoSinkId sink_id{};
+  ASSERT_EQ(MRS_E_INVALID_PARAMETER,
+            mrsVideoMosaicAddRemoteVideoSink(mosaic, 4, nullptr,
+                                             VideoSinkConfiguration{},
+                                             &sink_id));
+  ASSERT_EQ(MRS_E_INVALID_PARAMETER,
+            mrsVideoMosaicAddRemoteVideoSink(mosaic, -1, nullptr,
+                                             VideoSinkConfiguration{},
+                                             &sink_id));
+  ASSERT_EQ(MRS_E_INVALID_PEER_HANDLE,
+            mrsVideoMosaicAddRemoteVideoSink(mosaic, 3, nullptr,
+                                             VideoSinkConfiguration{},
+                                             &sink_id));
+  ASSERT_EQ(0u, sink_id);
+
+  // Nothing to draw until a tile changes
+  mrsBool updated = mrsBool::kTrue;
+  ASSERT_EQ(MRS_SUCCESS, mrsVideoMosaicCompose(mosaic, &updated));
+  ASSERT_EQ(mrsBool::kFalse, updated);
+  ASSERT_EQ(MRS_SUCCESS, mrsVideoMosaicClearTile(mosaic, 1));
+  ASSERT_EQ(MRS_SUCCESS, mrsVideoMosaicCompose(mosaic, &updated));
+  ASSERT_EQ(mrsBool::kTrue, updated);
+
+  mrsVideoMosaicRemoveRef(mosaic);
+}
+
+// Compose two remote test patterns into the first two tiles of a 2x2 grid.
+TEST(VideoMosaic, TwoTracks) {
+  constexpr int kNumTracks = 2;
+  ArgbCanvas canvas(640, 480);
+  VideoMosaicHandle mosaic{};
+  {
+    LocalPeerPairRaii pairs[kNumTracks];
+
+    // Create the mosaic once the library is initialized, to draw in parallel
+    VideoMosaicConfiguration config{};
+    config.parallel = mrsBool::kTrue;
+    ASSERT_EQ(MRS_SUCCESS,
+              mrsVideoMosaicCreate(config, &canvas.info, &mosaic));
+    LocalVideoTrackHandle tracks[kNumTracks]{};
+    VideoSinkId sink_ids[kNumTracks]{};
+    for (int i = 0; i < kNumTracks; ++i) {
+      TestPatternConfiguration pattern_config{};
+      pattern_config.width = 320;
+      pattern_config.height = 240;
+      ASSERT_EQ(MRS_SUCCESS,
+                mrsPeerConnectionAddLocalVideoTrackFromTestPattern(
+                    pairs[i].pc1(), "test_pattern", pattern_config,
+                    &tracks[i]));
+      ASSERT_EQ(MRS_SUCCESS, mrsVideoMosaicAddRemoteVideoSink(
+                                 mosaic, i, pairs[i].pc2(),
+                                 VideoSinkConfiguration{}, &sink_ids[i]));
+      pairs[i].ConnectAndWait();
+    }
+
+    // Render loop at about 60 Hz
+    uint32_t num_updates = 0;
+    const auto end = std::chrono::steady_clock::now() + 3s;
+    while (std::chrono::steady_clock::now() < end) {
+      mrsBool updated = mrsBool::kFalse;
+      ASSERT_EQ(MRS_SUCCESS, mrsVideoMosaicCompose(mosaic, &updated));
+      if (updated == mrsBool::kTrue) {
+        ++num_updates;
+      }
+      std::this_thread::sleep_for(16ms);
+    }
+    for (int i = 0; i < kNumTracks; ++i) {
+      ASSERT_EQ(MRS_SUCCESS, mrsPeerConnectionRemoveRemoteVideoSink(
+                                 pairs[i].pc2(), sink_ids[i]));
+      mrsLocalVideoTrackRemoveRef(tracks[i]);
+    }
+    ASSERT_LT(0u, num_updates);
+  }
+
+  VideoMosaicStats stats{};
+  ASSERT_EQ(MRS_SUCCESS, mrsVideoMosaicGetStats(mosaic, &stats));
+  printf("Mosaic: %llu composed, %llu tiles drawn, %llu dropped\n",
+         (unsigned long long)stats.composed_frames,
+         (unsigned long long)stats.drawn_tiles,
+         (unsigned long long)stats.dropped_frames);
+  ASSERT_LT(0u, stats.drawn_tiles);
+  ASSERT_LE(stats.composed_frames, stats.drawn_tiles);
+
+  // The tiles fed with a track are drawn, the others stay black
+  ASSERT_LT(320 * 240 / 2, canvas.CountNonBlack(0, 0, 320, 240));
+  ASSERT_LT(320 * 240 / 2, canvas.CountNonBlack(320, 0, 320, 240));
+  ASSERT_EQ(0, canvas.CountNonBlack(0, 240, 640, 240));
+
+  // Clearing a tile leaves the other tiles untouched
+  ASSERT_EQ(MRS_SUCCESS, mrsVideoMosaicClearTile(mosaic, 0));
+  mrsBool updated = mrsBool::kFalse;
+  ASSERT_EQ(MRS_SUCCESS, mrsVideoMosaicCompose(mosaic, &updated));
+  ASSERT_EQ(mrsBool::kTrue, updated);
+  ASSERT_EQ(0, canvas.CountNonBlack(0, 0, 320, 240));
+  ASSERT_LT(320 * 240 / 2, canvas.CountNonBlack(320, 0, 320, 240));
+
+  mrsVideoMosaicRemoveRef(mosaic);
+}
@@ -0,0 +1,169 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#include "pch.h"
+
+#include "interop/interop_api.h"
+#include "interop/local_video_track_interop.h"
+
+namespace {
+
+/// Snapshot completed asynchronously, holding a copy of the JPEG image.
+struct Snapshot {
+  static void MRS_CALL OnReady(void* user_data,
+                               mrsResult result,
+                               const void* data,
+                               uint64_t size) {
+    auto snapshot = static_cast<Snapshot*>(user_data);
+    snapshot->result = result;
+    if (data) {
+      auto bytes = static_cast<const uint8_t*>(data);
+      snapshot->jpeg.assign(bytes, bytes + size);
+    }
+    snapshot->thread_id = std::this_thread::get_id();
+    snapshot->ready.Set();
+  }
+
+  /// Read the image resolution from the baseline frame header.
+  bool GetSize(int* width, int* height) const {
+    for (size_t i = 2; i + 9 < jpeg.size(); ++i) {
+      if ((jpeg[i] == 0xFF) && (jpeg[i + 1] == 0xC0)) {
+        *height = (jpeg[i + 5] << 8) | jpeg[i + 6];
+        *width = (jpeg[i + 7] << 8) | jpeg[i + 8];
+        return true;
+      }
+    }
+    return false;
+  }
+
+  Event ready;
+  mrsResult result = MRS_E_UNKNOWN;
+  std::vector<uint8_t> jpeg;
+  std::thread::id thread_id;
+};
+
+/// Check that |jpeg| starts and ends with the JPEG image markers.
+void CheckMarkers(const std::vector<uint8_t>& jpeg) {
+  ASSERT_LT(4u, jpeg.size());
+  ASSERT_EQ(0xFF, jpeg[0]);
+  ASSERT_EQ(0xD8, jpeg[1]);
+  ASSERT_EQ(0xFF, jpeg[jpeg.size() - 2]);
+  ASSERT_EQ(0xD9, jpeg[jpeg.size() - 1]);
+}
+
+}  // namespace
+
+TEST(VideoSnapshot, InvalidParams) {
+  PCRaii pc;
+  LocalVideoTrackHandle track_handle{};
+  ASSERT_EQ(MRS_SUCCESS, mrsPeerConnectionAddLocalVideoTrackFromTestPattern(
+                             pc.handle(), "test_pattern",
+                             TestPatternConfiguration{}, &track_handle));
+
+  Snapshot snapshot;
+  VideoSnapshotConfiguration config{};
+  ASSERT_EQ(MRS_E_INVALID_PARAMETER,
+            mrsLocalVideoTrackCaptureSnapshot(track_handle, config, nullptr,
+                                              &snapshot));
+  config.quality = 0;
+  ASSERT_EQ(MRS_E_INVALID_PARAMETER,
+            mrsLocalVideoTrackCaptureSnapshot(
+                track_handle, config, &Snapshot::OnReady, &snapshot));
+  config = VideoSnapshotConfiguration{};
+  config.max_width = -1;
+  ASSERT_EQ(MRS_E_INVALID_PARAMETER,
+            mrsLocalVideoTrackCaptureSnapshot(
+                track_handle, config, &Snapshot::OnReady, &snapshot));
+  ASSERT_EQ(MRS_E_INVALID_PARAMETER,
+            mrsPeerConnectionCaptureRemoteVideoSnapshot(
+                pc.handle(), VideoSnapshotConfiguration{}, nullptr, nullptr));
+
+  ASSERT_EQ(MRS_SUCCESS,
+            mrsPeerConnectionRemoveLocalVideoTrack(pc.handle(), track_handle));
+  mrsLocalVideoTrackRemoveRef(track_handle);
+}
+
+// Snapshot the local and remote frames of a test pattern track, at reduced
+// and original size.
+TEST(VideoSnapshot, LocalAndRemote) {
+  LocalPeerPairRaii pair;
+  TestPatternConfiguration pattern_config{};
+  pattern_config.width = 640;
+  pattern_config.height = 480;
+  LocalVideoTrackHandle track_handle{};
+  ASSERT_EQ(MRS_SUCCESS, mrsPeerConnectionAddLocalVideoTrackFromTestPattern(
+                             pair.pc1(), "test_pattern", pattern_config,
+                             &track_handle));
+
+  Snapshot local;
+  VideoSnapshotConfiguration config{};
+  config.max_width = 320;
+  config.max_height = 320;
+  ASSERT_EQ(MRS_SUCCESS,
+            mrsLocalVideoTrackCaptureSnapshot(
+                track_handle, config, &Snapshot::OnReady, &local));
+  ASSERT_TRUE(local.ready.WaitFor(5s));
+  ASSERT_EQ(MRS_SUCCESS, local.result);
+  ASSERT_NE(std::this_thread::get_id(), local.thread_id);
+  CheckMarkers(local.jpeg);
+  int width = 0;
+  int height = 0;
+  ASSERT_TRUE(local.GetSize(&width, &height));
+  ASSERT_EQ(320, width);
+  ASSERT_EQ(240, height);
+
+  pair.ConnectAndWait();
+  Snapshot remote;
+  ASSERT_EQ(MRS_SUCCESS, mrsPeerConnectionCaptureRemoteVideoSnapshot(
+                             pair.pc2(), VideoSnapshotConfiguration{},
+                             &Snapshot::OnReady, &remote));
+  ASSERT_TRUE(remote.ready.WaitFor(5s));
+  ASSERT_EQ(MRS_SUCCESS, remote.result);
+  CheckMarkers(remote.jpeg);
+  ASSERT_TRUE(remote.GetSize(&width, &height));
+  // The sender may adapt the resolution down, preserving the aspect ratio.
+  ASSERT_GE(640, width);
+  ASSERT_EQ(width * 3, height * 4);
+  printf("Snapshots: %zu bytes at 320x240, %zu bytes at %dx%d\n",
+         local.jpeg.size(), remote.jpeg.size(), width, height);
+
+  mrsLocalVideoTrackRemoveRef(track_handle);
+}
+
+// The snapshot callback, invoked on a worker thread, can release the last
+// peer connection, which shuts down the library and its worker threads.
+TEST(VideoSnapshot, ReleaseFromCallback) {
+  struct Owner {
+    static void MRS_CALL OnReady(void* user_data,
+                                 mrsResult result,
+                                 const void* data,
+                                 uint64_t size) {
+      auto owner = static_cast<Owner*>(user_data);
+      Snapshot::OnReady(&owner->snapshot, result, data, size);
+      mrsPeerConnectionRemoveLocalVideoTrack(owner->pc, owner->track);
+      mrsLocalVideoTrackRemoveRef(owner->track);
+      mrsPeerConnectionClose(owner->pc);
+      owner->released.Set();
+    }
+    PeerConnectionHandle pc{};
+    LocalVideoTrackHandle track{};
+    Snapshot snapshot;
+    Event released;
+  } owner;
+
+  PeerConnectionConfiguration pc_config{};
+  ASSERT_EQ(MRS_SUCCESS,
+            mrsPeerConnectionCreate(pc_config, (void*)0x1, &owner.pc));
+  ASSERT_EQ(MRS_SUCCESS, mrsPeerConnectionAddLocalVideoTrackFromTestPattern(
+                             owner.pc, "test_pattern",
+                             TestPatternConfiguration{}, &owner.track));
+  ASSERT_EQ(MRS_SUCCESS, mrsLocalVideoTrackCaptureSnapshot(
+                             owner.track, VideoSnapshotConfiguration{},
+                             &Owner::OnReady, &owner));
+  ASSERT_TRUE(owner.released.WaitFor(5s));
+  ASSERT_EQ(MRS_SUCCESS, owner.snapshot.result);
+
+  // The library can be initialized again afterwards.
+  PCRaii pc;
+  ASSERT_NE(nullptr, pc.handle());
+}
@@ -0,0 +1,236 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#include "pch.h"
+
+#include "interop/interop_api.h"
+#include "interop/local_video_track_interop.h"
+#include "interop/video_frame_interop.h"
+
+namespace {
+
+/// Caller-owned I420 frame of uniform color.
+struct UniformI420Frame {
+  UniformI420Frame(int width, int height, uint8_t y, uint8_t u, uint8_t v)
+      : y_plane(static_cast<size_t>(width) * height, y),
+        u_plane(static_cast<size_t>((width + 1) / 2) * ((height + 1) / 2), u),
+        v_plane(u_plane.size(), v) {
+    info.format = VideoFrameFormat::kI420A;
+    info.width = width;
+    info.height = height;
+    info.data[0] = y_plane.data();
+    info.data[1] = u_plane.data();
+    info.data[2] = v_plane.data();
+    info.stride[0] = width;
+    info.stride[1] = (width + 1) / 2;
+    info.stride[2] = (width + 1) / 2;
+  }
+
+  std::vector<uint8_t> y_plane;
+  std::vector<uint8_t> u_plane;
+  std::vector<uint8_t> v_plane;
+  VideoFrameInfo info{};
+};
+
+/// Get the value of channel |c| at (x, y) of a CHW tensor.
+float At(const std::vector<float>& tensor,
+         const VideoTensorInfo& info,
+         int c,
+         int x,
+         int y) {
+  return tensor[(static_cast<size_t>(c) * info.height + y) * info.width + x];
+}
+
+}  // namespace
+
+TEST(VideoTensor, InvalidParams) {
+  VideoTensorConverterHandle converter{};
+  VideoTensorConfiguration config{};
+  config.width = 0;
+  ASSERT_EQ(MRS_E_INVALID_PARAMETER,
+            mrsVideoTensorConverterCreate(config, nullptr, nullptr,
+                                          &converter));
+  config = VideoTensorConfiguration{};
+  config.std[1] = 0.0f;
+  ASSERT_EQ(MRS_E_INVALID_PARAMETER,
+            mrsVideoTensorConverterCreate(config, nullptr, nullptr,
+                                          &converter));
+  ASSERT_EQ(nullptr, converter);
+
+  config = VideoTensorConfiguration{};
+  config.color_matrix = VideoColorMatrix::kBt709;
+  config.color_range = VideoColorRange::kFull;
+  ASSERT_EQ(MRS_E_INVALID_PARAMETER,
+            mrsVideoTensorConverterCreate(config, nullptr, nullptr,
+                                          &converter));
+  ASSERT_EQ(nullptr, converter);
+
+  config = VideoTensorConfiguration{};
+  ASSERT_EQ(MRS_SUCCESS, mrsVideoTensorConverterCreate(config, nullptr,
+                                                       nullptr, &converter));
+  uint64_t size = 0;
+  ASSERT_EQ(MRS_SUCCESS,
+            mrsVideoTensorConverterGetTensorSize(converter, &size));
+  ASSERT_EQ(224u * 224u * 3u, size);
+
+  UniformI420Frame frame(64, 48, 16, 128, 128);
+  std::vector<float> tensor(size - 1);
+  VideoTensorInfo info{};
+  ASSERT_EQ(MRS_E_INVALID_PARAMETER,
+            mrsVideoTensorConverterConvert(converter, &frame.info,
+                                           tensor.data(), tensor.size(),
+                                           &info));
+  tensor.resize(size);
+  frame.info.format = VideoFrameFormat::kArgb32;
+  ASSERT_EQ(MRS_E_INVALID_PARAMETER,
+            mrsVideoTensorConverterConvert(converter, &frame.info,
+                                           tensor.data(), tensor.size(),
+                                           &info));
+
+  mrsVideoTensorConverterRemoveRef(converter);
+}
+
+// Convert a 4:3 white frame into a square tensor, letterboxed and normalized.
+TEST(VideoTensor, LetterboxNormalize) {
+  VideoTensorConfiguration config{};
+  config.width = 32;
+  config.height = 32;
+  config.letterbox_value = 0;
+  for (int c = 0; c < 3; ++c) {
+    config.mean[c] = 0.5f;
+    config.std[c] = 0.5f;
+  }
+  VideoTensorConverterHandle converter{};
+  ASSERT_EQ(MRS_SUCCESS, mrsVideoTensorConverterCreate(config, nullptr,
+                                                       nullptr, &converter));
+
+  UniformI420Frame frame(64, 48, 235, 128, 128);
+  std::vector<float> tensor(32 * 32 * 3, 42.0f);
+  VideoTensorInfo info{};
+  ASSERT_EQ(MRS_SUCCESS,
+            mrsVideoTensorConverterConvert(converter, &frame.info,
+                                           tensor.data(), tensor.size(),
+                                           &info));
+  ASSERT_EQ(tensor.data(), info.data);
+  ASSERT_EQ(0, info.content_x);
+  ASSERT_EQ(4, info.content_y);
+  ASSERT_EQ(32, info.content_width);
+  ASSERT_EQ(24, info.content_height);
+  for (int c = 0; c < 3; ++c) {
+    // Black border, and white content
+    ASSERT_FLOAT_EQ(-1.0f, At(tensor, info, c, 0, 0));
+    ASSERT_FLOAT_EQ(-1.0f, At(tensor, info, c, 31, 3));
+    ASSERT_NEAR(1.0f, At(tensor, info, c, 0, 4), 0.01f);
+    ASSERT_NEAR(1.0f, At(tensor, info, c, 31, 27), 0.01f);
+    ASSERT_FLOAT_EQ(-1.0f, At(tensor, info, c, 16, 28));
+  }
+
+  mrsVideoTensorConverterRemoveRef(converter);
+}
+
+// Channel planes are in RGB order, or BGR if requested.
+TEST(VideoTensor, ChannelOrder) {
+  // BT.601 limited range red
+  UniformI420Frame frame(16, 16, 81, 90, 240);
+  for (mrsBool bgr : {mrsBool::kFalse, mrsBool::kTrue}) {
+    VideoTensorConfiguration config{};
+    config.width = 16;
+    config.height = 16;
+    config.bgr = bgr;
+    VideoTensorConverterHandle converter{};
+    ASSERT_EQ(MRS_SUCCESS, mrsVideoTensorConverterCreate(
+                               config, nullptr, nullptr, &converter));
+    std::vector<float> tensor(16 * 16 * 3);
+    VideoTensorInfo info{};
+    ASSERT_EQ(MRS_SUCCESS,
+              mrsVideoTensorConverterConvert(converter, &frame.info,
+                                             tensor.data(), tensor.size(),
+                                             &info));
+    const int red = (bgr == mrsBool::kTrue ? 2 : 0);
+    ASSERT_NEAR(1.0f, At(tensor, info, red, 8, 8), 0.02f);
+    ASSERT_NEAR(0.0f, At(tensor, info, 1, 8, 8), 0.02f);
+    ASSERT_NEAR(0.0f, At(tensor, info, 2 - red, 8, 8), 0.02f);
+    mrsVideoTensorConverterRemoveRef(converter);
+  }
+}
+
+// Convert the frames of a local video track with a video sink.
+TEST(VideoTensor, Sink) {
+  PCRaii pc;
+  TestPatternConfiguration pattern_config{};
+  pattern_config.width = 640;
+  pattern_config.height = 480;
+  LocalVideoTrackHandle track_handle{};
+  ASSERT_EQ(MRS_SUCCESS, mrsPeerConnectionAddLocalVideoTrackFromTestPattern(
+                             pc.handle(), "test_pattern", pattern_config,
+                             &track_handle));
+
+  struct Counter {
+    static void MRS_CALL OnTensor(void* user_data,
+                                  const VideoTensorInfo* tensor) {
+      auto counter = static_cast<Counter*>(user_data);
+      EXPECT_EQ(224, tensor->width);
+      EXPECT_EQ(168, tensor->content_height);
+      ++counter->count;
+    }
+    std::atomic_uint32_t count{0};
+  } counter;
+  VideoTensorConverterHandle converter{};
+  ASSERT_EQ(MRS_SUCCESS,
+            mrsVideoTensorConverterCreate(VideoTensorConfiguration{},
+                                          &Counter::OnTensor, &counter,
+                                          &converter));
+  VideoSinkId sink_id{};
+  VideoSinkConfiguration sink_config{};
+  sink_config.format = VideoFrameFormat::kArgb32;
+  ASSERT_EQ(MRS_E_INVALID_PARAMETER,
+            mrsVideoTensorConverterAddLocalVideoSink(converter, track_handle,
+                                                     sink_config, &sink_id));
+  sink_config.format = VideoFrameFormat::kI420A;
+  ASSERT_EQ(MRS_SUCCESS,
+            mrsVideoTensorConverterAddLocalVideoSink(converter, track_handle,
+                                                     sink_config, &sink_id));
+  ASSERT_NE(0u, sink_id);
+
+  // The sink keeps the converter alive
+  mrsVideoTensorConverterRemoveRef(converter);
+  Event ev;
+  ev.WaitFor(1s);
+  ASSERT_EQ(MRS_SUCCESS, mrsLocalVideoTrackRemoveSink(track_handle, sink_id));
+  ASSERT_LT(0u, counter.count.load());
+
+  ASSERT_EQ(MRS_SUCCESS,
+            mrsPeerConnectionRemoveLocalVideoTrack(pc.handle(), track_handle));
+  mrsLocalVideoTrackRemoveRef(track_handle);
+}
+
+// Measure the conversion of 1080p frames into the tensors of common models.
+TEST(VideoTensor, Benchmark) {
+  using clock = std::chrono::steady_clock;
+  constexpr int kNumFrames = 60;
+  UniformI420Frame frame(1920, 1080, 128, 100, 160);
+  for (int size : {224, 640}) {
+    VideoTensorConfiguration config{};
+    config.width = size;
+    config.height = size;
+    VideoTensorConverterHandle converter{};
+    ASSERT_EQ(MRS_SUCCESS, mrsVideoTensorConverterCreate(
+                               config, nullptr, nullptr, &converter));
+    std::vector<float> tensor(static_cast<size_t>(size) * size * 3);
+    VideoTensorInfo info{};
+
+    clock::duration total{};
+    for (int i = 0; i < kNumFrames; ++i) {
+      const auto start = clock::now();
+      ASSERT_EQ(MRS_SUCCESS,
+                mrsVideoTensorConverterConvert(converter, &frame.info,
+                                               tensor.data(), tensor.size(),
+                                               &info));
+      total += clock::now() - start;
+    }
+    const double avg_ms =
+        std::chrono::duration<double, std::milli>(total).count() / kNumFrames;
+    printf("1080p to %dx%d tensor: avg %.2f ms\n", size, size, avg_ms);
+    mrsVideoTensorConverterRemoveRef(converter);
+  }
+}
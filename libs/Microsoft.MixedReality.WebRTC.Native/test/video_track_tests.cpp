@@ -3,8 +3,11 @@
 
 #include "pch.h"
 
+#include <algorithm>
+
 #include "interop/interop_api.h"
 #include "interop/local_video_track_interop.h"
+#include "interop/video_frame_interop.h"
 
 #if !defined(MRSW_EXCLUDE_DEVICE_TESTS)
 
@@ -22,6 +25,43 @@ using I420VideoFrameCallback = InteropCallback<const void*,
                                                const int,
                                                const int>;
 
+// PeerConnectionVideoFrameHandleCallback
+using VideoFrameHandleCallback = InteropCallback<const VideoFrameInfo*>;
+
+/// Result of |mrsEnumVideoCaptureDevicesAsync|.
+struct DeviceList {
+  static void MRS_CALL OnDevice(const char* id,
+                                const char* /*name*/,
+                                void* user_data) {
+    static_cast<DeviceList*>(user_data)->ids.push_back(id);
+  }
+  static void MRS_CALL OnCompleted(void* user_data) {
+    static_cast<DeviceList*>(user_data)->completed.Set();
+  }
+  std::vector<std::string> ids;
+  Event completed;
+};
+
+/// Result of |mrsEnumVideoCaptureFormatsAsync|.
+struct FormatList {
+  static void MRS_CALL OnFormat(uint32_t width,
+                                uint32_t height,
+                                double framerate,
+                                uint32_t encoding,
+                                void* user_data) {
+    static_cast<FormatList*>(user_data)->formats.push_back(
+        {width, height, framerate, encoding});
+  }
+  static void MRS_CALL OnCompleted(mrsResult result, void* user_data) {
+    auto list = static_cast<FormatList*>(user_data);
+    list->result = result;
+    list->completed.Set();
+  }
+  std::vector<std::tuple<uint32_t, uint32_t, double, uint32_t>> formats;
+  mrsResult result = MRS_E_UNKNOWN;
+  Event completed;
+};
+
 }  // namespace
 
 TEST(VideoTrack, Simple) {
@@ -115,6 +155,599 @@ TEST(VideoTrack, Muted) {
   mrsLocalVideoTrackRemoveRef(track_handle);
 }
 
+TEST(VideoTrack, FrameHandle) {
+  LocalPeerPairRaii pair;
+
+  VideoDeviceConfiguration config{};
+  LocalVideoTrackHandle track_handle{};
+  ASSERT_EQ(MRS_SUCCESS,
+            mrsPeerConnectionAddLocalVideoTrack(pair.pc1(), "local_video_track",
+                                                config, &track_handle));
+
+  // Retain some frames beyond the callback, without copying them
+  constexpr size_t kMaxFrames = 8;
+  std::mutex frames_mutex;
+  std::vector<VideoFrameHandle> frames;
+  VideoFrameHandleCallback frame_cb = [&](const VideoFrameInfo* frame) {
+    ASSERT_NE(nullptr, frame);
+    ASSERT_NE(nullptr, frame->handle);
+    ASSERT_EQ(VideoFrameFormat::kI420A, frame->format);
+    ASSERT_NE(nullptr, frame->data[0]);
+    ASSERT_NE(nullptr, frame->data[1]);
+    ASSERT_NE(nullptr, frame->data[2]);
+    ASSERT_LT(0, frame->width);
+    ASSERT_LT(0, frame->height);
+    auto lock = std::scoped_lock{frames_mutex};
+    if (frames.size() < kMaxFrames) {
+      mrsVideoFrameAddRef(frame->handle);
+      frames.push_back(frame->handle);
+    }
+  };
+  mrsPeerConnectionRegisterRemoteVideoFrameHandleCallback(pair.pc2(),
+                                                          CB(frame_cb));
+
+  pair.ConnectAndWait();
+
+  Event ev;
+  ev.WaitFor(5s);
+
+  mrsPeerConnectionRegisterRemoteVideoFrameHandleCallback(pair.pc2(), nullptr,
+                                                          nullptr);
+
+  // Retained frames are still valid after the callback returned
+  ASSERT_EQ(kMaxFrames, frames.size());
+  for (VideoFrameHandle handle : frames) {
+    VideoFrameInfo info{};
+    ASSERT_EQ(MRS_SUCCESS, mrsVideoFrameGetInfo(handle, &info));
+    ASSERT_EQ(handle, info.handle);
+    ASSERT_LT(0, info.width);
+    ASSERT_LT(0, info.height);
+    ASSERT_LE(info.width, info.stride[0]);
+    ASSERT_NE(nullptr, info.data[0]);
+    mrsVideoFrameRemoveRef(handle);
+  }
+  mrsLocalVideoTrackRemoveRef(track_handle);
+}
+
+TEST(VideoTrack, FrameTiming) {
+  LocalPeerPairRaii pair;
+
+  VideoDeviceConfiguration config{};
+  LocalVideoTrackHandle track_handle{};
+  ASSERT_EQ(MRS_SUCCESS,
+            mrsPeerConnectionAddLocalVideoTrack(pair.pc1(), "local_video_track",
+                                                config, &track_handle));
+
+  // Timings of the remote frames, converted and unconverted
+  std::mutex timings_mutex;
+  std::vector<VideoFrameTiming> timings;
+  std::vector<VideoFrameTiming> argb_timings;
+  VideoFrameHandleCallback frame_cb = [&](const VideoFrameInfo* frame) {
+    auto lock = std::scoped_lock{timings_mutex};
+    timings.push_back(frame->timing);
+  };
+  VideoFrameHandleCallback argb_cb = [&](const VideoFrameInfo* frame) {
+    auto lock = std::scoped_lock{timings_mutex};
+    argb_timings.push_back(frame->timing);
+  };
+  mrsPeerConnectionRegisterRemoteVideoFrameHandleCallback(pair.pc2(),
+                                                          CB(frame_cb));
+  VideoSinkConfiguration sink_config{};
+  sink_config.format = VideoFrameFormat::kArgb32;
+  VideoSinkId sink_id{};
+  ASSERT_EQ(MRS_SUCCESS,
+            mrsPeerConnectionAddRemoteVideoSink(pair.pc2(), sink_config,
+                                                CB(argb_cb), &sink_id));
+
+  pair.ConnectAndWait();
+
+  Event ev;
+  ev.WaitFor(3s);
+
+  mrsPeerConnectionRegisterRemoteVideoFrameHandleCallback(pair.pc2(), nullptr,
+                                                          nullptr);
+  ASSERT_EQ(MRS_SUCCESS,
+            mrsPeerConnectionRemoveRemoteVideoSink(pair.pc2(), sink_id));
+  const int64_t now_us = mrsGetClockTimeUs();
+
+  // Received frames are timestamped, in order, and converted frames share the
+  // timing of their source frame.
+  ASSERT_LT(1u, timings.size());
+  ASSERT_EQ(timings.size(), argb_timings.size());
+  for (size_t i = 0; i < timings.size(); ++i) {
+    const VideoFrameTiming& timing = timings[i];
+    ASSERT_LT(0, timing.timestamp_us);
+    ASSERT_LT(0, timing.arrival_time_us);
+    ASSERT_LE(timing.arrival_time_us, now_us);
+    ASSERT_EQ(timing.rtp_timestamp, argb_timings[i].rtp_timestamp);
+    ASSERT_EQ(timing.arrival_time_us, argb_timings[i].arrival_time_us);
+    if (i > 0) {
+      ASSERT_LE(timings[i - 1].arrival_time_us, timing.arrival_time_us);
+      ASSERT_LT(timings[i - 1].timestamp_us, timing.timestamp_us);
+      ASSERT_NE(timings[i - 1].rtp_timestamp, timing.rtp_timestamp);
+    }
+  }
+  mrsLocalVideoTrackRemoveRef(track_handle);
+}
+
+TEST(VideoTrack, FrameQueue) {
+  LocalPeerPairRaii pair;
+
+  VideoDeviceConfiguration config{};
+  LocalVideoTrackHandle track_handle{};
+  ASSERT_EQ(MRS_SUCCESS,
+            mrsPeerConnectionAddLocalVideoTrack(pair.pc1(), "local_video_track",
+                                                config, &track_handle));
+
+  constexpr int kCapacity = 4;
+  VideoFrameQueueHandle queue{};
+  ASSERT_EQ(MRS_E_INVALID_PARAMETER, mrsVideoFrameQueueCreate(0, &queue));
+  ASSERT_EQ(MRS_SUCCESS, mrsVideoFrameQueueCreate(kCapacity, &queue));
+  ASSERT_NE(nullptr, queue);
+
+  // Nothing to present yet
+  VideoFrameInfo frame{};
+  mrsBool is_new_frame = mrsBool::kTrue;
+  ASSERT_EQ(MRS_E_NOTFOUND,
+            mrsVideoFrameQueueTryDequeue(queue, mrsGetClockTimeUs(), &frame,
+                                         &is_new_frame));
+  ASSERT_EQ(mrsBool::kFalse, is_new_frame);
+
+  VideoSinkConfiguration sink_config{};
+  sink_config.format = VideoFrameFormat::kArgb32;
+  VideoSinkId sink_id{};
+  ASSERT_EQ(MRS_SUCCESS,
+            mrsVideoFrameQueueAddRemoteVideoSink(queue, pair.pc2(),
+                                                 sink_config, &sink_id));
+
+  pair.ConnectAndWait();
+
+  // Render loop at about 100 Hz, faster than the capture
+  uint32_t num_new_frames = 0;
+  int64_t last_timestamp_us = 0;
+  const auto end = std::chrono::steady_clock::now() + 3s;
+  while (std::chrono::steady_clock::now() < end) {
+    const int64_t now_us = mrsGetClockTimeUs();
+    if (mrsVideoFrameQueueTryDequeue(queue, now_us, &frame, &is_new_frame) ==
+        MRS_SUCCESS) {
+      ASSERT_EQ(VideoFrameFormat::kArgb32, frame.format);
+      ASSERT_LE(frame.timing.timestamp_us, now_us);
+      if (is_new_frame == mrsBool::kTrue) {
+        ASSERT_LT(last_timestamp_us, frame.timing.timestamp_us);
+        last_timestamp_us = frame.timing.timestamp_us;
+        ++num_new_frames;
+      } else {
+        ASSERT_EQ(last_timestamp_us, frame.timing.timestamp_us);
+      }
+    }
+    std::this_thread::sleep_for(10ms);
+  }
+  ASSERT_EQ(MRS_SUCCESS,
+            mrsPeerConnectionRemoveRemoteVideoSink(pair.pc2(), sink_id));
+
+  VideoFrameQueueStats stats{};
+  ASSERT_EQ(MRS_SUCCESS, mrsVideoFrameQueueGetStats(queue, &stats));
+  printf(
+      "Frame queue: %llu enqueued, %llu dequeued, %llu late, %llu overflow, "
+      "%llu repeated\n",
+      (unsigned long long)stats.enqueued_frames,
+      (unsigned long long)stats.dequeued_frames,
+      (unsigned long long)stats.late_frames,
+      (unsigned long long)stats.overflow_frames,
+      (unsigned long long)stats.repeated_frames);
+  ASSERT_LT(0u, num_new_frames);
+  ASSERT_EQ(num_new_frames, stats.dequeued_frames);
+  ASSERT_LT(0u, stats.repeated_frames);
+  ASSERT_LE(stats.pending_frames, (uint32_t)kCapacity);
+  ASSERT_EQ(stats.enqueued_frames,
+            stats.dequeued_frames + stats.late_frames + stats.overflow_frames +
+                stats.pending_frames);
+
+  mrsVideoFrameQueueRemoveRef(queue);
+  mrsLocalVideoTrackRemoveRef(track_handle);
+}
+
+TEST(VideoTrack, UnrotatedFrames) {
+  LocalPeerPairRaii pair;
+
+  VideoDeviceConfiguration config{};
+  LocalVideoTrackHandle track_handle{};
+  ASSERT_EQ(MRS_SUCCESS,
+            mrsPeerConnectionAddLocalVideoTrack(pair.pc1(), "local_video_track",
+                                                config, &track_handle));
+  ASSERT_EQ(MRS_SUCCESS,
+            mrsLocalVideoTrackSetApplyRotation(track_handle, mrsBool::kFalse));
+  ASSERT_EQ(MRS_SUCCESS, mrsPeerConnectionSetRemoteVideoApplyRotation(
+                             pair.pc2(), mrsBool::kFalse));
+
+  // Frames are delivered with the rotation to apply for display
+  std::atomic_uint32_t frame_count{0};
+  VideoFrameHandleCallback frame_cb = [&](const VideoFrameInfo* frame) {
+    ASSERT_TRUE((frame->rotation == VideoRotation::kRotation0) ||
+                (frame->rotation == VideoRotation::kRotation90) ||
+                (frame->rotation == VideoRotation::kRotation180) ||
+                (frame->rotation == VideoRotation::kRotation270));
+    ASSERT_LT(0, frame->width);
+    ASSERT_LT(0, frame->height);
+    ++frame_count;
+  };
+  mrsPeerConnectionRegisterRemoteVideoFrameHandleCallback(pair.pc2(),
+                                                          CB(frame_cb));
+
+  pair.ConnectAndWait();
+
+  Event ev;
+  ev.WaitFor(2s);
+
+  // Restoring the default applies to the tracks already added
+  ASSERT_EQ(MRS_SUCCESS, mrsPeerConnectionSetRemoteVideoApplyRotation(
+                             pair.pc2(), mrsBool::kTrue));
+  ev.WaitFor(1s);
+  mrsPeerConnectionRegisterRemoteVideoFrameHandleCallback(pair.pc2(), nullptr,
+                                                          nullptr);
+  ASSERT_LT(0u, frame_count.load());
+
+  mrsLocalVideoTrackRemoveRef(track_handle);
+}
+
+TEST(VideoTrack, MultipleSinks) {
+  LocalPeerPairRaii pair;
+
+  VideoDeviceConfiguration config{};
+  LocalVideoTrackHandle track_handle{};
+  ASSERT_EQ(MRS_SUCCESS,
+            mrsPeerConnectionAddLocalVideoTrack(pair.pc1(), "local_video_track",
+                                                config, &track_handle));
+
+  // Two sinks per format; sinks with the same format share the same frame.
+  // Record the frame each sink received, per frame. The sinks are invoked in
+  // turn for each frame, so the frame is always the last one recorded or a new
+  // one.
+  struct Delivery {
+    uint32_t rtp_timestamp;
+    int sink_mask;
+    VideoFrameHandle handles[4];
+  };
+  std::mutex deliveries_mutex;
+  std::deque<Delivery> deliveries;
+  std::atomic_int32_t num_duplicates{0};
+  VideoFrameHandle last_argb_frame{};
+  auto record = [&](int index, const VideoFrameInfo* frame) {
+    auto lock = std::scoped_lock{deliveries_mutex};
+    if (deliveries.empty() ||
+        (deliveries.back().rtp_timestamp != frame->timing.rtp_timestamp)) {
+      deliveries.push_back(Delivery{frame->timing.rtp_timestamp, 0, {}});
+    }
+    Delivery& delivery = deliveries.back();
+    if (delivery.sink_mask & (1 << index)) {
+      ++num_duplicates;
+    }
+    delivery.sink_mask |= (1 << index);
+    delivery.handles[index] = frame->handle;
+    if (frame->format == VideoFrameFormat::kArgb32) {
+      if (last_argb_frame) {
+        mrsVideoFrameRemoveRef(last_argb_frame);
+      }
+      mrsVideoFrameAddRef(frame->handle);
+      last_argb_frame = frame->handle;
+    }
+  };
+  auto make_i420a_cb = [&](int index) {
+    return [&record, index](const VideoFrameInfo* frame) {
+      ASSERT_NE(nullptr, frame);
+      ASSERT_NE(nullptr, frame->handle);
+      ASSERT_EQ(VideoFrameFormat::kI420A, frame->format);
+      ASSERT_NE(nullptr, frame->data[0]);
+      ASSERT_NE(nullptr, frame->data[1]);
+      ASSERT_NE(nullptr, frame->data[2]);
+      record(index, frame);
+    };
+  };
+  auto make_argb_cb = [&](int index) {
+    return [&record, index](const VideoFrameInfo* frame) {
+      ASSERT_NE(nullptr, frame);
+      ASSERT_NE(nullptr, frame->handle);
+      ASSERT_EQ(VideoFrameFormat::kArgb32, frame->format);
+      ASSERT_NE(nullptr, frame->data[0]);
+      ASSERT_LE(frame->width * 4, frame->stride[0]);
+      ASSERT_EQ(nullptr, frame->data[1]);
+      record(index, frame);
+    };
+  };
+  VideoFrameHandleCallback sink_cbs[4]{make_i420a_cb(0), make_i420a_cb(1),
+                                       make_argb_cb(2), make_argb_cb(3)};
+  VideoSinkConfiguration i420a_config{};
+  i420a_config.format = VideoFrameFormat::kI420A;
+  VideoSinkConfiguration argb_config{};
+  argb_config.format = VideoFrameFormat::kArgb32;
+  VideoSinkId sink_ids[4]{};
+  for (int i = 0; i < 4; ++i) {
+    ASSERT_EQ(MRS_SUCCESS, mrsPeerConnectionAddRemoteVideoSink(
+                               pair.pc2(), (i < 2 ? i420a_config : argb_config),
+                               CB(sink_cbs[i]), &sink_ids[i]));
+    ASSERT_NE(0u, sink_ids[i]);
+    for (int j = 0; j < i; ++j) {
+      ASSERT_NE(sink_ids[j], sink_ids[i]);
+    }
+  }
+
+  pair.ConnectAndWait();
+
+  Event ev;
+  ev.WaitFor(5s);
+
+  for (VideoSinkId id : sink_ids) {
+    ASSERT_EQ(MRS_SUCCESS,
+              mrsPeerConnectionRemoveRemoteVideoSink(pair.pc2(), id));
+  }
+  ASSERT_EQ(MRS_E_INVALID_PARAMETER,
+            mrsPeerConnectionRemoveRemoteVideoSink(pair.pc2(), sink_ids[0]));
+
+  // Each frame was delivered at most once to each sink. Frames delivered while
+  // only some of the sinks were registered are at the start and the end; all
+  // the frames in between were delivered to all the sinks, and the sinks of the
+  // same format received the same frame.
+  ASSERT_EQ(0, num_duplicates.load());
+  auto first = std::find_if(
+      deliveries.begin(), deliveries.end(),
+      [](const Delivery& delivery) { return (delivery.sink_mask == 0xF); });
+  ASSERT_NE(deliveries.end(), first);
+  auto last = std::find_if(
+      deliveries.rbegin(), deliveries.rend(),
+      [](const Delivery& delivery) { return (delivery.sink_mask == 0xF); });
+  for (auto it = first; it != last.base(); ++it) {
+    ASSERT_EQ(0xF, it->sink_mask);
+    ASSERT_EQ(it->handles[0], it->handles[1]);
+    ASSERT_EQ(it->handles[2], it->handles[3]);
+    ASSERT_NE(it->handles[0], it->handles[2]);
+  }
+
+  // The last ARGB frame retained is still valid after the sinks were removed
+  ASSERT_NE(nullptr, last_argb_frame);
+  VideoFrameInfo info{};
+  ASSERT_EQ(MRS_SUCCESS, mrsVideoFrameGetInfo(last_argb_frame, &info));
+  ASSERT_EQ(VideoFrameFormat::kArgb32, info.format);
+  ASSERT_NE(nullptr, info.data[0]);
+  mrsVideoFrameRemoveRef(last_argb_frame);
+  mrsLocalVideoTrackRemoveRef(track_handle);
+}
+
+TEST(VideoTrack, ArgbBufferCheckout) {
+  LocalPeerPairRaii pair;
+
+  VideoDeviceConfiguration config{};
+  LocalVideoTrackHandle track_handle{};
+  ASSERT_EQ(MRS_SUCCESS,
+            mrsPeerConnectionAddLocalVideoTrack(pair.pc1(), "local_video_track",
+                                                config, &track_handle));
+
+  // Keep the last 2 frames checked out, like a double-buffered renderer, and
+  // check that their content is not overwritten by the following frames.
+  struct RetainedFrame {
+    VideoFrameHandle handle;
+    std::vector<uint8_t> first_row;
+  };
+  std::deque<RetainedFrame> retained;
+  std::unordered_set<const void*> buffers;
+  uint32_t frame_count = 0;
+  auto check_and_release = [](const RetainedFrame& frame) {
+    VideoFrameInfo info{};
+    ASSERT_EQ(MRS_SUCCESS, mrsVideoFrameGetInfo(frame.handle, &info));
+    const uint8_t* data = static_cast<const uint8_t*>(info.data[0]);
+    ASSERT_TRUE(std::equal(frame.first_row.begin(), frame.first_row.end(),
+                           data));
+    mrsVideoFrameRemoveRef(frame.handle);
+  };
+  VideoFrameHandleCallback argb_cb = [&](const VideoFrameInfo* frame) {
+    ASSERT_EQ(VideoFrameFormat::kArgb32, frame->format);
+    for (const RetainedFrame& prev : retained) {
+      VideoFrameInfo prev_info{};
+      ASSERT_EQ(MRS_SUCCESS, mrsVideoFrameGetInfo(prev.handle, &prev_info));
+      ASSERT_NE(prev_info.data[0], frame->data[0]);
+    }
+    if (retained.size() == 2) {
+      check_and_release(retained.front());
+      retained.pop_front();
+    }
+    const uint8_t* data = static_cast<const uint8_t*>(frame->data[0]);
+    mrsVideoFrameAddRef(frame->handle);
+    retained.push_back(
+        RetainedFrame{frame->handle, {data, data + frame->width * 4}});
+    buffers.insert(frame->data[0]);
+    ++frame_count;
+  };
+  VideoSinkConfiguration sink_config{};
+  sink_config.format = VideoFrameFormat::kArgb32;
+  VideoSinkId sink_id{};
+  ASSERT_EQ(MRS_SUCCESS,
+            mrsPeerConnectionAddRemoteVideoSink(pair.pc2(), sink_config,
+                                                CB(argb_cb), &sink_id));
+
+  pair.ConnectAndWait();
+
+  Event ev;
+  ev.WaitFor(5s);
+
+  ASSERT_EQ(MRS_SUCCESS,
+            mrsPeerConnectionRemoveRemoteVideoSink(pair.pc2(), sink_id));
+  for (const RetainedFrame& frame : retained) {
+    check_and_release(frame);
+  }
+
+  // Buffers returned to the pool were reused
+  ASSERT_LT(50u, frame_count);
+  ASSERT_GT(frame_count / 2, buffers.size());
+
+  mrsLocalVideoTrackRemoveRef(track_handle);
+}
+
+namespace {
+
+/// Statistics of the intervals between consecutive frames.
+struct FrameIntervalStats {
+  uint32_t frame_count{};
+  std::chrono::steady_clock::duration max_interval{};
+  std::chrono::steady_clock::time_point last_frame{};
+
+  void AddFrame() {
+    const auto now = std::chrono::steady_clock::now();
+    if (frame_count > 0) {
+      max_interval = std::max(max_interval, now - last_frame);
+    }
+    last_frame = now;
+    ++frame_count;
+  }
+};
+
+double ToMilliseconds(std::chrono::steady_clock::duration d) {
+  return std::chrono::duration<double, std::milli>(d).count();
+}
+
+}  // namespace
+
+// Benchmark the frame delivery while registrations churn on another thread.
+// Frame delivery does not take any lock, so the delivery interval should not
+// degrade, while registrations wait at most for one frame delivery.
+TEST(VideoTrack, CallbackContention) {
+  LocalPeerPairRaii pair;
+
+  VideoDeviceConfiguration config{};
+  LocalVideoTrackHandle track_handle{};
+  ASSERT_EQ(MRS_SUCCESS,
+            mrsPeerConnectionAddLocalVideoTrack(pair.pc1(), "local_video_track",
+                                                config, &track_handle));
+
+  // Sink measuring the frame intervals, only accessed by the frame thread
+  // while running, and by the test thread after the sink was removed.
+  FrameIntervalStats stats;
+  VideoFrameHandleCallback measure_cb = [&stats](const VideoFrameInfo*) {
+    stats.AddFrame();
+  };
+  VideoFrameHandleCallback noop_cb = [](const VideoFrameInfo*) {};
+  I420VideoFrameCallback noop_i420_cb =
+      [](const void*, const void*, const void*, const void*, const int,
+         const int, const int, const int, const int, const int) {};
+  VideoSinkConfiguration sink_config{};
+  sink_config.format = VideoFrameFormat::kArgb32;
+
+  pair.ConnectAndWait();
+
+  // Baseline without contention
+  VideoSinkId measure_id{};
+  ASSERT_EQ(MRS_SUCCESS,
+            mrsPeerConnectionAddRemoteVideoSink(pair.pc2(), sink_config,
+                                                CB(measure_cb), &measure_id));
+  Event ev;
+  ev.WaitFor(3s);
+  ASSERT_EQ(MRS_SUCCESS,
+            mrsPeerConnectionRemoveRemoteVideoSink(pair.pc2(), measure_id));
+  const FrameIntervalStats baseline = stats;
+  stats = FrameIntervalStats{};
+
+  // Same with registrations churning on another thread
+  ASSERT_EQ(MRS_SUCCESS,
+            mrsPeerConnectionAddRemoteVideoSink(pair.pc2(), sink_config,
+                                                CB(measure_cb), &measure_id));
+  std::atomic_bool stop{false};
+  uint32_t num_registrations = 0;
+  std::chrono::steady_clock::duration max_registration{};
+  std::thread churn([&]() {
+    while (!stop.load()) {
+      const auto start = std::chrono::steady_clock::now();
+      VideoSinkId id{};
+      mrsPeerConnectionAddRemoteVideoSink(pair.pc2(), sink_config,
+                                          CB(noop_cb), &id);
+      mrsPeerConnectionRegisterI420ARemoteVideoFrameCallback(pair.pc2(),
+                                                             CB(noop_i420_cb));
+      mrsPeerConnectionRegisterI420ARemoteVideoFrameCallback(pair.pc2(),
+                                                             nullptr, nullptr);
+      mrsPeerConnectionRemoveRemoteVideoSink(pair.pc2(), id);
+      max_registration = std::max(max_registration,
+                                  std::chrono::steady_clock::now() - start);
+      num_registrations += 4;
+    }
+  });
+  ev.WaitFor(3s);
+  stop = true;
+  churn.join();
+  ASSERT_EQ(MRS_SUCCESS,
+            mrsPeerConnectionRemoveRemoteVideoSink(pair.pc2(), measure_id));
+
+  printf(
+      "Baseline: %u frames, max interval %.2f ms\n"
+      "Churning: %u frames, max interval %.2f ms, %u registrations, "
+      "max registration %.2f ms\n",
+      baseline.frame_count, ToMilliseconds(baseline.max_interval),
+      stats.frame_count, ToMilliseconds(stats.max_interval), num_registrations,
+      ToMilliseconds(max_registration));
+
+  // The churn does not stall the frame delivery
+  ASSERT_LT(0u, num_registrations);
+  ASSERT_LT(baseline.frame_count * 9 / 10, stats.frame_count);
+  ASSERT_LT(stats.max_interval, baseline.max_interval * 2 + 20ms);
+
+  mrsLocalVideoTrackRemoveRef(track_handle);
+}
+
+// A slow consumer with asynchronous delivery does not stall the frame producer;
+// the frames it cannot keep up with are dropped instead of queued.
+TEST(VideoTrack, AsyncDelivery) {
+  LocalPeerPairRaii pair;
+
+  VideoDeviceConfiguration config{};
+  LocalVideoTrackHandle track_handle{};
+  ASSERT_EQ(MRS_SUCCESS,
+            mrsPeerConnectionAddLocalVideoTrack(pair.pc1(), "local_video_track",
+                                                config, &track_handle));
+  ASSERT_EQ(MRS_E_INVALID_PARAMETER,
+            mrsPeerConnectionSetRemoteVideoAsyncDelivery(pair.pc2(), -1));
+  ASSERT_EQ(MRS_SUCCESS,
+            mrsPeerConnectionSetRemoteVideoAsyncDelivery(pair.pc2(), 1));
+
+  // Slow sink, invoked on the delivery thread
+  std::atomic<std::thread::id> delivery_thread{};
+  std::atomic_uint32_t slow_count{0};
+  VideoFrameHandleCallback slow_cb = [&](const VideoFrameInfo*) {
+    delivery_thread = std::this_thread::get_id();
+    ++slow_count;
+    std::this_thread::sleep_for(200ms);
+  };
+  VideoSinkConfiguration sink_config{};
+  sink_config.format = VideoFrameFormat::kArgb32;
+  VideoSinkId sink_id{};
+  ASSERT_EQ(MRS_SUCCESS,
+            mrsPeerConnectionAddRemoteVideoSink(pair.pc2(), sink_config,
+                                                CB(slow_cb), &sink_id));
+
+  pair.ConnectAndWait();
+
+  Event ev;
+  ev.WaitFor(3s);
+  ASSERT_EQ(MRS_SUCCESS,
+            mrsPeerConnectionRemoveRemoteVideoSink(pair.pc2(), sink_id));
+
+  VideoDeliveryStats stats{};
+  ASSERT_EQ(MRS_SUCCESS,
+            mrsPeerConnectionGetRemoteVideoDeliveryStats(pair.pc2(), &stats));
+  printf("Async delivery: %llu frames delivered, %llu frames dropped\n",
+         (unsigned long long)stats.delivered_frames,
+         (unsigned long long)stats.dropped_frames);
+  ASSERT_LT(0u, slow_count.load());
+  ASSERT_NE(std::this_thread::get_id(), delivery_thread.load());
+  ASSERT_LT(0u, stats.dropped_frames);
+  ASSERT_LE(slow_count.load(), stats.delivered_frames);
+
+  // Disabling joins the delivery thread and resets the stats
+  ASSERT_EQ(MRS_SUCCESS,
+            mrsPeerConnectionSetRemoteVideoAsyncDelivery(pair.pc2(), 0));
+  ASSERT_EQ(MRS_SUCCESS,
+            mrsPeerConnectionGetRemoteVideoDeliveryStats(pair.pc2(), &stats));
+  ASSERT_EQ(0u, stats.delivered_frames);
+  ASSERT_EQ(0u, stats.dropped_frames);
+
+  mrsLocalVideoTrackRemoveRef(track_handle);
+}
+
 void MRS_CALL enumDeviceCallback(const char* id,
                                  const char* /*name*/,
                                  void* user_data) {
@@ -144,6 +777,89 @@ void MRS_CALL enumDeviceCallbackCompleted(void* user_data) {
 //  }
 //}
 
+TEST(VideoTrack, CaptureFormat) {
+  PCRaii pc;
+
+  VideoDeviceConfiguration config{};
+  config.format_policy = VideoCaptureFormatPolicy::kLowestCost;
+  LocalVideoTrackHandle track_handle{};
+  ASSERT_EQ(MRS_SUCCESS,
+            mrsPeerConnectionAddLocalVideoTrack(pc.handle(), "capture_track",
+                                                config, &track_handle));
+  VideoCaptureFormatInfo format{};
+  if (mrsLocalVideoTrackGetCaptureFormat(track_handle, &format) ==
+      MRS_SUCCESS) {
+    ASSERT_LT(0u, format.width);
+    ASSERT_LT(0u, format.height);
+    ASSERT_EQ(mrsVideoCaptureFormatGetCost(format.width, format.height,
+                                           format.framerate, format.encoding),
+              format.cost);
+  }
+  ASSERT_EQ(MRS_SUCCESS,
+            mrsPeerConnectionRemoveLocalVideoTrack(pc.handle(), track_handle));
+  mrsLocalVideoTrackRemoveRef(track_handle);
+
+  // By default WebRTC selects the format
+  config = VideoDeviceConfiguration{};
+  ASSERT_EQ(VideoCaptureFormatPolicy::kDefault, config.format_policy);
+  ASSERT_EQ(MRS_SUCCESS,
+            mrsPeerConnectionAddLocalVideoTrack(pc.handle(), "capture_track",
+                                                config, &track_handle));
+  ASSERT_EQ(MRS_E_INVALID_OPERATION,
+            mrsLocalVideoTrackGetCaptureFormat(track_handle, &format));
+  ASSERT_EQ(MRS_SUCCESS,
+            mrsPeerConnectionRemoveLocalVideoTrack(pc.handle(), track_handle));
+  mrsLocalVideoTrackRemoveRef(track_handle);
+}
+
+// Enumerations after the first one replay the cached devices and formats.
+TEST(VideoTrack, EnumCached) {
+  // The cache is only enabled while the library is initialized, which watches
+  // for device changes.
+  PCRaii pc;
+  ASSERT_NE(nullptr, pc.handle());
+
+  DeviceList devices;
+  mrsEnumVideoCaptureDevicesAsync(&DeviceList::OnDevice, &devices,
+                                  &DeviceList::OnCompleted, &devices);
+  ASSERT_TRUE(devices.completed.WaitFor(10s));
+  ASSERT_FALSE(devices.ids.empty());
+  FormatList formats;
+  ASSERT_EQ(MRS_SUCCESS, mrsEnumVideoCaptureFormatsAsync(
+                             devices.ids[0].c_str(), &FormatList::OnFormat,
+                             &formats, &FormatList::OnCompleted, &formats));
+  ASSERT_TRUE(formats.completed.WaitFor(10s));
+  ASSERT_EQ(MRS_SUCCESS, formats.result);
+
+  // Cached enumerations complete before returning
+  const auto start = std::chrono::steady_clock::now();
+  DeviceList cached_devices;
+  mrsEnumVideoCaptureDevicesAsync(&DeviceList::OnDevice, &cached_devices,
+                                  &DeviceList::OnCompleted, &cached_devices);
+  ASSERT_TRUE(cached_devices.completed.WaitFor(0s));
+  FormatList cached_formats;
+  ASSERT_EQ(MRS_SUCCESS,
+            mrsEnumVideoCaptureFormatsAsync(
+                devices.ids[0].c_str(), &FormatList::OnFormat,
+                &cached_formats, &FormatList::OnCompleted, &cached_formats));
+  ASSERT_TRUE(cached_formats.completed.WaitFor(0s));
+  const auto elapsed = std::chrono::steady_clock::now() - start;
+  ASSERT_EQ(devices.ids, cached_devices.ids);
+  ASSERT_EQ(formats.formats, cached_formats.formats);
+  printf("Cached enumeration: %lld us\n",
+         static_cast<long long>(
+             std::chrono::duration_cast<std::chrono::microseconds>(elapsed)
+                 .count()));
+
+  // Probe again after invalidation
+  mrsInvalidateVideoCaptureCache();
+  DeviceList probed_devices;
+  mrsEnumVideoCaptureDevicesAsync(&DeviceList::OnDevice, &probed_devices,
+                                  &DeviceList::OnCompleted, &probed_devices);
+  ASSERT_TRUE(probed_devices.completed.WaitFor(10s));
+  ASSERT_EQ(devices.ids, probed_devices.ids);
+}
+
 TEST(VideoTrack, DeviceIdInvalid) {
   LocalPeerPairRaii pair;
 
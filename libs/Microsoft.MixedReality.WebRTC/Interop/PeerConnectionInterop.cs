@@ -389,6 +389,11 @@ namespace Microsoft.MixedReality.WebRTC.Interop
             /// When MRC is enabled, enable the on-screen recording indicator.
             /// </summary>
             public mrsBool EnableMRCRecordingIndicator;
+
+            /// <summary>
+            /// Policy selecting the capture format among the formats matching the other constraints.
+            /// </summary>
+            public PeerConnection.VideoCaptureFormatPolicy FormatPolicy;
         }
 
 
@@ -378,6 +378,26 @@ namespace Microsoft.MixedReality.WebRTC
             VideoHdr8,
         };
 
+        /// <summary>
+        /// Policy selecting the capture format of a local video capture device among the formats
+        /// matching the resolution and framerate constraints of <see cref="LocalVideoTrackSettings"/>.
+        /// </summary>
+        public enum VideoCaptureFormatPolicy : int
+        {
+            /// <summary>
+            /// Let WebRTC select the format, by resolution and framerate only. The encoding selected
+            /// among the formats of equal resolution and framerate depends on the order the device
+            /// lists them in.
+            /// </summary>
+            Default = 0,
+
+            /// <summary>
+            /// Prefer among the formats of equal resolution and framerate the encoding cheapest to
+            /// convert to I420, like NV12 over YUY2 or MJPG.
+            /// </summary>
+            LowestCost = 1,
+        };
+
         /// <summary>
         /// Settings for adding a local video track.
         /// </summary>
@@ -456,6 +476,12 @@ namespace Microsoft.MixedReality.WebRTC
             /// retrieved by <see cref="GetVideoCaptureFormatsAsync"/>.
             /// </remarks>
             public double? framerate;
+
+            /// <summary>
+            /// Policy selecting the capture format among the formats of the device matching
+            /// <see cref="width"/>, <see cref="height"/> and <see cref="framerate"/>.
+            /// </summary>
+            public VideoCaptureFormatPolicy formatPolicy = VideoCaptureFormatPolicy.Default;
         }
 
 
@@ -593,8 +619,11 @@ namespace Microsoft.MixedReality.WebRTC
         /// produced locally and is available for render.
         /// </summary>
         /// <remarks>
-        /// WARNING -- This is currently not implemented in the underlying WebRTC
-        /// implementation, so THIS EVENT IS NEVER FIRED.
+        /// The frames are the raw audio of the local audio capture device, and are
+        /// only delivered while a local audio track is added and audio is sent to
+        /// the remote peer. No frame is delivered while the local audio track is
+        /// disabled. The event is invoked from the audio capture thread. This is
+        /// not supported on UWP, where the event is never fired.
         /// </remarks>
         public event AudioFrameDelegate LocalAudioFrameReady;
 
@@ -925,7 +954,8 @@ namespace Microsoft.MixedReality.WebRTC
                     Height = settings.height.GetValueOrDefault(0),
                     Framerate = settings.framerate.GetValueOrDefault(0.0),
                     EnableMixedRealityCapture = (mrsBool)settings.enableMrc,
-                    EnableMRCRecordingIndicator = (mrsBool)settings.enableMrcRecordingIndicator
+                    EnableMRCRecordingIndicator = (mrsBool)settings.enableMrcRecordingIndicator,
+                    FormatPolicy = settings.formatPolicy
                 } : new PeerConnectionInterop.VideoDeviceConfiguration());
                 string trackName = settings.trackName;
                 if (trackName.Length == 0)